@@ -0,0 +1,3 @@
+dxc -spirv -T vs_6_6 -E vsmain "bin\basic\shaders\TextDraw.hlsl" -Fo "bin\basic\shaders\spv\TextDraw.vs.spv" -fspv-preserve-interface -fspv-target-env="vulkan1.3" -fvk-use-dx-layout
+dxc -spirv -T ps_6_6 -E psmain "bin\basic\shaders\TextDraw.hlsl" -Fo "bin\basic\shaders\spv\TextDraw.ps.spv" -fspv-preserve-interface -fspv-target-env="vulkan1.3" -fvk-use-dx-layout
+dxc -spirv -T ps_6_6 -E psmain_sdf "bin\basic\shaders\TextDraw.hlsl" -Fo "bin\basic\shaders\spv\TextDrawSDF.ps.spv" -fspv-preserve-interface -fspv-target-env="vulkan1.3" -fvk-use-dx-layout
\ No newline at end of file
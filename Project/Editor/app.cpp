@@ -38,9 +38,11 @@ App::App()
 	.texturesDir = "assets/textures/tiles/",
 	.shapesDir = "assets/models/shapes/",
 	.undoMax = 30UL,
+	.undoMemoryMax = 64UL,
 	.mouseSensitivity = 0.5f,
 	.exportSeparateGeometry = false,
 	.cullFaces = true,
+	.exportInstanced = false,
 	.defaultTexturePath = "assets/textures/tiles/brickwall.png",
 	.defaultShapePath = "assets/models/shapes/cube.obj",
 	},
@@ -276,7 +278,7 @@ void App::TrySaveMap(fs::path path)
 	}
 }
 
-void App::TryExportMap(fs::path path, bool separateGeometry)
+void App::TryExportMap(fs::path path, bool separateGeometry, bool instanced)
 {
 	//Add correct extension if no extension is given.
 	if (path.extension().empty())
@@ -288,7 +290,7 @@ void App::TryExportMap(fs::path path, bool separateGeometry)
 
 	if (path.extension() == ".gltf" || path.extension() == ".glb")
 	{
-		if (_mapMan->ExportGLTFScene(path, separateGeometry))
+		if (_mapMan->ExportGLTFScene(path, separateGeometry, instanced))
 		{
 			DisplayStatusMessage(std::string("Exported map as ") + path.filename().string(), 5.0f, 100);
 		}
@@ -322,9 +324,13 @@ void App::LoadSettings()
 {
 	try
 	{
+		//Start from the defaults, so that settings files missing newer fields still load
 		nlohmann::json jData;
+		App::to_json(jData, _settings);
+		nlohmann::json jFile;
 		std::ifstream file(SETTINGS_FILE_PATH);
-		file >> jData;
+		file >> jFile;
+		jData.update(jFile);
 		App::from_json(jData, _settings);
 	}
 	catch (std::exception e)
@@ -26,8 +26,10 @@ public:
 		std::string texturesDir;
 		std::string shapesDir;
 		size_t undoMax;
+		size_t undoMemoryMax; //In megabytes
 		float mouseSensitivity;
 		bool exportSeparateGeometry, cullFaces; //For GLTF export
+		bool exportInstanced; //For GLTF export
 		std::string exportFilePath; //For GLTF export
 		std::string defaultTexturePath;
 		std::string defaultShapePath;
@@ -38,9 +40,11 @@ public:
 		texturesDir,
 		shapesDir,
 		undoMax,
+		undoMemoryMax,
 		mouseSensitivity,
 		exportSeparateGeometry,
 		cullFaces,
+		exportInstanced,
 		exportFilePath,
 		defaultTexturePath,
 		defaultShapePath,
@@ -66,6 +70,7 @@ public:
 
 	inline float       GetMouseSensitivity() { return _settings.mouseSensitivity; }
 	inline size_t      GetUndoMax() { return _settings.undoMax; }
+	inline size_t      GetUndoMemoryMax() { return _settings.undoMemoryMax * 1024 * 1024; }
 	inline std::string GetTexturesDir() { return _settings.texturesDir; };
 	inline std::string GetShapesDir() { return _settings.shapesDir; }
 	inline std::string GetDefaultTexturePath() { return _settings.defaultTexturePath; }
@@ -94,7 +99,7 @@ public:
 	void ShrinkMap();
 	void TryOpenMap(fs::path path);
 	void TrySaveMap(fs::path path);
-	void TryExportMap(fs::path path, bool separateGeometry);
+	void TryExportMap(fs::path path, bool separateGeometry, bool instanced);
 
 	//Serializes settings into JSON file and exports.
 	void SaveSettings();
@@ -0,0 +1,379 @@
+#include "bench.h"
+
+#include "raylib.h"
+
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+
+#include "app.h"
+#include "map_man.h"
+
+static size_t ArgCount(const std::vector<std::string>& args, size_t index, size_t defaultValue)
+{
+	return (index < args.size()) ? size_t(std::max(std::atoi(args[index].c_str()), 1)) : defaultValue;
+}
+
+static bool Check(bool condition, const std::string& what)
+{
+	if (!condition) std::cout << "Check failed: " << what << std::endl;
+	return condition;
+}
+
+// ======================================================================
+// UNDO HISTORY
+// ======================================================================
+
+//Plain copy of a map's tiles, edited by its own loops to know what the map has to look like.
+struct TileSnapshot
+{
+	size_t width, height, length;
+	std::vector<Tile> tiles;
+
+	inline Tile& At(size_t x, size_t y, size_t z) { return tiles[x + (z * width) + (y * width * length)]; }
+	inline const Tile& At(size_t x, size_t y, size_t z) const { return tiles[x + (z * width) + (y * width * length)]; }
+	inline bool operator==(const TileSnapshot& other) const { return tiles == other.tiles; }
+
+	bool Matches(const TileGrid& grid) const
+	{
+		for (size_t y = 0; y < height; ++y)
+			for (size_t z = 0; z < length; ++z)
+				for (size_t x = 0; x < width; ++x)
+					if (grid.GetTile(x, y, z) != At(x, y, z)) return false;
+		return true;
+	}
+};
+
+//Runs random fills, brush stamps, strokes, undos and redos, and after every step compares the whole map
+//with a snapshot of what the history says it should be.
+static bool UndoHistory(const std::vector<std::string>& args)
+{
+	const size_t steps = ArgCount(args, 0, 3000);
+	const size_t width = 24, height = 4, length = 24;
+	const size_t undoMax = App::Get()->GetUndoMax();
+
+	MapMan map;
+	map.NewMap(width, height, length);
+
+	std::mt19937 random(5);
+	auto randomIn = [&](size_t count) { return size_t(random() % count); };
+	//A small palette, so neighboring cels often get the same tile and share runs
+	auto randomTile = [&]() { return (random() % 5 == 0) ? Tile() : Tile(ModelID(random() % 3), int(random() % 4) * 90, TexID(random() % 3), 0); };
+
+	std::vector<TileSnapshot> states = { TileSnapshot{ width, height, length, std::vector<Tile>(width * height * length) } };
+	size_t current = 0, undoable = 0, redoable = 0;
+
+	//Fills the same box as ExecuteTileAction, clipped to the map
+	auto fill = [&](TileSnapshot& snapshot, size_t i, size_t j, size_t k, size_t w, size_t h, size_t l, const Tile& tile)
+	{
+		for (size_t y = j; y < std::min(j + h, height); ++y)
+			for (size_t z = k; z < std::min(k + l, length); ++z)
+				for (size_t x = i; x < std::min(i + w, width); ++x)
+					snapshot.At(x, y, z) = tile;
+	};
+
+	//An edit only becomes an action if it changed something, and then it drops the redo history
+	auto pushState = [&](const TileSnapshot& snapshot)
+	{
+		if (snapshot == states[current]) return;
+		states.resize(current + 1);
+		states.push_back(snapshot);
+		++current;
+		undoable = std::min(undoable + 1, undoMax);
+		redoable = 0;
+	};
+
+	size_t undos = 0, redos = 0;
+	bool ok = true;
+	for (size_t step = 0; step < steps && ok; ++step)
+	{
+		const size_t i = randomIn(width), j = randomIn(height), k = randomIn(length);
+		switch (random() % 10)
+		{
+		case 0: case 1: case 2: case 3: //Box fill
+		{
+			const size_t w = 1 + randomIn(8), h = 1 + randomIn(2), l = 1 + randomIn(8);
+			const Tile tile = randomTile();
+			TileSnapshot next = states[current];
+			fill(next, i, j, k, w, h, l, tile);
+			map.ExecuteTileAction(i, j, k, w, h, l, tile);
+			pushState(next);
+			break;
+		}
+		case 4: //Brush, its empty tiles leave the map alone
+		{
+			const size_t w = 1 + randomIn(5), h = 1 + randomIn(2), l = 1 + randomIn(5);
+			TileGrid brush(nullptr, w, h, l);
+			TileSnapshot next = states[current];
+			for (size_t y = 0; y < h; ++y)
+				for (size_t z = 0; z < l; ++z)
+					for (size_t x = 0; x < w; ++x)
+					{
+						const Tile tile = (random() % 3 == 0) ? Tile() : randomTile();
+						brush.SetTile(x, y, z, tile);
+						if (tile && i + x < width && j + y < height && k + z < length) next.At(i + x, j + y, k + z) = tile;
+					}
+			map.ExecuteTileAction(i, j, k, w, h, l, brush);
+			pushState(next);
+			break;
+		}
+		case 5: //Stroke of overlapping fills, undone as one
+		{
+			TileSnapshot next = states[current];
+			map.BeginTileStroke();
+			for (size_t s = 1 + randomIn(6); s > 0; --s)
+			{
+				const size_t x = randomIn(width), y = randomIn(height), z = randomIn(length);
+				const Tile tile = randomTile();
+				fill(next, x, y, z, 3, 1, 3, tile);
+				map.ExecuteTileAction(x, y, z, 3, 1, 3, tile);
+			}
+			map.EndTileStroke();
+			pushState(next);
+			break;
+		}
+		case 6: case 7: case 8:
+			map.Undo();
+			++undos;
+			if (undoable > 0) { --current; --undoable; ++redoable; }
+			break;
+		default:
+			map.Redo();
+			++redos;
+			if (redoable > 0) { ++current; --redoable; ++undoable; }
+			break;
+		}
+
+		ok &= Check(states[current].Matches(map.Tiles()), "map matches the expected history state after step " + std::to_string(step));
+	}
+	ok &= Check(map.GetHistoryMemoryUsage() <= App::Get()->GetUndoMemoryMax(), "history within its memory budget (the expected states assume no memory trimming)");
+
+	std::cout << "undo-history: " << steps << " steps, " << undos << " undos, " << redos << " redos, history "
+		<< map.GetHistoryMemoryUsage() << " bytes" << std::endl;
+	return ok;
+}
+
+// ======================================================================
+// CHUNK REBUILD
+// ======================================================================
+
+static void DrawOneFrame(MapMan& map)
+{
+	Camera camera = { 0 };
+	camera.position = Vector3{ 0.0f, 20.0f, -20.0f };
+	camera.up = Vector3{ 0.0f, 1.0f, 0.0f };
+	camera.fovy = 70.0f;
+	camera.projection = CAMERA_PERSPECTIVE;
+
+	BeginDrawing();
+	ClearBackground(BLACK);
+	BeginMode3D(camera);
+	map.DrawMap(camera, 0, int(map.Tiles().GetHeight()) - 1);
+	EndMode3D();
+	EndDrawing();
+}
+
+static double Median(std::vector<double>& samples)
+{
+	std::sort(samples.begin(), samples.end());
+	return samples.empty() ? 0.0 : samples[samples.size() / 2];
+}
+
+//The first few shapes and textures of the asset directories, to fill generated maps with
+struct TilePalette
+{
+	std::vector<fs::path> texturePaths, shapePaths;
+
+	TilePalette()
+	{
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(App::Get()->GetTexturesDir(), error))
+			if (entry.path().extension() == ".png" && texturePaths.size() < 4) texturePaths.push_back(entry.path());
+		for (const auto& entry : std::filesystem::directory_iterator(App::Get()->GetShapesDir(), error))
+			if (entry.path().extension() == ".obj" && shapePaths.size() < 4) shapePaths.push_back(entry.path());
+		if (texturePaths.empty()) texturePaths.push_back(App::Get()->GetDefaultTexturePath());
+		if (shapePaths.empty()) shapePaths.push_back(App::Get()->GetDefaultShapePath());
+	}
+
+	Tile RandomTile(MapMan& map, std::mt19937& random) const
+	{
+		const fs::path& shape = shapePaths[random() % shapePaths.size()];
+		const fs::path& texture = texturePaths[random() % texturePaths.size()];
+		return Tile(map.GetOrAddModelID(shape), int(random() % 4) * 90, map.GetOrAddTexID(texture), 0);
+	}
+};
+
+//Floor, walls around the edge and random pillars, roughly a level
+static void GenerateLevel(MapMan& map, size_t size, size_t height, const TilePalette& palette, std::mt19937& random)
+{
+	map.NewMap(size, height, size);
+	map.ExecuteTileAction(0, 0, 0, size, 1, size, palette.RandomTile(map, random));
+	map.ExecuteTileAction(0, 1, 0, size, height - 1, 1, palette.RandomTile(map, random));
+	map.ExecuteTileAction(0, 1, size - 1, size, height - 1, 1, palette.RandomTile(map, random));
+	for (size_t p = 0; p < size * size / 16; ++p)
+		map.ExecuteTileAction(random() % size, 1, random() % size, 1, 1 + random() % (height - 1), 1, palette.RandomTile(map, random));
+}
+
+//Times the draw batch rebuild of a large map from scratch and after single tile edits,
+//and checks that an edit only rebuilds the one chunk it is in.
+static bool ChunkRebuild(const std::vector<std::string>& args)
+{
+	const size_t edits = ArgCount(args, 0, 200);
+	const size_t size = ArgCount(args, 1, 256);
+	const size_t height = 5;
+	const size_t fullBuilds = 5;
+
+	const TilePalette palette;
+	std::mt19937 random(11);
+	MapMan map;
+
+	const size_t chunksPerLayer = ((size + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE) * ((size + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE);
+	bool ok = true;
+	std::vector<double> fullTimes;
+	for (size_t build = 0; build < fullBuilds; ++build)
+	{
+		GenerateLevel(map, size, height, palette, random);
+		DrawOneFrame(map);
+		const TileGrid::BatchStats& stats = map.Tiles().GetBatchStats();
+		ok &= Check(stats.chunksRebuilt == chunksPerLayer * height, "a new map rebuilds every chunk");
+		fullTimes.push_back(stats.milliseconds);
+	}
+
+	std::vector<double> editTimes;
+	for (size_t e = 0; e < edits && ok; ++e)
+	{
+		const size_t x = random() % size, y = random() % height, z = random() % size;
+		const Tile tile = map.Tiles().GetTile(x, y, z) ? Tile() : palette.RandomTile(map, random);
+		map.ExecuteTileAction(x, y, z, 1, 1, 1, tile);
+
+		const size_t rebuildCount = map.Tiles().GetBatchStats().rebuildCount;
+		DrawOneFrame(map);
+		const TileGrid::BatchStats& stats = map.Tiles().GetBatchStats();
+		ok &= Check(stats.rebuildCount == rebuildCount + 1, "an edit brings the batches up to date");
+		ok &= Check(stats.chunksRebuilt == 1, "a single tile edit rebuilds one chunk, not " + std::to_string(stats.chunksRebuilt));
+		editTimes.push_back(stats.milliseconds);
+	}
+
+	const double editMax = editTimes.empty() ? 0.0 : *std::max_element(editTimes.begin(), editTimes.end());
+	std::cout << "chunk-rebuild: " << size << "x" << height << "x" << size << " map, " << chunksPerLayer * height << " chunks, full rebuild "
+		<< Median(fullTimes) << " ms, single tile edit median " << Median(editTimes) << " ms, max " << editMax << " ms" << std::endl;
+	return ok;
+}
+
+// ======================================================================
+// EXPORT
+// ======================================================================
+
+//Checks the 12 byte GLB header: magic, version 2 and the total length matching the file
+static bool IsValidGLB(const fs::path& path, uintmax_t fileSize)
+{
+	std::ifstream file(path, std::ios::binary);
+	uint32_t header[3] = {};
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	return file && header[0] == 0x46546C67 && header[1] == 2 && header[2] == fileSize;
+}
+
+//Exports a large generated map as a baked .gltf, a streamed baked .glb and an instanced .glb,
+//and reports the best time and the file size of each.
+static bool Export(const std::vector<std::string>& args)
+{
+	const size_t size = ArgCount(args, 0, 64);
+	const size_t runs = ArgCount(args, 1, 3);
+	const size_t height = 3;
+
+	const TilePalette palette;
+	std::mt19937 random(17);
+	MapMan map;
+	GenerateLevel(map, size, height, palette, random);
+
+	size_t tileCount = 0;
+	for (size_t y = 0; y < height; ++y)
+		for (size_t z = 0; z < size; ++z)
+			for (size_t x = 0; x < size; ++x)
+				if (map.Tiles().GetTile(x, y, z)) ++tileCount;
+
+	std::error_code error;
+	const fs::path directory = fs::temp_directory_path(error) / "EditorExportBenchmark";
+	fs::create_directories(directory, error);
+
+	struct ExportCase { const char* name; const char* fileName; bool instanced; };
+	const ExportCase cases[] = {
+		{ "baked .gltf",    "baked.gltf",    false },
+		{ "baked .glb",     "baked.glb",     false },
+		{ "instanced .glb", "instanced.glb", true },
+	};
+
+	bool ok = true;
+	std::cout << "export: " << size << "x" << height << "x" << size << " map, " << tileCount << " tiles, "
+		<< palette.shapePaths.size() << " shapes, " << palette.texturePaths.size() << " textures, face culling "
+		<< (App::Get()->IsCullingEnabled() ? "on" : "off") << std::endl;
+	for (const ExportCase& exportCase : cases)
+	{
+		const fs::path path = directory / exportCase.fileName;
+		std::vector<double> times;
+		for (size_t r = 0; r < runs; ++r)
+		{
+			const auto startTime = std::chrono::steady_clock::now();
+			ok &= Check(map.ExportGLTFScene(path, false, exportCase.instanced), std::string("export ") + exportCase.name);
+			times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+		}
+
+		const uintmax_t fileSize = fs::file_size(path, error);
+		ok &= Check(!error && fileSize > 0, std::string(exportCase.name) + " was written");
+		if (path.extension() == ".glb")
+			ok &= Check(IsValidGLB(path, fileSize), std::string(exportCase.name) + " has a valid header");
+
+		std::cout << "export: " << exportCase.name << " best of " << runs << " " << *std::min_element(times.begin(), times.end())
+			<< " ms, " << double(fileSize) / (1024.0 * 1024.0) << " MB" << std::endl;
+	}
+
+	fs::remove_all(directory, error);
+	return ok;
+}
+
+// ======================================================================
+// RUNNER
+// ======================================================================
+
+struct Benchmark
+{
+	const char* name;
+	const char* usage;
+	bool (*func)(const std::vector<std::string>& args);
+};
+
+static const Benchmark BENCHMARKS[] = {
+	{ "undo-history",  "[steps=3000]",             UndoHistory },
+	{ "chunk-rebuild", "[edits=200] [size=256]",   ChunkRebuild },
+	{ "export",        "[size=64] [runs=3]",       Export },
+};
+
+bool RunBenchmarks(const std::string& name, const std::vector<std::string>& args)
+{
+	bool found = false;
+	bool succeeded = true;
+	for (const Benchmark& benchmark : BENCHMARKS)
+	{
+		if (name != "all" && name != benchmark.name) continue;
+		found = true;
+
+		std::cout << "--- " << benchmark.name << std::endl;
+		const bool result = benchmark.func(args);
+		std::cout << benchmark.name << (result ? ": OK" : ": FAILED") << std::endl;
+		succeeded &= result;
+	}
+
+	if (!found)
+	{
+		std::cout << "Usage: Editor --bench <name|all> [args...]" << std::endl;
+		for (const Benchmark& benchmark : BENCHMARKS)
+		{
+			std::cout << "  " << benchmark.name << " " << benchmark.usage << std::endl;
+		}
+		return false;
+	}
+	return succeeded;
+}
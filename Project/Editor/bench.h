@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//Editor --bench <name|all> [args...]: runs one of the editor's checks and benchmarks, or all of them.
+//They need a window (a hidden one does) for the GPU side of the tile models and textures.
+//Returns false if a check failed or the name is unknown, in which case the benchmarks are listed.
+bool RunBenchmarks(const std::string& name, const std::vector<std::string>& args);
@@ -420,6 +420,11 @@ bool SettingsDialog::Draw()
 		if (undoMax < 0) undoMax = 0;
 		_settingsCopy.undoMax = undoMax;
 
+		int undoMemoryMax = (int)_settingsCopy.undoMemoryMax;
+		ImGui::InputInt("Undo memory limit (MB)", &undoMemoryMax, 1, 16);
+		if (undoMemoryMax < 1) undoMemoryMax = 1;
+		_settingsCopy.undoMemoryMax = undoMemoryMax;
+
 		ImGui::SliderFloat("Mouse sensitivity", &_settingsCopy.mouseSensitivity, 0.05f, 10.0f, "%.1f", ImGuiSliderFlags_NoRoundToFormat);
 
 		float bgColorf[3] = {
@@ -603,12 +608,15 @@ bool ExportDialog::Draw()
 		}
 		_settings.exportFilePath = _filePathBuffer;
 
+		ImGui::Checkbox("Instance tile shapes (EXT_mesh_gpu_instancing)", &_settings.exportInstanced);
+		ImGui::BeginDisabled(_settings.exportInstanced);
 		ImGui::Checkbox("Seperate nodes for each texture", &_settings.exportSeparateGeometry);
 		ImGui::Checkbox("Cull redundant faces between tiles", &_settings.cullFaces);
+		ImGui::EndDisabled();
 
 		if (ImGui::Button("Export##exportgltf"))
 		{
-			App::Get()->TryExportMap(fs::path(_settings.exportFilePath), _settings.exportSeparateGeometry);
+			App::Get()->TryExportMap(fs::path(_settings.exportFilePath), _settings.exportSeparateGeometry, _settings.exportInstanced);
 			App::Get()->SaveSettings();
 			ImGui::EndPopup();
 			return false;
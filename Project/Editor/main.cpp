@@ -1,4 +1,5 @@
 ﻿#include "app.h"
+#include "bench.h"
 
 #include "raylib.h"
 #include "raymath.h"
@@ -17,6 +18,17 @@ int main(
 	[[maybe_unused]] int   argc,
 	[[maybe_unused]] char* argv[])
 {
+	// Editor --bench <name|all> [args...]: runs the editor checks and benchmarks in a hidden window and exits
+	if (argc >= 2 && std::string(argv[1]) == "--bench")
+	{
+		SetConfigFlags(FLAG_WINDOW_HIDDEN);
+		InitWindow(1280, 720, "Editor");
+		SetTraceLogLevel(LOG_WARNING);
+		const bool succeeded = RunBenchmarks(argc >= 3 ? argv[2] : "", std::vector<std::string>(argv + std::min(argc, 3), argv + argc));
+		CloseRaylibWindow();
+		return succeeded ? 0 : 1;
+	}
+
 	// Window stuff
 	InitWindow(1280, 720, "Editor");
 	SetWindowMinSize(640, 480);
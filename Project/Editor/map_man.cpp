@@ -7,6 +7,7 @@
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
 
 #include "app.h"
 #include "assets.h"
@@ -16,20 +17,51 @@
 // TILE ACTION
 // ======================================================================
 
-MapMan::TileAction::TileAction(size_t i, size_t j, size_t k, TileGrid prevState, TileGrid newState)
-	: _i(i), _j(j), _k(k),
-	_prevState(prevState),
-	_newState(newState)
-{}
+MapMan::TileAction::TileAction(const std::vector<Change>& changes)
+{
+	//Extends the last run if the cel comes right after it and has the same tile, otherwise starts a new run.
+	auto addToRuns = [](std::vector<Run>& runs, size_t index, const Tile& tile)
+	{
+		if (!runs.empty() && runs.back().start + runs.back().count == index && runs.back().tile == tile)
+		{
+			++runs.back().count;
+		}
+		else
+		{
+			runs.push_back(Run{ uint32_t(index), 1, tile });
+		}
+	};
+
+	for (const Change& change : changes)
+	{
+		addToRuns(_prevRuns, change.index, change.prevTile);
+		addToRuns(_newRuns, change.index, change.newTile);
+	}
+	_prevRuns.shrink_to_fit();
+	_newRuns.shrink_to_fit();
+}
 
 void MapMan::TileAction::Do(MapMan& map) const
 {
-	map._tileGrid.CopyTiles(_i, _j, _k, _newState);
+	_ApplyRuns(map._tileGrid, _newRuns);
 }
 
 void MapMan::TileAction::Undo(MapMan& map) const
 {
-	map._tileGrid.CopyTiles(_i, _j, _k, _prevState);
+	_ApplyRuns(map._tileGrid, _prevRuns);
+}
+
+size_t MapMan::TileAction::GetMemoryUsage() const
+{
+	return sizeof(*this) + (_prevRuns.capacity() + _newRuns.capacity()) * sizeof(Run);
+}
+
+void MapMan::TileAction::_ApplyRuns(TileGrid& grid, const std::vector<Run>& runs)
+{
+	for (const Run& run : runs)
+	{
+		grid.SetTileRun(run.start, run.count, run.tile);
+	}
 }
 
 // ======================================================================
@@ -68,43 +100,159 @@ void MapMan::EntAction::Undo(MapMan& map) const
 	}
 }
 
+size_t MapMan::EntAction::GetMemoryUsage() const
+{
+	size_t size = sizeof(*this);
+	for (const Ent* ent : { &_oldEnt, &_newEnt })
+	{
+		for (const auto& [key, value] : ent->properties)
+		{
+			size += sizeof(key) + sizeof(value) + key.capacity() + value.capacity();
+		}
+	}
+	return size;
+}
+
 // ======================================================================
 // MAP MAN
 // ======================================================================
 
 void MapMan::_Execute(std::shared_ptr<Action> action)
 {
+	_CommitTileChanges();
+	action->Do(*this);
+	_PushHistory(action);
+}
+
+void MapMan::_PushHistory(std::shared_ptr<Action> action)
+{
+	for (const std::shared_ptr<Action>& redoAction : _redoHistory)
+	{
+		_historyMemory -= redoAction->GetMemoryUsage();
+	}
+	_redoHistory.clear();
+
 	_undoHistory.push_back(action);
-	if (_undoHistory.size() > App::Get()->GetUndoMax()) _undoHistory.pop_front();
+	_historyMemory += action->GetMemoryUsage();
+	_TrimHistory();
+}
+
+void MapMan::_TrimHistory()
+{
+	const size_t undoMax = App::Get()->GetUndoMax();
+	const size_t memoryMax = App::Get()->GetUndoMemoryMax();
+	//The latest action is kept even if it doesn't fit in the memory budget by itself, so that it can still be undone.
+	while (!_undoHistory.empty() && (_undoHistory.size() > undoMax || (_historyMemory > memoryMax && _undoHistory.size() > 1)))
+	{
+		_historyMemory -= _undoHistory.front()->GetMemoryUsage();
+		_undoHistory.pop_front();
+	}
+}
+
+void MapMan::_ClearHistory()
+{
+	_undoHistory.clear();
 	_redoHistory.clear();
-	_undoHistory.back()->Do(*this);
+	_historyMemory = 0;
+	_pendingTileChanges.clear();
+	_tileStroke = false;
+}
+
+void MapMan::_ChangeTile(size_t flatIndex, const Tile& newTile)
+{
+	const Tile prevTile = _tileGrid.GetTile(flatIndex);
+	if (prevTile != newTile)
+	{
+		_pendingTileChanges.push_back(TileAction::Change{ flatIndex, prevTile, newTile });
+		_tileGrid.SetTile(flatIndex, newTile);
+	}
+}
+
+void MapMan::_CommitTileChanges()
+{
+	if (_pendingTileChanges.empty()) return;
+
+	//During a stroke the same cel can change more than once. Only its first old tile and its last new tile are kept.
+	std::vector<TileAction::Change>& changes = _pendingTileChanges;
+	if (!std::is_sorted(changes.begin(), changes.end(), [](const auto& a, const auto& b) { return a.index < b.index; }))
+	{
+		std::stable_sort(changes.begin(), changes.end(), [](const auto& a, const auto& b) { return a.index < b.index; });
+	}
+	size_t count = 0;
+	for (size_t c = 0; c < changes.size(); ++c)
+	{
+		if (count > 0 && changes[count - 1].index == changes[c].index)
+		{
+			changes[count - 1].newTile = changes[c].newTile;
+		}
+		else
+		{
+			changes[count++] = changes[c];
+		}
+	}
+	changes.resize(count);
+	std::erase_if(changes, [](const TileAction::Change& change) { return change.prevTile == change.newTile; });
+
+	if (!changes.empty())
+	{
+		_PushHistory(std::static_pointer_cast<Action>(std::make_shared<TileAction>(changes)));
+	}
+	changes.clear();
+}
+
+void MapMan::BeginTileStroke()
+{
+	_CommitTileChanges();
+	_tileStroke = true;
+}
+
+void MapMan::EndTileStroke()
+{
+	_tileStroke = false;
+	_CommitTileChanges();
 }
 
 void MapMan::ExecuteTileAction(size_t i, size_t j, size_t k, size_t w, size_t h, size_t l, Tile newTile)
 {
-	TileGrid prevState = _tileGrid.Subsection(i, j, k, w, h, l);
-	TileGrid newState = TileGrid(this, w, h, l, _tileGrid.GetSpacing(), newTile);
+	//Cut off parts that go beyond map boundaries
+	const size_t xEnd = std::min(i + w, _tileGrid.GetWidth());
+	const size_t yEnd = std::min(j + h, _tileGrid.GetHeight());
+	const size_t zEnd = std::min(k + l, _tileGrid.GetLength());
+	//Visits the cels in flat index order, so the changes come out sorted
+	for (size_t y = j; y < yEnd; ++y)
+	{
+		for (size_t z = k; z < zEnd; ++z)
+		{
+			for (size_t x = i; x < xEnd; ++x)
+			{
+				_ChangeTile(_tileGrid.FlatIndex(x, y, z), newTile);
+			}
+		}
+	}
 
-	_Execute(std::static_pointer_cast<Action>(
-		std::make_shared<TileAction>(i, j, k, prevState, newState)
-	));
+	if (!_tileStroke) _CommitTileChanges();
 }
 
 void MapMan::ExecuteTileAction(size_t i, size_t j, size_t k, size_t w, size_t h, size_t l, TileGrid brush)
 {
-	const TileGrid prevState = _tileGrid.Subsection(
-		i, j, k,
-		Min(w, _tileGrid.GetWidth() - i),  //Cut off parts that go beyond map boundaries
-		Min(h, _tileGrid.GetHeight() - j),
-		Min(l, _tileGrid.GetLength() - k)
-	);
-
-	TileGrid newState = prevState; //Copy the old state and merge the brush into it
-	newState.CopyTiles(0, 0, 0, brush, true);
+	//Cut off parts that go beyond map boundaries
+	const size_t xEnd = std::min(i + std::min(w, brush.GetWidth()), _tileGrid.GetWidth());
+	const size_t yEnd = std::min(j + std::min(h, brush.GetHeight()), _tileGrid.GetHeight());
+	const size_t zEnd = std::min(k + std::min(l, brush.GetLength()), _tileGrid.GetLength());
+	for (size_t y = j; y < yEnd; ++y)
+	{
+		for (size_t z = k; z < zEnd; ++z)
+		{
+			for (size_t x = i; x < xEnd; ++x)
+			{
+				//Empty brush tiles don't overwrite anything
+				const Tile brushTile = brush.GetTile(x - i, y - j, z - k);
+				if (brushTile) _ChangeTile(_tileGrid.FlatIndex(x, y, z), brushTile);
+			}
+		}
+	}
 
-	_Execute(std::static_pointer_cast<Action>(
-		std::make_shared<TileAction>(i, j, k, prevState, newState)
-	));
+	if (!_tileStroke) _CommitTileChanges();
 }
 
 void MapMan::ExecuteEntPlacement(int i, int j, int k, Ent newEnt)
@@ -207,8 +355,7 @@ bool MapMan::SaveTE3Map(fs::path filePath)
 
 bool MapMan::LoadTE3Map(fs::path filePath)
 {
-	_undoHistory.clear();
-	_redoHistory.clear();
+	_ClearHistory();
 
 	using namespace nlohmann;
 
@@ -18,21 +18,43 @@ public:
 	class Action
 	{
 	public:
+		virtual ~Action() {}
 		virtual void Do(MapMan& map) const = 0;
 		virtual void Undo(MapMan& map) const = 0;
+		//Returns roughly how many bytes the action keeps in memory, for the undo memory budget.
+		virtual size_t GetMemoryUsage() const = 0;
 	};
 
+	//Only stores the cels that changed. The old and new tiles are each run-length encoded over the changed cels,
+	//so neighboring cels (in flat index order) that had or got the same tile share one run.
 	class TileAction : public Action
 	{
 	public:
-		TileAction(size_t i, size_t j, size_t k, TileGrid prevState, TileGrid newState);
+		struct Change
+		{
+			size_t index; //Flat index into the map's tile grid
+			Tile prevTile;
+			Tile newTile;
+		};
+
+		struct Run
+		{
+			uint32_t start; //Flat index of the first cel
+			uint32_t count;
+			Tile tile;
+		};
+
+		//The changes must be sorted by index, with no index appearing twice.
+		TileAction(const std::vector<Change>& changes);
 
 		virtual void Do(MapMan& map) const override;
 		virtual void Undo(MapMan& map) const override;
+		virtual size_t GetMemoryUsage() const override;
+	protected:
+		static void _ApplyRuns(TileGrid& grid, const std::vector<Run>& runs);
 
-		size_t _i, _j, _k;
-		TileGrid _prevState;
-		TileGrid _newState;
+		std::vector<Run> _prevRuns;
+		std::vector<Run> _newRuns;
 	};
 
 	class EntAction : public Action
@@ -42,6 +64,7 @@ public:
 
 		virtual void Do(MapMan& map) const override;
 		virtual void Undo(MapMan& map) const override;
+		virtual size_t GetMemoryUsage() const override;
 	protected:
 		size_t _i, _j, _k;
 		bool _overwrite; //Indicates if there was an entity underneath the one placed that must be restored when undoing.
@@ -55,8 +78,7 @@ public:
 	{
 		_tileGrid = TileGrid(this, width, height, length);
 		_entGrid = EntGrid(width, height, length);
-		_undoHistory.clear();
-		_redoHistory.clear();
+		_ClearHistory();
 	}
 
 	inline const TileGrid& Tiles() const { return _tileGrid; }
@@ -88,8 +110,7 @@ public:
 		case Direction::Y_POS: newHeight += amount; break;
 		}
 
-		_undoHistory.clear();
-		_redoHistory.clear();
+		_ClearHistory();
 		TileGrid oldTiles = _tileGrid;
 		EntGrid oldEnts = _entGrid;
 		_tileGrid = TileGrid(this, newWidth, newHeight, newLength);
@@ -101,6 +122,7 @@ public:
 	//Reduces the size of the grid until it fits perfectly around all the non-empty cels in the map.
 	inline void ShrinkMap()
 	{
+		_ClearHistory(); //Tile actions refer to cels by flat index, which change with the grid size.
 		size_t minX, minY, minZ;
 		size_t maxX, maxY, maxZ;
 		minX = minY = minZ = std::numeric_limits<size_t>::max();
@@ -145,10 +167,12 @@ public:
 	//Loads and converts a Total Invasion II .ti map from the given path. Returns false on error.
 	bool LoadTE2Map(fs::path filePath);
 
-	//Exports the map as a .gltf file, returning false on error.
+	//Exports the map as a .gltf or .glb file, returning false on error.
 	//If separateGeometry is true, then the geometry will be put into separate
 	//GLTF nodes according to their tile texture.
-	bool ExportGLTFScene(fs::path filePath, bool separateGeometry);
+	//If instanced is true, each tile shape is written once and tiles become instances of it (EXT_mesh_gpu_instancing),
+	//with one node per combination of shape and texture. separateGeometry and face culling don't apply then.
+	bool ExportGLTFScene(fs::path filePath, bool separateGeometry, bool instanced = false);
 
 	//Executes a undoable tile action for filling an area with one tile
 	void ExecuteTileAction(size_t i, size_t j, size_t k, size_t w, size_t h, size_t l, Tile newTile);
@@ -159,6 +183,14 @@ public:
 	//Executes an undoable entity action for removing an entity.
 	void ExecuteEntRemoval(int i, int j, int k);
 
+	//Between these calls, all tile actions are merged into one, so a continuous brush stroke is undone at once.
+	//The merged action is added to the history when the stroke ends, or before anything else touches the history.
+	void BeginTileStroke();
+	void EndTileStroke();
+
+	//Returns roughly how many bytes the undo and redo history take up.
+	inline size_t GetHistoryMemoryUsage() const { return _historyMemory; }
+
 	inline TexID GetOrAddTexID(const fs::path texturePath)
 	{
 		//Look for existing ID
@@ -229,6 +261,7 @@ public:
 
 	inline void Undo()
 	{
+		_CommitTileChanges();
 		if (!_undoHistory.empty())
 		{
 			_undoHistory.back()->Undo(*this);
@@ -239,6 +272,7 @@ public:
 
 	inline void Redo()
 	{
+		_CommitTileChanges();
 		if (!_redoHistory.empty())
 		{
 			_redoHistory.back()->Do(*this);
@@ -248,6 +282,16 @@ public:
 	}
 private:
 	void _Execute(std::shared_ptr<Action> action);
+	//Adds an action that has already been applied to the map to the undo history.
+	void _PushHistory(std::shared_ptr<Action> action);
+	//Drops the oldest actions until the history fits within the undo count and memory limits.
+	void _TrimHistory();
+	void _ClearHistory();
+
+	//Sets a tile and records the change for the next tile action.
+	void _ChangeTile(size_t flatIndex, const Tile& newTile);
+	//Turns the recorded tile changes into one undoable action.
+	void _CommitTileChanges();
 
 	TileGrid _tileGrid;
 	EntGrid _entGrid;
@@ -261,4 +305,10 @@ private:
 	std::deque<std::shared_ptr<Action>> _undoHistory;
 	//Stores recently undone actions to be redone on command, unless the history is altered.
 	std::deque<std::shared_ptr<Action>> _redoHistory;
+	//Sum of GetMemoryUsage() over both histories.
+	size_t _historyMemory = 0;
+
+	//Tile changes applied to the map that aren't in the history yet. May contain the same cel more than once during a stroke.
+	std::vector<TileAction::Change> _pendingTileChanges;
+	bool _tileStroke = false;
 };
\ No newline at end of file
@@ -5,9 +5,12 @@
 #include "cppcodec/base64_default_rfc4648.hpp"
 
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <limits>
 #include <vector>
+#include <map>
+#include <functional>
 
 #include "app.h"
 #include "assets.h"
@@ -22,15 +25,14 @@
 #define FILTER_NEAREST 9728
 #define FILTER_NEAREST_MIP_NEAREST 9984
 #define WRAP_REPEAT 10497
+#define NO_TARGET 0
+#define EXT_INSTANCING "EXT_mesh_gpu_instancing"
 
-bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
+bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry, bool instanced)
 {
 	using namespace nlohmann;
 
-	const Model mapModel = _tileGrid.GetModel();
-
 	bool isGLB = (strcmp(TextToLower(filePath.extension().string().c_str()), ".glb") == 0);
-	uint8_t* bufferData = nullptr;
 
 	bool error = false;
 
@@ -38,27 +40,37 @@ bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
 	{
 		std::vector<json> scenes, nodes, meshes, buffers, bufferViews, accessors, materials, textures, images, samplers;
 
+		// A part of the binary buffer. The buffer is never put together in memory, each part is written
+		// to the file (or base64 encoder, for .gltf) straight from where its data lives.
+		struct BufferPart
+		{
+			size_t byteOffset;
+			size_t byteLength;
+			std::function<void(std::ostream&)> write;
+		};
+		std::vector<BufferPart> bufferParts;
+
 		size_t bufferOffset = 0;
 
 		// Automates the addition of bufferViews and accessors for a given vertex attribute
-		auto pushVertexAttrib = [&](size_t elemSize, size_t nElems, std::string elemType, int componentType, int target = TARGET_ARRAY_BUFFER)->size_t
+		// `write` must write exactly elemSize * nElems bytes.
+		auto pushVertexAttrib = [&](size_t elemSize, size_t nElems, std::string elemType, int componentType, int target, std::function<void(std::ostream&)> write)->size_t
 			{
-				// Always allocate at least one element's worth of data just to avoid errors
-				size_t nBytes = Max(1, elemSize) * nElems;
+				size_t nBytes = elemSize * nElems;
 
-				// Pad the offset so that the total offset of the accessor is divisible by the element size
-				// This is a requirement of the gltf specifications
-				size_t padding = bufferOffset % elemSize;
-				bufferOffset += padding;
+				// Pad the offset so that the accessor starts at a multiple of its component size, as the gltf specification requires
+				// All component types used here are at most 4 bytes long
+				bufferOffset += (4 - bufferOffset % 4) % 4;
 
 				size_t newIndex = bufferViews.size();
 
-				bufferViews.push_back({
+				json bufferView = {
 				{"buffer", 0},
 				{"byteLength", nBytes},
-				{"byteOffset", bufferOffset},
-				{"target", target}
-					});
+				{"byteOffset", bufferOffset}
+				};
+				if (target != NO_TARGET) bufferView["target"] = target;
+				bufferViews.push_back(bufferView);
 
 				accessors.push_back({
 				{"bufferView", bufferViews.size() - 1},
@@ -67,91 +79,65 @@ bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
 				{"type", elemType}
 					});
 
+				bufferParts.push_back(BufferPart{ bufferOffset, nBytes, std::move(write) });
 				bufferOffset += nBytes;
 
 				return newIndex;
 			};
 
-		std::vector<json> mapPrims;
-		mapPrims.reserve(mapModel.meshCount);
-
-		// Make primitives and buffer related objects for each mesh of the map
-		for (int i = 0; i < mapModel.meshCount; ++i)
-		{
-			// Calculate max and min component values. Required only for position buffer.
-			float minX, minY, minZ;
-			minX = minY = minZ = std::numeric_limits<float>::max();
-			float maxX, maxY, maxZ;
-			maxX = maxY = maxZ = std::numeric_limits<float>::min();
-			for (int j = 0; j < mapModel.meshes[i].vertexCount * 3; j += 3)
-				minX = Minf(mapModel.meshes[i].vertices[j], minX), maxX = Maxf(mapModel.meshes[i].vertices[j], maxX);
-			for (int j = 1; j < mapModel.meshes[i].vertexCount * 3; j += 3)
-				minY = Minf(mapModel.meshes[i].vertices[j], minY), maxY = Maxf(mapModel.meshes[i].vertices[j], maxY);
-			for (int j = 2; j < mapModel.meshes[i].vertexCount * 3; j += 3)
-				minZ = Minf(mapModel.meshes[i].vertices[j], minZ), maxZ = Maxf(mapModel.meshes[i].vertices[j], maxZ);
-
-			// Push buffers, accessors, etc.
-			size_t posBufferIdx = pushVertexAttrib(sizeof(float) * 3, mapModel.meshes[i].vertexCount, "VEC3", COMP_TYPE_FLOAT);
-			accessors[posBufferIdx]["min"] = { minX, minY, minZ };
-			accessors[posBufferIdx]["max"] = { maxX, maxY, maxZ };
-
-			size_t uvBufferIdx = pushVertexAttrib(sizeof(float) * 2, mapModel.meshes[i].vertexCount, "VEC2", COMP_TYPE_FLOAT);
-			size_t normBufferIdx = pushVertexAttrib(sizeof(float) * 3, mapModel.meshes[i].vertexCount, "VEC3", COMP_TYPE_FLOAT);
-			size_t indicesIdx = pushVertexAttrib(sizeof(unsigned short), mapModel.meshes[i].triangleCount * 3, "SCALAR", COMP_TYPE_USHORT, TARGET_ELEMENT_BUFFER);
-
-			// Push primitive
-			mapPrims.push_back({
-			{"mode", PRIMITIVE_MODE_TRIANGLES},
-			{"attributes", {
-			{"POSITION", posBufferIdx},
-			{"TEXCOORD_0", uvBufferIdx},
-			{"NORMAL", normBufferIdx}
-			}},
-			{"indices", indicesIdx},
-			{"material", i}
-				});
-		}
+		// Writes `nBytes` bytes from `data`.
+		auto writeArray = [](const void* data, size_t nBytes)
+			{
+				return [data, nBytes](std::ostream& out) { out.write(reinterpret_cast<const char*>(data), nBytes); };
+			};
 
-		// Indices for child nodes of the root map node
-		std::vector<int> mapNodeChildren;
+		// Pushes the buffers and accessors for a mesh's vertex data and returns a primitive (without material) using them.
+		auto pushMeshPrimitive = [&](const Mesh& mesh)->json
+			{
+				// Calculate max and min component values. Required only for position buffer.
+				float minX, minY, minZ;
+				minX = minY = minZ = std::numeric_limits<float>::max();
+				float maxX, maxY, maxZ;
+				maxX = maxY = maxZ = std::numeric_limits<float>::lowest();
+				for (int j = 0; j < mesh.vertexCount * 3; j += 3)
+					minX = Minf(mesh.vertices[j], minX), maxX = Maxf(mesh.vertices[j], maxX);
+				for (int j = 1; j < mesh.vertexCount * 3; j += 3)
+					minY = Minf(mesh.vertices[j], minY), maxY = Maxf(mesh.vertices[j], maxY);
+				for (int j = 2; j < mesh.vertexCount * 3; j += 3)
+					minZ = Minf(mesh.vertices[j], minZ), maxZ = Maxf(mesh.vertices[j], maxZ);
+
+				json prim = { {"mode", PRIMITIVE_MODE_TRIANGLES} };
+
+				// Push buffers, accessors, etc.
+				size_t posBufferIdx = pushVertexAttrib(sizeof(float) * 3, mesh.vertexCount, "VEC3", COMP_TYPE_FLOAT, TARGET_ARRAY_BUFFER,
+					writeArray(mesh.vertices, sizeof(float) * 3 * mesh.vertexCount));
+				accessors[posBufferIdx]["min"] = { minX, minY, minZ };
+				accessors[posBufferIdx]["max"] = { maxX, maxY, maxZ };
+				prim["attributes"]["POSITION"] = posBufferIdx;
+
+				if (mesh.texcoords != NULL)
+				{
+					prim["attributes"]["TEXCOORD_0"] = pushVertexAttrib(sizeof(float) * 2, mesh.vertexCount, "VEC2", COMP_TYPE_FLOAT, TARGET_ARRAY_BUFFER,
+						writeArray(mesh.texcoords, sizeof(float) * 2 * mesh.vertexCount));
+				}
+				if (mesh.normals != NULL)
+				{
+					prim["attributes"]["NORMAL"] = pushVertexAttrib(sizeof(float) * 3, mesh.vertexCount, "VEC3", COMP_TYPE_FLOAT, TARGET_ARRAY_BUFFER,
+						writeArray(mesh.normals, sizeof(float) * 3 * mesh.vertexCount));
+				}
+				if (mesh.indices != NULL)
+				{
+					prim["indices"] = pushVertexAttrib(sizeof(unsigned short), mesh.triangleCount * 3, "SCALAR", COMP_TYPE_USHORT, TARGET_ELEMENT_BUFFER,
+						writeArray(mesh.indices, sizeof(unsigned short) * 3 * mesh.triangleCount));
+				}
+
+				return prim;
+			};
 
-		// Encode materials and textures
-		for (int m = 0; m < mapModel.meshCount; ++m)
-		{
-			// Image paths in the GLTF are relative to the file.
-			fs::path imagePath = PathFromTexID(mapModel.meshMaterial[m]);
-			fs::path imagePathFromGLTF = fs::relative(
-				fs::current_path() / imagePath,
-				fs::current_path() / filePath.parent_path());
-
-			// Push material
-			materials.push_back({
-			{"name", imagePathFromGLTF.generic_string()},
-			{"pbrMetallicRoughness", {
-			{"baseColorTexture", {
-			{"index", textures.size()},
-			{"texCoord", 0}
-			}},
-			{"metallicFactor", 0.0f},
-			{"roughnessFactor", 1.0f},
-			}}
-				});
-
-			// Push texture
-			textures.push_back({
-			{"source", textures.size()},
-			{"sampler", 0}
-				});
-
-			// Push image
-			images.push_back({
-			{"uri", imagePathFromGLTF.generic_string()}
-				});
-
-			if (separateGeometry)
+		// Makes a node name out of an asset path, relative to `baseDir`.
+		auto makeNodeName = [](const fs::path& path, const std::string& baseDir)->std::string
 			{
-				// When separate geometry is enabled, each material gets its own node containing its portion of the map geometry
-				std::string nodeName = fs::relative(fs::current_path() / imagePath, fs::current_path() / App::Get()->GetTexturesDir()).generic_string();
+				std::string nodeName = fs::relative(fs::current_path() / path, fs::current_path() / baseDir).generic_string();
 
 				// The compiler thinks this is necessary, apparently... 9_9
 
@@ -161,21 +147,186 @@ bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
 				char* newNodeName = TextReplace(nodeNameBuffer, "/", "_");
 				char* finalNodeName = TextReplace(newNodeName, ".", "_");
 
-				json materialNode = { {"name", std::string(finalNodeName)} };
+				std::string result = finalNodeName;
 
 				free(newNodeName);
 				free(finalNodeName);
 				delete[] nodeNameBuffer;
 
-				json mesh = {
-				{"primitives", {mapPrims[m]}}
-				};
+				return result;
+			};
+
+		// Material index for each texture that has been used so far
+		std::map<TexID, size_t> materialIndices;
+
+		// Encodes the material, texture and image for the texture, once.
+		auto pushMaterial = [&](TexID texID)->size_t
+			{
+				if (auto it = materialIndices.find(texID); it != materialIndices.end())
+					return it->second;
+
+				// Image paths in the GLTF are relative to the file.
+				fs::path imagePath = PathFromTexID(texID);
+				fs::path imagePathFromGLTF = fs::relative(
+					fs::current_path() / imagePath,
+					fs::current_path() / filePath.parent_path());
+
+				size_t materialIndex = materials.size();
+
+				// Push material
+				materials.push_back({
+				{"name", imagePathFromGLTF.generic_string()},
+				{"pbrMetallicRoughness", {
+				{"baseColorTexture", {
+				{"index", textures.size()},
+				{"texCoord", 0}
+				}},
+				{"metallicFactor", 0.0f},
+				{"roughnessFactor", 1.0f},
+				}}
+					});
+
+				// Push texture
+				textures.push_back({
+				{"source", textures.size()},
+				{"sampler", 0}
+					});
+
+				// Push image
+				images.push_back({
+				{"uri", imagePathFromGLTF.generic_string()}
+					});
+
+				materialIndices[texID] = materialIndex;
+				return materialIndex;
+			};
+
+		json mapNode = { {"name", "map"} };
+
+		// Indices for child nodes of the root map node
+		std::vector<int> mapNodeChildren;
+
+		// Flat indices of the tiles for each combination of shape and texture, for instanced export
+		// Kept until the buffer is written, since the instance transforms are written from it.
+		std::map<std::pair<ModelID, TexID>, std::vector<size_t>> tileGroups;
+
+		if (instanced)
+		{
+			// Each shape mesh is written once. Tiles with the same shape and texture become the instances
+			// of one node using EXT_mesh_gpu_instancing. Faces between tiles can't be culled this way.
+			for (size_t t = 0; t < _tileGrid.GetWidth() * _tileGrid.GetHeight() * _tileGrid.GetLength(); ++t)
+			{
+				const Tile tile = _tileGrid.GetTile(t);
+				if (tile) tileGroups[std::make_pair(tile.shape, tile.texture)].push_back(t);
+			}
+
+			// Primitives for each mesh of each used shape
+			std::map<ModelID, std::vector<json>> shapePrims;
+
+			for (const auto& [group, tileIndices] : tileGroups)
+			{
+				const auto [shapeID, texID] = group;
+
+				if (!shapePrims.contains(shapeID))
+				{
+					const Model shape = ModelFromID(shapeID);
+					std::vector<json>& prims = shapePrims[shapeID];
+					for (int m = 0; m < shape.meshCount; ++m)
+					{
+						prims.push_back(pushMeshPrimitive(shape.meshes[m]));
+					}
+				}
+
+				json mesh = { {"primitives", shapePrims[shapeID]} };
+				const size_t materialIndex = pushMaterial(texID);
+				for (json& prim : mesh["primitives"])
+				{
+					prim["material"] = materialIndex;
+				}
+
+				// Instance transforms are calculated while they're written
+				const TileGrid& tiles = _tileGrid;
+				const std::vector<size_t>* tileList = &tileIndices;
+				size_t translationIdx = pushVertexAttrib(sizeof(float) * 3, tileIndices.size(), "VEC3", COMP_TYPE_FLOAT, NO_TARGET,
+					[&tiles, tileList](std::ostream& out)
+					{
+						for (size_t t : *tileList)
+						{
+							const Vector3 pos = tiles.GridToWorldPos(tiles.UnflattenIndex(t), true);
+							out.write(reinterpret_cast<const char*>(&pos), sizeof(pos));
+						}
+					});
+				size_t rotationIdx = pushVertexAttrib(sizeof(float) * 4, tileIndices.size(), "VEC4", COMP_TYPE_FLOAT, NO_TARGET,
+					[&tiles, tileList](std::ostream& out)
+					{
+						for (size_t t : *tileList)
+						{
+							const Quaternion rot = QuaternionFromMatrix(TileRotationMatrix(tiles.GetTile(t)));
+							out.write(reinterpret_cast<const char*>(&rot), sizeof(rot));
+						}
+					});
 
-				materialNode["mesh"] = meshes.size();
+				json groupNode = {
+				{"name", makeNodeName(PathFromTexID(texID), App::Get()->GetTexturesDir()) + "_" + makeNodeName(PathFromModelID(shapeID), App::Get()->GetShapesDir())},
+				{"mesh", meshes.size()},
+				{"extensions", {
+				{EXT_INSTANCING, {
+				{"attributes", {
+				{"TRANSLATION", translationIdx},
+				{"ROTATION", rotationIdx}
+				}}
+				}}
+				}}
+				};
 				meshes.push_back(mesh);
 
 				mapNodeChildren.push_back(nodes.size());
-				nodes.push_back(materialNode);
+				nodes.push_back(groupNode);
+			}
+
+			mapNode["children"] = mapNodeChildren;
+		}
+		else
+		{
+			const Model mapModel = _tileGrid.GetModel();
+
+			std::vector<json> mapPrims;
+			mapPrims.reserve(mapModel.meshCount);
+
+			// Make primitives and buffer related objects for each mesh of the map
+			for (int i = 0; i < mapModel.meshCount; ++i)
+			{
+				mapPrims.push_back(pushMeshPrimitive(mapModel.meshes[i]));
+				mapPrims.back()["material"] = pushMaterial(mapModel.meshMaterial[i]);
+
+				if (separateGeometry)
+				{
+					// When separate geometry is enabled, each material gets its own node containing its portion of the map geometry
+					json materialNode = { {"name", makeNodeName(PathFromTexID(mapModel.meshMaterial[i]), App::Get()->GetTexturesDir())} };
+
+					json mesh = {
+					{"primitives", {mapPrims[i]}}
+					};
+
+					materialNode["mesh"] = meshes.size();
+					meshes.push_back(mesh);
+
+					mapNodeChildren.push_back(nodes.size());
+					nodes.push_back(materialNode);
+				}
+			}
+
+			if (!separateGeometry)
+			{
+				// Assign all whole map geometry to the map node
+				mapNode["mesh"] = meshes.size();
+				meshes.push_back({
+				{"primitives", mapPrims}
+					});
+			}
+			else
+			{
+				mapNode["children"] = mapNodeChildren;
 			}
 		}
 
@@ -190,68 +341,34 @@ bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
 		size_t bufferSize = bufferOffset;
 		json buffer = { {"byteLength", bufferSize} };
 
-		bufferData = SAFE_MALLOC(uint8_t, bufferSize);
-
-		// Fill the buffer with the mesh data, now that we know all of the counts and offsets.
-		for (int i = 0; i < mapModel.meshCount; ++i)
-		{
-			// Position
+		// Writes the buffer parts, with zeroes for the padding between them.
+		auto writeBuffer = [&](std::ostream& out)
 			{
-				const json& bufferView = bufferViews[i * 4 + 0];
-				size_t byteOffset = (size_t)bufferView["byteOffset"];
-				size_t byteLength = (size_t)bufferView["byteLength"];
-				memcpy(&bufferData[byteOffset], mapModel.meshes[i].vertices, byteLength);
-			}
-			// Tex coord
-			{
-				const json& bufferView = bufferViews[i * 4 + 1];
-				size_t byteOffset = (size_t)bufferView["byteOffset"];
-				size_t byteLength = (size_t)bufferView["byteLength"];
-				memcpy(&bufferData[byteOffset], mapModel.meshes[i].texcoords, byteLength);
-			}
-			// Normals
-			{
-				const json& bufferView = bufferViews[i * 4 + 2];
-				size_t byteOffset = (size_t)bufferView["byteOffset"];
-				size_t byteLength = (size_t)bufferView["byteLength"];
-				memcpy(&bufferData[byteOffset], mapModel.meshes[i].normals, byteLength);
-			}
-			// Indices
-			{
-				const json& bufferView = bufferViews[i * 4 + 3];
-				size_t byteOffset = (size_t)bufferView["byteOffset"];
-				size_t byteLength = (size_t)bufferView["byteLength"];
-				memcpy(&bufferData[byteOffset], mapModel.meshes[i].indices, byteLength);
-			}
-		}
+				static const char ZEROES[4] = {};
+				size_t written = 0;
+				for (const BufferPart& part : bufferParts)
+				{
+					out.write(ZEROES, part.byteOffset - written);
+					part.write(out);
+					written = part.byteOffset + part.byteLength;
+				}
+			};
 
 		if (!isGLB)
 		{
 			// For plain .gltf files, simply encode the buffer into a base64 data string.
 			// For .glb, the buffer will be written to the end of the binary file later.
-			buffer["uri"] = std::string("data:application/octet-stream;base64,") + base64::encode(bufferData, bufferSize);
+			std::ostringstream bufferStream(std::ios::binary);
+			writeBuffer(bufferStream);
+			const std::string bufferData = bufferStream.str();
+			buffer["uri"] = std::string("data:application/octet-stream;base64,") + base64::encode(bufferData.data(), bufferData.size());
 		}
 
 		buffers.push_back(buffer);
 
-		json mapNode = { {"name", "map"} };
-
 		// Indices for each root node, because the scene object requires a list of them.
 		std::vector<int> rootNodes;
 
-		if (!separateGeometry)
-		{
-			// Assign all whole map geometry to the map node
-			mapNode["mesh"] = meshes.size();
-			meshes.push_back({
-			{"primitives", mapPrims}
-				});
-		}
-		else
-		{
-			mapNode["children"] = mapNodeChildren;
-		}
-
 		rootNodes.push_back(nodes.size());
 		nodes.push_back(mapNode);
 
@@ -306,6 +423,13 @@ bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
 		{"samplers", samplers}
 		};
 
+		if (instanced)
+		{
+			// Without the extension, only one tile of each group would be shown, so it is required
+			jsonData["extensionsUsed"] = { EXT_INSTANCING };
+			jsonData["extensionsRequired"] = { EXT_INSTANCING };
+		}
+
 		// Write JSON to file
 		std::ofstream file(filePath, isGLB ? std::ios::binary : std::ios::out);
 		std::string jsonString = to_string(jsonData);
@@ -357,7 +481,7 @@ bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
 			WRITE_BIN(GLB_BIN);
 
 			// Write data
-			file.write(reinterpret_cast<char*>(bufferData), bufferSize);
+			writeBuffer(file);
 
 			// Pad with zeroes to align with 4 byte boundary
 			for (int p = 0; p < binPadding; ++p)
@@ -376,6 +500,5 @@ bool MapMan::ExportGLTFScene(fs::path filePath, bool separateGeometry)
 		error = true;
 	}
 
-	if (bufferData != nullptr) free(bufferData);
 	return !error;
 }
\ No newline at end of file
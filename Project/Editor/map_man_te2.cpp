@@ -12,8 +12,7 @@
 
 bool MapMan::LoadTE2Map(fs::path filePath)
 {
-	_undoHistory.clear();
-	_redoHistory.clear();
+	_ClearHistory();
 
 	std::ifstream file(filePath);
 
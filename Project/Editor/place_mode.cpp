@@ -28,7 +28,8 @@ Tile PlaceMode::TileCursor::GetTile(MapMan& mapMan) const
 PlaceMode::PlaceMode(MapMan& mapMan)
 	: _mapMan(mapMan),
 	_layerViewMax(mapMan.Tiles().GetHeight() - 1),
-	_layerViewMin(0)
+	_layerViewMin(0),
+	_lastBatchRebuild(0)
 {
 	//Setup camera
 	_camera = { 0 };
@@ -109,6 +110,7 @@ void PlaceMode::OnEnter()
 
 void PlaceMode::OnExit()
 {
+	_mapMan.EndTileStroke();
 }
 
 void PlaceMode::ResetCamera()
@@ -312,6 +314,12 @@ void PlaceMode::UpdateCursor()
 
 		Tile cursorTile = _tileCursor.GetTile(_mapMan);
 
+		//Tiles placed or removed while holding a mouse button down are undone together
+		if ((IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) && !multiSelect)
+		{
+			_mapMan.BeginTileStroke();
+		}
+
 		if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && !IsKeyDown(KEY_LEFT_ALT) && !multiSelect)
 		{
 			//Place tiles
@@ -420,6 +428,12 @@ void PlaceMode::UpdateCursor()
 
 void PlaceMode::Update()
 {
+	//End brush strokes even if the button is released over the GUI
+	if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT) || IsMouseButtonReleased(MOUSE_BUTTON_RIGHT))
+	{
+		_mapMan.EndTileStroke();
+	}
+
 	// Don't update this when using the GUI
 	if (auto io = ImGui::GetIO(); io.WantCaptureMouse || io.WantCaptureKeyboard)
 	{
@@ -502,6 +516,17 @@ void PlaceMode::Draw()
 
 		_mapMan.DrawMap(_camera, _layerViewMin, _layerViewMax);
 
+		//Report how long it took to bring the map's draw batches up to date, e.g. after an edit
+		const TileGrid::BatchStats& batchStats = _mapMan.Tiles().GetBatchStats();
+		if (batchStats.rebuildCount != _lastBatchRebuild && batchStats.chunksRebuilt > 0 && !App::Get()->IsPreviewing())
+		{
+			char message[128];
+			snprintf(message, sizeof(message), "REBUILT %zu OF %zu TILE CHUNKS IN %.2f MS",
+				batchStats.chunksRebuilt, batchStats.chunksVisible, batchStats.milliseconds);
+			App::Get()->DisplayStatusMessage(message, 1.0f, 0);
+		}
+		_lastBatchRebuild = batchStats.rebuildCount;
+
 		if (!App::Get()->IsPreviewing())
 		{
 			//Draw cursor
@@ -78,6 +78,7 @@ protected:
 	float _outlineScale; //How much the wire box around the cursor is larger than its contents
 
 	int _layerViewMin, _layerViewMax;
+	size_t _lastBatchRebuild; //Last rebuild of the map's draw batches that has been reported
 
 	Vector3 _planeGridPos;
 	Vector3 _planeWorldPos;
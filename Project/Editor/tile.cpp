@@ -6,6 +6,7 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <chrono>
 
 #include "assets.h"
 #include "app.h"
@@ -33,6 +34,10 @@ TileGrid::TileGrid(MapMan* mapMan, size_t width, size_t height, size_t length, f
 	_regenBatches = true;
 	_regenModel = true;
 	_modelCulled = false;
+	_chunksX = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	_chunksZ = (length + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	_chunks.resize(_chunksX * _chunksZ * height);
+	_batchStats = BatchStats{ 0, 0, 0.0, 0 };
 }
 
 TileGrid::~TileGrid()
@@ -52,14 +57,28 @@ Tile TileGrid::GetTile(int flatIndex) const
 void TileGrid::SetTile(int i, int j, int k, const Tile& tile)
 {
 	SetCel(i, j, k, tile);
-	_regenBatches = true;
+	_MarkChunksDirty(i, j, k, 1, 1, 1);
 	_regenModel = true;
 }
 
 void TileGrid::SetTile(int flatIndex, const Tile& tile)
 {
-	_grid[flatIndex] = tile;
-	_regenBatches = true;
+	SetTileRun(flatIndex, 1, tile);
+}
+
+void TileGrid::SetTileRun(size_t flatIndex, size_t count, const Tile& tile)
+{
+	assert(flatIndex + count <= _grid.size());
+	std::fill_n(_grid.begin() + flatIndex, count, tile);
+	//Mark the chunks row by row, since a run can wrap around to the next row or layer
+	const size_t end = flatIndex + count;
+	for (size_t t = flatIndex; t < end;)
+	{
+		const size_t x = t % _width;
+		const size_t rowEnd = std::min(t - x + _width, end);
+		_MarkChunksDirty(x, t / (_width * _length), (t / _width) % _length, rowEnd - t, 1, 1);
+		t = rowEnd;
+	}
 	_regenModel = true;
 }
 
@@ -78,7 +97,7 @@ void TileGrid::SetTileRect(int i, int j, int k, int w, int h, int l, const Tile&
 			}
 		}
 	}
-	_regenBatches = true;
+	_MarkChunksDirty(i, j, k, w, h, l);
 	_regenModel = true;
 }
 
@@ -104,14 +123,14 @@ void TileGrid::CopyTiles(int i, int j, int k, const TileGrid& src, bool ignoreEm
 			}
 		}
 	}
-	_regenBatches = true;
+	_MarkChunksDirty(i, j, k, xEnd - i, yEnd - j, zEnd - k);
 	_regenModel = true;
 }
 
 void TileGrid::UnsetTile(int i, int j, int k)
 {
 	_grid[FlatIndex(i, j, k)].shape = NO_MODEL;
-	_regenBatches = true;
+	_MarkChunksDirty(i, j, k, 1, 1, 1);
 	_regenModel = true;
 }
 
@@ -129,28 +148,53 @@ TileGrid TileGrid::Subsection(int i, int j, int k, int w, int h, int l) const
 	return newGrid;
 }
 
-void TileGrid::_RegenBatches(Vector3 position, int fromY, int toY)
+void TileGrid::_MarkChunksDirty(int i, int j, int k, int w, int h, int l)
 {
-	if (!_mapMan) return;
+	if (w <= 0 || h <= 0 || l <= 0) return;
+	for (int y = j; y < j + h; ++y)
+	{
+		for (int cz = k / TILE_CHUNK_SIZE; cz <= (k + l - 1) / TILE_CHUNK_SIZE; ++cz)
+		{
+			for (int cx = i / TILE_CHUNK_SIZE; cx <= (i + w - 1) / TILE_CHUNK_SIZE; ++cx)
+			{
+				_chunks[_ChunkIndex(cx, y, cz)].dirty = true;
+			}
+		}
+	}
+	_regenBatches = true;
+}
 
-	_drawBatches.clear();
-	_batchFromY = fromY;
-	_batchToY = toY;
-	_batchPosition = position;
-	_regenBatches = false;
+void TileGrid::_MarkAllChunksDirty()
+{
+	for (Chunk& chunk : _chunks)
+	{
+		chunk.dirty = true;
+	}
+	_regenBatches = true;
+}
+
+void TileGrid::_RegenChunk(int chunkX, int y, int chunkZ)
+{
+	Chunk& chunk = _chunks[_ChunkIndex(chunkX, y, chunkZ)];
+	chunk.dirty = false;
+	//Keep the vectors around, the same combinations usually come back after an edit
+	for (auto& [pair, matrices] : chunk.batches)
+	{
+		matrices.clear();
+	}
 
-	const size_t layerArea = _width * _length;
-	// Create a hash map of dynamic arrays for each combination of texture and mesh
-	for (int y = fromY; y <= toY; ++y)
+	const int xEnd = Min((chunkX + 1) * TILE_CHUNK_SIZE, int(_width));
+	const int zEnd = Min((chunkZ + 1) * TILE_CHUNK_SIZE, int(_length));
+	for (int z = chunkZ * TILE_CHUNK_SIZE; z < zEnd; ++z)
 	{
-		for (size_t t = y * layerArea; t < (y + 1) * layerArea; ++t)
+		const size_t base = FlatIndex(0, y, z);
+		for (int x = chunkX * TILE_CHUNK_SIZE; x < xEnd; ++x)
 		{
-			const Tile& tile = _grid[t];
+			const Tile& tile = _grid[base + x];
 			if (tile)
 			{
 				// Calculate world space matrix for the tile
-				Vector3 gridPos = UnflattenIndex(t);
-				Vector3 worldPos = Vector3Add(position, GridToWorldPos(gridPos, true));
+				Vector3 worldPos = Vector3Add(_batchPosition, GridToWorldPos(Vector3{ float(x), float(y), float(z) }, true));
 				Matrix rotMatrix = TileRotationMatrix(tile);
 				Matrix matrix = MatrixMultiply(rotMatrix, MatrixTranslate(worldPos.x, worldPos.y, worldPos.z));
 
@@ -158,17 +202,72 @@ void TileGrid::_RegenBatches(Vector3 position, int fromY, int toY)
 				for (int m = 0; m < shape.meshCount; ++m)
 				{
 					// Add the tile's transform to the instance arrays for each mesh
-					auto pair = std::make_pair(tile.texture, &shape.meshes[m]);
-					if (_drawBatches.find(pair) == _drawBatches.end())
-					{
-						// Put in a vector for this pair if there hasn't been one already
-						_drawBatches[pair] = std::vector<Matrix>();
-					}
-					_drawBatches[pair].push_back(matrix);
+					chunk.batches[std::make_pair(tile.texture, &shape.meshes[m])].push_back(matrix);
 				}
 			}
 		}
 	}
+
+	std::erase_if(chunk.batches, [](const auto& batch) { return batch.second.empty(); });
+}
+
+void TileGrid::_RegenBatches(Vector3 position, int fromY, int toY)
+{
+	if (!_mapMan) return;
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	//Every matrix includes the grid's position
+	if (!Vector3Equals(position, _batchPosition))
+	{
+		_MarkAllChunksDirty();
+	}
+	_batchFromY = fromY;
+	_batchToY = toY;
+	_batchPosition = position;
+	_regenBatches = false;
+
+	//Chunks outside of the layer range stay dirty until they are shown
+	size_t chunksRebuilt = 0;
+	for (int y = Max(fromY, 0); y <= Min(toY, int(_height) - 1); ++y)
+	{
+		for (int cz = 0; cz < int(_chunksZ); ++cz)
+		{
+			for (int cx = 0; cx < int(_chunksX); ++cx)
+			{
+				if (_chunks[_ChunkIndex(cx, y, cz)].dirty)
+				{
+					_RegenChunk(cx, y, cz);
+					++chunksRebuilt;
+				}
+			}
+		}
+	}
+
+	// Merge the chunks into one instance array for each combination of texture and mesh
+	for (auto& [pair, matrices] : _drawBatches)
+	{
+		matrices.clear();
+	}
+	size_t chunksVisible = 0;
+	for (int y = Max(fromY, 0); y <= Min(toY, int(_height) - 1); ++y)
+	{
+		for (size_t c = _ChunkIndex(0, y, 0); c < _ChunkIndex(0, y + 1, 0); ++c)
+		{
+			for (const auto& [pair, matrices] : _chunks[c].batches)
+			{
+				std::vector<Matrix>& merged = _drawBatches[pair];
+				merged.insert(merged.end(), matrices.begin(), matrices.end());
+			}
+			++chunksVisible;
+		}
+	}
+	std::erase_if(_drawBatches, [](const auto& batch) { return batch.second.empty(); });
+
+	_batchStats.chunksRebuilt = chunksRebuilt;
+	_batchStats.chunksVisible = chunksVisible;
+	_batchStats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	++_batchStats.rebuildCount;
 }
 
 void TileGrid::Draw(Vector3 position)
@@ -293,6 +392,8 @@ void TileGrid::SetTileDataBase64(std::string data)
 			++gridIndex;
 		}
 	}
+	_MarkAllChunksDirty();
+	_regenModel = true;
 	std::cout << std::endl;
 }
 
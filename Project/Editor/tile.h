@@ -18,6 +18,7 @@
 class MapMan;
 
 #define TILE_SPACING_DEFAULT 2.0f
+#define TILE_CHUNK_SIZE 16 //Width and length in cels of the chunks draw batches are cached for.
 
 enum class Direction { Z_POS, Z_NEG, X_POS, X_NEG, Y_POS, Y_NEG };
 
@@ -65,6 +66,15 @@ inline Matrix TileRotationMatrix(const Tile& tile)
 class TileGrid : public Grid<Tile>
 {
 public:
+	//Describes the last time the draw batches were brought up to date.
+	struct BatchStats
+	{
+		size_t chunksRebuilt;
+		size_t chunksVisible;
+		double milliseconds;
+		size_t rebuildCount; //Increases every time the batches are brought up to date
+	};
+
 	//Constructs a blank TileGrid with no size
 	TileGrid();
 	//Constructs a TileGrid full of empty tiles.
@@ -77,6 +87,8 @@ public:
 	Tile GetTile(int flatIndex) const;
 	void SetTile(int i, int j, int k, const Tile& tile);
 	void SetTile(int flatIndex, const Tile& tile);
+	//Sets `count` consecutive tiles, starting at the given flat index.
+	void SetTileRun(size_t flatIndex, size_t count, const Tile& tile);
 
 	//Sets a range of tiles in the grid inside of the rectangular prism with a corner at (i, j, k) and size (w, h, l).
 	void SetTileRect(int i, int j, int k, int w, int h, int l, const Tile& tile);
@@ -108,15 +120,33 @@ public:
 	std::pair<std::vector<TexID>, std::vector<ModelID>> GetUsedIDs() const;
 
 	const Model GetModel();
+
+	inline const BatchStats& GetBatchStats() const { return _batchStats; }
 protected:
+	//Instance transforms of the tiles in a TILE_CHUNK_SIZE x 1 x TILE_CHUNK_SIZE part of the grid.
+	struct Chunk
+	{
+		std::map<std::pair<TexID, Mesh*>, std::vector<Matrix>> batches;
+		bool dirty = true;
+	};
+
 	MapMan* _mapMan;
 
-	// Calculates lists of transformations for each tile, separated by texture and shape, to be drawn as instances.
+	// Rebuilds the chunks that changed in the given layer range, then merges the chunks' instance lists, separated by texture and shape, into one list per batch.
 	void _RegenBatches(Vector3 position, int fromY, int toY);
+	// Calculates lists of transformations for each tile in the chunk, separated by texture and shape.
+	void _RegenChunk(int chunkX, int y, int chunkZ);
+	// Marks the chunks overlapping the rectangular prism with a corner at (i, j, k) and size (w, h, l) for rebuilding.
+	void _MarkChunksDirty(int i, int j, int k, int w, int h, int l);
+	void _MarkAllChunksDirty();
+	inline size_t _ChunkIndex(int chunkX, int y, int chunkZ) const { return chunkX + (chunkZ * _chunksX) + (y * _chunksX * _chunksZ); }
 	// Combines all of the tiles into a single model, for export or for preview. When culling is true, redundant faces between tiles are removed.
 	Model* _GenerateModel(bool culling = true);
 
 	std::map<std::pair<TexID, Mesh*>, std::vector<Matrix>> _drawBatches;
+	std::vector<Chunk> _chunks;
+	size_t _chunksX, _chunksZ;
+	BatchStats _batchStats;
 
 	Vector3 _batchPosition;
 	bool _regenBatches;
@@ -44,6 +44,10 @@ bool Example_026::Setup()
 		createInfo.characters = vkr::TextureFont::GetDefaultCharacters();
 
 		CHECKED_CALL(device.CreateTextureFont(createInfo, &mRoboto));
+
+		// Same font as a signed distance field atlas, glyphs are added as they are drawn and scale to any size
+		createInfo.signedDistanceField = true;
+		CHECKED_CALL(device.CreateTextureFont(createInfo, &mRobotoSdf));
 	}
 
 	// Text draw
@@ -52,6 +56,16 @@ bool Example_026::Setup()
 		CHECKED_CALL(device.CreateShader("basic/shaders", "TextDraw.vs", &VS));
 		vkr::ShaderModulePtr PS;
 		CHECKED_CALL(device.CreateShader("basic/shaders", "TextDraw.ps", &PS));
+		// TextDrawSDF.ps.spv isn't shipped, BuildBasicShader.bat compiles it with dxc. The SDF text is left out without it
+		vkr::ShaderModulePtr PSSdf;
+		if (FileExists("basic/shaders/spv/TextDrawSDF.ps.spv"))
+		{
+			CHECKED_CALL(device.CreateShader("basic/shaders", "TextDrawSDF.ps", &PSSdf));
+		}
+		else
+		{
+			Warning("basic/shaders/spv/TextDrawSDF.ps.spv not found, run BuildBasicShader.bat to draw the SDF text");
+		}
 
 		vkr::TextDrawCreateInfo createInfo = {};
 		createInfo.pFont = mRoboto;
@@ -63,6 +77,14 @@ bool Example_026::Setup()
 		CHECKED_CALL(device.CreateTextDraw(createInfo, &mStaticText));
 		CHECKED_CALL(device.CreateTextDraw(createInfo, &mDynamicText));
 
+		if (!PSSdf.IsNull())
+		{
+			createInfo.pFont = mRobotoSdf;
+			createInfo.PS = { PSSdf.Get(), "psmain_sdf" };
+			CHECKED_CALL(device.CreateTextDraw(createInfo, &mSdfText));
+			device.DestroyShaderModule(PSSdf);
+		}
+
 		device.DestroyShaderModule(VS);
 		device.DestroyShaderModule(PS);
 	}
@@ -121,9 +143,24 @@ void Example_026::Render()
 			mDynamicText->UploadToGpu(frame.cmd);
 		}
 
+		// One SDF atlas for every size, new glyphs are copied to it in this command buffer
+		if (!mSdfText.IsNull())
+		{
+			mRobotoSdf->BeginFrame();
+			mSdfText->Clear();
+			float y = 580.0f;
+			for (float size : { 16.0f, 32.0f, 64.0f, 96.0f }) {
+				mSdfText->SetFontSize(size);
+				mSdfText->AddString(float2(50, y), "SDF text at " + std::to_string(static_cast<int>(size)) + "px", float3(0.9f, 0.8f, 0.5f));
+				y += size * 1.2f;
+			}
+			mSdfText->UploadToGpu(frame.cmd);
+		}
+
 		// Update constnat buffer
 		mStaticText->PrepareDraw(mCamera.GetViewProjectionMatrix(), frame.cmd);
 		mDynamicText->PrepareDraw(mCamera.GetViewProjectionMatrix(), frame.cmd);
+		if (!mSdfText.IsNull()) mSdfText->PrepareDraw(mCamera.GetViewProjectionMatrix(), frame.cmd);
 
 		vkr::RenderPassPtr renderPass = swapChain.GetRenderPass(imageIndex);
 		ASSERT_MSG(!renderPass.IsNull(), "render pass object is null");
@@ -144,6 +181,7 @@ void Example_026::Render()
 
 			mStaticText->Draw(frame.cmd);
 			mDynamicText->Draw(frame.cmd);
+			if (!mSdfText.IsNull()) mSdfText->Draw(frame.cmd);
 		}
 		frame.cmd->EndRenderPass();
 		frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), ALL_SUBRESOURCES, vkr::ResourceState::RenderTarget, vkr::ResourceState::Present);
@@ -21,7 +21,9 @@ private:
 
 	std::vector<PerFrame> mPerFrame;
 	vkr::TextureFontPtr        mRoboto;
+	vkr::TextureFontPtr        mRobotoSdf;
 	vkr::TextDrawPtr           mStaticText;
 	vkr::TextDrawPtr           mDynamicText;
+	vkr::TextDrawPtr           mSdfText;
 	PerspectiveCamera           mCamera;
 };
\ No newline at end of file
@@ -10,7 +10,7 @@ extern bool showTriggers;
 
 #pragma region AFuncBrush
 
-AFuncBrush::AFuncBrush(const std::vector<MapData::Brush>& brushes, BrushType type, PhysicsLayer layer)
+AFuncBrush::AFuncBrush(std::span<const MapData::Brush> brushes, BrushType type, PhysicsLayer layer, bool movable)
 	: m_brushes(brushes, type, layer)
 {
 	const glm::vec3& center = m_brushes.GetCenter();
@@ -18,6 +18,12 @@ AFuncBrush::AFuncBrush(const std::vector<MapData::Brush>& brushes, BrushType typ
 	GetTransform().SetPosition(center);
 	m_position = center;
 
+	if (!movable)
+	{
+		m_brushes.CreateStaticActors(this);
+		return;
+	}
+
 	m_rigidbody = physicsScene->CreateStatic(physx::PxTransform{ center.x, center.y, center.z });
 	m_brushes.AttachToRigidActor(m_rigidbody);
 
@@ -37,6 +43,9 @@ void AFuncBrush::Update([[maybe_unused]] float deltaTime)
 
 void AFuncBrush::FixedUpdate(float fixedDeltaTime)
 {
+	if (!m_rigidbody)
+		return;
+
 	const physx::PxTransform transform = m_rigidbody->getGlobalPose();
 	const glm::vec3 lastPosition = m_position;
 
@@ -53,6 +62,12 @@ void AFuncBrush::Draw()
 
 void AFuncBrush::Move(const glm::vec3& deltaPosition)
 {
+	if (!m_rigidbody)
+	{
+		Error("Can't move a brush that isn't movable!");
+		return;
+	}
+
 	physx::PxTransform pose = m_rigidbody->getGlobalPose();
 	physx::PxVec3& position = pose.p;
 	position.x += deltaPosition.x;
@@ -65,7 +80,7 @@ void AFuncBrush::Move(const glm::vec3& deltaPosition)
 
 #pragma region AFuncMove
 
-AFuncMove::AFuncMove(const std::vector<MapData::Brush>& brushes, const glm::vec3& moveSpeed, float moveTime, const std::string& moveSound)
+AFuncMove::AFuncMove(std::span<const MapData::Brush> brushes, const glm::vec3& moveSpeed, float moveTime, const std::string& moveSound)
 	: AFuncBrush(brushes)
 	, m_moveSpeed(moveSpeed)
 	, m_moveTime(moveTime)
@@ -205,7 +220,7 @@ void AFuncButton::StopUse(Actor* user)
 
 #pragma region AFuncPhys
 
-AFuncPhys::AFuncPhys(const std::vector<MapData::Brush>& brushes)
+AFuncPhys::AFuncPhys(std::span<const MapData::Brush> brushes)
 	: m_brushes(brushes)
 {
 	const glm::vec3& center = m_brushes.GetCenter();
@@ -495,12 +510,12 @@ void ATrigger::Draw()
 #pragma region AWorldSpawn
 
 AWorldSpawn::AWorldSpawn(
-	const std::vector<MapData::Brush>& brushes,
+	std::span<const MapData::Brush> brushes,
 	const glm::vec3& lightDirection,
 	const glm::vec3& lightColor,
 	const std::string& script
 )
-	: AFuncBrush(brushes)
+	: AFuncBrush(brushes, BrushType::Normal, PHYSICS_LAYER_0, false)
 {
 	for (const auto& brush : brushes)
 	{
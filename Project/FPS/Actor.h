@@ -10,7 +10,8 @@ class AFuncBrush : public Actor
 public:
 	DEFINE_ACTOR_CLASS(AFuncBrush);
 
-	explicit AFuncBrush(const std::vector<MapData::Brush>& brushes, BrushType type = BrushType::Normal, PhysicsLayer layer = PHYSICS_LAYER_0);
+	// Brushes that aren't movable get one static actor per cell instead of one actor for all of them, see Brushes::CreateStaticActors.
+	explicit AFuncBrush(std::span<const MapData::Brush> brushes, BrushType type = BrushType::Normal, PhysicsLayer layer = PHYSICS_LAYER_0, bool movable = true);
 	~AFuncBrush() override;
 
 	void Update(float deltaTime) override;
@@ -20,7 +21,7 @@ public:
 
 private:
 	Brushes               m_brushes;
-	physx::PxRigidStatic* m_rigidbody;
+	physx::PxRigidStatic* m_rigidbody = nullptr; // Only for movable brushes
 
 	glm::mat4 m_translationMatrix{ 1.0f };
 	glm::mat4 m_rotationMatrix{ 1.0f };
@@ -38,7 +39,7 @@ class AFuncMove : public AFuncBrush
 public:
 	DEFINE_ACTOR_CLASS(AFuncMove);
 
-	AFuncMove(const std::vector<MapData::Brush>& brushes, const glm::vec3& moveSpeed, float moveTime, const std::string& moveSound = "");
+	AFuncMove(std::span<const MapData::Brush> brushes, const glm::vec3& moveSpeed, float moveTime, const std::string& moveSound = "");
 
 	void FixedUpdate(float fixedDeltaTime) override;
 
@@ -79,7 +80,7 @@ class AFuncButton final : public AFuncMove
 public:
 	DEFINE_ACTOR_CLASS(AFuncButton)
 
-	AFuncButton(const std::vector<MapData::Brush>& brushes, const glm::vec3& moveSpeed, float moveTime, std::string event)
+	AFuncButton(std::span<const MapData::Brush> brushes, const glm::vec3& moveSpeed, float moveTime, std::string event)
 		: AFuncMove(brushes, moveSpeed, moveTime)
 		, m_event(std::move(event)) {}
 
@@ -99,7 +100,7 @@ class AFuncPhys final : public Actor
 public:
 	DEFINE_ACTOR_CLASS(AFuncPhys)
 
-	explicit AFuncPhys(const std::vector<MapData::Brush>& brushes);
+	explicit AFuncPhys(std::span<const MapData::Brush> brushes);
 	~AFuncPhys() final;
 
 	void FixedUpdate(float fixedDeltaTime) final;
@@ -217,7 +218,7 @@ public:
 		TARGET_TYPE_POWER_SPHERE = 1,
 	};
 
-	ATrigger(const std::vector<MapData::Brush>& brushes, int targetType, std::string event)
+	ATrigger(std::span<const MapData::Brush> brushes, int targetType, std::string event)
 		: AFuncBrush(brushes, BrushType::Trigger, PHYSICS_LAYER_1)
 		, m_targetType(static_cast<TargetType>(targetType))
 		, m_event(std::move(event)) {}
@@ -238,7 +239,7 @@ private:
 class ATriggerOnce final : public ATrigger
 {
 public:
-	ATriggerOnce(const std::vector<MapData::Brush>& brushes, int targetType, std::string event)
+	ATriggerOnce(std::span<const MapData::Brush> brushes, int targetType, std::string event)
 		: ATrigger(brushes, targetType, std::move(event)) {}
 
 	void OnTriggerEnter(Actor* other) final
@@ -258,7 +259,7 @@ public:
 	DEFINE_ACTOR_CLASS(AWorldSpawn)
 
 	explicit AWorldSpawn(
-		const std::vector<MapData::Brush>& brushes,
+		std::span<const MapData::Brush> brushes,
 		const glm::vec3& lightDirection,
 		const glm::vec3& lightColor,
 		const std::string& script
@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
 #include <bitset>
@@ -25,6 +26,12 @@
 #include <array>
 #include <deque>
 #include <unordered_map>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <random>
 
 #define VK_NO_PROTOTYPES
 
@@ -0,0 +1,1037 @@
+#include "Base.h"
+#include "Core.h"
+#include "EngineMath.h"
+#include "Scene.h"
+#include "LightClusters.h"
+#include "ShadowCascades.h"
+#include "LuaSandbox.h"
+#include "GameLua.h"
+#include "MapData.h"
+#include "RenderResources.h"
+#include "Benchmarks.h"
+
+#pragma region Benchmarks
+
+namespace
+{
+	std::atomic<uint64_t> allocationCount = 0;
+}
+
+// Counts the allocations of the whole program for the benchmarks, a relaxed increment is all it adds to the game.
+void* operator new(size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size > 0 ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, [[maybe_unused]] size_t size) noexcept
+{
+	std::free(memory);
+}
+
+namespace
+{
+	using BenchmarkFunc = bool (*)(std::span<const std::string> args);
+
+	struct Benchmark final
+	{
+		std::string_view Name;
+		std::string_view Usage;
+		BenchmarkFunc    Func;
+	};
+
+	uint32_t ArgU32(std::span<const std::string> args, size_t index, uint32_t defaultValue)
+	{
+		return index < args.size() ? static_cast<uint32_t>(std::max(std::atoi(args[index].c_str()), 1)) : defaultValue;
+	}
+
+	bool Check(bool condition, const std::string& what)
+	{
+		if (!condition) Error("Check failed: " + what);
+		return condition;
+	}
+
+	// Median of the samples in microseconds, the samples are sorted.
+	int64_t Median(std::vector<int64_t>& samples)
+	{
+		std::sort(samples.begin(), samples.end());
+		return samples.empty() ? 0 : samples[samples.size() / 2];
+	}
+
+	// Samples points inside every light and checks the cluster each point falls in lists that light. The cluster of a
+	// point is computed here from the grid definition (screen tile of the projected point, slice between the
+	// exponential slice depths), not by LightClusterBuilder. Then times Build() for growing light counts.
+	bool LightClusters(std::span<const std::string> args)
+	{
+		const uint32_t samplesPerLight = ArgU32(args, 0, 64);
+		const uint32_t iterations = ArgU32(args, 1, 50);
+
+		constexpr float Fov = glm::radians(60.0f);
+		constexpr float Aspect = 16.0f / 9.0f;
+		constexpr float Near = 0.01f;
+		constexpr float Far = 100.0f;
+		using Builder = LightClusterBuilder;
+
+		const float ndcScaleY = 1.0f / glm::tan(Fov * 0.5f);
+		const glm::vec2 ndcScale(ndcScaleY / Aspect, ndcScaleY);
+		std::array<float, Builder::GRID_SIZE_Z + 1> sliceDepths;
+		for (uint32_t slice = 0; slice <= Builder::GRID_SIZE_Z; slice++)
+			sliceDepths[slice] = Near * std::pow(Far / Near, static_cast<float>(slice) / static_cast<float>(Builder::GRID_SIZE_Z));
+
+		// returns false for points outside the frustum or too close to a cluster border to tell which side they are on
+		auto expectedCluster = [&](const glm::vec3& p, uint32_t& cluster)
+			{
+				constexpr float Margin = 1e-3f;
+				if (p.z <= Near || p.z >= Far) return false;
+				const glm::vec2 grid = (glm::vec2(p) / p.z * ndcScale * 0.5f + 0.5f) * glm::vec2(Builder::GRID_SIZE_X, Builder::GRID_SIZE_Y);
+				if (grid.x <= 0.0f || grid.y <= 0.0f || grid.x >= Builder::GRID_SIZE_X || grid.y >= Builder::GRID_SIZE_Y) return false;
+				if (glm::any(glm::lessThan(glm::abs(grid - glm::round(grid)), glm::vec2(Margin)))) return false;
+
+				const auto upper = std::upper_bound(sliceDepths.begin(), sliceDepths.end(), p.z);
+				if (std::abs(p.z - *(upper - 1)) < Margin * p.z || std::abs(*upper - p.z) < Margin * p.z) return false;
+				const uint32_t slice = static_cast<uint32_t>(upper - sliceDepths.begin()) - 1;
+				cluster = static_cast<uint32_t>(grid.x) + static_cast<uint32_t>(grid.y) * Builder::GRID_SIZE_X + slice * Builder::GRID_SIZE_X * Builder::GRID_SIZE_Y;
+				return true;
+			};
+
+		std::mt19937 random(1234);
+		auto makeLights = [&](uint32_t count)
+			{
+				std::uniform_real_distribution<float> side(-40.0f, 40.0f), depth(-5.0f, Far + 5.0f), radius(0.1f, 6.0f);
+				std::vector<PointLightData> lights;
+				for (uint32_t i = 0; i < count; i++)
+					lights.emplace_back(glm::vec3(side(random), side(random) * 0.5f, depth(random)), radius(random), glm::vec3(1.0f));
+				return lights;
+			};
+
+		bool ok = true;
+		Builder builder;
+		builder.SetCamera(glm::mat4(1.0f), Fov, Aspect, Near, Far);
+
+		const std::vector<PointLightData> lights = makeLights(Builder::MAX_POINT_LIGHTS);
+		builder.Build(lights);
+		ok &= Check(builder.GetDroppedLightCount() == 0 && builder.GetDroppedIndexCount() == 0, "nothing dropped under the limits");
+
+		// the records tile the index list without gaps or overlap
+		uint32_t offset = 0;
+		for (const LightClusterRecord& record : builder.GetClusters())
+		{
+			ok &= Check(record.Offset == offset, "cluster records are contiguous");
+			offset += record.Count;
+		}
+		ok &= Check(offset == builder.GetLightIndices().size(), "cluster records cover the index list");
+		if (!ok) return false;
+
+		// the compact light array keeps submission order, map it back to the input
+		std::vector<uint32_t> compactIndex(lights.size(), UINT32_MAX);
+		for (uint32_t i = 0, c = 0; i < lights.size() && c < builder.GetLights().size(); i++)
+		{
+			if (builder.GetLights()[c].Position == lights[i].Position && builder.GetLights()[c].Radius == lights[i].Radius)
+				compactIndex[i] = c++;
+		}
+
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		uint32_t checked = 0, missing = 0, wrongCluster = 0;
+		for (uint32_t i = 0; i < lights.size(); i++)
+		{
+			for (uint32_t s = 0; s < samplesPerLight; s++)
+			{
+				glm::vec3 offsetInSphere;
+				do offsetInSphere = { unit(random), unit(random), unit(random) };
+				while (glm::dot(offsetInSphere, offsetInSphere) > 1.0f);
+				const glm::vec3 point = lights[i].Position + offsetInSphere * lights[i].Radius;
+
+				uint32_t cluster;
+				if (!expectedCluster(point, cluster)) continue;
+				checked++;
+				if (builder.GetClusterIndex(point) != cluster) wrongCluster++;
+
+				const LightClusterRecord& record = builder.GetClusters()[cluster];
+				const auto first = builder.GetLightIndices().begin() + record.Offset;
+				if (compactIndex[i] == UINT32_MAX || std::find(first, first + record.Count, compactIndex[i]) == first + record.Count)
+					missing++;
+			}
+		}
+		ok &= Check(checked > 0, "some sample points inside the frustum");
+		ok &= Check(wrongCluster == 0, std::to_string(wrongCluster) + " points with a wrong GetClusterIndex()");
+		ok &= Check(missing == 0, std::to_string(missing) + " points whose cluster misses the light they are in");
+		Print("light-clusters: " + std::to_string(checked) + " points checked, " + std::to_string(builder.GetLights().size()) + " of "
+			+ std::to_string(lights.size()) + " lights visible, " + std::to_string(builder.GetLightIndices().size()) + " indices");
+
+		for (const uint32_t count : { 256u, 1024u, Builder::MAX_POINT_LIGHTS })
+		{
+			const std::vector<PointLightData> frameLights = makeLights(count);
+			std::vector<int64_t> times;
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				builder.Build(frameLights);
+				times.push_back(builder.GetBuildTime().AsMicroseconds());
+			}
+			Print("light-clusters: " + std::to_string(count) + " lights, median build " + std::to_string(Median(times)) + " us");
+		}
+		return ok;
+	}
+
+	// Runs ShadowCascades over camera traces and checks the layers it asks to redraw against what changed:
+	// - a still camera redraws every layer of each slot once, then nothing
+	// - a camera bobbing by less than half a texel of the finest cascade redraws nothing
+	// - a caster moving in front of a still camera redraws the cascades its old or new bounds overlap, and only those
+	// Then times Update() with every caster.
+	bool ShadowCascadeRedraws(std::span<const std::string> args)
+	{
+		const uint32_t casterGrid = ArgU32(args, 0, 64);
+		const uint32_t frames = ArgU32(args, 1, 240);
+		constexpr uint32_t SlotCount = 2;
+		constexpr uint8_t AllLayers = (1u << ShadowCascades::CASCADE_COUNT) - 1;
+		constexpr float Fov = glm::radians(70.0f);
+		constexpr float Aspect = 16.0f / 9.0f;
+		constexpr float Spacing = 4.0f;
+
+		// a grid of boxes on the ground around the camera, the mesh is only hashed so any address does
+		const int mesh = 0;
+		std::vector<ShadowCaster> casters;
+		const float gridOffset = static_cast<float>(casterGrid - 1) * Spacing * 0.5f;
+		for (uint32_t z = 0; z < casterGrid; z++)
+		{
+			for (uint32_t x = 0; x < casterGrid; x++)
+			{
+				const glm::vec3 center(static_cast<float>(x) * Spacing - gridOffset, 1.0f, static_cast<float>(z) * Spacing - gridOffset);
+				casters.push_back({ center, glm::vec3(0.5f, 1.0f, 0.5f), ShadowCascades::HashCaster(&mesh, glm::translate(glm::mat4(1.0f), center)) });
+			}
+		}
+
+		ShadowCascades cascades;
+		cascades.SetLightDirection(glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f)));
+		cascades.SetWorldBounds(glm::vec3(-gridOffset - 8.0f, -8.0f, -gridOffset - 8.0f), glm::vec3(gridOffset + 8.0f, 32.0f, gridOffset + 8.0f));
+		const glm::vec3 eye(0.3f, 1.7f, 0.2f);
+		const glm::vec3 forward = glm::normalize(glm::vec3(0.2f, -0.15f, 1.0f));
+		auto setCamera = [&](const glm::vec3& position)
+			{
+				cascades.SetCamera(glm::lookAt(position, position + forward, glm::vec3(0.0f, 1.0f, 0.0f)), Fov, Aspect);
+			};
+
+		bool ok = true;
+		setCamera(eye);
+		uint32_t stillRedraws = 0;
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			const uint32_t slot = frame % SlotCount;
+			cascades.Update(casters, slot);
+			const uint8_t expected = frame < SlotCount ? AllLayers : 0;
+			ok &= Check(cascades.GetRedrawMask() == expected, "still camera redraw mask in frame " + std::to_string(frame));
+			stillRedraws += std::bitset<8>(cascades.GetRedrawMask()).count();
+		}
+
+		// the projection scale is 1 / radius, a texel is 2 * radius / Resolution
+		const glm::mat4& finest = cascades.GetShadowMatrix(0);
+		const float radius = 1.0f / glm::length(glm::vec3(finest[0][0], finest[1][0], finest[2][0]));
+		const float texelSize = 2.0f * radius / static_cast<float>(ShadowCascadeSettings{}.Resolution);
+		uint32_t bobRedraws = 0;
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			const float phase = static_cast<float>(frame) * 0.37f;
+			setCamera(eye + glm::vec3(glm::sin(phase), glm::abs(glm::sin(phase * 2.0f)), glm::cos(phase * 0.5f)) * (0.25f * texelSize));
+			cascades.Update(casters, frame % SlotCount);
+			bobRedraws += std::bitset<8>(cascades.GetRedrawMask()).count();
+		}
+		ok &= Check(bobRedraws == 0, std::to_string(bobRedraws) + " layers redrawn by a sub-texel camera bob");
+
+		// the matrices don't change while the camera is still, so the overlap of a box is known up front
+		setCamera(eye);
+		cascades.Update(casters, 0);
+		cascades.Update(casters, 1);
+		std::array<Frustum, ShadowCascades::CASCADE_COUNT> frustums;
+		for (uint32_t cascade = 0; cascade < ShadowCascades::CASCADE_COUNT; cascade++)
+			frustums[cascade] = Frustum(cascades.GetShadowMatrix(cascade));
+		auto overlapMask = [&](const ShadowCaster& caster)
+			{
+				uint8_t mask = 0;
+				for (uint32_t cascade = 0; cascade < ShadowCascades::CASCADE_COUNT; cascade++)
+					if (frustums[cascade].Intersects(caster.Center, caster.HalfSize)) mask |= static_cast<uint8_t>(1u << cascade);
+				return mask;
+			};
+
+		// the box closest to a point a few meters in front of the camera walks away from it
+		const glm::vec3 start = eye + forward * 3.0f;
+		const size_t moving = static_cast<size_t>(std::min_element(casters.begin(), casters.end(), [&](const ShadowCaster& a, const ShadowCaster& b)
+			{ return glm::distance(a.Center, start) < glm::distance(b.Center, start); }) - casters.begin());
+		std::vector<ShadowCaster> history(SlotCount, casters[moving]); // the caster as each slot last drew it
+		uint32_t partialRedraws = 0, moveRedraws = 0;
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			const uint32_t slot = frame % SlotCount;
+			ShadowCaster& caster = casters[moving];
+			caster.Center += forward * 0.25f;
+			caster.Hash = ShadowCascades::HashCaster(&mesh, glm::translate(glm::mat4(1.0f), caster.Center));
+			cascades.Update(casters, slot);
+
+			const uint8_t expected = overlapMask(history[slot]) | overlapMask(caster);
+			ok &= Check(cascades.GetRedrawMask() == expected, "moving caster redraw mask in frame " + std::to_string(frame));
+			if (expected != 0 && expected != AllLayers) partialRedraws++;
+			moveRedraws += std::bitset<8>(cascades.GetRedrawMask()).count();
+			history[slot] = caster;
+		}
+		ok &= Check(partialRedraws > 0, "the moving caster leaves some cascades untouched");
+
+		std::vector<int64_t> times;
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			Clock clock;
+			cascades.Update(casters, frame % SlotCount);
+			times.push_back(clock.GetElapsedTime().AsMicroseconds());
+		}
+
+		Print("shadow-cascades: " + std::to_string(casters.size()) + " casters, " + std::to_string(frames) + " frames per trace, layers redrawn: still "
+			+ std::to_string(stillRedraws) + ", bob " + std::to_string(bobRedraws) + ", moving caster " + std::to_string(moveRedraws) + " of "
+			+ std::to_string(frames * ShadowCascades::CASCADE_COUNT) + ", median update " + std::to_string(Median(times)) + " us");
+		return ok;
+	}
+
+	class ATestActor final : public Actor
+	{
+	public:
+		DEFINE_ACTOR_CLASS(ATestActor)
+
+		ATestActor(bool destroyInConstructor, uint32_t& updateCount) : m_updateCount(updateCount)
+		{
+			if (destroyInConstructor) Destroy();
+		}
+
+		void Update([[maybe_unused]] float deltaTime) final { m_updateCount++; }
+
+	private:
+		uint32_t& m_updateCount;
+	};
+
+	// Writes a map in the .mp layout MapParser reads: entities with key/value properties and brushes of six quads.
+	// Returns what the parser has to find in it.
+	struct GeneratedMap final
+	{
+		std::string Bytes;
+		size_t      Faces = 0;
+		size_t      FaceVertices = 0;
+		double      PositionSum = 0.0; // of all brush and face vertices
+	};
+
+	GeneratedMap GenerateMap(uint32_t entityCount, uint32_t brushesPerEntity)
+	{
+		GeneratedMap map;
+		std::string& bytes = map.Bytes;
+		auto write = [&](const auto& value) { bytes.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+		auto writeString = [&](std::string_view string)
+			{
+				write(static_cast<uint8_t>(string.size()));
+				bytes.append(string);
+			};
+
+		constexpr std::string_view Textures[] = { "dev/dev_128_gr", "dev/dev_64_bl", "metal/floor_01", "concrete/wall_03" };
+		const glm::vec3 Normals[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+		write(static_cast<uint16_t>(entityCount));
+		for (uint32_t e = 0; e < entityCount; e++)
+		{
+			const glm::vec3 origin(static_cast<float>(e % 64) * 96.0f, static_cast<float>(e / 64 % 64) * 96.0f, static_cast<float>(e / 4096) * 96.0f);
+			write(static_cast<uint16_t>(4));
+			writeString("classname");
+			writeString(e == 0 ? "worldspawn" : "func_wall");
+			writeString("targetname");
+			writeString("entity_" + std::to_string(e));
+			writeString("origin");
+			writeString(std::to_string(static_cast<int>(origin.x)) + " " + std::to_string(static_cast<int>(origin.y)) + " " + std::to_string(static_cast<int>(origin.z)));
+			writeString("_color");
+			writeString("255 200 128");
+
+			write(static_cast<uint16_t>(brushesPerEntity));
+			for (uint32_t b = 0; b < brushesPerEntity; b++)
+			{
+				const glm::vec3 min = origin + glm::vec3(static_cast<float>(b) * 32.0f, 0.0f, 0.0f);
+				const glm::vec3 max = min + glm::vec3(24.0f, 24.0f, 64.0f);
+				write(static_cast<uint16_t>(8));
+				for (int corner = 0; corner < 8; corner++)
+				{
+					const glm::vec3 position((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+					write(position);
+					map.PositionSum += static_cast<double>(position.x) + position.y + position.z;
+				}
+
+				write(static_cast<uint16_t>(6));
+				for (uint32_t f = 0; f < 6; f++)
+				{
+					writeString(Textures[(e + b + f) % std::size(Textures)]);
+					write(Normals[f]);
+					write(static_cast<uint16_t>(4));
+					for (int v = 0; v < 4; v++)
+					{
+						const MapData::Vertex vertex{ min + glm::vec3(static_cast<float>(v), static_cast<float>(f), 0.0f), { static_cast<float>(v & 1), static_cast<float>(v >> 1) } };
+						write(vertex);
+						map.PositionSum += static_cast<double>(vertex.Position.x) + vertex.Position.y + vertex.Position.z;
+					}
+					map.Faces++;
+					map.FaceVertices += 4;
+				}
+			}
+		}
+		return map;
+	}
+
+	// Generates a large map, parses it with MapParser and checks the element counts, a sum over every vertex and the
+	// typed property reads against the generated values. Reports the best parse time and the allocations of a parse.
+	bool MapParse(std::span<const std::string> args)
+	{
+		const uint32_t entityCount = std::min(ArgU32(args, 0, 3000), uint32_t{ UINT16_MAX });
+		const uint32_t iterations = ArgU32(args, 1, 20);
+		constexpr uint32_t BrushesPerEntity = 3;
+
+		const GeneratedMap generated = GenerateMap(entityCount, BrushesPerEntity);
+		std::error_code ec;
+		const std::filesystem::path directory = std::filesystem::temp_directory_path(ec) / "MapParseBenchmark";
+		std::filesystem::create_directories(directory, ec);
+		{
+			std::ofstream file(directory / "generated.mp", std::ios::binary);
+			file.write(generated.Bytes.data(), static_cast<std::streamsize>(generated.Bytes.size()));
+		}
+
+		FileSystem::Init();
+		FileSystem::Mount(directory.string(), "/");
+
+		bool ok = true;
+		{
+			const MapParser parser("generated.mp");
+			const MapData::Map& map = parser.GetMap();
+			ok &= Check(map.Entities.size() == entityCount, std::to_string(map.Entities.size()) + " entities");
+			ok &= Check(map.Brushes.size() == size_t{ entityCount } * BrushesPerEntity, std::to_string(map.Brushes.size()) + " brushes");
+			ok &= Check(map.Faces.size() == generated.Faces, std::to_string(map.Faces.size()) + " faces");
+			ok &= Check(map.FaceVertices.size() == generated.FaceVertices, std::to_string(map.FaceVertices.size()) + " face vertices");
+
+			double positionSum = 0.0;
+			for (const MapData::Brush& brush : map.Brushes)
+			{
+				for (const glm::vec3& position : brush.Vertices)
+					positionSum += static_cast<double>(position.x) + position.y + position.z;
+				for (const MapData::Face& face : brush.Faces)
+				{
+					for (const MapData::Vertex& vertex : face.Vertices)
+						positionSum += static_cast<double>(vertex.Position.x) + vertex.Position.y + vertex.Position.z;
+				}
+			}
+			ok &= Check(positionSum == generated.PositionSum, "sum of the parsed vertex positions");
+
+			uint32_t wrongProperties = 0;
+			for (uint32_t e = 0; e < map.Entities.size(); e++)
+			{
+				const MapData::Entity& entity = map.Entities[e];
+				std::string name;
+				glm::vec3 color, origin;
+				const glm::vec3 expectedOrigin(static_cast<float>(e % 64) * 3.0f, static_cast<float>(e / 4096) * 3.0f, static_cast<float>(e / 64 % 64) * 3.0f);
+				if (!entity.GetPropertyString("targetname", name) || name != "entity_" + std::to_string(e)
+					|| !entity.GetPropertyColor("_color", color) || !entity.GetPropertyVector("origin", origin) || origin != expectedOrigin
+					|| entity.Brushes.size() != BrushesPerEntity)
+					wrongProperties++;
+			}
+			ok &= Check(wrongProperties == 0, std::to_string(wrongProperties) + " entities with wrong properties or brushes");
+		}
+
+		int64_t bestTime = INT64_MAX;
+		uint64_t allocations = 0;
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			const uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+			Clock clock;
+			const MapParser parser("generated.mp");
+			bestTime = std::min(bestTime, clock.GetElapsedTime().AsMicroseconds());
+			allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+		}
+
+		FileSystem::Shutdown();
+		std::filesystem::remove_all(directory, ec);
+
+		Print("map-parse: " + std::to_string(entityCount) + " entities, " + std::to_string(generated.Faces) + " faces, "
+			+ std::to_string(generated.Bytes.size() / 1024) + " KB, best of " + std::to_string(iterations) + " parses "
+			+ std::to_string(bestTime) + " us, " + std::to_string(allocations) + " allocations per parse");
+		return ok;
+	}
+
+	// Box brushes laid out like a map: ranges of the arrays are turned into MapData::Brush once all boxes are added.
+	class BoxBrushSet final
+	{
+	public:
+		void AddBox(const glm::vec3& min, const glm::vec3& max, std::string_view texture)
+		{
+			m_boxes.push_back({ m_vertices.size(), m_faces.size() });
+			for (int corner = 0; corner < 8; corner++)
+				m_vertices.emplace_back((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+
+			// counter-clockwise corner indices seen from outside, per axis and side
+			constexpr int Quads[6][4] = { { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 2, 3, 1 }, { 4, 5, 7, 6 } };
+			for (int side = 0; side < 6; side++)
+			{
+				glm::vec3 normal(0.0f);
+				normal[side / 2] = (side & 1) ? 1.0f : -1.0f;
+				m_faces.push_back({ texture, normal, m_faceVertices.size() });
+				for (const int corner : Quads[side])
+				{
+					const glm::vec3& position = m_vertices[m_boxes.back().FirstVertex + static_cast<size_t>(corner)];
+					m_faceVertices.push_back({ position, glm::vec2(position.x + position.z, position.y + position.z) });
+				}
+			}
+		}
+
+		[[nodiscard]] std::vector<MapData::Brush> GetBrushes()
+		{
+			m_mapFaces.clear();
+			for (const FaceRange& face : m_faces)
+				m_mapFaces.push_back({ face.Texture, face.Normal, std::span<const MapData::Vertex>(m_faceVertices).subspan(face.FirstVertex, 4) });
+			std::vector<MapData::Brush> brushes;
+			for (const BoxRange& box : m_boxes)
+				brushes.push_back({ std::span<const glm::vec3>(m_vertices).subspan(box.FirstVertex, 8), std::span<const MapData::Face>(m_mapFaces).subspan(box.FirstFace, 6) });
+			return brushes;
+		}
+
+	private:
+		struct BoxRange final
+		{
+			size_t FirstVertex;
+			size_t FirstFace;
+		};
+
+		struct FaceRange final
+		{
+			std::string_view Texture;
+			glm::vec3        Normal;
+			size_t           FirstVertex;
+		};
+
+		std::vector<BoxRange>         m_boxes;
+		std::vector<FaceRange>        m_faces;
+		std::vector<glm::vec3>        m_vertices;
+		std::vector<MapData::Vertex>  m_faceVertices;
+		std::vector<MapData::Face>    m_mapFaces;
+	};
+
+	// Compiles small brush sets whose hidden faces are known and checks what BrushMeshCompiler removes:
+	// - a box buried in another box loses all six faces
+	// - a box inside another box and flush with its floor keeps that floor face, two boxes side by side only lose
+	//   the two faces touching each other
+	// - a box standing on a bigger one loses its bottom, the partly covered top of the bigger one stays
+	// Then compiles a level of rooms (floor and ceiling tiles, wall segments) the old way, one unwelded mesh per
+	// material with every face, and with the default settings, and prints triangles, vertices and draw calls of both.
+	bool BrushCompile(std::span<const std::string> args)
+	{
+		const uint32_t roomsPerSide = ArgU32(args, 0, 3);
+		const uint32_t iterations = ArgU32(args, 1, 10);
+
+		bool ok = true;
+		auto checkHidden = [&](const char* name, BoxBrushSet& set, uint32_t expectedHidden)
+			{
+				BrushMeshCompiler compiler;
+				compiler.Compile(set.GetBrushes(), glm::vec3(0.0f));
+				const BrushMeshCompilerStats& stats = compiler.GetStats();
+				ok &= Check(stats.HiddenFaces == expectedHidden, std::string(name) + ": " + std::to_string(stats.HiddenFaces) + " hidden faces, expected " + std::to_string(expectedHidden));
+				ok &= Check(stats.OutputTriangles == (stats.Faces - expectedHidden) * 2, std::string(name) + ": two triangles per kept face");
+			};
+
+		BoxBrushSet buried;
+		buried.AddBox(glm::vec3(0.0f), glm::vec3(2.0f), "wall");
+		buried.AddBox(glm::vec3(0.5f), glm::vec3(1.0f), "wall");
+		checkHidden("buried box", buried, 6);
+
+		BoxBrushSet flushFloor;
+		flushFloor.AddBox(glm::vec3(0.0f), glm::vec3(2.0f), "wall");
+		flushFloor.AddBox(glm::vec3(0.5f, 0.5f, 0.0f), glm::vec3(1.0f), "wall");
+		checkHidden("box flush with the floor of another", flushFloor, 5);
+
+		BoxBrushSet sideBySide;
+		sideBySide.AddBox(glm::vec3(0.0f), glm::vec3(1.0f), "floor");
+		sideBySide.AddBox(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(2.0f, 1.0f, 1.0f), "floor");
+		checkHidden("boxes side by side", sideBySide, 2);
+
+		BoxBrushSet standing;
+		standing.AddBox(glm::vec3(0.0f), glm::vec3(2.0f, 2.0f, 0.5f), "floor");
+		standing.AddBox(glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(1.0f, 1.0f, 1.5f), "wall");
+		checkHidden("box standing on a bigger one", standing, 1);
+
+		// rooms of 16x16 floor and ceiling tiles, walled by 16 segments per side, with a gap between rooms.
+		// Map units are meters (32 Quake units), like the brushes of a converted map.
+		constexpr int Tiles = 16;
+		constexpr float Tile = 1.0f;
+		constexpr float Thickness = 0.5f;
+		constexpr float RoomHeight = 4.0f;
+		constexpr float RoomStride = Tiles * Tile + 2.0f;
+		BoxBrushSet level;
+		for (uint32_t roomY = 0; roomY < roomsPerSide; roomY++)
+		{
+			for (uint32_t roomX = 0; roomX < roomsPerSide; roomX++)
+			{
+				const glm::vec3 room(static_cast<float>(roomX) * RoomStride, static_cast<float>(roomY) * RoomStride, 0.0f);
+				for (int y = 0; y < Tiles; y++)
+				{
+					for (int x = 0; x < Tiles; x++)
+					{
+						const glm::vec3 tile = room + glm::vec3(static_cast<float>(x) * Tile, static_cast<float>(y) * Tile, 0.0f);
+						level.AddBox(tile + glm::vec3(0.0f, 0.0f, -Thickness), tile + glm::vec3(Tile, Tile, 0.0f), "floor");
+						level.AddBox(tile + glm::vec3(0.0f, 0.0f, RoomHeight), tile + glm::vec3(Tile, Tile, RoomHeight + Thickness), "ceiling");
+					}
+				}
+				for (int i = 0; i < Tiles; i++)
+				{
+					const float along = static_cast<float>(i) * Tile;
+					level.AddBox(room + glm::vec3(along, 0.0f, 0.0f), room + glm::vec3(along + Tile, Thickness, RoomHeight), "wall");
+					level.AddBox(room + glm::vec3(along, Tiles * Tile - Thickness, 0.0f), room + glm::vec3(along + Tile, Tiles * Tile, RoomHeight), "wall");
+					level.AddBox(room + glm::vec3(0.0f, along, 0.0f), room + glm::vec3(Thickness, along + Tile, RoomHeight), "wall");
+					level.AddBox(room + glm::vec3(Tiles * Tile - Thickness, along, 0.0f), room + glm::vec3(Tiles * Tile, along + Tile, RoomHeight), "wall");
+				}
+			}
+		}
+		const std::vector<MapData::Brush> brushes = level.GetBrushes();
+
+		BrushMeshCompilerSettings unbatched;
+		unbatched.CellSize = std::numeric_limits<float>::max();
+		unbatched.RemoveHiddenFaces = false;
+		unbatched.WeldVertices = false;
+		auto compileLevel = [&](const BrushMeshCompilerSettings& settings, BrushMeshCompilerStats& stats)
+			{
+				std::vector<int64_t> times;
+				BrushMeshCompiler compiler(settings);
+				for (uint32_t i = 0; i < iterations; i++)
+				{
+					Clock clock;
+					compiler.Compile(brushes, glm::vec3(0.0f));
+					times.push_back(clock.GetElapsedTime().AsMicroseconds());
+				}
+				stats = compiler.GetStats();
+				return Median(times);
+			};
+		BrushMeshCompilerStats before, after;
+		const int64_t beforeTime = compileLevel(unbatched, before);
+		const int64_t afterTime = compileLevel(BrushMeshCompilerSettings{}, after);
+		ok &= Check(before.HiddenFaces == 0 && before.Meshes == before.Materials, "the old way keeps every face in one mesh per material");
+		ok &= Check(after.OutputTriangles < before.OutputTriangles, "hidden faces are removed from the level");
+
+		// colliders Brushes would create for the level as one static entity: brushes with the same vertices around
+		// their center share a cooked mesh, and the shapes are grouped into one static actor per cell
+		std::vector<std::vector<float>> colliderShapes;
+		std::unordered_map<glm::ivec3, uint32_t> colliderCells;
+		for (const MapData::Brush& brush : brushes)
+		{
+			glm::vec3 min{ std::numeric_limits<float>::max() };
+			glm::vec3 max{ std::numeric_limits<float>::lowest() };
+			for (const glm::vec3& vertex : brush.Vertices)
+			{
+				min = glm::min(min, vertex);
+				max = glm::max(max, vertex);
+			}
+			const glm::vec3 center = (min + max) * 0.5f;
+			std::vector<float>& shape = colliderShapes.emplace_back();
+			for (const glm::vec3& vertex : brush.Vertices)
+				shape.insert(shape.end(), { vertex.x - center.x, vertex.y - center.y, vertex.z - center.z });
+			colliderCells[glm::ivec3(glm::floor(center / Brushes::COLLIDER_CELL_SIZE))]++;
+		}
+		std::sort(colliderShapes.begin(), colliderShapes.end());
+		const size_t cookedColliders = static_cast<size_t>(std::unique(colliderShapes.begin(), colliderShapes.end()) - colliderShapes.begin());
+
+		Print("brush-compile: " + std::to_string(brushes.size()) + " box brushes, " + std::to_string(before.Faces) + " faces");
+		Print("brush-compile: before " + std::to_string(before.OutputTriangles) + " triangles, " + std::to_string(before.OutputVertices) + " vertices, "
+			+ std::to_string(before.Meshes) + " draw calls, median " + std::to_string(beforeTime) + " us");
+		Print("brush-compile: after  " + std::to_string(after.OutputTriangles) + " triangles, " + std::to_string(after.OutputVertices) + " vertices, "
+			+ std::to_string(after.Meshes) + " draw calls, median " + std::to_string(afterTime) + " us, " + std::to_string(after.HiddenFaces) + " hidden faces");
+		Print("brush-compile: colliders " + std::to_string(cookedColliders) + " cooked for " + std::to_string(brushes.size()) + " brushes, "
+			+ std::to_string(colliderCells.size()) + " static actors (broadphase entries) instead of " + std::to_string(brushes.size()));
+		return ok;
+	}
+
+	// Draw-only actor, most level geometry and props are like this.
+	class ADrawActor final : public Actor
+	{
+	public:
+		DEFINE_ACTOR_CLASS(ADrawActor)
+
+		explicit ADrawActor(uint32_t& drawCount) : m_drawCount(drawCount) {}
+
+		void Draw() final { m_drawCount++; }
+
+	private:
+		uint32_t& m_drawCount;
+	};
+
+	// Actor without tick functions, found through class queries like the player or a map's triggers.
+	class AQueryActor final : public Actor
+	{
+	public:
+		DEFINE_ACTOR_CLASS(AQueryActor)
+
+		AQueryActor() = default;
+	};
+
+	// Creates and destroys actors in a random order, some of them in their own constructor, and checks the actor count,
+	// the class bucket and the number of Update calls against a plain list of the actors that should be alive.
+	// Then fills a scene with N named actors (10% ticking, 10% queried by class, 80% draw-only), checks the tick
+	// counts and lookup results, and times Update + Draw, class queries and name lookups.
+	bool SceneActors(std::span<const std::string> args)
+	{
+		const uint32_t actorCount = ArgU32(args, 0, 10000);
+		const uint32_t frames = ArgU32(args, 1, 200);
+		constexpr uint32_t Lookups = 100000;
+
+		bool ok = true;
+		size_t churnActorsLeft = 0;
+		{
+			Scene scene;
+			std::mt19937 random(42);
+			std::vector<ATestActor*> alive;
+			uint32_t updateCount = 0;
+			for (uint32_t frame = 0; frame < frames && ok; frame++)
+			{
+				const uint32_t createCount = random() % 8;
+				for (uint32_t i = 0; i < createCount; i++)
+				{
+					const bool destroyInConstructor = random() % 4 == 0;
+					ATestActor* actor = scene.CreateActor<ATestActor>(destroyInConstructor, updateCount);
+					if (!destroyInConstructor) alive.push_back(actor);
+				}
+				const uint32_t destroyCount = alive.empty() ? 0 : random() % std::min<size_t>(alive.size(), 6);
+				for (uint32_t i = 0; i < destroyCount; i++)
+				{
+					const size_t index = random() % alive.size();
+					alive[index]->Destroy();
+					alive.erase(alive.begin() + static_cast<ptrdiff_t>(index));
+				}
+
+				updateCount = 0;
+				scene.Update(0.0f);
+
+				size_t bucketCount = 0;
+				scene.ForEachActorOfClass<ATestActor>([&](ATestActor*) { bucketCount++; });
+				ok &= Check(scene.GetActorCount() == alive.size(), "actor count in frame " + std::to_string(frame));
+				ok &= Check(bucketCount == alive.size(), "class bucket size in frame " + std::to_string(frame));
+				ok &= Check(updateCount == alive.size() + destroyCount, "Update calls in frame " + std::to_string(frame));
+			}
+			churnActorsLeft = alive.size();
+		}
+		if (!ok) return false;
+
+		Scene scene;
+		uint32_t updateCount = 0, drawCount = 0;
+		uint32_t tickingCount = 0, drawOnlyCount = 0;
+		std::vector<Actor*> actors;
+		std::vector<AQueryActor*> queryActors;
+		for (uint32_t i = 0; i < actorCount; i++)
+		{
+			Actor* actor;
+			if (i % 10 == 0)
+			{
+				actor = scene.CreateActor<ATestActor>(false, updateCount);
+				tickingCount++;
+			}
+			else if (i % 10 == 5)
+			{
+				queryActors.push_back(scene.CreateActor<AQueryActor>());
+				actor = queryActors.back();
+			}
+			else
+			{
+				actor = scene.CreateActor<ADrawActor>(drawCount);
+				drawOnlyCount++;
+			}
+			scene.Register("actor_" + std::to_string(i), actor);
+			actors.push_back(actor);
+		}
+
+		std::vector<int64_t> tickTimes;
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			Clock clock;
+			scene.Update(1.0f / 60.0f);
+			scene.Draw();
+			tickTimes.push_back(clock.GetElapsedTime().AsMicroseconds());
+		}
+		ok &= Check(updateCount == frames * tickingCount, std::to_string(updateCount) + " Update calls, expected " + std::to_string(frames * tickingCount));
+		ok &= Check(drawCount == frames * drawOnlyCount, std::to_string(drawCount) + " Draw calls, expected " + std::to_string(frames * drawOnlyCount));
+
+		Clock clock;
+		uint32_t firstFound = 0;
+		for (uint32_t i = 0; i < Lookups; i++)
+			firstFound += scene.FindFirstActorOfClass<AQueryActor>() == queryActors.front() ? 1 : 0;
+		const Time findFirstTime = clock.Restart();
+		ok &= Check(firstFound == Lookups, "FindFirstActorOfClass returns the first actor of the class");
+
+		constexpr uint32_t ClassVisits = 100;
+		size_t visited = 0;
+		for (uint32_t i = 0; i < ClassVisits; i++)
+			scene.ForEachActorOfClass<AQueryActor>([&](AQueryActor* actor) { visited += actor->IsPendingDestroy() ? 0 : 1; });
+		const Time forEachTime = clock.Restart();
+		ok &= Check(visited == size_t{ ClassVisits } * queryActors.size(), "ForEachActorOfClass visits every actor of the class");
+
+		// names are built up front so the loop only times the lookup
+		std::mt19937 random(11);
+		std::vector<uint32_t> nameIndices(Lookups);
+		std::vector<std::string> names(Lookups);
+		for (uint32_t i = 0; i < Lookups; i++)
+		{
+			nameIndices[i] = random() % actorCount;
+			names[i] = "actor_" + std::to_string(nameIndices[i]);
+		}
+		clock.Restart();
+		uint32_t namesFound = 0;
+		for (uint32_t i = 0; i < Lookups; i++)
+			namesFound += scene.FindActorWithName(names[i]) == actors[nameIndices[i]] ? 1 : 0;
+		const Time nameTime = clock.GetElapsedTime();
+		ok &= Check(namesFound == Lookups, std::to_string(Lookups - namesFound) + " names not found or pointing at the wrong actor");
+
+		Print("scene-actors: churn " + std::to_string(frames) + " frames, " + std::to_string(churnActorsLeft) + " actors left");
+		Print("scene-actors: " + std::to_string(actorCount) + " actors (" + std::to_string(tickingCount) + " ticking, " + std::to_string(queryActors.size())
+			+ " queried, " + std::to_string(drawOnlyCount) + " draw-only), median Update + Draw " + std::to_string(Median(tickTimes)) + " us");
+		Print("scene-actors: " + std::to_string(Lookups) + "x FindFirstActorOfClass " + std::to_string(findFirstTime.AsMicroseconds()) + " us, "
+			+ std::to_string(ClassVisits) + "x ForEachActorOfClass over " + std::to_string(queryActors.size()) + " actors "
+			+ std::to_string(forEachTime.AsMicroseconds()) + " us, " + std::to_string(Lookups) + "x FindActorWithName "
+			+ std::to_string(nameTime.AsMicroseconds()) + " us");
+		return ok;
+	}
+
+	int DumpChunk(lua_State*, const void* data, size_t size, void* userData) noexcept
+	{
+		static_cast<std::string*>(userData)->append(static_cast<const char*>(data), size);
+		return 0;
+	}
+
+	// Bytecode of the function on top of the stack, debug info kept like the chunk cache does.
+	std::string DumpTop(lua_State* L)
+	{
+		std::string bytecode;
+		lua_dump(L, DumpChunk, &bytecode, 0);
+		return bytecode;
+	}
+
+	// Loads every shipped script from source with luaL_loadbuffer and through LuaSandbox::LoadChunk, checks a cache hit
+	// gives the same function as compiling the source, and reports the time of both.
+	bool LuaScripts(std::span<const std::string> args)
+	{
+		const uint32_t iterations = ArgU32(args, 0, 200);
+
+		std::vector<std::filesystem::path> scripts;
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator("Data/scripts", ec))
+			if (entry.path().extension() == ".lua") scripts.push_back(entry.path());
+		std::sort(scripts.begin(), scripts.end());
+		if (!Check(!scripts.empty(), "no .lua scripts found in Data/scripts")) return false;
+
+		// bytecode files go to a scratch directory, the memory cache serves the hits below
+		const std::filesystem::path cacheDir = std::filesystem::temp_directory_path(ec) / "LuaBenchmarkCache";
+		LuaSandbox::SetChunkCacheDir(cacheDir.string() + "/");
+
+		lua_State* L = luaL_newstate();
+		bool ok = true;
+		int64_t totalSource = 0, totalCached = 0;
+		for (const std::filesystem::path& script : scripts)
+		{
+			std::ifstream file(script, std::ios::binary);
+			const std::string source{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+			const std::string name = script.generic_string();
+
+			if (!Check(luaL_loadbuffer(L, source.data(), source.size(), name.c_str()) == LUA_OK, "compile " + name))
+			{
+				lua_pop(L, 1);
+				ok = false;
+				continue;
+			}
+			const std::string compiled = DumpTop(L);
+			lua_pop(L, 1);
+
+			// the first load compiles and fills the cache, the second one has to come from it
+			bool fromCache = true;
+			ok &= Check(LuaSandbox::LoadChunk(L, source, name, &fromCache) == LUA_OK && !fromCache, "first LoadChunk of " + name + " compiles");
+			lua_pop(L, 1);
+			ok &= Check(LuaSandbox::LoadChunk(L, source, name, &fromCache) == LUA_OK && fromCache, "second LoadChunk of " + name + " is cached");
+			ok &= Check(DumpTop(L) == compiled, "cached " + name + " matches the source");
+			lua_pop(L, 1);
+
+			// a single load is a few microseconds, so whole batches are timed
+			Clock clock;
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				luaL_loadbuffer(L, source.data(), source.size(), name.c_str());
+				lua_pop(L, 1);
+			}
+			const int64_t sourceTime = clock.Restart().AsMicroseconds();
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				LuaSandbox::LoadChunk(L, source, name);
+				lua_pop(L, 1);
+			}
+			const int64_t cachedTime = clock.GetElapsedTime().AsMicroseconds();
+			totalSource += sourceTime;
+			totalCached += cachedTime;
+			Print("lua-scripts: " + name + " (" + std::to_string(source.size()) + " bytes) " + std::to_string(iterations) + " loads, source "
+				+ std::to_string(sourceTime) + " us, cached " + std::to_string(cachedTime) + " us");
+		}
+		lua_close(L);
+		std::filesystem::remove_all(cacheDir, ec);
+
+		Print("lua-scripts: all " + std::to_string(scripts.size()) + " scripts, source " + std::to_string(totalSource) + " us, cached " + std::to_string(totalCached) + " us");
+		return ok;
+	}
+
+	uint32_t timerCallCount = 0;
+
+	// Schedules one-shot and repeating timers with random delays, cancels a quarter of them and runs GameLua::Update
+	// until all due times have passed. The number of callbacks is checked against a count worked out from the delays
+	// and intervals. Times are whole 1/64 s steps, so the simulated clock is exact and no timer sits on a rounding edge.
+	// Delays start at one step: a repeating timer runs at most once per Update, one due before the first Update would
+	// stay a step behind.
+	bool LuaTimers(std::span<const std::string> args)
+	{
+		const uint32_t timerCount = ArgU32(args, 0, 100000);
+		constexpr float Step = 1.0f / 64.0f;
+		constexpr uint32_t MaxDelaySteps = 640;
+		constexpr uint32_t RunSteps = 768;
+
+		GameLua lua;
+		lua.SetGlobalFunction("onTimer", [](lua_State*) { timerCallCount++; return 0; });
+		lua.DoSource("function tick() onTimer() end", "LuaTimers");
+		const int tick = lua.GetGlobalVariableReference("tick");
+
+		std::mt19937 random(7);
+		std::vector<uint32_t> handles(timerCount);
+		std::vector<std::pair<uint32_t, uint32_t>> timers(timerCount); // (delay, interval) in steps, interval 0 for one-shot
+		Clock clock;
+		for (uint32_t i = 0; i < timerCount; i++)
+		{
+			timers[i] = { 1 + random() % MaxDelaySteps, random() % 4 == 0 ? 1 + random() % 128 : 0 };
+			lua.PushReference(tick);
+			handles[i] = lua.ScheduleTimer(static_cast<float>(timers[i].first) * Step, static_cast<float>(timers[i].second) * Step);
+		}
+		const Time scheduleTime = clock.Restart();
+
+		uint64_t expectedCalls = 0;
+		for (uint32_t i = 0; i < timerCount; i++)
+		{
+			if (i % 4 == 1)
+			{
+				if (!Check(lua.CancelTimer(handles[i]), "cancel a scheduled timer")) return false;
+				continue;
+			}
+			const auto [delay, interval] = timers[i];
+			expectedCalls += interval == 0 ? 1 : (RunSteps - delay) / interval + 1;
+		}
+		const Time cancelTime = clock.Restart();
+
+		timerCallCount = 0;
+		int64_t slowestUpdate = 0;
+		for (uint32_t step = 0; step < RunSteps; step++)
+		{
+			Clock updateClock;
+			lua.Update(Step);
+			slowestUpdate = std::max(slowestUpdate, updateClock.GetElapsedTime().AsMicroseconds());
+		}
+		const Time updateTime = clock.GetElapsedTime();
+
+		bool ok = Check(timerCallCount == expectedCalls, std::to_string(timerCallCount) + " timer callbacks, expected " + std::to_string(expectedCalls));
+		if (timerCount > 1)
+			ok &= Check(!lua.CancelTimer(handles[1]), "a cancelled timer can't be cancelled again");
+		lua.FreeReference(tick);
+
+		Print("lua-timers: " + std::to_string(timerCount) + " timers, " + std::to_string(timerCallCount) + " callbacks, schedule "
+			+ std::to_string(scheduleTime.AsMicroseconds()) + " us, cancel " + std::to_string(cancelTime.AsMicroseconds()) + " us, "
+			+ std::to_string(RunSteps) + " updates " + std::to_string(updateTime.AsMicroseconds()) + " us, slowest update "
+			+ std::to_string(slowestUpdate) + " us");
+		return ok;
+	}
+
+	// Compiles the shaders of every pipeline config into an empty cache, then again with VerifyCache so every cache
+	// hit is also compiled and compared with the cached SPIR-V. Needs no GPU, reports the time of both runs.
+	bool ShaderCache(std::span<const std::string> args)
+	{
+		std::vector<std::string> pipelineConfigs;
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::directory_iterator("Data/pipelines", ec))
+			if (entry.path().extension() == ".json") pipelineConfigs.push_back("pipelines/" + entry.path().filename().string());
+		std::sort(pipelineConfigs.begin(), pipelineConfigs.end());
+		if (!Check(!pipelineConfigs.empty(), "no pipeline configs found in Data/pipelines")) return false;
+
+		FileSystem::Init();
+		FileSystem::Mount("Data", "/");
+
+		std::vector<ShaderFile> shaderFiles;
+		for (const std::string& pipelineConfig : pipelineConfigs)
+			VulkanPipelineConfig(pipelineConfig).AppendShaderFiles(shaderFiles);
+
+		const std::filesystem::path cacheDir = std::filesystem::temp_directory_path(ec) / "ShaderBenchmarkCache";
+		std::filesystem::remove_all(cacheDir, ec);
+		ShaderCompilerSettings settings;
+		settings.CacheDir = cacheDir.string() + "/";
+
+		bool ok = true;
+		ShaderCompilerStats cold, warm;
+		Time coldTime, warmTime;
+		{
+			ShaderCompiler compiler("shader_includes/", settings);
+			Clock clock;
+			compiler.CompileFiles(shaderFiles);
+			coldTime = clock.GetElapsedTime();
+			cold = compiler.GetStats();
+		}
+		ok &= Check(cold.Hits == 0, std::to_string(cold.Hits) + " cache hits in an empty cache");
+
+		settings.VerifyCache = true;
+		{
+			ShaderCompiler compiler("shader_includes/", settings);
+			Clock clock;
+			compiler.CompileFiles(shaderFiles);
+			warmTime = clock.GetElapsedTime();
+			warm = compiler.GetStats();
+		}
+		ok &= Check(warm.Hits == cold.Misses && warm.Misses == 0, std::to_string(warm.Hits) + " of " + std::to_string(cold.Misses) + " shaders from the cache");
+		ok &= Check(warm.Mismatches == 0, std::to_string(warm.Mismatches) + " cached shaders differ from a fresh compile");
+
+		FileSystem::Shutdown();
+		std::filesystem::remove_all(cacheDir, ec);
+
+		Print("shader-cache: " + std::to_string(pipelineConfigs.size()) + " pipelines, " + std::to_string(cold.Misses) + " shaders, cold "
+			+ std::to_string(coldTime.AsMilliseconds()) + " ms, warm with verification " + std::to_string(warmTime.AsMilliseconds()) + " ms, "
+			+ std::to_string(warm.Mismatches) + " mismatches");
+		return ok;
+	}
+
+	constexpr Benchmark Benchmarks[] = {
+		{ "light-clusters",  "[samplesPerLight=64] [iterations=50]", LightClusters },
+		{ "shadow-cascades", "[casterGrid=64] [frames=240]",         ShadowCascadeRedraws },
+		{ "scene-actors",    "[actors=10000] [frames=200]",          SceneActors },
+		{ "map-parse",       "[entities=3000] [iterations=20]",      MapParse },
+		{ "brush-compile",   "[roomsPerSide=3] [iterations=10]",     BrushCompile },
+		{ "lua-scripts",     "[iterations=200]",                     LuaScripts },
+		{ "lua-timers",      "[timers=100000]",                      LuaTimers },
+		{ "shader-cache",    "",                                     ShaderCache },
+	};
+}
+
+bool RunBenchmarks(std::string_view name, std::span<const std::string> args)
+{
+	bool found = false;
+	bool succeeded = true;
+	for (const Benchmark& benchmark : Benchmarks)
+	{
+		if (name != "all" && name != benchmark.Name) continue;
+		found = true;
+
+		Print("--- " + std::string(benchmark.Name));
+		const bool result = benchmark.Func(args);
+		Print(std::string(benchmark.Name) + (result ? ": OK" : ": FAILED"));
+		succeeded &= result;
+	}
+
+	if (!found)
+	{
+		Print("Usage: FPS --bench <name|all> [args...]");
+		for (const Benchmark& benchmark : Benchmarks)
+			Print("  " + std::string(benchmark.Name) + " " + std::string(benchmark.Usage));
+		return false;
+	}
+	return succeeded;
+}
+
+#pragma endregion
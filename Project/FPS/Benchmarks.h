@@ -0,0 +1,10 @@
+#pragma once
+
+#pragma region Benchmarks
+
+// FPS --bench <name|all> [args...]: CPU side checks and benchmarks of engine and game systems. They run before the
+// engine is created, so they need neither a window nor a GPU. Each prints its numbers and returns false when a result
+// is wrong. An unknown name lists them.
+bool RunBenchmarks(std::string_view name, std::span<const std::string> args);
+
+#pragma endregion
@@ -1,6 +1,16 @@
 ﻿#include "Base.h"
 #include "Core.h"
 
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
 #pragma region Clock
 
 Time Clock::GetElapsedTime() const
@@ -173,6 +183,115 @@ std::string FileSystem::Read(const std::string& filename)
 	return bytes;
 }
 
+MappedFile::MappedFile(const std::string& filename)
+{
+	// PhysFS only tells where a file comes from, a file inside a mounted directory can be mapped directly
+	if (const char* realDir = PHYSFS_getRealDir(filename.c_str()))
+	{
+		std::error_code error;
+		if (std::filesystem::is_directory(realDir, error))
+		{
+			std::string_view relativePath = filename;
+			std::string_view mountPoint = PHYSFS_getMountPoint(realDir) ? PHYSFS_getMountPoint(realDir) : "";
+			while (relativePath.starts_with('/'))
+				relativePath.remove_prefix(1);
+			while (mountPoint.starts_with('/'))
+				mountPoint.remove_prefix(1);
+			if (relativePath.starts_with(mountPoint))
+				relativePath.remove_prefix(mountPoint.size());
+
+			if (mapFile(std::filesystem::path(realDir) / relativePath))
+				return;
+		}
+	}
+
+	m_buffer = FileSystem::Read(filename);
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+}
+
+bool MappedFile::mapFile(const std::filesystem::path& path)
+{
+#if defined(_WIN32)
+	const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// the mapping keeps the file open and the view keeps the mapping alive
+	const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!view)
+		return false;
+
+	m_size = static_cast<size_t>(size.QuadPart);
+#else
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file == -1)
+		return false;
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED)
+		return false;
+
+	m_size = static_cast<size_t>(status.st_size);
+#endif
+
+	m_mapping = view;
+	m_data = static_cast<const char*>(view);
+	return true;
+}
+
+void MappedFile::Release()
+{
+	if (m_mapping)
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile(m_mapping);
+#else
+		munmap(m_mapping, m_size);
+#endif
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+	m_buffer = {};
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept
+{
+	std::swap(m_data, other.m_data);
+	std::swap(m_size, other.m_size);
+	std::swap(m_mapping, other.m_mapping);
+	std::swap(m_buffer, other.m_buffer);
+
+	// a short buffer lives inside the string, so its data moved with the swap
+	if (!m_mapping && m_data)
+		m_data = m_buffer.data();
+	if (!other.m_mapping && other.m_data)
+		other.m_data = other.m_buffer.data();
+}
+
 JsonFile::JsonFile(const std::string& filename)
 {
 	const simdjson::error_code result = m_parser.parse(FileSystem::Read(filename)).get(m_document);
@@ -262,10 +381,28 @@ void ImageFile::Swap(ImageFile& other) noexcept
 }
 
 BinaryParser::BinaryParser(const std::string& filename)
-	: m_binary(FileSystem::Read(filename))
-	, m_current(m_binary.data())
-	, m_remainingBytes(m_binary.size())
+	: m_file(filename)
+	, m_current(m_file.GetData())
+	, m_remainingBytes(m_file.GetSize())
+{
+}
+
+bool BinaryParser::skipBytes(size_t numBytes)
+{
+	if (m_remainingBytes < numBytes)
+	{
+		Fatal("Not enough data in the binary file.");
+		return false;
+	}
+	m_current += numBytes;
+	m_remainingBytes -= numBytes;
+	return true;
+}
+
+void BinaryParser::rewind()
 {
+	m_current = m_file.GetData();
+	m_remainingBytes = m_file.GetSize();
 }
 
 bool BinaryParser::readBytes(size_t numBytes, void* output)
@@ -185,6 +185,57 @@ private:
 
 #pragma endregion
 
+#pragma region Hash
+
+// FNV-1a, for cache keys and small content hashes. Pass the previous result as hash to continue over more data.
+constexpr uint64_t FNV1A_OFFSET_BASIS = 0xcbf29ce484222325ull;
+
+constexpr uint64_t HashString(std::string_view text, uint64_t hash = FNV1A_OFFSET_BASIS)
+{
+	for (const char c : text)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = FNV1A_OFFSET_BASIS)
+{
+	const auto* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+#pragma endregion
+
+#pragma region Threading
+
+// Runs func(i) for every i below count, on the calling thread and as many workers as there are cores.
+// func must be safe to call from several threads at once.
+template<class Func>
+inline void ParallelFor(size_t count, Func&& func)
+{
+	const size_t numThreads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+
+	std::atomic<size_t> next = 0;
+	const auto worker = [&]() {
+		for (size_t i = next++; i < count; i = next++)
+			func(i);
+	};
+
+	std::vector<std::jthread> threads;
+	for (size_t i = 1; i < numThreads; i++)
+		threads.emplace_back(worker);
+	worker();
+}
+
+#pragma endregion
+
 #pragma region Log
 
 namespace EngineApp
@@ -211,6 +262,45 @@ namespace FileSystem
 	std::string Read(const std::string& filename); // TODO: return optional
 } // namespace FileSystem
 
+// Read-only view of a whole file. Files in a mounted directory are memory-mapped,
+// files PhysFS can't map (archives) are read into memory instead.
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& filename);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept { Swap(other); }
+	~MappedFile() { Release(); }
+
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Release();
+			Swap(other);
+		}
+		return *this;
+	}
+
+	void Release();
+
+	void Swap(MappedFile& other) noexcept;
+
+	[[nodiscard]] const char* GetData() const { return m_data; }
+	[[nodiscard]] size_t GetSize() const { return m_size; }
+	[[nodiscard]] bool IsMapped() const { return m_mapping != nullptr; }
+
+private:
+	[[nodiscard]] bool mapFile(const std::filesystem::path& path);
+
+	const char* m_data = nullptr;
+	size_t      m_size = 0;
+	void*       m_mapping = nullptr; // Base address of the mapped view, null if the file was read into m_buffer
+	std::string m_buffer;
+};
+
 class JsonFile final
 {
 public:
@@ -292,6 +382,8 @@ protected:
 	bool readVec3(glm::vec3& value) { return readValue(value); }
 	// u8 length; char string[length];
 	bool readShortString(std::string& string) { return readString<uint8_t>(string); }
+	// Same as readShortString, but the view points into the file and stays valid as long as the parser.
+	bool readShortString(std::string_view& string) { return readStringView<uint8_t>(string); }
 
 	// u16 size; T vector[size];
 	template<class T>
@@ -300,6 +392,32 @@ protected:
 		return readVectorImpl<uint16_t>(vector);
 	}
 
+	// u16 size; T array[size]; appended to the end of the vector.
+	template<class T>
+	bool appendVector(std::vector<T>& vector)
+	{
+		uint16_t size;
+		if (!readValue(size))
+		{
+			return false;
+		}
+		const size_t offset = vector.size();
+		vector.resize(offset + size);
+		return readBytes(size * sizeof(T), vector.data() + offset);
+	}
+
+	// Moves past a "u16 size; T array[size];" and returns the size.
+	template<class T>
+	bool skipVector(uint16_t& size)
+	{
+		return readValue(size) && skipBytes(size * sizeof(T));
+	}
+
+	bool skipBytes(size_t numBytes);
+
+	// Starts reading from the beginning of the file again.
+	void rewind();
+
 private:
 	bool readBytes(size_t numBytes, void* output);
 
@@ -321,6 +439,23 @@ private:
 		return readBytes(length, string.data());
 	}
 
+	template<class LengthType>
+	bool readStringView(std::string_view& string)
+	{
+		LengthType length;
+		if (!readValue(length))
+		{
+			return false;
+		}
+		const char* begin = m_current;
+		if (!skipBytes(length))
+		{
+			return false;
+		}
+		string = std::string_view(begin, length);
+		return true;
+	}
+
 	template<class LengthType, class ValueType>
 	bool readVectorImpl(std::vector<ValueType>& vector)
 	{
@@ -333,7 +468,7 @@ private:
 		return readBytes(size * sizeof(ValueType), vector.data());
 	}
 
-	std::string m_binary;
+	MappedFile  m_file;
 	const char* m_current;
 	size_t      m_remainingBytes;
 };
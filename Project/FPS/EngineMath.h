@@ -542,9 +542,48 @@ public:
 class Frustum final
 {
 public:
+	Frustum() = default;
+	// Extracts the planes of a view projection matrix with depth range 0..1, normals point inside.
+	explicit Frustum(const glm::mat4& viewProjection);
+
+	[[nodiscard]] bool Intersects(const glm::vec3& center, const glm::vec3& halfSize) const;
+
 	Plane planes[6] = {};
 };
 
+#pragma region inline Frustum
+
+inline Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	const auto row = [&](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+	const glm::vec4 equations[6] = {
+		row(3) + row(0), // left
+		row(3) - row(0), // right
+		row(3) + row(1), // bottom
+		row(3) - row(1), // top
+		row(2),          // near
+		row(3) - row(2), // far
+	};
+	for (int i = 0; i < 6; i++)
+	{
+		const float length = glm::length(glm::vec3(equations[i]));
+		planes[i].n = glm::vec3(equations[i]) / length;
+		planes[i].d = equations[i].w / length;
+	}
+}
+
+inline bool Frustum::Intersects(const glm::vec3& center, const glm::vec3& halfSize) const
+{
+	for (const Plane& plane : planes)
+	{
+		if (glm::dot(plane.n, center) + plane.d + glm::dot(glm::abs(plane.n), halfSize) < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+#pragma endregion
+
 class Sphere final
 {
 public:
@@ -723,25 +762,3 @@ inline glm::vec3 Transform::GetHorizontalForwardVector() const
 }
 
 #pragma endregion
-
-class ShadowMatrixCalculator final
-{
-public:
-	void SetCameraInfo(const glm::mat4& view, float fov, float aspectRatio);
-	void SetLightDirection(const glm::vec3& lightDir);
-	void SetWorldBounds(const glm::vec3& min, const glm::vec3& max);
-	[[nodiscard]] glm::mat4 CalcShadowMatrix(float near, float far) const;
-
-private:
-	[[nodiscard]] std::array<glm::vec4, 8> getFrustumCorners(float near, float far) const;
-
-	[[nodiscard]] glm::mat4 getLightProjection(const std::array<glm::vec4, 8>& frustumCorners, const glm::mat4& lightView) const;
-
-	glm::mat4 m_view{ 1.0f };
-	float     m_fov = 0.0f;
-	float     m_aspectRatio = 1.0f;
-
-	glm::vec3 m_lightDir{};
-
-	std::array<glm::vec4, 8> m_worldCorners{};
-};
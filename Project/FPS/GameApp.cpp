@@ -13,6 +13,7 @@ std::string currentMap;
 
 bool slowMotion = false;
 bool showTriggers = false;
+bool showDrawStats = false;
 bool prevR = false;
 
 // recreated per map
@@ -104,6 +105,7 @@ void GameApp::Update()
 
 	slowMotion = glfwGetKey(Window::GetWindow(), GLFW_KEY_TAB);
 	showTriggers = glfwGetKey(Window::GetWindow(), GLFW_KEY_CAPS_LOCK);
+	showDrawStats = glfwGetKey(Window::GetWindow(), GLFW_KEY_F3);
 
 	lua->Update(deltatime);
 
@@ -1,6 +1,7 @@
 ﻿#include "GameHUD.h"
 
 extern std::unique_ptr<PbrRenderer> renderer;
+extern bool showDrawStats;
 
 GameHUD::GameHUD()
 {
@@ -63,4 +64,21 @@ void GameHUD::Draw()
 		{ 48.0f, screenExtent.y - 48.0f - m_textRenderer->GetCharSize().y },
 		{ 1.0f, 1.0f, 1.0f, 1.0f }
 	);
+
+	if (showDrawStats)
+	{
+		// stats of the last finished frame, the current one is built in FinishDrawing
+		const char* passNames[] = { "deferred", "forward" };
+		for (size_t pass = 0; pass < static_cast<size_t>(DrawPass::Count); pass++)
+		{
+			const DrawListStats& stats = renderer->GetDrawStats(static_cast<DrawPass>(pass));
+			m_textRenderer->DrawText(
+				std::string(passNames[pass]) + ": " + std::to_string(stats.Submitted) + " draws, "
+				+ std::to_string(stats.Culled) + " culled, " + std::to_string(stats.PipelineChanges) + " pipelines, "
+				+ std::to_string(stats.MaterialChanges) + " materials, " + std::to_string(stats.MeshChanges) + " meshes",
+				{ 48.0f, 48.0f + static_cast<float>(pass) * m_textRenderer->GetCharSize().y },
+				{ 1.0f, 1.0f, 0.5f, 1.0f }
+			);
+		}
+	}
 }
\ No newline at end of file
@@ -16,8 +16,7 @@ GameLua::GameLua()
 		});
 
 	SetGlobalFunction("signal", [](lua_State* L) {
-		const std::string name = luaL_checkstring(L, 1);
-		Actor* actor = scene->FindActorWithName(name);
+		Actor* actor = scene->FindActorWithName(luaL_checkstring(L, 1));
 		if (actor != nullptr) actor->LuaSignal(L);
 		return 0;
 		});
@@ -25,10 +24,24 @@ GameLua::GameLua()
 	SetGlobalFunction("delay", [](lua_State* L) {
 		const auto delay = static_cast<float>(luaL_checknumber(L, 1));
 		luaL_checktype(L, 2, LUA_TFUNCTION);
-		const int function = lua->CreateReference();
-		// using another vector because we might want to queue another delayed function when executing delayed functions and we don't want to add items when iterating the vector
-		lua->m_queuedDelayedLuaFunctions.emplace_back(delay, function);
-		return 0;
+		lua_settop(L, 2);
+		lua_pushinteger(L, lua->ScheduleTimer(delay, 0.0f));
+		return 1;
+		});
+
+	SetGlobalFunction("repeatDelay", [](lua_State* L) {
+		const auto interval = static_cast<float>(luaL_checknumber(L, 1));
+		luaL_argcheck(L, interval > 0.0f, 1, "interval must be above zero");
+		luaL_checktype(L, 2, LUA_TFUNCTION);
+		lua_settop(L, 2);
+		lua_pushinteger(L, lua->ScheduleTimer(interval, interval));
+		return 1;
+		});
+
+	SetGlobalFunction("cancelDelay", [](lua_State* L) {
+		const lua_Integer handle = luaL_checkinteger(L, 1);
+		lua_pushboolean(L, handle > 0 && handle <= UINT32_MAX && lua->CancelTimer(static_cast<uint32_t>(handle)));
+		return 1;
 		});
 
 	SetGlobalFunction("playAudio", [](lua_State* L) {
@@ -76,20 +89,79 @@ GameLua::GameLua()
 
 void GameLua::Update(float deltaTime)
 {
-	std::vector<std::tuple<float, int>> delayedLuaFunctions = std::move(m_queuedDelayedLuaFunctions);
-	for (auto [delay, function] : m_delayedLuaFunctions)
+	m_time += deltaTime;
+
+	m_runningTimers = true;
+	while (!m_dueTimers.empty() && m_dueTimers.front().Time <= m_time)
 	{
-		delay -= deltaTime;
-		if (delay <= 0.0f)
+		std::pop_heap(m_dueTimers.begin(), m_dueTimers.end(), std::greater<>{});
+		const DueTimer dueTimer = m_dueTimers.back();
+		m_dueTimers.pop_back();
+
+		const auto it = m_timers.find(dueTimer.Handle);
+		if (it == m_timers.end())
 		{
-			PushReference(function);
-			PCall(0, 0);
-			FreeReference(function);
+			m_cancelledDueTimers--;
+			continue;
 		}
+
+		const Timer timer = it->second;
+		if (timer.Interval <= 0.0f)
+			m_timers.erase(it);
+
+		// the callback may schedule or cancel timers, including its own, so it is looked up again afterwards
+		PushReference(timer.Function);
+		PCall(0, 0);
+
+		if (timer.Interval <= 0.0f)
+			FreeReference(timer.Function);
+		else if (m_timers.contains(dueTimer.Handle))
+			m_pendingTimers.push_back({ dueTimer.Time + timer.Interval, dueTimer.Handle });
 		else
-		{
-			delayedLuaFunctions.emplace_back(delay, function);
-		}
+			m_cancelledDueTimers--; // cancelled itself, its entry is already off the heap
 	}
-	m_delayedLuaFunctions = std::move(delayedLuaFunctions);
-}
\ No newline at end of file
+	m_runningTimers = false;
+
+	for (const DueTimer& dueTimer : m_pendingTimers)
+		pushDueTimer(dueTimer);
+	m_pendingTimers.clear();
+}
+
+uint32_t GameLua::ScheduleTimer(float delay, float interval)
+{
+	const uint32_t handle = m_nextTimerHandle++;
+	m_timers.emplace(handle, Timer{ CreateReference(), std::max(interval, 0.0f) });
+
+	const DueTimer dueTimer{ m_time + std::max(delay, 0.0f), handle };
+	if (m_runningTimers)
+		m_pendingTimers.push_back(dueTimer);
+	else
+		pushDueTimer(dueTimer);
+	return handle;
+}
+
+bool GameLua::CancelTimer(uint32_t handle)
+{
+	const auto it = m_timers.find(handle);
+	if (it == m_timers.end())
+		return false;
+
+	FreeReference(it->second.Function);
+	m_timers.erase(it);
+	m_cancelledDueTimers++;
+
+	// drop the skipped entries once they make up most of the heap, so cancelling many timers doesn't grow it forever
+	if (!m_runningTimers && m_cancelledDueTimers > 64 && m_cancelledDueTimers > m_dueTimers.size() / 2)
+	{
+		std::erase_if(m_dueTimers, [this](const DueTimer& dueTimer) { return !m_timers.contains(dueTimer.Handle); });
+		std::make_heap(m_dueTimers.begin(), m_dueTimers.end(), std::greater<>{});
+		m_cancelledDueTimers = 0;
+	}
+	return true;
+}
+
+void GameLua::pushDueTimer(const DueTimer& dueTimer)
+{
+	m_dueTimers.push_back(dueTimer);
+	std::push_heap(m_dueTimers.begin(), m_dueTimers.end(), std::greater<>{});
+}
@@ -14,7 +14,36 @@ public:
 
 	void Update(float deltaTime);
 
+	// Calls the function on top of the stack after delay seconds, and then every interval seconds if interval is above zero.
+	// Returns the handle to cancel it with. Timers scheduled while timers are run are first due in the next Update.
+	uint32_t ScheduleTimer(float delay, float interval);
+	// False if the timer already ran out or was cancelled
+	bool CancelTimer(uint32_t handle);
+
 private:
-	std::vector<std::tuple<float, int>> m_delayedLuaFunctions;
-	std::vector<std::tuple<float, int>> m_queuedDelayedLuaFunctions;
+	struct Timer final
+	{
+		int   Function; // Lua reference
+		float Interval; // Zero for one-shot timers
+	};
+
+	// Timers are kept in a min-heap by due time, cancelled timers are only erased from m_timers
+	// and their heap entries skipped when they come up, so Update only touches the timers that are due.
+	struct DueTimer final
+	{
+		double   Time;
+		uint32_t Handle; // Handles grow, so timers due at the same time run in the order they were scheduled
+
+		bool operator>(const DueTimer& other) const { return Time != other.Time ? Time > other.Time : Handle > other.Handle; }
+	};
+
+	void pushDueTimer(const DueTimer& dueTimer);
+
+	double                              m_time = 0.0;
+	uint32_t                            m_nextTimerHandle = 1;
+	std::unordered_map<uint32_t, Timer> m_timers;
+	std::vector<DueTimer>               m_dueTimers;     // Min-heap
+	std::vector<DueTimer>               m_pendingTimers; // Scheduled while running timers
+	size_t                              m_cancelledDueTimers = 0; // Entries in m_dueTimers without a timer
+	bool                                m_runningTimers = false;
 };
\ No newline at end of file
@@ -42,12 +42,12 @@ void LoadInfoPlayerStart(const MapData::Entity& entity)
 
 void LoadFuncBrush(const MapData::Entity& entity)
 {
-	scene->CreateActor<AFuncBrush>(entity.Brushes);
+	scene->CreateActor<AFuncBrush>(entity.Brushes, BrushType::Normal, PHYSICS_LAYER_0, false);
 }
 
 void LoadFuncGroup(const MapData::Entity& entity)
 {
-	scene->CreateActor<AFuncBrush>(entity.Brushes);
+	scene->CreateActor<AFuncBrush>(entity.Brushes, BrushType::Normal, PHYSICS_LAYER_0, false);
 }
 
 void LoadFuncMove(const MapData::Entity& entity)
@@ -167,7 +167,7 @@ void LoadEntities(const std::string& mapFilename)
 
 typedef void (*EntityLoader)(const MapData::Entity& entity);
 
-static const std::map<std::string, EntityLoader> s_EntityLoaders
+static const std::map<std::string, EntityLoader, std::less<>> s_EntityLoaders
 {
 	{"worldspawn",        LoadWorldSpawn     },
 	{"info_player_start", LoadInfoPlayerStart},
@@ -185,13 +185,13 @@ static const std::map<std::string, EntityLoader> s_EntityLoaders
 
 void LoadEntity(const MapData::Entity& entity)
 {
-	std::string className;
-	if(!entity.GetPropertyString("classname", className))
+	const std::string_view className = entity.GetProperty("classname");
+	if(className.empty())
 		Fatal("Entity doesn't have a class!");
 
 	auto loader = s_EntityLoaders.find(className);
 	if(loader == s_EntityLoaders.end())
-		Fatal("Unknown entity type: " + className);
+		Fatal("Unknown entity type: " + std::string(className));
 
 	loader->second(entity);
 #if defined(_DEBUG)
@@ -201,10 +201,29 @@ void LoadEntity(const MapData::Entity& entity)
 
 void LoadEntities(const MapData::Map& map)
 {
+	const Clock clock;
+	Brushes::BeginMapLoad();
 	for (const MapData::Entity& entity : map.Entities)
 	{
 		LoadEntity(entity);
 	}
+	Brushes::EndMapLoad();
+	Print("Loaded " + std::to_string(map.Entities.size()) + " entities in " + std::to_string(clock.GetElapsedTime().AsMilliseconds()) + " ms");
+
+	const BrushMeshCompilerStats& meshStats = Brushes::GetMeshStats();
+	Print("Brush meshes: " + std::to_string(meshStats.OutputTriangles) + "/" + std::to_string(meshStats.InputTriangles) + " triangles ("
+		+ std::to_string(meshStats.HiddenFaces) + " hidden faces), "
+		+ std::to_string(meshStats.OutputVertices) + "/" + std::to_string(meshStats.InputVertices) + " vertices, "
+		+ std::to_string(meshStats.Meshes) + " meshes for " + std::to_string(meshStats.Materials) + " entity materials");
+
+	const BrushColliderStats& colliderStats = Brushes::GetColliderStats();
+	Print("Brush colliders: " + std::to_string(colliderStats.CookedMeshes) + " cooked, " + std::to_string(colliderStats.ReusedMeshes) + " reused for "
+		+ std::to_string(colliderStats.Brushes) + " brushes in " + std::to_string(colliderStats.CookTime.AsMilliseconds()) + " ms, "
+		+ std::to_string(colliderStats.Actors) + " actors, " + std::to_string(colliderStats.BroadphaseEntries) + " broadphase entries");
+
+	const LuaChunkCacheStats& luaStats = LuaSandbox::GetChunkCacheStats();
+	Print("Lua chunks so far: " + std::to_string(luaStats.Hits) + " cached, " + std::to_string(luaStats.Misses) + " compiled, "
+		+ std::to_string(luaStats.Rejected) + " rejected, loaded in " + std::to_string(luaStats.LoadTime.AsMicroseconds()) + " us");
 }
 
 #pragma endregion
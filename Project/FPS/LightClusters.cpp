@@ -0,0 +1,173 @@
+#include "Base.h"
+#include "Core.h"
+#include "LightClusters.h"
+
+#pragma region LightClusterBuilder
+
+void LightClusterBuilder::SetCamera(const glm::mat4& view, float fovY, float aspectRatio, float near, float far)
+{
+	const float tanHalfFovY = glm::tan(fovY * 0.5f);
+	const float logDepthRange = glm::log(far / near);
+
+	m_view = view;
+	m_ndcScale = { 1.0f / (tanHalfFovY * aspectRatio), 1.0f / tanHalfFovY };
+	m_near = near;
+	m_far = far;
+
+	// slice = log(z) * scale + bias, the same formula is used in uniform_lighting.glsl
+	const float sliceScale = static_cast<float>(GRID_SIZE_Z) / logDepthRange;
+	const float sliceBias = -static_cast<float>(GRID_SIZE_Z) * glm::log(near) / logDepthRange;
+	m_clusterParams = { m_ndcScale.x, m_ndcScale.y, sliceScale, sliceBias };
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		m_sidePlaneNormals[axis] = glm::normalize(glm::vec2(m_ndcScale[axis], 1.0f));
+	}
+
+	for (uint32_t slice = 0; slice <= GRID_SIZE_Z; slice++)
+	{
+		m_sliceDepths[slice] = near * glm::pow(far / near, static_cast<float>(slice) / static_cast<float>(GRID_SIZE_Z));
+	}
+}
+
+uint32_t LightClusterBuilder::GetSlice(float viewDepth) const
+{
+	const float slice = glm::log(glm::max(viewDepth, m_near)) * m_clusterParams.z + m_clusterParams.w;
+	return static_cast<uint32_t>(glm::clamp(static_cast<int>(slice), 0, static_cast<int>(GRID_SIZE_Z) - 1));
+}
+
+bool LightClusterBuilder::IsInsideSidePlanes(const glm::vec3& viewPosition, float radius) const
+{
+	// the left/right and bottom/top planes are mirrored, so one normal per axis tests both with |x| and |y|
+	for (int axis = 0; axis < 2; axis++)
+	{
+		const glm::vec2& normal = m_sidePlaneNormals[axis];
+		if (glm::abs(viewPosition[axis]) * normal.x - viewPosition.z * normal.y > radius)
+			return false;
+	}
+	return true;
+}
+
+template <typename Visitor>
+void LightClusterBuilder::ForEachCluster(const LightBounds& bounds, Visitor&& visitor) const
+{
+	const glm::vec3& center = bounds.ViewPosition;
+	const float radius = bounds.Radius;
+
+	for (uint32_t slice = bounds.MinSlice; slice <= bounds.MaxSlice; slice++)
+	{
+		const float zMin = glm::max(m_sliceDepths[slice], center.z - radius);
+		const float zMax = glm::min(m_sliceDepths[slice + 1], center.z + radius);
+
+		// widest cross-section of the sphere inside this slice
+		const float zDistance = center.z < zMin ? zMin - center.z : (center.z > zMax ? center.z - zMax : 0.0f);
+		const float sliceRadius = glm::sqrt(glm::max(radius * radius - zDistance * zDistance, 0.0f));
+
+		// conservative NDC rectangle of the cross-section box over [zMin, zMax]
+		const glm::vec2 boxMin = glm::vec2(center) - sliceRadius;
+		const glm::vec2 boxMax = glm::vec2(center) + sliceRadius;
+		glm::vec2 ndcMin, ndcMax;
+		for (int axis = 0; axis < 2; axis++)
+		{
+			ndcMin[axis] = (boxMin[axis] >= 0.0f ? boxMin[axis] / zMax : boxMin[axis] / zMin) * m_ndcScale[axis];
+			ndcMax[axis] = (boxMax[axis] >= 0.0f ? boxMax[axis] / zMin : boxMax[axis] / zMax) * m_ndcScale[axis];
+		}
+		if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+			continue;
+
+		const glm::vec2 gridSize(GRID_SIZE_X, GRID_SIZE_Y);
+		const glm::ivec2 gridMax(GRID_SIZE_X - 1, GRID_SIZE_Y - 1);
+		const glm::ivec2 tileMin = glm::clamp(glm::ivec2(glm::floor((ndcMin * 0.5f + 0.5f) * gridSize)), glm::ivec2(0), gridMax);
+		const glm::ivec2 tileMax = glm::clamp(glm::ivec2(glm::floor((ndcMax * 0.5f + 0.5f) * gridSize)), glm::ivec2(0), gridMax);
+
+		const uint32_t sliceOffset = slice * GRID_SIZE_X * GRID_SIZE_Y;
+		for (int y = tileMin.y; y <= tileMax.y; y++)
+		{
+			for (int x = tileMin.x; x <= tileMax.x; x++)
+			{
+				visitor(sliceOffset + static_cast<uint32_t>(x + y * GRID_SIZE_X));
+			}
+		}
+	}
+}
+
+void LightClusterBuilder::Build(std::span<const PointLightData> lights)
+{
+	const Clock clock;
+
+	m_lights.clear();
+	m_lightBounds.clear();
+	m_overlaps.clear();
+	m_clusters.assign(CLUSTER_COUNT, { 0, 0 });
+	m_clusterFill.assign(CLUSTER_COUNT, 0);
+	m_droppedLightCount = 0;
+	m_droppedIndexCount = 0;
+
+	// keep only lights that reach the view frustum, the light indices refer to this compact array
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		if (m_lights.size() == MAX_POINT_LIGHTS)
+		{
+			m_droppedLightCount = static_cast<uint32_t>(lights.size() - i);
+			break;
+		}
+
+		const PointLightData& light = lights[i];
+		const glm::vec3 viewPosition = m_view * glm::vec4(light.Position, 1.0f);
+		if (viewPosition.z + light.Radius < m_near || viewPosition.z - light.Radius > m_far)
+			continue;
+		if (!IsInsideSidePlanes(viewPosition, light.Radius))
+			continue;
+
+		const uint32_t minSlice = GetSlice(glm::max(viewPosition.z - light.Radius, m_near));
+		const uint32_t maxSlice = GetSlice(glm::min(viewPosition.z + light.Radius, m_far));
+		m_lightBounds.push_back({ viewPosition, light.Radius, minSlice, maxSlice });
+		m_lights.push_back(light);
+	}
+
+	// first pass records every (cluster, light) overlap and counts the lights of every cluster,
+	// so the index list can be laid out without per-cluster allocations
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_lightBounds.size()); i++)
+	{
+		ForEachCluster(m_lightBounds[i], [&](uint32_t cluster)
+			{
+				m_clusters[cluster].Count++;
+				m_overlaps.push_back({ cluster, i });
+			});
+	}
+
+	uint32_t offset = 0;
+	for (LightClusterRecord& cluster : m_clusters)
+	{
+		const uint32_t count = glm::min(cluster.Count, MAX_LIGHT_INDICES - offset);
+		m_droppedIndexCount += cluster.Count - count;
+		cluster.Offset = offset;
+		cluster.Count = count;
+		offset += count;
+	}
+	m_lightIndices.resize(offset);
+
+	// second pass scatters the overlaps, lights stay in submission order inside a cluster
+	for (const LightOverlap& overlap : m_overlaps)
+	{
+		const LightClusterRecord& record = m_clusters[overlap.Cluster];
+		uint32_t& fill = m_clusterFill[overlap.Cluster];
+		if (fill < record.Count)
+			m_lightIndices[record.Offset + fill++] = overlap.Light;
+	}
+
+	m_buildTime = clock.GetElapsedTime();
+}
+
+uint32_t LightClusterBuilder::GetClusterIndex(const glm::vec3& viewPosition) const
+{
+	const glm::vec2 ndc = glm::vec2(viewPosition) / glm::max(viewPosition.z, m_near) * m_ndcScale;
+	const glm::uvec2 tile = glm::clamp(
+		glm::ivec2(glm::floor((ndc * 0.5f + 0.5f) * glm::vec2(GRID_SIZE_X, GRID_SIZE_Y))),
+		glm::ivec2(0),
+		glm::ivec2(GRID_SIZE_X - 1, GRID_SIZE_Y - 1)
+	);
+	return tile.x + tile.y * GRID_SIZE_X + GetSlice(viewPosition.z) * GRID_SIZE_X * GRID_SIZE_Y;
+}
+
+#pragma endregion
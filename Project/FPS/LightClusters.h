@@ -0,0 +1,99 @@
+#pragma once
+
+#pragma region LightClusterBuilder
+
+struct alignas(16) PointLightData final
+{
+	glm::vec3              Position;
+	[[maybe_unused]] float Radius;
+	glm::vec3              Color;
+	[[maybe_unused]] float Padding;
+
+	PointLightData() = default;
+	PointLightData(const glm::vec3& position, float radius, const glm::vec3& color)
+		: Position(position)
+		, Radius(radius)
+		, Color(color)
+		, Padding(0.0f) {}
+};
+
+// Range of the light index list used by one cluster, uvec2 in the shaders.
+struct LightClusterRecord final
+{
+	uint32_t Offset;
+	uint32_t Count;
+};
+
+// Bins point lights into a view space froxel grid: GRID_SIZE_X * GRID_SIZE_Y screen tiles and GRID_SIZE_Z exponential depth slices.
+// The output is a compact light array, one record per cluster and one light index list shared by all clusters.
+// Has no GPU dependencies, so it can be run on its own.
+class LightClusterBuilder final
+{
+public:
+	static constexpr uint32_t GRID_SIZE_X = 16;
+	static constexpr uint32_t GRID_SIZE_Y = 9;
+	static constexpr uint32_t GRID_SIZE_Z = 24;
+	static constexpr uint32_t CLUSTER_COUNT = GRID_SIZE_X * GRID_SIZE_Y * GRID_SIZE_Z;
+	static constexpr uint32_t MAX_POINT_LIGHTS = 4096;
+	static constexpr uint32_t MAX_LIGHT_INDICES = 64 * 1024;
+
+	void SetCamera(const glm::mat4& view, float fovY, float aspectRatio, float near, float far);
+
+	void Build(std::span<const PointLightData> lights);
+
+	[[nodiscard]] const std::vector<PointLightData>& GetLights() const { return m_lights; }
+	[[nodiscard]] const std::vector<LightClusterRecord>& GetClusters() const { return m_clusters; }
+	[[nodiscard]] const std::vector<uint32_t>& GetLightIndices() const { return m_lightIndices; }
+
+	// x, y: view space xy / z to NDC scale, z, w: scale and bias of the depth slice from log(view z)
+	[[nodiscard]] const glm::vec4& GetClusterParams() const { return m_clusterParams; }
+
+	[[nodiscard]] uint32_t GetClusterIndex(const glm::vec3& viewPosition) const;
+
+	[[nodiscard]] Time GetBuildTime() const { return m_buildTime; }
+	[[nodiscard]] uint32_t GetDroppedLightCount() const { return m_droppedLightCount; }
+	[[nodiscard]] uint32_t GetDroppedIndexCount() const { return m_droppedIndexCount; }
+
+private:
+	struct LightBounds final
+	{
+		glm::vec3 ViewPosition;
+		float     Radius;
+		uint32_t  MinSlice;
+		uint32_t  MaxSlice;
+	};
+
+	struct LightOverlap final
+	{
+		uint32_t Cluster;
+		uint32_t Light;
+	};
+
+	[[nodiscard]] uint32_t GetSlice(float viewDepth) const;
+	[[nodiscard]] bool IsInsideSidePlanes(const glm::vec3& viewPosition, float radius) const;
+
+	template <typename Visitor>
+	void ForEachCluster(const LightBounds& bounds, Visitor&& visitor) const;
+
+	glm::mat4 m_view{ 1.0f };
+	glm::vec2 m_ndcScale{ 1.0f };
+	float     m_near = 0.1f;
+	float     m_far = 100.0f;
+	glm::vec4 m_clusterParams{ 0.0f };
+	glm::vec2 m_sidePlaneNormals[2]{}; // (xy, z) of the right and top frustum planes in view space
+
+	std::array<float, GRID_SIZE_Z + 1> m_sliceDepths{}; // View depth of the near plane of every slice, the last one is the far plane
+
+	std::vector<PointLightData>     m_lights;
+	std::vector<LightClusterRecord> m_clusters;
+	std::vector<uint32_t>           m_lightIndices;
+	std::vector<LightBounds>        m_lightBounds;
+	std::vector<LightOverlap>       m_overlaps;
+	std::vector<uint32_t>           m_clusterFill;
+
+	Time     m_buildTime;
+	uint32_t m_droppedLightCount = 0;
+	uint32_t m_droppedIndexCount = 0;
+};
+
+#pragma endregion
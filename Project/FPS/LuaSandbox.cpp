@@ -2,12 +2,17 @@
 #include "Core.h"
 #include "LuaSandbox.h"
 
+std::string                               LuaSandbox::s_chunkCacheDir = "LuaCache/";
+std::unordered_map<uint64_t, std::string> LuaSandbox::s_chunkCache;
+LuaChunkCacheStats                        LuaSandbox::s_chunkCacheStats;
+
 int LuaPackageSearcher(lua_State* L) noexcept
 {
 	const std::string path = luaL_checkstring(L, 1);
-	Print("Loading Lua package: " + path);
 	const std::string source = FileSystem::Read(path);
-	luaL_loadbuffer(L, source.data(), source.size(), path.c_str());
+	bool fromCache = false;
+	LuaSandbox::LoadChunk(L, source, path, &fromCache);
+	Print("Loading Lua package: " + path + (fromCache ? " (cached)" : ""));
 	return 1;
 }
 
@@ -37,6 +42,124 @@ LuaSandbox::~LuaSandbox()
 	lua_close(m_luaState);
 }
 
+static uint64_t GetChunkKey(const std::string& source, const std::string& name)
+{
+	// hash of the name and the source, the Lua version and number sizes decide the bytecode format
+	const uint32_t format[] = { LUA_VERSION_RELEASE_NUM, sizeof(lua_Integer), sizeof(lua_Number), sizeof(void*) };
+	uint64_t hash = HashBytes(format, sizeof(format));
+	hash = HashBytes(name.c_str(), name.size() + 1, hash);
+	return HashBytes(source.data(), source.size(), hash);
+}
+
+static std::string GetChunkCacheFilename(const std::string& dir, uint64_t key)
+{
+	char hex[16];
+	const auto [end, error] = std::to_chars(std::begin(hex), std::end(hex), key, 16);
+	return dir + std::string(std::begin(hex), end) + ".luac";
+}
+
+static bool LoadChunkFile(const std::string& filename, std::string& bytecode)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	const std::streamsize size = file.tellg();
+	// a precompiled chunk starts with LUA_SIGNATURE
+	if (size < static_cast<std::streamsize>(sizeof(LUA_SIGNATURE)))
+		return false;
+
+	bytecode.resize(static_cast<size_t>(size));
+	file.seekg(0);
+	if (!file.read(bytecode.data(), size) || !bytecode.starts_with(LUA_SIGNATURE))
+	{
+		bytecode.clear();
+		return false;
+	}
+	return true;
+}
+
+static void SaveChunkFile(const std::string& dir, const std::string& filename, const std::string& bytecode)
+{
+	std::error_code error;
+	std::filesystem::create_directories(dir, error);
+	if (error)
+	{
+		Warning("Can't create Lua cache directory " + dir + ": " + error.message());
+		return;
+	}
+
+	// written next to the cache file and renamed, so a crash never leaves half a file behind
+	const std::string tempFilename = filename + ".tmp";
+	{
+		std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+		if (!file.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size())))
+		{
+			Warning("Failed to write Lua cache file " + tempFilename);
+			return;
+		}
+	}
+
+	std::filesystem::rename(tempFilename, filename, error);
+	if (error)
+		Warning("Failed to write Lua cache file " + filename + ": " + error.message());
+}
+
+static int LuaChunkWriter(lua_State*, const void* data, size_t size, void* userData) noexcept
+{
+	static_cast<std::string*>(userData)->append(static_cast<const char*>(data), size);
+	return 0;
+}
+
+int LuaSandbox::LoadChunk(lua_State* L, const std::string& source, const std::string& name, bool* fromCache)
+{
+	const Clock clock;
+	const uint64_t key = GetChunkKey(source, name);
+	const std::string cacheFilename = s_chunkCacheDir.empty() ? std::string() : GetChunkCacheFilename(s_chunkCacheDir, key);
+
+	auto it = s_chunkCache.find(key);
+	if (it == s_chunkCache.end() && !cacheFilename.empty())
+	{
+		std::string bytecode;
+		if (LoadChunkFile(cacheFilename, bytecode))
+			it = s_chunkCache.emplace(key, std::move(bytecode)).first;
+	}
+
+	if (it != s_chunkCache.end())
+	{
+		if (luaL_loadbufferx(L, it->second.data(), it->second.size(), name.c_str(), "b") == LUA_OK)
+		{
+			s_chunkCacheStats.Hits++;
+			s_chunkCacheStats.LoadTime = s_chunkCacheStats.LoadTime.ToDuration() + clock.GetElapsedTime().ToDuration();
+			if (fromCache)
+				*fromCache = true;
+			return LUA_OK;
+		}
+		Warning("Cached bytecode of Lua script " + name + " is invalid: " + std::string(lua_tostring(L, -1)));
+		lua_pop(L, 1);
+		s_chunkCache.erase(it);
+		s_chunkCacheStats.Rejected++;
+	}
+
+	if (fromCache)
+		*fromCache = false;
+	const int result = luaL_loadbuffer(L, source.data(), source.size(), name.c_str());
+	if (result == LUA_OK && !source.starts_with(LUA_SIGNATURE))
+	{
+		// debug info is kept, so errors in cached scripts still report lines
+		std::string bytecode;
+		if (lua_dump(L, LuaChunkWriter, &bytecode, 0) == 0)
+		{
+			if (!cacheFilename.empty())
+				SaveChunkFile(s_chunkCacheDir, cacheFilename, bytecode);
+			s_chunkCache.emplace(key, std::move(bytecode));
+		}
+	}
+	s_chunkCacheStats.Misses++;
+	s_chunkCacheStats.LoadTime = s_chunkCacheStats.LoadTime.ToDuration() + clock.GetElapsedTime().ToDuration();
+	return result;
+}
+
 void LuaSandbox::setupPackageSearcher()
 {
 	//
@@ -126,15 +249,16 @@ void LuaSandbox::CallGlobalFunction(const std::string& name, const std::string&
 
 void LuaSandbox::DoSource(const std::string& source, const std::string& name)
 {
-	Print("Executing Lua script " + name);
-
-	if (luaL_loadbuffer(m_luaState, source.data(), source.size(), name.c_str()) != LUA_OK)
+	bool fromCache = false;
+	if (LoadChunk(m_luaState, source, name, &fromCache) != LUA_OK)
 	{
 		Error("Failed to load Lua script: " + std::string(lua_tostring(m_luaState, -1)));
 		lua_pop(m_luaState, 1);
 		return;
 	}
 
+	Print("Executing Lua script " + name + (fromCache ? " (cached)" : ""));
+
 	PCall(0, 0);
 }
 
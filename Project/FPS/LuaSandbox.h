@@ -1,5 +1,13 @@
 #pragma once
 
+struct LuaChunkCacheStats final
+{
+	uint32_t Hits = 0;     // Chunks loaded from cached bytecode
+	uint32_t Misses = 0;   // Chunks compiled from source
+	uint32_t Rejected = 0; // Cached bytecode Lua refused to load, compiled from source instead
+	Time     LoadTime;
+};
+
 class LuaSandbox
 {
 public:
@@ -31,8 +39,22 @@ public:
 
 	void PCall(int nArgs, int nResults);
 
+	// Like luaL_loadbuffer, but loads the bytecode the same source and name were compiled to before, if there is any.
+	// Bytecode is kept in memory for the whole run and in the chunk cache directory between runs, keyed by a hash
+	// of the source, the name and the Lua version. Bytecode Lua doesn't accept is replaced by compiling the source.
+	// Lua doesn't verify bytecode, the cache is only ever written by the game itself and never read from game data.
+	static int LoadChunk(lua_State* L, const std::string& source, const std::string& name, bool* fromCache = nullptr);
+
+	// Real directory the bytecode is cached in between runs, empty keeps it in memory only
+	static void SetChunkCacheDir(const std::string& dir) { s_chunkCacheDir = dir; }
+	[[nodiscard]] static const LuaChunkCacheStats& GetChunkCacheStats() { return s_chunkCacheStats; }
+
 private:
 	void setupPackageSearcher();
 
 	lua_State* m_luaState = nullptr;
+
+	static std::string                               s_chunkCacheDir;
+	static std::unordered_map<uint64_t, std::string> s_chunkCache; // Bytecode by key
+	static LuaChunkCacheStats                        s_chunkCacheStats;
 };
\ No newline at end of file
@@ -8,48 +8,55 @@ extern std::unique_ptr<PhysicsScene> physicsScene;
 
 #pragma region MapData
 
-bool MapData::Entity::GetPropertyString(const std::string& key, std::string& value) const
+// Parses one number and moves the literal past it, leading spaces are skipped like stream extraction does.
+template<class T>
+static bool parseNumber(std::string_view& literal, T& value)
 {
-	value = getProperty(key);
-	return !value.empty();
-}
-
-bool MapData::Entity::GetPropertyInteger(const std::string& key, int& value) const
-{
-	const std::string& literal = getProperty(key);
-	if (literal.empty()) return false;
-
-	std::stringstream literalStream(literal);
+	while (!literal.empty() && std::isspace(static_cast<unsigned char>(literal.front())))
+		literal.remove_prefix(1);
 
-	int x;
-	literalStream >> x;
-	if (literalStream.bad()) return false;
+	const auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+	if (error != std::errc())
+		return false;
 
-	value = x;
+	literal.remove_prefix(static_cast<size_t>(end - literal.data()));
 	return true;
 }
 
-bool MapData::Entity::GetPropertyFloat(const std::string& key, float& value) const
+std::string_view MapData::Entity::GetProperty(std::string_view key) const
 {
-	const std::string& literal = getProperty(key);
-	if (literal.empty()) return false;
+	// entities only have a handful of properties, the first one with the key wins
+	for (const Property& property : Properties)
+	{
+		if (property.Key == key) return property.Value;
+	}
+	return {};
+}
 
-	std::stringstream literalStream(literal);
+bool MapData::Entity::GetPropertyString(std::string_view key, std::string& value) const
+{
+	value = GetProperty(key);
+	return !value.empty();
+}
 
-	float x;
-	literalStream >> x;
-	if (literalStream.bad()) return false;
+bool MapData::Entity::GetPropertyInteger(std::string_view key, int& value) const
+{
+	std::string_view literal = GetProperty(key);
+	return !literal.empty() && parseNumber(literal, value);
+}
 
-	value = x;
-	return true;
+bool MapData::Entity::GetPropertyFloat(std::string_view key, float& value) const
+{
+	std::string_view literal = GetProperty(key);
+	return !literal.empty() && parseNumber(literal, value);
 }
 
-bool MapData::Entity::GetPropertyColor(const std::string& key, glm::vec3& value) const
+bool MapData::Entity::GetPropertyColor(std::string_view key, glm::vec3& value) const
 {
 	return getPropertyVec3(key, value);
 }
 
-bool MapData::Entity::GetPropertyVector(const std::string& key, glm::vec3& value) const
+bool MapData::Entity::GetPropertyVector(std::string_view key, glm::vec3& value) const
 {
 	if (!getPropertyVec3(key, value)) return false;
 	// convert from quake direction to engine direction
@@ -58,25 +65,16 @@ bool MapData::Entity::GetPropertyVector(const std::string& key, glm::vec3& value
 	return true;
 }
 
-const std::string& MapData::Entity::getProperty(const std::string& key, const std::string& fallback) const
-{
-	auto pair = Properties.find(key);
-	if (pair == Properties.end()) return fallback;
-	return pair->second;
-}
-
-bool MapData::Entity::getPropertyVec3(const std::string& key, glm::vec3& value) const
+bool MapData::Entity::getPropertyVec3(std::string_view key, glm::vec3& value) const
 {
-	const std::string& literal = getProperty(key);
+	std::string_view literal = GetProperty(key);
 	if (literal.empty()) return false;
 
-	std::stringstream literalStream(literal);
+	glm::vec3 vector;
+	if (!parseNumber(literal, vector.x) || !parseNumber(literal, vector.y) || !parseNumber(literal, vector.z))
+		return false;
 
-	float x, y, z;
-	literalStream >> x >> y >> z;
-	if (literalStream.bad()) return false;
-
-	value = { x, y, z };
+	value = vector;
 	return true;
 }
 
@@ -87,78 +85,399 @@ bool MapData::Entity::getPropertyVec3(const std::string& key, glm::vec3& value)
 MapParser::MapParser(const std::string& filename)
 	: BinaryParser(filename)
 {
-	parseMap(m_map);
+	parseMap<false>();
+
+	m_map.Entities.reserve(m_counts.Entities);
+	m_map.Properties.reserve(m_counts.Properties);
+	m_map.Brushes.reserve(m_counts.Brushes);
+	m_map.Faces.reserve(m_counts.Faces);
+	m_map.BrushVertices.reserve(m_counts.BrushVertices);
+	m_map.FaceVertices.reserve(m_counts.FaceVertices);
+
+	rewind();
+	parseMap<true>();
 }
 
-void MapParser::parseFace(MapData::Face& face)
+template<bool Fill>
+void MapParser::parseFace()
 {
-	if (!readShortString(face.Texture))
+	std::string_view texture;
+	if (!readShortString(texture))
 		Fatal("Failed to parse Face::texture.");
-	if (!readVec3(face.Normal))
+	glm::vec3 normal;
+	if (!readVec3(normal))
 		Fatal("Failed to parse Face::normal.");
-	if (!readVector(face.Vertices))
-		Fatal("Failed to parse Face::numVertices and Face::vertices.");
+
+	if constexpr (Fill)
+	{
+		const size_t firstVertex = m_map.FaceVertices.size();
+		if (!appendVector(m_map.FaceVertices))
+			Fatal("Failed to parse Face::numVertices and Face::vertices.");
+		m_map.Faces.push_back({ texture, normal, std::span(m_map.FaceVertices).subspan(firstVertex) });
+	}
+	else
+	{
+		uint16_t numVertices;
+		if (!skipVector<MapData::Vertex>(numVertices))
+			Fatal("Failed to parse Face::numVertices and Face::vertices.");
+		m_counts.FaceVertices += numVertices;
+		m_counts.Faces++;
+	}
 }
 
-void MapParser::parseBrush(MapData::Brush& brush)
+template<bool Fill>
+void MapParser::parseBrush()
 {
-	if (!readVector(brush.Vertices))
-		Fatal("Failed to parse Brush::numVertices and Brush::vertices.");
+	const size_t firstVertex = m_map.BrushVertices.size();
+	if constexpr (Fill)
+	{
+		if (!appendVector(m_map.BrushVertices))
+			Fatal("Failed to parse Brush::numVertices and Brush::vertices.");
+	}
+	else
+	{
+		uint16_t numVertices;
+		if (!skipVector<glm::vec3>(numVertices))
+			Fatal("Failed to parse Brush::numVertices and Brush::vertices.");
+		m_counts.BrushVertices += numVertices;
+		m_counts.Brushes++;
+	}
 
 	uint16_t numFaces;
 	if (!readU16(numFaces))
 		Fatal("Failed to parse Brush::numFaces.");
-	brush.Faces.resize(numFaces);
+	const size_t firstFace = m_map.Faces.size();
 	for (int i = 0; i < numFaces; i++)
 	{
-		parseFace(brush.Faces[i]);
+		parseFace<Fill>();
+	}
+
+	if constexpr (Fill)
+	{
+		m_map.Brushes.push_back({
+			std::span(m_map.BrushVertices).subspan(firstVertex),
+			std::span(m_map.Faces).subspan(firstFace)
+		});
 	}
 }
 
-void MapParser::parseEntity(MapData::Entity& entity)
+template<bool Fill>
+void MapParser::parseEntity()
 {
 	uint16_t numProperties;
 	if (!readU16(numProperties))
 		Fatal("Failed to parse Entity::numProperties.");
 
-	std::string key;
-	std::string value;
+	const size_t firstProperty = m_map.Properties.size();
 	for (int i = 0; i < numProperties; i++)
 	{
-		if (!readShortString(key))
+		MapData::Property property;
+		if (!readShortString(property.Key))
 			Fatal("Failed to parse KeyValue::key.");
-		if (!readShortString(value))
+		if (!readShortString(property.Value))
 			Fatal("Failed to parse KeyValue::value.");
-		entity.Properties.emplace(key, value);
+		if constexpr (Fill)
+			m_map.Properties.push_back(property);
 	}
 
 	uint16_t numBrushes;
 	if (!readU16(numBrushes))
 		Fatal("Failed to parse Entity::numBrushes.");
-	entity.Brushes.resize(numBrushes);
+	const size_t firstBrush = m_map.Brushes.size();
 	for (int i = 0; i < numBrushes; i++)
 	{
-		parseBrush(entity.Brushes[i]);
+		parseBrush<Fill>();
+	}
+
+	if constexpr (Fill)
+	{
+		MapData::Entity& entity = m_map.Entities.emplace_back();
+		entity.Properties = std::span(m_map.Properties).subspan(firstProperty);
+		entity.Brushes = std::span(m_map.Brushes).subspan(firstBrush);
+	}
+	else
+	{
+		m_counts.Properties += numProperties;
+		m_counts.Entities++;
 	}
 }
 
-void MapParser::parseMap(MapData::Map& map)
+template<bool Fill>
+void MapParser::parseMap()
 {
 	uint16_t numEntities;
 	if (!readU16(numEntities))
 		Fatal("Failed to parse Map::numEntities.");
-	map.Entities.resize(numEntities);
 	for (int i = 0; i < numEntities; i++)
 	{
-		parseEntity(map.Entities[i]);
+		parseEntity<Fill>();
+	}
+}
+
+#pragma endregion
+
+#pragma region BrushMeshCompiler
+
+BrushMeshCompilerStats& BrushMeshCompilerStats::operator+=(const BrushMeshCompilerStats& other)
+{
+	Faces += other.Faces;
+	HiddenFaces += other.HiddenFaces;
+	InputTriangles += other.InputTriangles;
+	OutputTriangles += other.OutputTriangles;
+	InputVertices += other.InputVertices;
+	OutputVertices += other.OutputVertices;
+	Materials += other.Materials;
+	Meshes += other.Meshes;
+	return *this;
+}
+
+size_t BrushMeshCompiler::KeyHash::operator()(const MeshKey& key) const
+{
+	return std::hash<std::string_view>{}(key.Texture) ^ (std::hash<glm::ivec3>{}(key.Cell) * 31);
+}
+
+size_t BrushMeshCompiler::KeyHash::operator()(const WeldKey& key) const
+{
+	size_t hash = std::hash<glm::ivec3>{}(key.Position);
+	hash = hash * 31 + std::hash<glm::ivec3>{}(key.Normal);
+	return hash * 31 + std::hash<glm::ivec2>{}(key.TexCoord);
+}
+
+void BrushMeshCompiler::Compile(std::span<const MapData::Brush> brushes, const glm::vec3& origin, const OccluderFunc& isOccluder)
+{
+	m_meshes.clear();
+	m_meshIndices.clear();
+	m_weldMaps.clear();
+	m_brushInfos.clear();
+	m_brushGrid.clear();
+	m_stats = {};
+
+	// cells start at the corner of the brush set, so anything smaller than a cell stays one mesh per material
+	m_gridOrigin = glm::vec3(std::numeric_limits<float>::max());
+	for (const MapData::Brush& brush : brushes)
+	{
+		for (const glm::vec3& vertex : brush.Vertices)
+			m_gridOrigin = glm::min(m_gridOrigin, vertex);
+	}
+	if (m_gridOrigin.x == std::numeric_limits<float>::max())
+		m_gridOrigin = glm::vec3(0.0f);
+
+	std::unordered_map<std::string_view, bool> occluderTextures;
+	const auto isOccluderTexture = [&](std::string_view texture) {
+		auto [pair, inserted] = occluderTextures.try_emplace(texture, true);
+		if (inserted)
+			pair->second = !isOccluder || isOccluder(texture);
+		return pair->second;
+	};
+
+	// a brush hides other faces only if none of its own faces can be seen through
+	for (uint32_t i = 0; i < static_cast<uint32_t>(brushes.size()); i++)
+	{
+		const MapData::Brush& brush = brushes[i];
+		BrushInfo info{ glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()), true };
+		for (const glm::vec3& vertex : brush.Vertices)
+		{
+			info.Min = glm::min(info.Min, vertex);
+			info.Max = glm::max(info.Max, vertex);
+		}
+		for (const MapData::Face& face : brush.Faces)
+			info.Occluder = info.Occluder && isOccluderTexture(face.Texture);
+		m_brushInfos.push_back(info);
+
+		if (!m_settings.RemoveHiddenFaces || !info.Occluder || brush.Vertices.empty())
+			continue;
+
+		const glm::ivec3 cellMin = getCell(info.Min);
+		const glm::ivec3 cellMax = getCell(info.Max);
+		for (int z = cellMin.z; z <= cellMax.z; z++)
+			for (int y = cellMin.y; y <= cellMax.y; y++)
+				for (int x = cellMin.x; x <= cellMax.x; x++)
+					m_brushGrid[{ x, y, z }].push_back(i);
+	}
+	m_brushVisits.assign(brushes.size(), 0);
+	m_faceVisit = 0;
+
+	occluderTextures.clear();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(brushes.size()); i++)
+	{
+		for (const MapData::Face& face : brushes[i].Faces)
+		{
+			if (face.Vertices.size() < 3)
+				continue;
+
+			const uint32_t numTriangles = static_cast<uint32_t>(face.Vertices.size() - 2);
+			m_stats.Faces++;
+			m_stats.InputTriangles += numTriangles;
+			if (occluderTextures.try_emplace(face.Texture, true).second)
+				m_stats.Materials++;
+
+			if (m_settings.RemoveHiddenFaces && isFaceHidden(brushes, i, face))
+			{
+				m_stats.HiddenFaces++;
+				continue;
+			}
+
+			glm::vec3 center(0.0f);
+			for (const MapData::Vertex& vertex : face.Vertices)
+				center += vertex.Position;
+			center /= static_cast<float>(face.Vertices.size());
+
+			const size_t meshIndex = getMesh(face.Texture, getCell(center));
+
+			m_faceIndices.clear();
+			for (const MapData::Vertex& vertex : face.Vertices)
+				m_faceIndices.push_back(addVertex(meshIndex, VertexBase(vertex.Position - origin, face.Normal, vertex.TexCoord)));
+
+			// triangulate
+			std::vector<uint32_t>& indices = m_meshes[meshIndex].Indices;
+			for (uint32_t k = 1; k <= numTriangles; k++)
+			{
+				indices.push_back(m_faceIndices[0]);
+				indices.push_back(m_faceIndices[k]);
+				indices.push_back(m_faceIndices[k + 1]);
+			}
+			m_stats.OutputTriangles += numTriangles;
+		}
+	}
+
+	for (const BrushMesh& mesh : m_meshes)
+		m_stats.OutputVertices += static_cast<uint32_t>(mesh.Vertices.size());
+	m_stats.InputVertices = m_stats.InputTriangles * 3;
+	m_stats.Meshes = static_cast<uint32_t>(m_meshes.size());
+
+	m_meshIndices.clear();
+	m_weldMaps.clear();
+}
+
+bool BrushMeshCompiler::isFaceHidden(std::span<const MapData::Brush> brushes, uint32_t brushIndex, const MapData::Face& face)
+{
+	static constexpr float EPSILON = 1.0f / 1024.0f;
+
+	glm::vec3 faceMin{ std::numeric_limits<float>::max() };
+	glm::vec3 faceMax{ std::numeric_limits<float>::lowest() };
+	for (const MapData::Vertex& vertex : face.Vertices)
+	{
+		faceMin = glm::min(faceMin, vertex.Position);
+		faceMax = glm::max(faceMax, vertex.Position);
+	}
+
+	// a brush is only tested once per face even if it is in several of the face's cells
+	m_faceVisit++;
+	const glm::ivec3 cellMin = getCell(faceMin - EPSILON);
+	const glm::ivec3 cellMax = getCell(faceMax + EPSILON);
+	for (int z = cellMin.z; z <= cellMax.z; z++)
+	for (int y = cellMin.y; y <= cellMax.y; y++)
+	for (int x = cellMin.x; x <= cellMax.x; x++)
+	{
+		const auto cell = m_brushGrid.find({ x, y, z });
+		if (cell == m_brushGrid.end())
+			continue;
+
+		for (const uint32_t otherIndex : cell->second)
+		{
+			if (otherIndex == brushIndex || m_brushVisits[otherIndex] == m_faceVisit)
+				continue;
+			m_brushVisits[otherIndex] = m_faceVisit;
+
+			const BrushInfo& other = m_brushInfos[otherIndex];
+			if (glm::any(glm::greaterThan(faceMin, other.Max + EPSILON)) || glm::any(glm::lessThan(faceMax, other.Min - EPSILON)))
+				continue;
+
+			// brushes are convex, the face is hidden if it is inside or on every plane of the other brush,
+			// unless it lies on a face of the other brush that points the same way (two flush surfaces)
+			bool hidden = true;
+			for (const MapData::Face& plane : brushes[otherIndex].Faces)
+			{
+				if (plane.Vertices.empty())
+					continue;
+
+				const float distance = glm::dot(plane.Normal, plane.Vertices[0].Position);
+				bool onPlane = true;
+				for (const MapData::Vertex& vertex : face.Vertices)
+				{
+					const float vertexDistance = glm::dot(plane.Normal, vertex.Position) - distance;
+					if (vertexDistance > EPSILON)
+					{
+						hidden = false;
+						break;
+					}
+					onPlane = onPlane && vertexDistance > -EPSILON;
+				}
+				if (!hidden || (onPlane && glm::dot(plane.Normal, face.Normal) > 0.0f))
+				{
+					hidden = false;
+					break;
+				}
+			}
+			if (hidden)
+				return true;
+		}
+	}
+	return false;
+}
+
+glm::ivec3 BrushMeshCompiler::getCell(const glm::vec3& position) const
+{
+	return glm::ivec3(glm::floor((position - m_gridOrigin) / m_settings.CellSize));
+}
+
+size_t BrushMeshCompiler::getMesh(std::string_view texture, const glm::ivec3& cell)
+{
+	const auto [pair, inserted] = m_meshIndices.try_emplace({ texture, cell }, m_meshes.size());
+	if (inserted)
+	{
+		m_meshes.push_back({ texture, {}, {} });
+		m_weldMaps.emplace_back();
 	}
+	return pair->second;
+}
+
+uint32_t BrushMeshCompiler::addVertex(size_t meshIndex, const VertexBase& vertex)
+{
+	std::vector<VertexBase>& vertices = m_meshes[meshIndex].Vertices;
+	if (!m_settings.WeldVertices)
+	{
+		vertices.push_back(vertex);
+		return static_cast<uint32_t>(vertices.size() - 1);
+	}
+
+	const WeldKey key{
+		glm::ivec3(glm::round(vertex.Position * 1024.0f)),
+		glm::ivec3(glm::round(vertex.Normal * 1024.0f)),
+		glm::ivec2(glm::round(vertex.TexCoord * 4096.0f))
+	};
+	const auto [pair, inserted] = m_weldMaps[meshIndex].try_emplace(key, static_cast<uint32_t>(vertices.size()));
+	if (inserted)
+		vertices.push_back(vertex);
+	return pair->second;
 }
 
 #pragma endregion
 
 #pragma region Brushes
 
-glm::vec3 calculateCenter(const std::vector<MapData::Brush>& brushes)
+bool                                                       Brushes::s_mapLoading = false;
+std::unordered_multimap<uint64_t, Brushes::CachedCollider> Brushes::s_colliderCache;
+BrushMeshCompilerStats                                     Brushes::s_meshStats;
+BrushColliderStats                                         Brushes::s_colliderStats;
+
+BrushColliderStats& BrushColliderStats::operator+=(const BrushColliderStats& other)
+{
+	Brushes += other.Brushes;
+	CookedMeshes += other.CookedMeshes;
+	ReusedMeshes += other.ReusedMeshes;
+	Actors += other.Actors;
+	BroadphaseEntries += other.BroadphaseEntries;
+	CookTime = CookTime.ToDuration() + other.CookTime.ToDuration();
+	return *this;
+}
+
+static bool SameColliderVertices(const std::vector<physx::PxVec3>& a, const std::vector<physx::PxVec3>& b)
+{
+	return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(physx::PxVec3)) == 0;
+}
+
+glm::vec3 calculateCenter(std::span<const MapData::Brush> brushes)
 {
 	float numVertices = 0;
 	glm::vec3 sum{ 0.0f };
@@ -175,7 +494,7 @@ glm::vec3 calculateCenter(const std::vector<MapData::Brush>& brushes)
 	return sum / numVertices;
 }
 
-Brushes::Brushes(const std::vector<MapData::Brush>& brushes, BrushType type, PhysicsLayer layer)
+Brushes::Brushes(std::span<const MapData::Brush> brushes, BrushType type, PhysicsLayer layer)
 	: m_type(type)
 	, m_center(calculateCenter(brushes))
 {
@@ -199,6 +518,9 @@ Brushes::~Brushes()
 {
 	renderer->WaitDeviceIdle();
 
+	for (physx::PxRigidStatic*& actor : m_staticActors)
+		PhysicsReleaseStaticAggregate(actor);
+
 	for (physx::PxShape* shape : m_shapes)
 		PX_RELEASE(shape);
 
@@ -210,6 +532,28 @@ void Brushes::AttachToRigidActor(physx::PxRigidActor* actor)
 {
 	for (const auto& shape : m_shapes)
 		actor->attachShape(*shape);
+
+	s_colliderStats.Actors++;
+	s_colliderStats.BroadphaseEntries += static_cast<uint32_t>(m_shapes.size());
+}
+
+void Brushes::CreateStaticActors(void* userData)
+{
+	std::unordered_map<glm::ivec3, std::vector<physx::PxShape*>> cellShapes;
+	for (size_t i = 0; i < m_shapes.size(); i++)
+		cellShapes[m_shapeCells[i]].push_back(m_shapes[i]);
+
+	// shape poses are relative to the center of the brushes, like for AttachToRigidActor
+	const physx::PxTransform pose{ m_center.x, m_center.y, m_center.z };
+	for (const auto& [cell, shapes] : cellShapes)
+	{
+		physx::PxRigidStatic* actor = physicsScene->CreateStaticAggregate(pose, shapes);
+		actor->userData = userData;
+		m_staticActors.push_back(actor);
+	}
+
+	s_colliderStats.Actors += static_cast<uint32_t>(cellShapes.size());
+	s_colliderStats.BroadphaseEntries += static_cast<uint32_t>(cellShapes.size());
 }
 
 void Brushes::Draw(const glm::mat4& model)
@@ -218,89 +562,172 @@ void Brushes::Draw(const glm::mat4& model)
 		renderer->Draw(&mesh, model, material);
 }
 
-void Brushes::createMeshes(const std::vector<MapData::Brush>& brushes)
+void Brushes::createMeshes(std::span<const MapData::Brush> brushes)
 {
-	std::map<std::string, std::vector<VertexBase>> textureToVertices;
-	for (const auto& brush : brushes)
-	{
-		for (const auto& face : brush.Faces)
-		{
-			std::vector<VertexBase>& vertices = textureToVertices[face.Texture];
-			// triangulate
-			for (int k = 1; k < face.Vertices.size() - 1; k++)
-			{
-				vertices.emplace_back(
-					face.Vertices[0].Position - m_center,
-					face.Normal,
-					face.Vertices[0].TexCoord
-				);
-				vertices.emplace_back(
-					face.Vertices[k].Position - m_center,
-					face.Normal,
-					face.Vertices[k].TexCoord
-				);
-				vertices.emplace_back(
-					face.Vertices[k + 1].Position - m_center,
-					face.Normal,
-					face.Vertices[k + 1].TexCoord
-				);
-			}
-		}
-	}
-	for (const auto& [texture, vertices] : textureToVertices)
+	BrushMeshCompiler compiler;
+	compiler.Compile(brushes, m_center, [](std::string_view texture) {
+		return texture != "trigger" && !renderer->LoadPbrMaterial("materials/" + std::string(texture) + ".json")->Transparent;
+	});
+	s_meshStats += compiler.GetStats();
+
+	bool warnedTriggerFaces = false;
+	bool warnedSolidFaces = false;
+	for (const BrushMesh& mesh : compiler.GetMeshes())
 	{
-		if (texture == "trigger")
+		if (mesh.Texture == "trigger")
 		{
-			if (m_type != BrushType::Trigger)
+			if (m_type != BrushType::Trigger && !warnedTriggerFaces)
 			{
 				Warning("Trigger faces should only be used on trigger brushes!");
+				warnedTriggerFaces = true;
 			}
 		}
 		else
 		{
-			if (m_type == BrushType::Trigger)
+			if (m_type == BrushType::Trigger && !warnedSolidFaces)
 			{
 				Warning("Trigger brushes should only contain trigger faces!");
+				warnedSolidFaces = true;
 			}
 		}
 
 		m_meshes.emplace_back(
-			renderer->CreateMesh(vertices),
-			renderer->LoadPbrMaterial("materials/" + texture + ".json")
+			renderer->CreateMesh(mesh.Vertices, mesh.Indices),
+			renderer->LoadPbrMaterial("materials/" + std::string(mesh.Texture) + ".json")
 		);
 	}
 }
 
-void Brushes::createColliders(const std::vector<MapData::Brush>& brushes, PhysicsLayer layer)
+void Brushes::createColliders(std::span<const MapData::Brush> brushes, PhysicsLayer layer)
 {
+	const Clock clock;
 	const physx::PxFilterData filterData = PhysicsFilterDataFromLayer(layer);
 
-	m_colliders.reserve(brushes.size());
-	m_shapes.reserve(brushes.size());
-	for (const auto& brush : brushes)
+	struct CookJob final
 	{
-		std::vector<physx::PxVec3> collider;
-		collider.reserve(brush.Vertices.size());
-		for (const glm::vec3& vertex : brush.Vertices)
+		std::vector<physx::PxVec3> Vertices;
+		uint64_t                   Hash;
+		std::vector<uint8_t>       CookedData;
+		bool                       Cooked = false;
+		physx::PxConvexMesh*       Mesh = nullptr;
+	};
+
+	// colliders are cooked around the center of each brush, so brushes with the same shape anywhere share them
+	std::vector<glm::vec3>            brushCenters(brushes.size());
+	std::vector<physx::PxConvexMesh*> cachedMeshes(brushes.size(), nullptr);
+	std::vector<size_t>               jobIndices(brushes.size(), 0);
+	std::vector<CookJob>              jobs;
+	std::unordered_multimap<uint64_t, size_t> jobsByHash;
+	for (size_t i = 0; i < brushes.size(); i++)
+	{
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ std::numeric_limits<float>::lowest() };
+		for (const glm::vec3& vertex : brushes[i].Vertices)
+		{
+			min = glm::min(min, vertex);
+			max = glm::max(max, vertex);
+		}
+		const glm::vec3 center = brushes[i].Vertices.empty() ? m_center : (min + max) * 0.5f;
+		brushCenters[i] = center;
+
+		std::vector<physx::PxVec3> vertices;
+		vertices.reserve(brushes[i].Vertices.size());
+		for (const glm::vec3& vertex : brushes[i].Vertices)
+			vertices.emplace_back(vertex.x - center.x, vertex.y - center.y, vertex.z - center.z);
+		const uint64_t hash = HashBytes(vertices.data(), vertices.size() * sizeof(physx::PxVec3));
+
+		const auto [cachedBegin, cachedEnd] = s_colliderCache.equal_range(hash);
+		const auto cached = std::find_if(cachedBegin, cachedEnd, [&](const auto& pair) { return SameColliderVertices(pair.second.Vertices, vertices); });
+		if (cached != cachedEnd)
 		{
-			collider.emplace_back(
-				vertex.x - m_center.x,
-				vertex.y - m_center.y,
-				vertex.z - m_center.z
-			);
+			cachedMeshes[i] = cached->second.Mesh;
+			s_colliderStats.ReusedMeshes++;
+			continue;
 		}
 
-		physx::PxConvexMesh* brushCollider = physicsSystem->CreateConvexMesh(collider.size(), collider.data());
-		m_colliders.push_back(brushCollider);
+		const auto [jobBegin, jobEnd] = jobsByHash.equal_range(hash);
+		const auto job = std::find_if(jobBegin, jobEnd, [&](const auto& pair) { return SameColliderVertices(jobs[pair.second].Vertices, vertices); });
+		if (job != jobEnd)
+		{
+			jobIndices[i] = job->second;
+			s_colliderStats.ReusedMeshes++;
+			continue;
+		}
+
+		jobIndices[i] = jobs.size();
+		jobsByHash.emplace(hash, jobs.size());
+		jobs.push_back({ std::move(vertices), hash });
+	}
 
+	ParallelFor(jobs.size(), [&jobs](size_t i) {
+		CookJob& job = jobs[i];
+		job.Cooked = physicsSystem->CookConvexMesh(static_cast<physx::PxU32>(job.Vertices.size()), job.Vertices.data(), job.CookedData);
+	});
+
+	m_colliders.reserve(jobs.size());
+	for (CookJob& job : jobs)
+	{
+		if (!job.Cooked)
+			Fatal("Failed to create convex PhysX mesh.");
+
+		job.Mesh = physicsSystem->CreateConvexMesh(job.CookedData);
+		m_colliders.push_back(job.Mesh);
+		s_colliderStats.CookedMeshes++;
+
+		if (s_mapLoading)
+		{
+			job.Mesh->acquireReference();
+			s_colliderCache.emplace(job.Hash, CachedCollider{ std::move(job.Vertices), job.Mesh });
+		}
+	}
+
+	// one reference per mesh, no matter how many of the brushes use it
+	std::vector<physx::PxConvexMesh*> reusedMeshes = cachedMeshes;
+	std::sort(reusedMeshes.begin(), reusedMeshes.end());
+	reusedMeshes.erase(std::unique(reusedMeshes.begin(), reusedMeshes.end()), reusedMeshes.end());
+	for (physx::PxConvexMesh* collider : reusedMeshes)
+	{
+		if (!collider)
+			continue;
+		collider->acquireReference();
+		m_colliders.push_back(collider);
+	}
+
+	m_shapes.reserve(brushes.size());
+	m_shapeCells.reserve(brushes.size());
+	for (size_t i = 0; i < brushes.size(); i++)
+	{
+		physx::PxConvexMesh* collider = cachedMeshes[i] ? cachedMeshes[i] : jobs[jobIndices[i]].Mesh;
 		physx::PxShape* brushShape = physicsScene->CreateShape(
-			physx::PxConvexMeshGeometry(brushCollider),
+			physx::PxConvexMeshGeometry(collider),
 			true,
 			m_type == BrushType::Trigger
 		);
+		const glm::vec3 localPosition = brushCenters[i] - m_center;
+		brushShape->setLocalPose(physx::PxTransform{ localPosition.x, localPosition.y, localPosition.z });
 		brushShape->setQueryFilterData(filterData);
 		m_shapes.push_back(brushShape);
+		m_shapeCells.push_back(glm::ivec3(glm::floor(brushCenters[i] / COLLIDER_CELL_SIZE)));
 	}
+
+	s_colliderStats.Brushes += static_cast<uint32_t>(brushes.size());
+	s_colliderStats.CookTime = s_colliderStats.CookTime.ToDuration() + clock.GetElapsedTime().ToDuration();
+}
+
+void Brushes::BeginMapLoad()
+{
+	EndMapLoad();
+	s_mapLoading = true;
+	s_meshStats = {};
+	s_colliderStats = {};
+}
+
+void Brushes::EndMapLoad()
+{
+	for (auto& [hash, collider] : s_colliderCache)
+		PX_RELEASE(collider.Mesh)
+	s_colliderCache.clear();
+	s_mapLoading = false;
 }
 
 #pragma endregion
\ No newline at end of file
@@ -18,36 +18,52 @@ namespace MapData
 
 	struct Face final
 	{
-		std::string         Texture;
-		glm::vec3           Normal;
-		std::vector<Vertex> Vertices;
+		std::string_view        Texture;
+		glm::vec3               Normal;
+		std::span<const Vertex> Vertices;
 	};
 
 	struct Brush final
 	{
-		std::vector<glm::vec3> Vertices;
-		std::vector<Face>      Faces;
+		std::span<const glm::vec3> Vertices;
+		std::span<const Face>      Faces;
+	};
+
+	struct Property final
+	{
+		std::string_view Key;
+		std::string_view Value;
 	};
 
+	// Property values are only parsed when they are asked for.
 	struct Entity final 
 	{
-		[[nodiscard]] bool GetPropertyString(const std::string& key, std::string& value) const;
-		[[nodiscard]] bool GetPropertyInteger(const std::string& key, int& value) const;
-		[[nodiscard]] bool GetPropertyFloat(const std::string& key, float& value) const;
-		[[nodiscard]] bool GetPropertyColor(const std::string& key, glm::vec3& value) const;
-		[[nodiscard]] bool GetPropertyVector(const std::string& key, glm::vec3& value) const;
+		// Empty if the entity doesn't have the property
+		[[nodiscard]] std::string_view GetProperty(std::string_view key) const;
 
-		std::map<std::string, std::string> Properties;
-		std::vector<Brush>                 Brushes;
+		[[nodiscard]] bool GetPropertyString(std::string_view key, std::string& value) const;
+		[[nodiscard]] bool GetPropertyInteger(std::string_view key, int& value) const;
+		[[nodiscard]] bool GetPropertyFloat(std::string_view key, float& value) const;
+		[[nodiscard]] bool GetPropertyColor(std::string_view key, glm::vec3& value) const;
+		[[nodiscard]] bool GetPropertyVector(std::string_view key, glm::vec3& value) const;
+
+		std::span<const Property> Properties;
+		std::span<const Brush>    Brushes;
 
 	private:
-		[[nodiscard]] const std::string& getProperty(const std::string& key, const std::string& fallback = {}) const;
-		[[nodiscard]] bool getPropertyVec3(const std::string& key, glm::vec3& value) const;
+		[[nodiscard]] bool getPropertyVec3(std::string_view key, glm::vec3& value) const;
 	};
 
+	// Every kind of map element is stored in one array, entities, brushes and faces refer to ranges of them.
+	// Strings point into the map file, so a Map is only valid as long as the MapParser that loaded it.
 	struct Map final
 	{
-		std::vector<Entity> Entities;
+		std::vector<Entity>    Entities;
+		std::vector<Property>  Properties;
+		std::vector<Brush>     Brushes;
+		std::vector<Face>      Faces;
+		std::vector<glm::vec3> BrushVertices;
+		std::vector<Vertex>    FaceVertices;
 	};
 } // namespace MapData
 
@@ -55,6 +71,8 @@ namespace MapData
 
 #pragma region MapParser
 
+// Parses the map straight from the memory-mapped file. The file is walked twice, the first pass only counts
+// the elements so every array of the Map is allocated once and the ranges pointing into them never move.
 class MapParser final : private BinaryParser
 {
 public:
@@ -63,18 +81,146 @@ public:
 	[[nodiscard]] const MapData::Map& GetMap() const { return m_map; }
 
 private:
-	void parseFace(MapData::Face& face);
-	void parseBrush(MapData::Brush& brush);
-	void parseEntity(MapData::Entity& entity);
-	void parseMap(MapData::Map& map);
+	struct ElementCounts final
+	{
+		size_t Entities = 0;
+		size_t Properties = 0;
+		size_t Brushes = 0;
+		size_t Faces = 0;
+		size_t BrushVertices = 0;
+		size_t FaceVertices = 0;
+	};
 
-	MapData::Map m_map;
+	template<bool Fill>
+	void parseFace();
+	template<bool Fill>
+	void parseBrush();
+	template<bool Fill>
+	void parseEntity();
+	template<bool Fill>
+	void parseMap();
+
+	ElementCounts m_counts;
+	MapData::Map  m_map;
+};
+
+#pragma endregion
+
+#pragma region BrushMeshCompiler
+
+struct BrushMeshCompilerSettings final
+{
+	float CellSize = 16.0f;         // Faces sharing a material are merged into one mesh per cell of this size
+	bool  RemoveHiddenFaces = true; // Drop faces covered by or buried inside another brush of the same set
+	bool  WeldVertices = true;      // Share identical vertices between the triangles of a mesh
+};
+
+struct BrushMeshCompilerStats final
+{
+	uint32_t Faces = 0;
+	uint32_t HiddenFaces = 0;
+	uint32_t InputTriangles = 0;
+	uint32_t OutputTriangles = 0;
+	uint32_t InputVertices = 0; // One per triangle corner, like the unindexed meshes before welding
+	uint32_t OutputVertices = 0;
+	uint32_t Materials = 0;     // Meshes without cells, one per material
+	uint32_t Meshes = 0;
+
+	BrushMeshCompilerStats& operator+=(const BrushMeshCompilerStats& other);
+};
+
+struct BrushMesh final
+{
+	std::string_view        Texture;
+	std::vector<VertexBase> Vertices;
+	std::vector<uint32_t>   Indices;
+};
+
+// Turns the brushes of one entity into indexed meshes. Faces covered by a touching brush face or buried inside
+// another brush are removed, identical vertices are welded, and faces sharing a material are merged per grid cell
+// so the meshes stay small enough to be frustum culled. Has no GPU dependencies, so it can be run on its own.
+class BrushMeshCompiler final
+{
+public:
+	// Tells whether faces with the texture hide what is behind them, transparent and trigger textures don't.
+	using OccluderFunc = std::function<bool(std::string_view texture)>;
+
+	explicit BrushMeshCompiler(const BrushMeshCompilerSettings& settings = {}) : m_settings(settings) {}
+
+	// origin is subtracted from every vertex. Meshes refer to texture names of the map, see MapData::Map.
+	void Compile(std::span<const MapData::Brush> brushes, const glm::vec3& origin, const OccluderFunc& isOccluder = {});
+
+	[[nodiscard]] const std::vector<BrushMesh>& GetMeshes() const { return m_meshes; }
+	[[nodiscard]] const BrushMeshCompilerStats& GetStats() const { return m_stats; }
+
+private:
+	struct BrushInfo final
+	{
+		glm::vec3 Min;
+		glm::vec3 Max;
+		bool      Occluder;
+	};
+
+	struct MeshKey final
+	{
+		std::string_view Texture;
+		glm::ivec3       Cell;
+
+		bool operator==(const MeshKey& other) const = default;
+	};
+
+	// Vertex quantized to the weld tolerance
+	struct WeldKey final
+	{
+		glm::ivec3 Position;
+		glm::ivec3 Normal;
+		glm::ivec2 TexCoord;
+
+		bool operator==(const WeldKey& other) const = default;
+	};
+
+	struct KeyHash final
+	{
+		size_t operator()(const MeshKey& key) const;
+		size_t operator()(const WeldKey& key) const;
+	};
+
+	[[nodiscard]] bool isFaceHidden(std::span<const MapData::Brush> brushes, uint32_t brushIndex, const MapData::Face& face);
+	[[nodiscard]] glm::ivec3 getCell(const glm::vec3& position) const;
+	[[nodiscard]] size_t getMesh(std::string_view texture, const glm::ivec3& cell);
+	[[nodiscard]] uint32_t addVertex(size_t meshIndex, const VertexBase& vertex);
+
+	BrushMeshCompilerSettings m_settings;
+	glm::vec3                 m_gridOrigin{ 0.0f };
+
+	std::vector<BrushInfo>                                m_brushInfos;
+	std::unordered_map<glm::ivec3, std::vector<uint32_t>> m_brushGrid;
+	std::vector<uint32_t>                                 m_brushVisits; // Last face a brush was tested against
+	uint32_t                                              m_faceVisit = 0;
+
+	std::vector<BrushMesh>                                        m_meshes;
+	std::unordered_map<MeshKey, size_t, KeyHash>                  m_meshIndices;
+	std::vector<std::unordered_map<WeldKey, uint32_t, KeyHash>>   m_weldMaps; // Per mesh
+	std::vector<uint32_t>                                         m_faceIndices;
+	BrushMeshCompilerStats                                        m_stats;
 };
 
 #pragma endregion
 
 #pragma region Brushes
 
+struct BrushColliderStats final
+{
+	uint32_t Brushes = 0;
+	uint32_t CookedMeshes = 0;
+	uint32_t ReusedMeshes = 0;      // Brushes whose shape was already cooked for another brush
+	uint32_t Actors = 0;
+	uint32_t BroadphaseEntries = 0; // Shapes on single actors plus one per static cell
+	Time     CookTime;
+
+	BrushColliderStats& operator+=(const BrushColliderStats& other);
+};
+
 enum class BrushType
 {
 	Normal,      // mesh + collision
@@ -86,7 +232,7 @@ enum class BrushType
 class Brushes final
 {
 public:
-	explicit Brushes(const std::vector<MapData::Brush>& brushes, BrushType type = BrushType::Normal, PhysicsLayer layer = PHYSICS_LAYER_0);
+	explicit Brushes(std::span<const MapData::Brush> brushes, BrushType type = BrushType::Normal, PhysicsLayer layer = PHYSICS_LAYER_0);
 	Brushes(const Brushes&) = delete;
 	Brushes(Brushes&&) = delete;
 	~Brushes();
@@ -98,20 +244,45 @@ public:
 	[[nodiscard]] const glm::vec3& GetCenter() const { return m_center; }
 
 	void AttachToRigidActor(physx::PxRigidActor* actor);
+	// For brushes that never move: groups the colliders into one static actor per cell, see CreateStaticAggregate.
+	void CreateStaticActors(void* userData);
 
 	void Draw(const glm::mat4& model);
 
+	// While a map is loaded, brushes with the same shape share one cooked collider and the stats are summed up for the report.
+	static void BeginMapLoad();
+	static void EndMapLoad();
+	[[nodiscard]] static const BrushMeshCompilerStats& GetMeshStats() { return s_meshStats; }
+	[[nodiscard]] static const BrushColliderStats& GetColliderStats() { return s_colliderStats; }
+
+	// Static brushes get one actor per cell of this size
+	static constexpr float COLLIDER_CELL_SIZE = 16.0f;
+
 private:
-	void createMeshes(const std::vector<MapData::Brush>& brushes);
-	void createColliders(const std::vector<MapData::Brush>& brushes, PhysicsLayer layer);
+
+	struct CachedCollider final
+	{
+		std::vector<physx::PxVec3> Vertices; // Relative to the center of the brush bounds
+		physx::PxConvexMesh*       Mesh;
+	};
+
+	void createMeshes(std::span<const MapData::Brush> brushes);
+	void createColliders(std::span<const MapData::Brush> brushes, PhysicsLayer layer);
 
 	BrushType m_type = BrushType::Normal;
 	glm::vec3 m_center;
 
 	std::vector<std::pair<VulkanMesh, PbrMaterial*>> m_meshes;
 
-	std::vector<physx::PxConvexMesh*> m_colliders;
-	std::vector<physx::PxShape*>      m_shapes;
+	std::vector<physx::PxConvexMesh*>  m_colliders; // Each holds a reference
+	std::vector<physx::PxShape*>       m_shapes;
+	std::vector<glm::ivec3>            m_shapeCells;
+	std::vector<physx::PxRigidStatic*> m_staticActors;
+
+	static bool                                              s_mapLoading;
+	static std::unordered_multimap<uint64_t, CachedCollider> s_colliderCache; // Holds a reference to each mesh
+	static BrushMeshCompilerStats                            s_meshStats;
+	static BrushColliderStats                                s_colliderStats;
 };
 
 #pragma endregion
@@ -181,6 +181,25 @@ physx::PxRigidStatic* PhysicsScene::CreateStatic(const physx::PxTransform& trans
 	return actor;
 }
 
+physx::PxRigidStatic* PhysicsScene::CreateStaticAggregate(const physx::PxTransform& transform, std::span<physx::PxShape* const> shapes)
+{
+	physx::PxRigidStatic* actor = m_physics->createRigidStatic(transform);
+	for (physx::PxShape* shape : shapes)
+		actor->attachShape(*shape);
+
+	physx::PxAggregate* aggregate = m_physics->createAggregate(
+		1,
+		static_cast<physx::PxU32>(shapes.size()),
+		physx::PxGetAggregateFilterHint(physx::PxAggregateType::eSTATIC, false)
+	);
+	if (!aggregate)
+		Fatal("Failed to create PhysX aggregate.");
+
+	aggregate->addActor(*actor);
+	m_scene->addAggregate(*aggregate);
+	return actor;
+}
+
 physx::PxRigidDynamic* PhysicsScene::CreateDynamic(const physx::PxTransform& transform)
 {
 	physx::PxRigidDynamic* actor = m_physics->createRigidDynamic(transform);
@@ -259,6 +278,17 @@ physx::PxMaterial* PhysicsSystem::CreateMaterial(physx::PxReal staticFriction, p
 }
 
 physx::PxConvexMesh* PhysicsSystem::CreateConvexMesh(physx::PxU32 count, const physx::PxVec3* vertices, physx::PxU16 vertexLimit)
+{
+	std::vector<uint8_t> cookedData;
+	if (!CookConvexMesh(count, vertices, cookedData, vertexLimit))
+	{
+		Fatal("Failed to create convex PhysX mesh.");
+		return nullptr;
+	}
+	return CreateConvexMesh(cookedData);
+}
+
+bool PhysicsSystem::CookConvexMesh(physx::PxU32 count, const physx::PxVec3* vertices, std::vector<uint8_t>& cookedData, physx::PxU16 vertexLimit) const
 {
 	physx::PxConvexMeshDesc desc;
 	desc.points.count = count;
@@ -270,12 +300,15 @@ physx::PxConvexMesh* PhysicsSystem::CreateConvexMesh(physx::PxU32 count, const p
 	physx::PxDefaultMemoryOutputStream buffer;
 	const physx::PxCookingParams cookingParams(m_physics->getTolerancesScale()); // TODO: save init
 	if (!PxCookConvexMesh(cookingParams, desc, buffer))
-	{
-		Fatal("Failed to create convex PhysX mesh.");
-		return nullptr;
-	}
+		return false;
 
-	physx::PxDefaultMemoryInputData input(buffer.getData(), buffer.getSize());
+	cookedData.assign(buffer.getData(), buffer.getData() + buffer.getSize());
+	return true;
+}
+
+physx::PxConvexMesh* PhysicsSystem::CreateConvexMesh(std::span<const uint8_t> cookedData)
+{
+	physx::PxDefaultMemoryInputData input(const_cast<uint8_t*>(cookedData.data()), static_cast<physx::PxU32>(cookedData.size()));
 	return m_physics->createConvexMesh(input);
 }
 
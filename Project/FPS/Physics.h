@@ -19,6 +19,14 @@ inline void PhysicsSetActorMaterial(physx::PxRigidActor* actor, physx::PxMateria
 	PhysicsForEachActorShape(actor, [material](physx::PxShape* shape) { shape->setMaterials(&material, 1); });
 }
 
+// Releases an actor made by PhysicsScene::CreateStaticAggregate together with its aggregate
+inline void PhysicsReleaseStaticAggregate(physx::PxRigidStatic*& actor)
+{
+	physx::PxAggregate* aggregate = actor ? actor->getAggregate() : nullptr;
+	PX_RELEASE(actor)
+	PX_RELEASE(aggregate)
+}
+
 #pragma endregion
 
 #pragma region Physics Error Callback
@@ -113,6 +121,10 @@ public:
 		PhysicsLayer              queryLayer = PHYSICS_LAYER_0
 	);
 
+	// Static actor with all the shapes, in its own aggregate so the broadphase tracks one box instead of one per shape.
+	// Release it with PhysicsReleaseStaticAggregate.
+	physx::PxRigidStatic* CreateStaticAggregate(const physx::PxTransform& transform, std::span<physx::PxShape* const> shapes);
+
 	physx::PxRigidDynamic* CreateDynamic(const physx::PxTransform& transform);
 
 	physx::PxRigidDynamic* CreateDynamic(
@@ -168,6 +180,16 @@ public:
 		physx::PxU16         vertexLimit = 255
 	);
 
+	// Only cooks and doesn't touch the SDK objects, so several threads can cook at once.
+	[[nodiscard]] bool CookConvexMesh(
+		physx::PxU32          count,
+		const physx::PxVec3*  vertices,
+		std::vector<uint8_t>& cookedData,
+		physx::PxU16          vertexLimit = 255
+	) const;
+
+	physx::PxConvexMesh* CreateConvexMesh(std::span<const uint8_t> cookedData);
+
 	physx::PxTriangleMesh* CreateTriangleMesh(physx::PxU32 count, const physx::PxVec3* vertices);
 
 private:
@@ -23,6 +23,8 @@ struct ShaderIncluder final : glslang::TShader::Includer
 private:
 	IncludeResult* include(const std::string& headerName)
 	{
+		// shaders are compiled on several threads, map nodes don't move so the content stays valid after unlocking
+		std::lock_guard lock(m_mutex);
 		auto pair = m_headerFiles.find(headerName);
 		if (pair == m_headerFiles.end())
 		{
@@ -35,15 +37,28 @@ private:
 
 	std::string m_includesDir;
 
+	std::mutex                         m_mutex;
 	std::map<std::string, std::string> m_headerFiles;
 };
 
-ShaderCompiler::ShaderCompiler(const std::string& includesDir)
+ShaderCompiler::ShaderCompiler(const std::string& includesDir, const ShaderCompilerSettings& settings)
+	: m_settings(settings)
 {
 	Print("glslang version: " + std::string(glslang::GetGlslVersionString()));
 	if (!glslang::InitializeProcess())
 		Fatal("Failed to initialize glslang.");
 	m_includer = std::make_unique<ShaderIncluder>(includesDir);
+
+	if (!m_settings.CacheDir.empty())
+	{
+		std::error_code error;
+		std::filesystem::create_directories(m_settings.CacheDir, error);
+		if (error)
+		{
+			Warning("Can't create shader cache directory " + m_settings.CacheDir + ": " + error.message());
+			m_settings.CacheDir.clear();
+		}
+	}
 }
 
 ShaderCompiler::~ShaderCompiler()
@@ -76,22 +91,151 @@ inline const char* GetShaderStageName(vk::ShaderStageFlagBits stage)
 	}
 }
 
+// Everything besides the source that changes the SPIR-V, bump the version when the compile options change
+constexpr const char* SHADER_CACHE_KEY = "shader cache 1, vulkan 1.3, spirv 1.0, ";
+
+static void SetupShader(glslang::TShader& shader, EShLanguage glslStage, const char* const* source)
+{
+	shader.setStrings(source, 1);
+	shader.setPreamble("#extension GL_GOOGLE_include_directive : require\n");
+	shader.setEnvInput(glslang::EShSourceGlsl, glslStage, glslang::EShClientVulkan, 100);
+	shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_3);
+	shader.setEnvTarget(glslang::EshTargetSpv, glslang::EShTargetSpv_1_0);
+}
+
+static bool LoadSpirvFile(const std::string& filename, std::vector<uint32_t>& spirv)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	const std::streamsize size = file.tellg();
+	// a SPIR-V header has 5 words, the first one is the magic number
+	constexpr uint32_t SPIRV_MAGIC_NUMBER = 0x07230203;
+	if (size < static_cast<std::streamsize>(5 * sizeof(uint32_t)) || size % sizeof(uint32_t) != 0)
+		return false;
+
+	spirv.resize(static_cast<size_t>(size) / sizeof(uint32_t));
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char*>(spirv.data()), size) || spirv[0] != SPIRV_MAGIC_NUMBER)
+	{
+		spirv.clear();
+		return false;
+	}
+	return true;
+}
+
+static void SaveSpirvFile(const std::string& filename, const std::vector<uint32_t>& spirv)
+{
+	// written next to the cache file and renamed, so a crash or another thread never leaves half a file behind
+	const std::string tempFilename = filename + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+		if (!file.write(reinterpret_cast<const char*>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t))))
+		{
+			Warning("Failed to write shader cache file " + tempFilename);
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFilename, filename, error);
+	if (error)
+		Warning("Failed to write shader cache file " + filename + ": " + error.message());
+}
+
+void ShaderCompiler::CompileFiles(std::span<const ShaderFile> files)
+{
+	std::vector<const ShaderFile*> pendingFiles;
+	std::vector<std::string>       sources;
+	for (const ShaderFile& file : files)
+	{
+		const auto key = std::make_pair(file.Stage, file.Filename);
+		if (m_compiledFiles.contains(key))
+			continue;
+		m_compiledFiles.emplace(key, std::vector<uint32_t>{});
+
+		pendingFiles.push_back(&file);
+		sources.push_back(FileSystem::Read(file.Filename));
+	}
+
+	const Clock clock;
+	std::vector<CompileResult> results(pendingFiles.size());
+	ParallelFor(pendingFiles.size(), [&](size_t i) {
+		results[i] = compile(pendingFiles[i]->Stage, sources[i], pendingFiles[i]->Filename);
+	});
+
+	uint32_t hits = 0;
+	for (size_t i = 0; i < pendingFiles.size(); i++)
+	{
+		addStats(results[i]);
+		hits += results[i].FromCache ? 1 : 0;
+		m_compiledFiles[std::make_pair(pendingFiles[i]->Stage, pendingFiles[i]->Filename)] = std::move(results[i].Spirv);
+	}
+
+	Print("Prepared " + std::to_string(pendingFiles.size()) + " shaders in " + std::to_string(clock.GetElapsedTime().AsMilliseconds()) + " ms, "
+		+ std::to_string(hits) + " from the cache.");
+}
+
 std::vector<uint32_t> ShaderCompiler::Compile(vk::ShaderStageFlagBits stage, const std::string& source)
+{
+	CompileResult result = compile(stage, source, "source");
+	addStats(result);
+	return std::move(result.Spirv);
+}
+
+std::vector<uint32_t> ShaderCompiler::CompileFromFile(vk::ShaderStageFlagBits stage, const std::string& filename)
+{
+	const auto compiled = m_compiledFiles.find(std::make_pair(stage, filename));
+	if (compiled != m_compiledFiles.end())
+		return compiled->second;
+
+	CompileResult result = compile(stage, FileSystem::Read(filename), filename);
+	addStats(result);
+	return std::move(result.Spirv);
+}
+
+ShaderCompiler::CompileResult ShaderCompiler::compile(vk::ShaderStageFlagBits stage, const std::string& source, const std::string& name) const
+{
+	CompileResult result;
+
+	const std::string cacheFilename = getCacheFilename(stage, source);
+	if (!cacheFilename.empty())
+	{
+		result.FromCache = LoadSpirvFile(cacheFilename, result.Spirv);
+		if (result.FromCache && !m_settings.VerifyCache)
+			return result;
+	}
+
+	Print("Compiling " + std::string(GetShaderStageName(stage)) + " shader: " + name);
+	const Clock clock;
+	std::vector<uint32_t> spirv = compileSpirv(stage, source, name);
+	result.CompileTime = clock.GetElapsedTime();
+
+	if (result.FromCache)
+	{
+		result.Mismatch = spirv != result.Spirv;
+		if (result.Mismatch)
+			Error("Cached SPIR-V of " + std::string(GetShaderStageName(stage)) + " shader " + name + " differs from a fresh compile.");
+	}
+	if (!cacheFilename.empty() && !spirv.empty() && (!result.FromCache || result.Mismatch))
+		SaveSpirvFile(cacheFilename, spirv);
+	result.Spirv = std::move(spirv);
+	return result;
+}
+
+std::vector<uint32_t> ShaderCompiler::compileSpirv(vk::ShaderStageFlagBits stage, const std::string& source, const std::string& name) const
 {
 	const EShLanguage glslStage = GetShaderStageLanguage(stage);
-	const char* stageName = GetShaderStageName(stage);
+	const std::string stageName = GetShaderStageName(stage);
 
 	glslang::TShader shader(glslStage);
 	const char* sourceCStr = source.c_str();
-	shader.setStrings(&sourceCStr, 1);
-	shader.setPreamble("#extension GL_GOOGLE_include_directive : require\n");
-	shader.setEnvInput(glslang::EShSourceGlsl, glslStage, glslang::EShClientVulkan, 100);
-	shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_3);
-	shader.setEnvTarget(glslang::EshTargetSpv, glslang::EShTargetSpv_1_0);
+	SetupShader(shader, glslStage, &sourceCStr);
 
 	if (!shader.parse(GetDefaultResources(), 100, false, EShMsgDefault, *m_includer))
 	{
-		Error("Failed to parse " + std::string(stageName) + " shader: " + shader.getInfoLog());
+		Error("Failed to parse " + stageName + " shader " + name + ": " + shader.getInfoLog());
 		return {};
 	}
 	else
@@ -108,7 +252,7 @@ std::vector<uint32_t> ShaderCompiler::Compile(vk::ShaderStageFlagBits stage, con
 
 	if (!program.link(EShMsgDefault))
 	{
-		Error("Failed to link " + std::string(stageName) + " shader program: " + program.getInfoLog());
+		Error("Failed to link " + stageName + " shader program " + name + ": " + program.getInfoLog());
 		return {};
 	}
 
@@ -117,11 +261,41 @@ std::vector<uint32_t> ShaderCompiler::Compile(vk::ShaderStageFlagBits stage, con
 	return spirv;
 }
 
-std::vector<uint32_t> ShaderCompiler::CompileFromFile(vk::ShaderStageFlagBits stage, const std::string& filename)
+std::string ShaderCompiler::getCacheFilename(vk::ShaderStageFlagBits stage, const std::string& source) const
+{
+	if (m_settings.CacheDir.empty())
+		return {};
+
+	// preprocessing resolves the includes, so a changed header changes the key
+	const EShLanguage glslStage = GetShaderStageLanguage(stage);
+	glslang::TShader shader(glslStage);
+	const char* sourceCStr = source.c_str();
+	SetupShader(shader, glslStage, &sourceCStr);
+
+	std::string preprocessed;
+	if (!shader.preprocess(GetDefaultResources(), 100, ENoProfile, false, false, EShMsgDefault, &preprocessed, *m_includer))
+		return {}; // compiling reports the error
+
+	uint64_t hash = HashString(SHADER_CACHE_KEY);
+	hash = HashString(glslang::GetGlslVersionString(), hash);
+	hash = HashString(std::to_string(glslang::GetSpirvGeneratorVersion()), hash);
+	hash = HashString(GetShaderStageName(stage), hash);
+	hash = HashString(preprocessed, hash);
+
+	char hex[16];
+	const auto [end, error] = std::to_chars(std::begin(hex), std::end(hex), hash, 16);
+	return m_settings.CacheDir + std::string(std::begin(hex), end) + ".spv";
+}
+
+void ShaderCompiler::addStats(const CompileResult& result)
 {
-	const char* stageName = GetShaderStageName(stage);
-	Print("Compiling " + std::string(stageName) + " shader: " + filename);
-	return Compile(stage, FileSystem::Read(filename));
+	if (result.FromCache)
+		m_stats.Hits++;
+	else
+		m_stats.Misses++;
+	if (result.Mismatch)
+		m_stats.Mismatches++;
+	m_stats.CompileTime = m_stats.CompileTime.ToDuration() + result.CompileTime.ToDuration();
 }
 
 #pragma endregion
@@ -202,7 +376,7 @@ VulkanUniformBufferSet::VulkanUniformBufferSet(VulkanRender& device, const std::
 	bindings.reserve(numUniformBuffers);
 	for (const auto& uniformBufferInfo : uniformBufferInfos)
 	{
-		bindings.emplace_back(uniformBufferInfo.Binding, vk::DescriptorType::eUniformBufferDynamic, 1, uniformBufferInfo.Stage);
+		bindings.emplace_back(uniformBufferInfo.Binding, uniformBufferInfo.Type, 1, uniformBufferInfo.Stage);
 	}
 	m_descriptorSetLayout = m_device->CreateDescriptorSetLayout(bindings);
 	m_descriptorSet = m_device->AllocateDescriptorSet(m_descriptorSetLayout);
@@ -215,12 +389,12 @@ VulkanUniformBufferSet::VulkanUniformBufferSet(VulkanRender& device, const std::
 
 		VulkanBuffer uniformBuffer = m_device->CreateBuffer(
 			numBuffering * uniformBufferInfo.Size,
-			vk::BufferUsageFlagBits::eUniformBuffer,
+			uniformBufferInfo.Type == vk::DescriptorType::eStorageBufferDynamic ? vk::BufferUsageFlagBits::eStorageBuffer : vk::BufferUsageFlagBits::eUniformBuffer,
 			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
 			VMA_MEMORY_USAGE_AUTO_PREFER_HOST
 		);
 
-		m_device->WriteDynamicUniformBufferToDescriptorSet(uniformBuffer.Get(), uniformBufferInfo.Size, m_descriptorSet, uniformBufferInfo.Binding);
+		m_device->WriteDynamicUniformBufferToDescriptorSet(uniformBuffer.Get(), uniformBufferInfo.Size, m_descriptorSet, uniformBufferInfo.Binding, uniformBufferInfo.Type);
 
 		m_uniformBuffers.push_back(std::move(uniformBuffer));
 	}
@@ -276,6 +450,14 @@ void VulkanUniformBufferSet::UpdateAllBuffers(uint32_t bufferingIndex, const std
 	}
 }
 
+void VulkanUniformBufferSet::UpdateBuffer(uint32_t bufferingIndex, size_t bufferIndex, size_t size, const void* data)
+{
+	const size_t uploadSize = std::min<size_t>(size, m_uniformBufferSizes[bufferIndex]);
+	if (uploadSize == 0) return;
+	const uint32_t offset = bufferingIndex * m_uniformBufferSizes[bufferIndex];
+	m_uniformBuffers[bufferIndex].UploadRange(offset, uploadSize, data);
+}
+
 #pragma endregion
 
 #pragma region VulkanImage
@@ -406,6 +588,14 @@ VulkanPipelineConfig::VulkanPipelineConfig(const std::string& jsonFilename)
 	Options.DepthCompareOp = compareOp.empty() ? vk::CompareOp::eLess : CompareOpFromString(compareOp);
 }
 
+void VulkanPipelineConfig::AppendShaderFiles(std::vector<ShaderFile>& files) const
+{
+	files.push_back({ vk::ShaderStageFlagBits::eVertex, VertexShader });
+	if (!GeometryShader.empty())
+		files.push_back({ vk::ShaderStageFlagBits::eGeometry, GeometryShader });
+	files.push_back({ vk::ShaderStageFlagBits::eFragment, FragmentShader });
+}
+
 VulkanPipeline::VulkanPipeline(
 	VulkanRender& device,
 	ShaderCompiler& compiler,
@@ -419,6 +609,9 @@ VulkanPipeline::VulkanPipeline(
 )
 	: m_device(&device)
 {
+	static uint32_t nextId = 0;
+	m_id = ++nextId;
+
 	m_pipelineLayout = m_device->CreatePipelineLayout(descriptorSetLayouts, pushConstantRanges);
 
 	const VulkanPipelineConfig pipelineConfig(pipelineConfigFile);
@@ -457,6 +650,7 @@ void VulkanPipeline::Release()
 	}
 
 	m_device = nullptr;
+	m_id = 0;
 	m_pipeline = VK_NULL_HANDLE;
 	m_vertexShaderModule = VK_NULL_HANDLE;
 	m_geometryShaderModule = VK_NULL_HANDLE;
@@ -467,6 +661,7 @@ void VulkanPipeline::Release()
 void VulkanPipeline::Swap(VulkanPipeline& other) noexcept
 {
 	std::swap(m_device, other.m_device);
+	std::swap(m_id, other.m_id);
 	std::swap(m_pipeline, other.m_pipeline);
 	std::swap(m_vertexShaderModule, other.m_vertexShaderModule);
 	std::swap(m_geometryShaderModule, other.m_geometryShaderModule);
@@ -581,10 +776,8 @@ void VulkanTexture::BindToDescriptorSet(vk::DescriptorSet descriptorSet, uint32_
 
 #pragma region VulkanMesh
 
-VulkanMesh::VulkanMesh(VulkanRender& device, size_t vertexCount, size_t vertexSize, const void* data)
+static VulkanBuffer CreateDeviceLocalBuffer(VulkanRender& device, vk::DeviceSize size, vk::BufferUsageFlags usage, const void* data)
 {
-	const vk::DeviceSize size = vertexCount * vertexSize;
-
 	VulkanBuffer uploadBuffer = device.CreateBuffer(
 		size,
 		vk::BufferUsageFlagBits::eTransferSrc,
@@ -593,39 +786,88 @@ VulkanMesh::VulkanMesh(VulkanRender& device, size_t vertexCount, size_t vertexSi
 	);
 	uploadBuffer.Upload(size, data);
 
-	VulkanBuffer vertexBuffer = device.CreateBuffer(
+	VulkanBuffer buffer = device.CreateBuffer(
 		size,
-		vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
+		usage | vk::BufferUsageFlagBits::eTransferDst,
 		0,
 		VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
 	);
 
-	device.ImmediateSubmit([size, &uploadBuffer, &vertexBuffer](vk::CommandBuffer cmd) {
+	device.ImmediateSubmit([size, &uploadBuffer, &buffer](vk::CommandBuffer cmd) {
 		const vk::BufferCopy copy(0, 0, size);
-		cmd.copyBuffer(uploadBuffer.Get(), vertexBuffer.Get(), 1, &copy);
+		cmd.copyBuffer(uploadBuffer.Get(), buffer.Get(), 1, &copy);
 		});
 
-	m_vertexBuffer = std::move(vertexBuffer);
+	return buffer;
+}
+
+VulkanMesh::VulkanMesh(VulkanRender& device, size_t vertexCount, size_t vertexSize, const void* data)
+{
+	static uint32_t nextId = 0;
+	m_id = ++nextId;
+	m_vertexBuffer = CreateDeviceLocalBuffer(device, vertexCount * vertexSize, vk::BufferUsageFlagBits::eVertexBuffer, data);
 	m_vertexCount = vertexCount;
 }
 
+VulkanMesh::VulkanMesh(VulkanRender& device, const std::vector<VertexBase>& vertices)
+	: VulkanMesh(device, vertices.size(), sizeof(VertexBase), vertices.data())
+{
+	for (const VertexBase& vertex : vertices)
+	{
+		m_boundsMin = glm::min(m_boundsMin, vertex.Position);
+		m_boundsMax = glm::max(m_boundsMax, vertex.Position);
+	}
+}
+
+VulkanMesh::VulkanMesh(VulkanRender& device, const std::vector<VertexBase>& vertices, const std::vector<uint32_t>& indices)
+	: VulkanMesh(device, vertices)
+{
+	m_indexBuffer = CreateDeviceLocalBuffer(device, indices.size() * sizeof(uint32_t), vk::BufferUsageFlagBits::eIndexBuffer, indices.data());
+	m_indexCount = static_cast<uint32_t>(indices.size());
+}
+
 void VulkanMesh::Release()
 {
+	m_id = 0;
 	m_vertexBuffer = {};
 	m_vertexCount = 0;
+	m_indexBuffer = {};
+	m_indexCount = 0;
+	m_boundsMin = glm::vec3(std::numeric_limits<float>::max());
+	m_boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
 }
 
 void VulkanMesh::Swap(VulkanMesh& other) noexcept
 {
+	std::swap(m_id, other.m_id);
 	std::swap(m_vertexBuffer, other.m_vertexBuffer);
 	std::swap(m_vertexCount, other.m_vertexCount);
+	std::swap(m_indexBuffer, other.m_indexBuffer);
+	std::swap(m_indexCount, other.m_indexCount);
+	std::swap(m_boundsMin, other.m_boundsMin);
+	std::swap(m_boundsMax, other.m_boundsMax);
 }
 
 void VulkanMesh::BindAndDraw(vk::CommandBuffer commandBuffer) const
+{
+	Bind(commandBuffer);
+	Draw(commandBuffer);
+}
+
+void VulkanMesh::Bind(vk::CommandBuffer commandBuffer) const
 {
 	const vk::DeviceSize offset = 0;
 	commandBuffer.bindVertexBuffers(0, 1, &m_vertexBuffer.Get(), &offset);
-	commandBuffer.draw(m_vertexCount, 1, 0, 0);
+	if (m_indexCount > 0)
+		commandBuffer.bindIndexBuffer(m_indexBuffer.Get(), 0, vk::IndexType::eUint32);
+}
+
+void VulkanMesh::Draw(vk::CommandBuffer commandBuffer) const
+{
+	if (m_indexCount > 0)
+		commandBuffer.drawIndexed(m_indexCount, 1, 0, 0, 0);
+	else
+		commandBuffer.draw(m_vertexCount, 1, 0, 0);
 }
 
 #pragma endregion
@@ -753,7 +995,7 @@ VulkanMesh* MeshCache::LoadObjMesh(const std::string& filename)
 	{
 		Print("Caching OBJ mesh " + filename);
 		const std::vector<VertexBase> vertices = LoadObj(filename);
-		pair = m_meshes.emplace(filename, VulkanMesh(m_device, vertices.size(), sizeof(VertexBase), vertices.data())).first;
+		pair = m_meshes.emplace(filename, VulkanMesh(m_device, vertices)).first;
 	}
 	return &pair->second;
 }
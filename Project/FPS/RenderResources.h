@@ -4,10 +4,32 @@
 
 struct ShaderIncluder;
 
+struct ShaderCompilerSettings final
+{
+	std::string CacheDir = "ShaderCache/"; // Real directory the SPIR-V is cached in, empty disables the cache
+	bool        VerifyCache = false;       // Also compiles cache hits and compares the SPIR-V, needs no GPU
+};
+
+struct ShaderCompilerStats final
+{
+	uint32_t Hits = 0;
+	uint32_t Misses = 0;
+	uint32_t Mismatches = 0; // Cache hits that differ from a fresh compile, only counted with VerifyCache
+	Time     CompileTime;    // Summed over all threads
+};
+
+struct ShaderFile final
+{
+	vk::ShaderStageFlagBits Stage;
+	std::string             Filename;
+};
+
+// Compiles GLSL to SPIR-V with glslang. Results are cached on disk, keyed by a hash of the preprocessed source
+// (so every included file is part of it), the stage and the compiler version.
 class ShaderCompiler final
 {
 public:
-	explicit ShaderCompiler(const std::string& includesDir);
+	explicit ShaderCompiler(const std::string& includesDir, const ShaderCompilerSettings& settings = {});
 	ShaderCompiler(const ShaderCompiler&) = delete;
 	ShaderCompiler(ShaderCompiler&&) = delete;
 	~ShaderCompiler();
@@ -15,11 +37,34 @@ public:
 	ShaderCompiler& operator=(const ShaderCompiler&) = delete;
 	ShaderCompiler& operator=(ShaderCompiler&&) = delete;
 
+	// Compiles the files on worker threads, CompileFromFile returns the results afterwards without compiling again.
+	void CompileFiles(std::span<const ShaderFile> files);
+
 	std::vector<uint32_t> Compile(vk::ShaderStageFlagBits stage, const std::string& source);
 	std::vector<uint32_t> CompileFromFile(vk::ShaderStageFlagBits stage, const std::string& filename);
 
+	[[nodiscard]] const ShaderCompilerStats& GetStats() const { return m_stats; }
+
 private:
+	struct CompileResult final
+	{
+		std::vector<uint32_t> Spirv;
+		bool                  FromCache = false;
+		bool                  Mismatch = false;
+		Time                  CompileTime;
+	};
+
+	// Safe to call from several threads at once, errors are logged
+	[[nodiscard]] CompileResult compile(vk::ShaderStageFlagBits stage, const std::string& source, const std::string& name) const;
+	[[nodiscard]] std::vector<uint32_t> compileSpirv(vk::ShaderStageFlagBits stage, const std::string& source, const std::string& name) const;
+	[[nodiscard]] std::string getCacheFilename(vk::ShaderStageFlagBits stage, const std::string& source) const; // Empty without cache
+	void addStats(const CompileResult& result);
+
 	std::unique_ptr<ShaderIncluder> m_includer;
+	ShaderCompilerSettings          m_settings;
+	ShaderCompilerStats             m_stats;
+
+	std::map<std::pair<vk::ShaderStageFlagBits, std::string>, std::vector<uint32_t>> m_compiledFiles; // From CompileFiles
 };
 
 #pragma endregion
@@ -78,6 +123,7 @@ struct VulkanUniformBufferInfo final
 	uint32_t             Binding;
 	vk::ShaderStageFlags Stage;
 	size_t               Size;
+	vk::DescriptorType   Type = vk::DescriptorType::eUniformBufferDynamic; // or eStorageBufferDynamic
 };
 
 class VulkanUniformBufferSet final
@@ -109,6 +155,8 @@ public:
 	[[nodiscard]] const std::vector<uint32_t>& GetDynamicOffsets(uint32_t bufferingIndex) const { return m_dynamicOffsets[bufferingIndex]; }
 
 	void UpdateAllBuffers(uint32_t bufferingIndex, const std::initializer_list<const void*>& allBuffersData);
+	// Uploads the first size bytes of one buffer, buffers are indexed in creation order.
+	void UpdateBuffer(uint32_t bufferingIndex, size_t bufferIndex, size_t size, const void* data);
 
 private:
 	VulkanRender* m_device = nullptr;
@@ -185,6 +233,8 @@ struct VulkanPipelineConfig final
 	VulkanPipelineOptions Options;
 
 	explicit VulkanPipelineConfig(const std::string& jsonFilename);
+
+	void AppendShaderFiles(std::vector<ShaderFile>& files) const;
 };
 
 class VulkanRender;
@@ -225,9 +275,12 @@ public:
 
 	[[nodiscard]] const vk::PipelineLayout& GetLayout() const { return m_pipelineLayout; }
 	[[nodiscard]] const vk::Pipeline& Get() const { return m_pipeline; }
+	// Creation order, stable for the lifetime of the pipeline and used for draw sorting
+	[[nodiscard]] uint32_t GetId() const { return m_id; }
 
 private:
 	VulkanRender*      m_device = nullptr;
+	uint32_t           m_id = 0;
 	vk::PipelineLayout m_pipelineLayout;
 	vk::ShaderModule   m_vertexShaderModule;
 	vk::ShaderModule   m_geometryShaderModule;
@@ -288,11 +341,15 @@ private:
 
 #pragma region VulkanMesh
 
+struct VertexBase;
+
 class VulkanMesh final
 {
 public:
 	VulkanMesh() = default;
 	VulkanMesh(VulkanRender& device, size_t vertexCount, size_t vertexSize, const void* data);
+	VulkanMesh(VulkanRender& device, const std::vector<VertexBase>& vertices); // also computes the bounds
+	VulkanMesh(VulkanRender& device, const std::vector<VertexBase>& vertices, const std::vector<uint32_t>& indices);
 	VulkanMesh(const VulkanMesh&) = delete;
 	VulkanMesh(VulkanMesh&& other) noexcept { Swap(other); }
 	~VulkanMesh() { Release(); }
@@ -313,10 +370,24 @@ public:
 	void Swap(VulkanMesh& other) noexcept;
 
 	void BindAndDraw(vk::CommandBuffer commandBuffer) const;
+	void Bind(vk::CommandBuffer commandBuffer) const;
+	void Draw(vk::CommandBuffer commandBuffer) const;
+
+	// Meshes created from raw vertex data have no bounds and are never culled.
+	[[nodiscard]] bool HasBounds() const { return m_boundsMin.x <= m_boundsMax.x; }
+	[[nodiscard]] const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+	[[nodiscard]] const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+	// Creation order, stable for the lifetime of the mesh and used for draw sorting
+	[[nodiscard]] uint32_t GetId() const { return m_id; }
 
 private:
+	uint32_t     m_id = 0;
 	VulkanBuffer m_vertexBuffer;
 	uint32_t     m_vertexCount = 0;
+	VulkanBuffer m_indexBuffer; // Drawn indexed if the mesh has indices
+	uint32_t     m_indexCount = 0;
+	glm::vec3    m_boundsMin{ std::numeric_limits<float>::max() };
+	glm::vec3    m_boundsMax{ std::numeric_limits<float>::lowest() };
 };
 
 #pragma endregion
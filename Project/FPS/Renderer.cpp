@@ -567,11 +567,35 @@ void ShadowMap::CreateAttachment(const vk::Extent2D& extent) {
 	m_depthAttachment = m_device->CreateImage(
 		vk::Format::eD32Sfloat,
 		extent,
-		vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled,
+		vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
 		0,
 		VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
 		4
 	);
+
+	// the shadow pass loads the layers it doesn't redraw, so they start out cleared and readable
+	m_device->ImmediateSubmit([image = m_depthAttachment.Get()](vk::CommandBuffer cmd) {
+		const vk::ImageSubresourceRange range{ vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 4 };
+		vk::ImageMemoryBarrier imageMemoryBarrier(
+			{},
+			vk::AccessFlagBits::eTransferWrite,
+			vk::ImageLayout::eUndefined,
+			vk::ImageLayout::eTransferDstOptimal,
+			{},
+			{},
+			image,
+			range
+		);
+		cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, imageMemoryBarrier);
+
+		cmd.clearDepthStencilImage(image, vk::ImageLayout::eTransferDstOptimal, vk::ClearDepthStencilValue{ 1.0f, 0 }, range);
+
+		imageMemoryBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+		imageMemoryBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+		imageMemoryBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		imageMemoryBarrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+		cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, imageMemoryBarrier);
+		});
 }
 
 void ShadowMap::CreateAttachmentView() {
@@ -617,6 +641,7 @@ ShadowContext::ShadowContext(VulkanRender& device)
 
 void ShadowContext::CreateRenderPass() {
 	VulkanRenderPassOptions options;
+	options.PreserveDepth = true; // cascades that didn't change keep last frame's depth
 	options.ShaderReadsDepth = true;
 
 	m_renderPass = m_device->CreateRenderPass(
@@ -751,7 +776,8 @@ PbrMaterial* PbrMaterialCache::LoadMaterial(const std::string& filename) {
 		const PbrMaterial material{
 			textureSet, //
 			config.Transparent,
-			config.Shadow };
+			config.Shadow,
+			static_cast<uint32_t>(m_materials.size()) };
 
 		pair = m_materials.emplace(filename, material).first;
 	}
@@ -923,6 +949,155 @@ void AppendBoxVertices(std::vector<VertexBase>& vertices, const glm::vec3& min,
 
 #pragma endregion
 
+#pragma region DrawList
+
+bool DrawList::CalcWorldBox(const DrawCall& drawCall, glm::vec3& center, glm::vec3& halfSize)
+{
+	const glm::mat4& model = drawCall.ModelMatrix;
+	if (!drawCall.Mesh->HasBounds())
+	{
+		center = glm::vec3(model[3]);
+		halfSize = glm::vec3(0.0f);
+		return false;
+	}
+
+	// world space box around the transformed mesh bounds
+	const glm::vec3 localCenter = (drawCall.Mesh->GetBoundsMin() + drawCall.Mesh->GetBoundsMax()) * 0.5f;
+	const glm::vec3 localHalfSize = (drawCall.Mesh->GetBoundsMax() - drawCall.Mesh->GetBoundsMin()) * 0.5f;
+	center = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+	halfSize = glm::abs(glm::vec3(model[0])) * localHalfSize.x
+		+ glm::abs(glm::vec3(model[1])) * localHalfSize.y
+		+ glm::abs(glm::vec3(model[2])) * localHalfSize.z;
+	return true;
+}
+
+void DrawList::Build(const glm::mat4& view, const glm::mat4& projection)
+{
+	const Frustum frustum(projection * view);
+
+	m_sortItems.clear();
+	for (DrawListStats& stats : m_stats)
+		stats = {};
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_drawCalls.size()); i++)
+	{
+		const DrawCall& drawCall = m_drawCalls[i];
+		const DrawPass pass = drawCall.Material->Transparent ? DrawPass::Forward : DrawPass::Deferred;
+
+		glm::vec3 center, halfSize;
+		if (CalcWorldBox(drawCall, center, halfSize) && !frustum.Intersects(center, halfSize))
+		{
+			m_stats[static_cast<size_t>(pass)].Culled++;
+			continue;
+		}
+
+		const float viewDepth = (view * glm::vec4(center, 1.0f)).z;
+		m_sortItems.push_back({ MakeSortKey(pass, drawCall, viewDepth), i });
+	}
+
+	RadixSort(m_sortItems, m_sortScratch);
+
+	// the pass is in the highest key bits, so every pass is one contiguous range
+	m_visible.resize(m_sortItems.size());
+	std::fill(std::begin(m_passOffsets), std::end(m_passOffsets), 0);
+	for (size_t i = 0; i < m_sortItems.size(); i++)
+	{
+		m_visible[i] = m_sortItems[i].Index;
+		m_passOffsets[(m_sortItems[i].Key >> 62) + 1]++;
+	}
+	for (size_t pass = 0; pass < static_cast<size_t>(DrawPass::Count); pass++)
+		m_passOffsets[pass + 1] += m_passOffsets[pass];
+
+	// state changes the submission will make, a pipeline change also rebinds material and mesh
+	for (size_t pass = 0; pass < static_cast<size_t>(DrawPass::Count); pass++)
+	{
+		DrawListStats& stats = m_stats[pass];
+		const VulkanPipeline* lastPipeline = nullptr;
+		const PbrMaterial* lastMaterial = nullptr;
+		const VulkanMesh* lastMesh = nullptr;
+		for (size_t i = m_passOffsets[pass]; i < m_passOffsets[pass + 1]; i++)
+		{
+			const DrawCall& drawCall = m_drawCalls[m_visible[i]];
+			stats.Submitted++;
+			if (drawCall.Pipeline != lastPipeline)
+			{
+				stats.PipelineChanges++;
+				lastMaterial = nullptr;
+				lastMesh = nullptr;
+			}
+			if (drawCall.Material != lastMaterial)
+				stats.MaterialChanges++;
+			if (drawCall.Mesh != lastMesh)
+				stats.MeshChanges++;
+			lastPipeline = drawCall.Pipeline;
+			lastMaterial = drawCall.Material;
+			lastMesh = drawCall.Mesh;
+		}
+	}
+}
+
+void DrawList::Clear()
+{
+	m_drawCalls.clear();
+	m_sortItems.clear();
+	m_visible.clear();
+	std::fill(std::begin(m_passOffsets), std::end(m_passOffsets), 0);
+}
+
+std::span<const uint32_t> DrawList::GetVisible(DrawPass pass) const
+{
+	const size_t begin = m_passOffsets[static_cast<size_t>(pass)];
+	const size_t end = m_passOffsets[static_cast<size_t>(pass) + 1];
+	return { m_visible.data() + begin, end - begin };
+}
+
+uint64_t DrawList::MakeSortKey(DrawPass pass, const DrawCall& drawCall, float viewDepth)
+{
+	// non-negative floats keep their order when compared as integers, the top 26 bits are enough
+	uint32_t depthBits;
+	const float depth = glm::max(viewDepth, 0.0f);
+	memcpy(&depthBits, &depth, sizeof(depthBits));
+	const uint64_t depthKey = depthBits >> 6;
+
+	const uint64_t passKey = static_cast<uint64_t>(pass);
+	const uint64_t pipelineKey = drawCall.Pipeline->GetId() & 0xF;
+	const uint64_t materialKey = drawCall.Material->Id & 0xFFFF;
+	const uint64_t meshKey = drawCall.Mesh->GetId() & 0xFFFF;
+
+	uint64_t key = passKey << 62 | pipelineKey << 58;
+	if (pass == DrawPass::Forward)
+		key |= (~depthKey & 0x3FFFFFF) << 32 | materialKey << 16 | meshKey; // back-to-front for blending
+	else
+		key |= materialKey << 42 | meshKey << 26 | depthKey;                 // state first, then front-to-back
+	return key;
+}
+
+void DrawList::RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch)
+{
+	if (items.size() < 2) return;
+
+	// LSD radix sort with 8-bit digits, stable so submission order breaks ties
+	scratch.resize(items.size());
+	for (uint32_t shift = 0; shift < 64; shift += 8)
+	{
+		size_t offsets[257] = {};
+		for (const SortItem& item : items)
+			offsets[((item.Key >> shift) & 0xFF) + 1]++;
+
+		// a digit shared by all keys doesn't change the order
+		if (offsets[((items[0].Key >> shift) & 0xFF) + 1] == items.size())
+			continue;
+
+		for (size_t digit = 0; digit < 256; digit++)
+			offsets[digit + 1] += offsets[digit];
+		for (const SortItem& item : items)
+			scratch[offsets[(item.Key >> shift) & 0xFF]++] = item;
+		items.swap(scratch);
+	}
+}
+
+#pragma endregion
+
 #pragma region PbrRenderer
 
 PbrRenderer::PbrRenderer(GLFWwindow* window)
@@ -943,11 +1118,19 @@ PbrRenderer::PbrRenderer(GLFWwindow* window)
 }
 
 void PbrRenderer::CreateUniformBuffers() {
+	// every buffer is bound with a dynamic offset of bufferingIndex * size
+	static_assert(LightClusterBuilder::MAX_POINT_LIGHTS * sizeof(PointLightData) % 256 == 0);
+	static_assert(LightClusterBuilder::CLUSTER_COUNT * sizeof(LightClusterRecord) % 256 == 0);
+	static_assert(LightClusterBuilder::MAX_LIGHT_INDICES * sizeof(uint32_t) % 256 == 0);
+
 	m_uniformBufferSet = VulkanUniformBufferSet(
 		m_device,
 		{
 			{0, vk::ShaderStageFlagBits::eAllGraphics,                                   sizeof(RendererUniformData)},
-			{1, vk::ShaderStageFlagBits::eGeometry | vk::ShaderStageFlagBits::eFragment, sizeof(LightingUniformData)}
+			{1, vk::ShaderStageFlagBits::eGeometry | vk::ShaderStageFlagBits::eFragment, sizeof(LightingUniformData)},
+			{2, vk::ShaderStageFlagBits::eFragment, LightClusterBuilder::MAX_POINT_LIGHTS * sizeof(PointLightData), vk::DescriptorType::eStorageBufferDynamic},
+			{3, vk::ShaderStageFlagBits::eFragment, LightClusterBuilder::CLUSTER_COUNT * sizeof(LightClusterRecord), vk::DescriptorType::eStorageBufferDynamic},
+			{4, vk::ShaderStageFlagBits::eFragment, LightClusterBuilder::MAX_LIGHT_INDICES * sizeof(uint32_t), vk::DescriptorType::eStorageBufferDynamic}
 		}
 	);
 }
@@ -1017,139 +1200,165 @@ void PbrRenderer::CreatePipelines() {
 
 	ShaderCompiler compiler("shader_includes/");
 
-	m_shadowPipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{
-			m_uniformBufferSet.GetDescriptorSetLayout()
-		},
-		{
-			{vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4)}
-		},
-		VertexBase::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/shadow.json",
-		{},
-		m_shadowContext.GetRenderPass(),
-		0
-	);
-
-	m_basePipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{
-			m_uniformBufferSet.GetDescriptorSetLayout(),
-			m_pbrMaterialCache.GetDescriptorSetLayout()
-		},
-		{
-			{vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4)} //
-		},
-		VertexBase::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/base.json",
-		{ NO_BLEND, NO_BLEND, NO_BLEND, NO_BLEND },
-		m_deferredContext.GetDeferredRenderPass(),
-		0
-	);
-
-	m_skyboxPipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{ m_uniformBufferSet.GetDescriptorSetLayout(), m_iblTextureSetLayout },
-		{},
-		VertexPositionOnly::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/skybox.json",
-		{ NO_BLEND, NO_BLEND, NO_BLEND, NO_BLEND },
-		m_deferredContext.GetDeferredRenderPass(),
-		0
-	);
-
-	m_combinePipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{ m_uniformBufferSet.GetDescriptorSetLayout(),
-		 m_deferredContext.GetDeferredTextureSetLayout(),
-		 m_iblTextureSetLayout,
-		 m_shadowContext.GetTextureSetLayout() },
-		{},
-		VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/combine.json",
-		{ NO_BLEND },
-		m_deferredContext.GetForwardRenderPass(),
-		0
-	);
+	// every pipeline is created from its config file after the shaders of all of them are compiled,
+	// so cache misses are compiled at the same time
+	const std::pair<const char*, std::function<void(const std::string&)>> pipelines[] = {
+		{ "pipelines/shadow.json", [&](const std::string& configFile) {
+			m_shadowPipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{
+					m_uniformBufferSet.GetDescriptorSetLayout()
+				},
+				{
+					{vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eGeometry, 0, sizeof(ShadowPushConstants)}
+				},
+				VertexBase::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{},
+				m_shadowContext.GetRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/base.json", [&](const std::string& configFile) {
+			m_basePipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{
+					m_uniformBufferSet.GetDescriptorSetLayout(),
+					m_pbrMaterialCache.GetDescriptorSetLayout()
+				},
+				{
+					{vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4)} //
+				},
+				VertexBase::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ NO_BLEND, NO_BLEND, NO_BLEND, NO_BLEND },
+				m_deferredContext.GetDeferredRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/skybox.json", [&](const std::string& configFile) {
+			m_skyboxPipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{ m_uniformBufferSet.GetDescriptorSetLayout(), m_iblTextureSetLayout },
+				{},
+				VertexPositionOnly::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ NO_BLEND, NO_BLEND, NO_BLEND, NO_BLEND },
+				m_deferredContext.GetDeferredRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/combine.json", [&](const std::string& configFile) {
+			m_combinePipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{ m_uniformBufferSet.GetDescriptorSetLayout(),
+				 m_deferredContext.GetDeferredTextureSetLayout(),
+				 m_iblTextureSetLayout,
+				 m_shadowContext.GetTextureSetLayout() },
+				{},
+				VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ NO_BLEND },
+				m_deferredContext.GetForwardRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/base_forward.json", [&](const std::string& configFile) {
+			m_baseForwardPipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{
+					m_uniformBufferSet.GetDescriptorSetLayout(),
+					m_pbrMaterialCache.GetDescriptorSetLayout(),
+					m_iblTextureSetLayout,
+					m_shadowContext.GetTextureSetLayout()
+				},
+				{
+					{vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4)} //
+				},
+				VertexBase::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ ALPHA_BLEND },
+				m_deferredContext.GetForwardRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/post_processing.json", [&](const std::string& configFile) {
+			m_postProcessingPipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{ m_deferredContext.GetForwardTextureSetLayout() },
+				{},
+				VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ NO_BLEND },
+				m_toneMappingContext.GetRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/present.json", [&](const std::string& configFile) {
+			m_presentPipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{ m_uniformBufferSet.GetDescriptorSetLayout(), m_toneMappingContext.GetTextureSetLayout() },
+				{},
+				VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ NO_BLEND },
+				m_device.GetPrimaryRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/screen_rect.json", [&](const std::string& configFile) {
+			m_screenRectPipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{
+					m_uniformBufferSet.GetDescriptorSetLayout(),
+					m_singleTextureMaterialCache.GetDescriptorSetLayout()
+				},
+				{ {vk::ShaderStageFlagBits::eVertex, 0, SCREEN_RECT_DRAW_CALL_DATA_SIZE} },
+				VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ ALPHA_BLEND },
+				m_device.GetPrimaryRenderPass(),
+				0
+			);
+		} },
+		{ "pipelines/screen_line.json", [&](const std::string& configFile) {
+			m_screenLinePipeline = VulkanPipeline(
+				m_device,
+				compiler,
+				{
+					m_uniformBufferSet.GetDescriptorSetLayout()
+				},
+				{
+					{vk::ShaderStageFlagBits::eVertex, 0, sizeof(ScreenLineDrawCall)} //
+				},
+				VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
+				configFile,
+				{ ALPHA_BLEND },
+				m_device.GetPrimaryRenderPass(),
+				0
+			);
+		} },
+	};
 
-	m_baseForwardPipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{
-			m_uniformBufferSet.GetDescriptorSetLayout(),
-			m_pbrMaterialCache.GetDescriptorSetLayout(),
-			m_iblTextureSetLayout,
-			m_shadowContext.GetTextureSetLayout()
-		},
-		{
-			{vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4)} //
-		},
-		VertexBase::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/base_forward.json",
-		{ ALPHA_BLEND },
-		m_deferredContext.GetForwardRenderPass(),
-		0
-	);
+	std::vector<ShaderFile> shaderFiles;
+	for (const auto& [configFile, createPipeline] : pipelines)
+		VulkanPipelineConfig(configFile).AppendShaderFiles(shaderFiles);
+	compiler.CompileFiles(shaderFiles);
 
-	m_postProcessingPipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{ m_deferredContext.GetForwardTextureSetLayout() },
-		{},
-		VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/post_processing.json",
-		{ NO_BLEND },
-		m_toneMappingContext.GetRenderPass(),
-		0
-	);
+	for (const auto& [configFile, createPipeline] : pipelines)
+		createPipeline(configFile);
 
-	m_presentPipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{ m_uniformBufferSet.GetDescriptorSetLayout(), m_toneMappingContext.GetTextureSetLayout() },
-		{},
-		VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/present.json",
-		{ NO_BLEND },
-		m_device.GetPrimaryRenderPass(),
-		0
-	);
-
-	m_screenRectPipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{
-			m_uniformBufferSet.GetDescriptorSetLayout(),
-			m_singleTextureMaterialCache.GetDescriptorSetLayout()
-		},
-		{ {vk::ShaderStageFlagBits::eVertex, 0, SCREEN_RECT_DRAW_CALL_DATA_SIZE} },
-		VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/screen_rect.json",
-		{ ALPHA_BLEND },
-		m_device.GetPrimaryRenderPass(),
-		0
-	);
-
-	m_screenLinePipeline = VulkanPipeline(
-		m_device,
-		compiler,
-		{
-			m_uniformBufferSet.GetDescriptorSetLayout()
-		},
-		{
-			{vk::ShaderStageFlagBits::eVertex, 0, sizeof(ScreenLineDrawCall)} //
-		},
-		VertexCanvas::GetPipelineVertexInputStateCreateInfo(),
-		"pipelines/screen_line.json",
-		{ ALPHA_BLEND },
-		m_device.GetPrimaryRenderPass(),
-		0
-	);
+	const ShaderCompilerStats& shaderStats = compiler.GetStats();
+	Print("Shader cache: " + std::to_string(shaderStats.Hits) + " hits, " + std::to_string(shaderStats.Misses) + " misses, "
+		+ std::to_string(shaderStats.CompileTime.AsMilliseconds()) + " ms compiling");
 }
 
 void PbrRenderer::CreateSkyboxCube() {
@@ -1211,19 +1420,20 @@ void PbrRenderer::SetCameraData(const glm::vec3& cameraPosition, const glm::mat4
 	m_rendererUniformData.View = view;
 	m_rendererUniformData.CameraPosition = cameraPosition;
 
-	m_shadowMatrixCalculator.SetCameraInfo(view, fov, aspectRatio);
+	m_shadowCascades.SetCamera(view, fov, aspectRatio);
+	m_lightClusters.SetCamera(view, fov, aspectRatio, near, far);
 }
 
 void PbrRenderer::SetLightingData(const glm::vec3& lightDirection, const glm::vec3& lightColor) {
 	m_lightingUniformData.LightDirection = lightDirection;
 	m_lightingUniformData.LightColor = lightColor;
 
-	m_shadowMatrixCalculator.SetLightDirection(lightDirection);
+	m_shadowCascades.SetLightDirection(lightDirection);
 }
 
 void PbrRenderer::SetWorldBounds(const glm::vec3& min, const glm::vec3& max) {
 	static constexpr float SHADOW_SAFE_DISTANCE = 4.0f;
-	m_shadowMatrixCalculator.SetWorldBounds(min - SHADOW_SAFE_DISTANCE, max + SHADOW_SAFE_DISTANCE);
+	m_shadowCascades.SetWorldBounds(min - SHADOW_SAFE_DISTANCE, max + SHADOW_SAFE_DISTANCE);
 }
 
 void PbrRenderer::FinishDrawing()
@@ -1251,42 +1461,90 @@ void PbrRenderer::FinishDrawing()
 		m_rendererUniformData.ScaledScreenInfo.w = 1.0f / m_rendererUniformData.ScaledScreenInfo.y;
 	}
 
-	// update shadow data
+	// update shadow data, cascades whose matrix and casters didn't change keep last frame's depth
 	{
-		constexpr float     shadowNear = 0.01f;
-		constexpr float     shadowFar = 64.0f;
-		constexpr glm::vec3 csmSplits{ 8.0f, 16.0f, 32.0f };
-		m_lightingUniformData.CascadeShadowMapSplits = csmSplits;
-		m_lightingUniformData.ShadowMatrices[0] = m_shadowMatrixCalculator.CalcShadowMatrix(shadowNear, csmSplits[0]);
-		m_lightingUniformData.ShadowMatrices[1] = m_shadowMatrixCalculator.CalcShadowMatrix(csmSplits[0], csmSplits[1]);
-		m_lightingUniformData.ShadowMatrices[2] = m_shadowMatrixCalculator.CalcShadowMatrix(csmSplits[1], csmSplits[2]);
-		m_lightingUniformData.ShadowMatrices[3] = m_shadowMatrixCalculator.CalcShadowMatrix(csmSplits[2], shadowFar);
+		m_shadowCasters.clear();
+		m_shadowCasterDraws.clear();
+		const auto& drawCalls = m_drawList.GetDrawCalls();
+		for (uint32_t i = 0; i < static_cast<uint32_t>(drawCalls.size()); i++)
+		{
+			const DrawList::DrawCall& drawCall = drawCalls[i];
+			if (!drawCall.Material->Shadow)
+				continue;
+
+			ShadowCaster caster;
+			if (!DrawList::CalcWorldBox(drawCall, caster.Center, caster.HalfSize))
+				caster.HalfSize = glm::vec3(1e30f); // unknown size, goes to every cascade
+			caster.Hash = ShadowCascades::HashCaster(drawCall.Mesh, drawCall.ModelMatrix);
+			m_shadowCasters.push_back(caster);
+			m_shadowCasterDraws.push_back(i);
+		}
+
+		ShadowCascadeSettings settings = m_shadowSettings;
+		settings.Resolution = m_shadowContext.GetExtent().width;
+		m_shadowCascades.SetSettings(settings);
+		m_shadowCascades.Update(m_shadowCasters, frameInfo.BufferingIndex);
+
+		m_lightingUniformData.CascadeShadowMapSplits = m_shadowCascades.GetSplits();
+		for (uint32_t cascade = 0; cascade < ShadowCascades::CASCADE_COUNT; cascade++)
+		{
+			m_lightingUniformData.ShadowMatrices[cascade] = m_shadowCascades.GetShadowMatrix(cascade);
+		}
 	}
 
-	// update point lights
+	// bin point lights into view space clusters
 	{
-		const int numPointLights = static_cast<int>(m_pointLights.size());
-		m_lightingUniformData.NumPointLights = numPointLights;
-		memcpy(m_lightingUniformData.PointLights, m_pointLights.data(), numPointLights * sizeof(PointLightData));
+		m_lightClusters.Build(m_pointLights);
+		m_lightingUniformData.NumPointLights = static_cast<int32_t>(m_lightClusters.GetLights().size());
+		m_lightingUniformData.LightClusterParams = m_lightClusters.GetClusterParams();
 		m_pointLights.clear();
 	}
 
+	m_drawList.Build(m_rendererUniformData.View, m_rendererUniformData.Projection);
+
 	m_uniformBufferSet.UpdateAllBuffers(frameInfo.BufferingIndex, { &m_rendererUniformData, &m_lightingUniformData });
 
+	// light buffers only upload the part that is in use this frame
+	{
+		const auto& lights = m_lightClusters.GetLights();
+		const auto& clusters = m_lightClusters.GetClusters();
+		const auto& lightIndices = m_lightClusters.GetLightIndices();
+		m_uniformBufferSet.UpdateBuffer(frameInfo.BufferingIndex, 2, lights.size() * sizeof(PointLightData), lights.data());
+		m_uniformBufferSet.UpdateBuffer(frameInfo.BufferingIndex, 3, clusters.size() * sizeof(LightClusterRecord), clusters.data());
+		m_uniformBufferSet.UpdateBuffer(frameInfo.BufferingIndex, 4, lightIndices.size() * sizeof(uint32_t), lightIndices.data());
+	}
+
 	DrawToShadowMaps(frameInfo.CommandBuffer, frameInfo.BufferingIndex);
 	DrawDeferred(frameInfo.CommandBuffer, frameInfo.BufferingIndex);
 	DrawForward(frameInfo.CommandBuffer, frameInfo.BufferingIndex);
 	PostProcess(frameInfo.CommandBuffer, frameInfo.BufferingIndex);
 	DrawToScreen(frameInfo.PrimaryRenderPassBeginInfo, frameInfo.CommandBuffer, frameInfo.BufferingIndex);
 
+	m_drawList.Clear();
+
 	m_device.EndFrame();
 }
 
 void PbrRenderer::DrawToShadowMaps(vk::CommandBuffer cmd, uint32_t bufferingIndex) {
+	const uint8_t redrawMask = m_shadowCascades.GetRedrawMask();
+	if (redrawMask == 0) {
+		return;
+	}
+
 	const auto [viewport, scissor] = CalcViewportAndScissorFromExtent(m_shadowContext.GetExtent(), false);
 
+	// the shadow map is loaded, only the layers that are redrawn get cleared
 	cmd.beginRenderPass(m_shadowContext.GetRenderPassBeginInfo(bufferingIndex), vk::SubpassContents::eInline);
 
+	for (uint32_t cascade = 0; cascade < ShadowCascades::CASCADE_COUNT; cascade++) {
+		if (redrawMask & (1u << cascade)) {
+			cmd.clearAttachments(
+				vk::ClearAttachment(vk::ImageAspectFlagBits::eDepth, 0, vk::ClearDepthStencilValue(1.0f, 0)),
+				vk::ClearRect(scissor, cascade, 1)
+			);
+		}
+	}
+
 	cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, m_shadowPipeline.Get());
 
 	cmd.setViewport(0, viewport);
@@ -1300,34 +1558,31 @@ void PbrRenderer::DrawToShadowMaps(vk::CommandBuffer cmd, uint32_t bufferingInde
 		m_uniformBufferSet.GetDynamicOffsets(bufferingIndex)
 	);
 
-	for (const DrawCall& drawCall : m_deferredDrawCalls) {
-		if (!drawCall.Material->Shadow) {
+	// shadow casters outside the camera frustum still cast into it, so this pass uses the unculled list,
+	// the geometry shader only emits to the cascades in the caster's mask
+	const std::vector<uint8_t>& casterMasks = m_shadowCascades.GetCasterMasks();
+	const auto& drawCalls = m_drawList.GetDrawCalls();
+	const VulkanMesh* boundMesh = nullptr;
+	for (size_t i = 0; i < m_shadowCasterDraws.size(); i++) {
+		const uint32_t cascadeMask = casterMasks[i] & redrawMask;
+		if (cascadeMask == 0) {
 			continue;
 		}
 
+		const DrawList::DrawCall& drawCall = drawCalls[m_shadowCasterDraws[i]];
+		const ShadowPushConstants pushConstants{ drawCall.ModelMatrix, cascadeMask };
 		cmd.pushConstants(
 			m_shadowPipeline.GetLayout(), //
-			vk::ShaderStageFlagBits::eVertex,
+			vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eGeometry,
 			0,
-			sizeof(glm::mat4),
-			glm::value_ptr(drawCall.ModelMatrix)
+			sizeof(ShadowPushConstants),
+			&pushConstants
 		);
-		drawCall.Mesh->BindAndDraw(cmd);
-	}
-
-	for (const DrawCall& drawCall : m_forwardDrawCalls) {
-		if (!drawCall.Material->Shadow) {
-			continue;
+		if (drawCall.Mesh != boundMesh) {
+			drawCall.Mesh->Bind(cmd);
+			boundMesh = drawCall.Mesh;
 		}
-
-		cmd.pushConstants(
-			m_shadowPipeline.GetLayout(), //
-			vk::ShaderStageFlagBits::eVertex,
-			0,
-			sizeof(glm::mat4),
-			glm::value_ptr(drawCall.ModelMatrix)
-		);
-		drawCall.Mesh->BindAndDraw(cmd);
+		drawCall.Mesh->Draw(cmd);
 	}
 
 	cmd.endRenderPass();
@@ -1338,37 +1593,50 @@ void PbrRenderer::DrawDeferred(vk::CommandBuffer cmd, uint32_t bufferingIndex) {
 
 	cmd.beginRenderPass(m_deferredContext.GetDeferredRenderPassBeginInfo(bufferingIndex), vk::SubpassContents::eInline);
 
-	cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, m_basePipeline.Get());
-
 	cmd.setViewport(0, viewport);
 	cmd.setScissor(0, scissor);
 
-	cmd.bindDescriptorSets(
-		vk::PipelineBindPoint::eGraphics,
-		m_basePipeline.GetLayout(),
-		0,
-		m_uniformBufferSet.GetDescriptorSet(),
-		m_uniformBufferSet.GetDynamicOffsets(bufferingIndex)
-	);
-
-	for (const DrawCall& drawCall : m_deferredDrawCalls) {
-		cmd.bindDescriptorSets(
-			vk::PipelineBindPoint::eGraphics, //
-			m_basePipeline.GetLayout(),
-			1,
-			drawCall.Material->DescriptorSet,
-			{}
-		);
+	const VulkanPipeline* boundPipeline = nullptr;
+	const PbrMaterial* boundMaterial = nullptr;
+	const VulkanMesh* boundMesh = nullptr;
+	for (uint32_t index : m_drawList.GetVisible(DrawPass::Deferred)) {
+		const DrawList::DrawCall& drawCall = m_drawList.GetDrawCalls()[index];
+		if (drawCall.Pipeline != boundPipeline) {
+			cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, drawCall.Pipeline->Get());
+			cmd.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				drawCall.Pipeline->GetLayout(),
+				0,
+				m_uniformBufferSet.GetDescriptorSet(),
+				m_uniformBufferSet.GetDynamicOffsets(bufferingIndex)
+			);
+			boundPipeline = drawCall.Pipeline;
+			boundMaterial = nullptr;
+			boundMesh = nullptr;
+		}
+		if (drawCall.Material != boundMaterial) {
+			cmd.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics, //
+				boundPipeline->GetLayout(),
+				1,
+				drawCall.Material->DescriptorSet,
+				{}
+			);
+			boundMaterial = drawCall.Material;
+		}
 		cmd.pushConstants(
-			m_basePipeline.GetLayout(), //
+			boundPipeline->GetLayout(), //
 			vk::ShaderStageFlagBits::eVertex,
 			0,
 			sizeof(glm::mat4),
 			glm::value_ptr(drawCall.ModelMatrix)
 		);
-		drawCall.Mesh->BindAndDraw(cmd);
+		if (drawCall.Mesh != boundMesh) {
+			drawCall.Mesh->Bind(cmd);
+			boundMesh = drawCall.Mesh;
+		}
+		drawCall.Mesh->Draw(cmd);
 	}
-	m_deferredDrawCalls.clear();
 
 	cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, m_skyboxPipeline.Get());
 
@@ -1410,45 +1678,54 @@ void PbrRenderer::DrawForward(vk::CommandBuffer cmd, uint32_t bufferingIndex) {
 
 	m_fullScreenQuad.BindAndDraw(cmd);
 
-	cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, m_baseForwardPipeline.Get());
-
-	cmd.setViewport(0, viewport);
-	cmd.setScissor(0, scissor);
-
-	cmd.bindDescriptorSets(
-		vk::PipelineBindPoint::eGraphics,
-		m_baseForwardPipeline.GetLayout(),
-		0,
-		m_uniformBufferSet.GetDescriptorSet(),
-		m_uniformBufferSet.GetDynamicOffsets(bufferingIndex)
-	);
-
-	cmd.bindDescriptorSets(
-		vk::PipelineBindPoint::eGraphics,
-		m_baseForwardPipeline.GetLayout(),
-		2,
-		{ m_iblTextureSet, m_shadowContext.GetTextureSet(bufferingIndex) },
-		{}
-	);
-
-	for (const DrawCall& drawCall : m_forwardDrawCalls) {
-		cmd.bindDescriptorSets(
-			vk::PipelineBindPoint::eGraphics, //
-			m_baseForwardPipeline.GetLayout(),
-			1,
-			drawCall.Material->DescriptorSet,
-			{}
-		);
+	const VulkanPipeline* boundPipeline = nullptr;
+	const PbrMaterial* boundMaterial = nullptr;
+	const VulkanMesh* boundMesh = nullptr;
+	for (uint32_t index : m_drawList.GetVisible(DrawPass::Forward)) {
+		const DrawList::DrawCall& drawCall = m_drawList.GetDrawCalls()[index];
+		if (drawCall.Pipeline != boundPipeline) {
+			cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, drawCall.Pipeline->Get());
+			cmd.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				drawCall.Pipeline->GetLayout(),
+				0,
+				m_uniformBufferSet.GetDescriptorSet(),
+				m_uniformBufferSet.GetDynamicOffsets(bufferingIndex)
+			);
+			cmd.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				drawCall.Pipeline->GetLayout(),
+				2,
+				{ m_iblTextureSet, m_shadowContext.GetTextureSet(bufferingIndex) },
+				{}
+			);
+			boundPipeline = drawCall.Pipeline;
+			boundMaterial = nullptr;
+			boundMesh = nullptr;
+		}
+		if (drawCall.Material != boundMaterial) {
+			cmd.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics, //
+				boundPipeline->GetLayout(),
+				1,
+				drawCall.Material->DescriptorSet,
+				{}
+			);
+			boundMaterial = drawCall.Material;
+		}
 		cmd.pushConstants(
-			m_baseForwardPipeline.GetLayout(), //
+			boundPipeline->GetLayout(), //
 			vk::ShaderStageFlagBits::eVertex,
 			0,
 			sizeof(glm::mat4),
 			glm::value_ptr(drawCall.ModelMatrix)
 		);
-		drawCall.Mesh->BindAndDraw(cmd);
+		if (drawCall.Mesh != boundMesh) {
+			drawCall.Mesh->Bind(cmd);
+			boundMesh = drawCall.Mesh;
+		}
+		drawCall.Mesh->Draw(cmd);
 	}
-	m_forwardDrawCalls.clear();
 
 	cmd.endRenderPass();
 }
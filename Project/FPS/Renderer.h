@@ -2,6 +2,8 @@
 
 #include "VulkanRender.h"
 #include "EngineMath.h"
+#include "LightClusters.h"
+#include "ShadowCascades.h"
 
 #pragma region DeferredFramebuffer
 
@@ -409,6 +411,7 @@ struct PbrMaterial final
 	vk::DescriptorSet DescriptorSet;
 	bool              Transparent = false;
 	bool              Shadow = true;
+	uint32_t          Id = 0; // load order in PbrMaterialCache, used for draw sorting
 };
 
 class PbrMaterialCache final
@@ -483,6 +486,77 @@ void AppendBoxVertices(std::vector<VertexBase>& vertices, const glm::vec3& min,
 
 #pragma endregion
 
+#pragma region DrawList
+
+enum class DrawPass : uint8_t
+{
+	Deferred,
+	Forward,
+
+	Count
+};
+
+struct DrawListStats final
+{
+	uint32_t Submitted = 0;       // Draws left after culling
+	uint32_t Culled = 0;          // Draws outside the camera frustum
+	uint32_t PipelineChanges = 0;
+	uint32_t MaterialChanges = 0;
+	uint32_t MeshChanges = 0;
+};
+
+// Collects the draw calls of a frame, culls them against the camera frustum and orders them by 64-bit sort keys.
+// Key from the high bits: pass, pipeline, then material, mesh and front-to-back depth for opaque draws,
+// or back-to-front depth, material and mesh for transparent draws.
+class DrawList final
+{
+public:
+	struct DrawCall final
+	{
+		const VulkanMesh*     Mesh;
+		glm::mat4             ModelMatrix;
+		const PbrMaterial*    Material;
+		const VulkanPipeline* Pipeline;
+	};
+
+	void Add(const VulkanMesh* mesh, const glm::mat4& modelMatrix, const PbrMaterial* material, const VulkanPipeline* pipeline)
+	{
+		m_drawCalls.push_back({ mesh, modelMatrix, material, pipeline });
+	}
+
+	void Build(const glm::mat4& view, const glm::mat4& projection);
+	void Clear();
+
+	// Every draw call in submission order, culling is camera specific so shadow passes use these.
+	[[nodiscard]] const std::vector<DrawCall>& GetDrawCalls() const { return m_drawCalls; }
+	// Sorted indices into GetDrawCalls() of the visible draw calls of the pass.
+	[[nodiscard]] std::span<const uint32_t> GetVisible(DrawPass pass) const;
+
+	[[nodiscard]] const DrawListStats& GetStats(DrawPass pass) const { return m_stats[static_cast<size_t>(pass)]; }
+
+	// World space box of the draw call, returns false (and the model origin as center) if the mesh has no bounds.
+	static bool CalcWorldBox(const DrawCall& drawCall, glm::vec3& center, glm::vec3& halfSize);
+
+private:
+	struct SortItem final
+	{
+		uint64_t Key;
+		uint32_t Index;
+	};
+
+	static uint64_t MakeSortKey(DrawPass pass, const DrawCall& drawCall, float viewDepth);
+	static void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+
+	std::vector<DrawCall> m_drawCalls;
+	std::vector<SortItem> m_sortItems;
+	std::vector<SortItem> m_sortScratch;
+	std::vector<uint32_t> m_visible;
+	size_t                m_passOffsets[static_cast<size_t>(DrawPass::Count) + 1] = {};
+	DrawListStats         m_stats[static_cast<size_t>(DrawPass::Count)];
+};
+
+#pragma endregion
+
 #pragma region PbrRenderer
 
 struct alignas(256) RendererUniformData final
@@ -495,21 +569,6 @@ struct alignas(256) RendererUniformData final
 	glm::vec4              ScaledScreenInfo;
 };
 
-struct alignas(16) PointLightData final
-{
-	glm::vec3              Position;
-	[[maybe_unused]] float Radius;
-	glm::vec3              Color;
-	[[maybe_unused]] float Padding;
-
-	PointLightData() = default;
-	PointLightData(const glm::vec3& position, float radius, const glm::vec3& color)
-		: Position(position)
-		, Radius(radius)
-		, Color(color)
-		, Padding(0.0f) {}
-};
-
 struct alignas(256) LightingUniformData final
 {
 	glm::vec3              LightDirection;
@@ -519,7 +578,7 @@ struct alignas(256) LightingUniformData final
 	glm::vec3              CascadeShadowMapSplits;
 	[[maybe_unused]] float Padding1;
 	glm::mat4              ShadowMatrices[4];
-	PointLightData         PointLights[128];
+	glm::vec4              LightClusterParams; // LightClusterBuilder::GetClusterParams()
 };
 
 class PbrRenderer final
@@ -541,7 +600,9 @@ public:
 
 	void WaitDeviceIdle() { m_device.GetInstance().WaitIdle(); }
 
-	VulkanMesh CreateMesh(const std::vector<VertexBase>& vertices) { return { m_device, vertices.size(), sizeof(VertexBase), vertices.data() }; }
+	VulkanMesh CreateMesh(const std::vector<VertexBase>& vertices) { return { m_device, vertices }; }
+
+	VulkanMesh CreateMesh(const std::vector<VertexBase>& vertices, const std::vector<uint32_t>& indices) { return { m_device, vertices, indices }; }
 
 	VulkanMesh* LoadObjMesh(const std::string& objFilename) { return m_meshCache.LoadObjMesh(objFilename); }
 
@@ -558,18 +619,14 @@ public:
 
 	void SetWorldBounds(const glm::vec3& min, const glm::vec3& max);
 
+	// The shadow map resolution is taken from the shadow context, settings.Resolution is ignored.
+	void SetShadowSettings(const ShadowCascadeSettings& settings) { m_shadowSettings = settings; }
+
 	void DrawPointLight(const glm::vec3& position, const glm::vec3& color, float radius) { m_pointLights.emplace_back(position, radius, color); }
 
 	void Draw(const VulkanMesh* mesh, const glm::mat4& modelMatrix, const PbrMaterial* material)
 	{
-		if (material->Transparent)
-		{
-			m_forwardDrawCalls.emplace_back(mesh, modelMatrix, material);
-		}
-		else
-		{
-			m_deferredDrawCalls.emplace_back(mesh, modelMatrix, material);
-		}
+		m_drawList.Add(mesh, modelMatrix, material, material->Transparent ? &m_baseForwardPipeline : &m_basePipeline);
 	}
 
 	void DrawScreenRect(
@@ -588,6 +645,9 @@ public:
 
 	void FinishDrawing();
 
+	[[nodiscard]] const LightClusterBuilder& GetLightClusters() const { return m_lightClusters; }
+	[[nodiscard]] const DrawListStats& GetDrawStats(DrawPass pass) const { return m_drawList.GetStats(pass); }
+
 private:
 	void CreateUniformBuffers();
 	void CreateIblTextureSet();
@@ -611,7 +671,10 @@ private:
 	DeferredContext       m_deferredContext;
 	PostProcessingContext m_toneMappingContext;
 
-	ShadowMatrixCalculator m_shadowMatrixCalculator;
+	ShadowCascades            m_shadowCascades;
+	ShadowCascadeSettings     m_shadowSettings;
+	std::vector<ShadowCaster> m_shadowCasters;
+	std::vector<uint32_t>     m_shadowCasterDraws; // Index into the draw list of every shadow caster
 
 	RendererUniformData    m_rendererUniformData{};
 	LightingUniformData    m_lightingUniformData{};
@@ -621,6 +684,12 @@ private:
 	vk::DescriptorSet       m_iblTextureSet;
 
 	// shadow pass
+	struct ShadowPushConstants final
+	{
+		glm::mat4 ModelMatrix;
+		uint32_t  CascadeMask; // Cascades the caster is drawn to, bit per shadow map layer
+	};
+
 	VulkanPipeline m_shadowPipeline;
 
 	// deferred pass
@@ -645,20 +714,9 @@ private:
 	VulkanMesh m_screenLineMesh;
 
 	std::vector<PointLightData> m_pointLights;
+	LightClusterBuilder         m_lightClusters;
 
-	struct DrawCall {
-		const VulkanMesh* Mesh;
-		glm::mat4          ModelMatrix;
-		const PbrMaterial* Material;
-
-		DrawCall(const VulkanMesh* mesh, const glm::mat4& modelMatrix, const PbrMaterial* material)
-			: Mesh(mesh)
-			, ModelMatrix(modelMatrix)
-			, Material(material) {}
-	};
-
-	std::vector<DrawCall> m_deferredDrawCalls;
-	std::vector<DrawCall> m_forwardDrawCalls;
+	DrawList m_drawList;
 
 	struct ScreenRectDrawCall {
 		glm::vec2              PMin;
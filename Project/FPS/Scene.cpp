@@ -61,6 +61,20 @@ void ALightPoint::Draw()
 
 #pragma endregion
 
+#pragma region Actor
+
+void Actor::Destroy()
+{
+	if (m_pendingDestroy)
+		return;
+
+	m_pendingDestroy = true;
+	if (m_scene)
+		m_scene->onActorDestroyed(this);
+}
+
+#pragma endregion
+
 #pragma region Scene
 
 void Scene::Update(const float deltaTime)
@@ -68,73 +82,107 @@ void Scene::Update(const float deltaTime)
 	// put pending destroy actors from last frame into a temp queue
 	const std::vector<std::unique_ptr<Actor>> pendingDestroyActorsFromLastFrame = std::move(m_pendingDestroyActors);
 
-	// update all alive actors
-	std::vector<std::unique_ptr<Actor>> aliveActors;
-	aliveActors.reserve(m_actors.size());
-	for (auto& actor : m_actors)
-	{
-		actor->Update(deltaTime);
-		if (actor->IsPendingDestroy())
-		{
-			// put pending destroy actors in this frame into m_pendingDestroyActors
-			m_pendingDestroyActors.push_back(std::move(actor));
-		}
-		else
-		{
-			aliveActors.push_back(std::move(actor));
-		}
-	}
-	m_actors = std::move(aliveActors);
+	// only actors that override Update are in the list, actors created during the update are ticked from the next frame
+	const size_t updateCount = m_updateActors.size();
+	for (size_t i = 0; i < updateCount; i++)
+		m_updateActors[i]->Update(deltaTime);
+
+	// put actors destroyed in this frame into m_pendingDestroyActors
+	removeDestroyedActors();
 
-	// pendingDestroyActorsFromLastFrame deconstructs and releases all pending destroy actors destroy pending destroy actors from last frame this strategy will give other actors one frame to cleanup their references
+	// pendingDestroyActorsFromLastFrame deconstructs and releases all pending destroy actors from last frame, this strategy will give other actors one frame to cleanup their references
 }
 
 void Scene::FixedUpdate(float fixedDeltaTime)
 {
-	for (auto& actor : m_actors)
-		actor->FixedUpdate(fixedDeltaTime);
+	const size_t fixedUpdateCount = m_fixedUpdateActors.size();
+	for (size_t i = 0; i < fixedUpdateCount; i++)
+		m_fixedUpdateActors[i]->FixedUpdate(fixedDeltaTime);
 }
 
 void Scene::Draw()
 {
-	for (auto& actor : m_actors)
+	for (Actor* actor : m_drawActors)
 		actor->Draw();
 }
 
 void Scene::Register(const std::string& name, Actor* actor)
 {
-	auto pair = m_registeredActors.find(name);
-	if (pair == m_registeredActors.end())
-	{
-		m_registeredActors.emplace(name, actor);
-	}
-	else
+	if (!m_registeredActors.try_emplace(name, actor).second)
 	{
 		Error("Failed to register actor \"" + name + "\" because the name is already registered.");
 	}
 }
 
-Actor* Scene::FindActorWithName(const std::string& name) const
+Actor* Scene::FindActorWithName(std::string_view name) const
 {
 	auto pair = m_registeredActors.find(name);
 	if (pair == m_registeredActors.end())
 	{
-		Error("Failed to find actor \"" + name + "\"");
+		Error("Failed to find actor \"" + std::string(name) + "\"");
 		return nullptr;
 	}
 	return pair->second;
 }
 
-Actor* Scene::findFirstActorOfClassImpl(const std::string& className) const
+void Scene::addActor(std::unique_ptr<Actor> actor, uint8_t tickFlags)
+{
+	Actor* actorRef = actor.get();
+	actorRef->m_scene = this;
+	actorRef->m_sceneIndex = m_actors.size();
+	m_actors.emplace_back(std::move(actor));
+
+	// destroyed before it was added (in its constructor), nobody could queue it then. It never ticks and goes out
+	// with the actors destroyed this frame
+	if (actorRef->m_pendingDestroy)
+	{
+		onActorDestroyed(actorRef);
+		return;
+	}
+
+	if (tickFlags & TICK_UPDATE)
+		m_updateActors.push_back(actorRef);
+	if (tickFlags & TICK_FIXED_UPDATE)
+		m_fixedUpdateActors.push_back(actorRef);
+	if (tickFlags & TICK_DRAW)
+		m_drawActors.push_back(actorRef);
+
+	m_actorsByClass[actorRef->GetActorTypeId()].push_back(actorRef);
+}
+
+void Scene::removeDestroyedActors()
 {
-	for (auto& actor : m_actors)
+	if (m_destroyedActors.empty())
+		return;
+
+	for (Actor* actor : m_destroyedActors)
 	{
-		if (actor->GetActorClassName() == className)
+		// move the last actor into the hole, m_actors has no order to keep
+		const size_t index = actor->m_sceneIndex;
+		m_pendingDestroyActors.push_back(std::move(m_actors[index]));
+		if (index != m_actors.size() - 1)
 		{
-			return actor.get();
+			m_actors[index] = std::move(m_actors.back());
+			m_actors[index]->m_sceneIndex = index;
 		}
+		m_actors.pop_back();
 	}
-	return nullptr;
+	m_destroyedActors.clear();
+
+	// one compaction per list for all actors destroyed this frame, the actors are still alive until the next update
+	const auto isPendingDestroy = [](const Actor* actor) { return actor->IsPendingDestroy(); };
+	std::erase_if(m_updateActors, isPendingDestroy);
+	std::erase_if(m_fixedUpdateActors, isPendingDestroy);
+	std::erase_if(m_drawActors, isPendingDestroy);
+	for (auto& [typeId, actors] : m_actorsByClass)
+		std::erase_if(actors, isPendingDestroy);
+	std::erase_if(m_registeredActors, [](const auto& pair) { return pair.second->IsPendingDestroy(); });
+}
+
+const std::vector<Actor*>* Scene::findActorsOfClassImpl(ActorTypeId typeId) const
+{
+	const auto pair = m_actorsByClass.find(typeId);
+	return pair != m_actorsByClass.end() ? &pair->second : nullptr;
 }
 
 #pragma endregion
\ No newline at end of file
@@ -4,16 +4,30 @@
 
 #pragma region Actor
 
-#define DEFINE_ACTOR_CLASS(className)                        \
-	className(const className &) = delete;                   \
-	className &operator=(const className &) = delete;        \
-	className(className &&) = delete;                        \
-	className &operator=(className &&) = delete;             \
-	static inline const std::string &ClassName = #className; \
-	const std::string &GetActorClassName() const override {  \
-		return ClassName;                                    \
+using ActorTypeId = uint64_t;
+
+// Hash of the class name, DEFINE_ACTOR_CLASS evaluates it at compile time.
+constexpr ActorTypeId MakeActorTypeId(std::string_view className)
+{
+	return HashString(className);
+}
+
+#define DEFINE_ACTOR_CLASS(className)                                        \
+	className(const className &) = delete;                                   \
+	className &operator=(const className &) = delete;                        \
+	className(className &&) = delete;                                        \
+	className &operator=(className &&) = delete;                             \
+	static inline const std::string &ClassName = #className;                 \
+	static constexpr ActorTypeId TypeId = MakeActorTypeId(#className);       \
+	const std::string &GetActorClassName() const override {                  \
+		return ClassName;                                                    \
+	}                                                                        \
+	ActorTypeId GetActorTypeId() const override {                            \
+		return TypeId;                                                       \
 	}
 
+class Scene;
+
 class Actor
 {
 public:
@@ -26,17 +40,25 @@ public:
 	Actor& operator=(Actor&&) = delete;
 
 	[[nodiscard]] virtual const std::string& GetActorClassName() const = 0;
+	[[nodiscard]] virtual ActorTypeId GetActorTypeId() const = 0;
 
+	// Exact class match, like comparing GetActorClassName() but without the string compare.
 	template<class T>
 	[[nodiscard]] bool IsClass() const
 	{
-		return T::ClassName == GetActorClassName();
+		return GetActorTypeId() == T::TypeId;
 	}
 
 	template<class T>
 	T* Cast()
 	{
-		return IsClass<T>() ? reinterpret_cast<T*>(this) : nullptr;
+		return IsClass<T>() ? static_cast<T*>(this) : nullptr;
+	}
+
+	template<class T>
+	const T* Cast() const
+	{
+		return IsClass<T>() ? static_cast<const T*>(this) : nullptr;
 	}
 
 	virtual void Update([[maybe_unused]] float deltaTime) {}
@@ -54,15 +76,20 @@ public:
 
 	[[nodiscard]] bool IsPendingDestroy() const { return m_pendingDestroy; }
 
-	void Destroy() { m_pendingDestroy = true; }
+	void Destroy();
 
 	const Transform& GetTransform() const { return m_transform; }
 
 	Transform& GetTransform() { return m_transform; }
 
 private:
+	friend class Scene;
+
 	bool      m_pendingDestroy = false;
 	Transform m_transform{};
+
+	Scene* m_scene = nullptr;
+	size_t m_sceneIndex = 0; // Index in Scene::m_actors
 };
 
 #pragma endregion
@@ -123,27 +150,82 @@ public:
 	{
 		std::unique_ptr<T> actor = std::make_unique<T>(std::forward<Args>(args)...);
 		T* actorRef = actor.get();
-		m_actors.emplace_back(std::move(actor));
+		addActor(std::move(actor), getTickFlags<T>());
 		return actorRef;
 	}
 
 	template<class T>
 	[[nodiscard]] T* FindFirstActorOfClass() const
 	{
-		return reinterpret_cast<T*>(findFirstActorOfClassImpl(T::ClassName));
+		const std::vector<Actor*>* actors = findActorsOfClassImpl(T::TypeId);
+		return actors && !actors->empty() ? static_cast<T*>(actors->front()) : nullptr;
+	}
+
+	// Calls func(T*) for every actor of exactly class T, in creation order.
+	template<class T, class Func>
+	void ForEachActorOfClass(Func&& func) const
+	{
+		if (const std::vector<Actor*>* actors = findActorsOfClassImpl(T::TypeId))
+		{
+			for (Actor* actor : *actors)
+				func(static_cast<T*>(actor));
+		}
 	}
 
 	void Register(const std::string& name, Actor* actor);
 
-	[[nodiscard]] Actor* FindActorWithName(const std::string& name) const;
+	[[nodiscard]] Actor* FindActorWithName(std::string_view name) const;
+
+	[[nodiscard]] size_t GetActorCount() const { return m_actors.size(); }
 
 private:
-	[[nodiscard]] Actor* findFirstActorOfClassImpl(const std::string& className) const;
+	friend class Actor;
 
-	std::vector<std::unique_ptr<Actor>> m_actors;
+	enum TickFlags : uint8_t
+	{
+		TICK_UPDATE = 1 << 0,
+		TICK_FIXED_UPDATE = 1 << 1,
+		TICK_DRAW = 1 << 2,
+	};
+
+	// A member function pointer has the type of the class that declared the function,
+	// so T only gets into a tick list if it or a base between it and Actor overrides the function.
+	template<class T>
+	static constexpr uint8_t getTickFlags()
+	{
+		uint8_t flags = 0;
+		if constexpr (!std::is_same_v<decltype(&T::Update), decltype(&Actor::Update)>)
+			flags |= TICK_UPDATE;
+		if constexpr (!std::is_same_v<decltype(&T::FixedUpdate), decltype(&Actor::FixedUpdate)>)
+			flags |= TICK_FIXED_UPDATE;
+		if constexpr (!std::is_same_v<decltype(&T::Draw), decltype(&Actor::Draw)>)
+			flags |= TICK_DRAW;
+		return flags;
+	}
+
+	struct NameHash final
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+	};
+
+	void addActor(std::unique_ptr<Actor> actor, uint8_t tickFlags);
+	void onActorDestroyed(Actor* actor) { m_destroyedActors.push_back(actor); }
+	void removeDestroyedActors();
+
+	[[nodiscard]] const std::vector<Actor*>* findActorsOfClassImpl(ActorTypeId typeId) const;
+
+	std::vector<std::unique_ptr<Actor>> m_actors; // Unordered, the tick lists and class buckets keep creation order
 	std::vector<std::unique_ptr<Actor>> m_pendingDestroyActors;
+	std::vector<Actor*>                 m_destroyedActors; // Destroyed since the last Update
+
+	std::vector<Actor*> m_updateActors;
+	std::vector<Actor*> m_fixedUpdateActors;
+	std::vector<Actor*> m_drawActors;
+
+	std::unordered_map<ActorTypeId, std::vector<Actor*>> m_actorsByClass;
 
-	std::map<std::string, Actor*> m_registeredActors;
+	std::unordered_map<std::string, Actor*, NameHash, std::equal_to<>> m_registeredActors;
 };
 
 #pragma endregion
\ No newline at end of file
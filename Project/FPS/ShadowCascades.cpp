@@ -0,0 +1,167 @@
+#include "Base.h"
+#include "Core.h"
+#include "EngineMath.h"
+#include "ShadowCascades.h"
+
+#pragma region ShadowCascades
+
+void ShadowCascades::SetCamera(const glm::mat4& view, float fovY, float aspectRatio)
+{
+	m_inverseView = glm::inverse(view);
+	m_tanHalfFovY = glm::tan(fovY * 0.5f);
+	m_aspectRatio = aspectRatio;
+}
+
+void ShadowCascades::SetLightDirection(const glm::vec3& lightDirection)
+{
+	// the snapped centers are in light space
+	if (lightDirection != m_lightDirection)
+		m_snappedTexelSizes.fill(0.0f);
+	m_lightDirection = lightDirection;
+}
+
+void ShadowCascades::SetWorldBounds(const glm::vec3& min, const glm::vec3& max)
+{
+	m_worldMin = min;
+	m_worldMax = max;
+}
+
+void ShadowCascades::Update(std::span<const ShadowCaster> casters, uint32_t slot)
+{
+	calcSplits();
+
+	std::array<Frustum, CASCADE_COUNT> frustums;
+	std::array<uint64_t, CASCADE_COUNT> hashes;
+	for (uint32_t cascade = 0; cascade < CASCADE_COUNT; cascade++)
+	{
+		m_shadowMatrices[cascade] = calcShadowMatrix(cascade);
+		frustums[cascade] = Frustum(m_shadowMatrices[cascade]);
+		hashes[cascade] = HashBytes(&m_shadowMatrices[cascade], sizeof(glm::mat4));
+		m_casterCounts[cascade] = 0;
+	}
+
+	// a cascade's depth only depends on its matrix and on the casters inside it, in order
+	m_casterMasks.resize(casters.size());
+	for (size_t i = 0; i < casters.size(); i++)
+	{
+		const ShadowCaster& caster = casters[i];
+		uint8_t mask = 0;
+		for (uint32_t cascade = 0; cascade < CASCADE_COUNT; cascade++)
+		{
+			if (!frustums[cascade].Intersects(caster.Center, caster.HalfSize))
+				continue;
+
+			mask |= static_cast<uint8_t>(1u << cascade);
+			hashes[cascade] = HashBytes(&caster.Hash, sizeof(caster.Hash), hashes[cascade]);
+			m_casterCounts[cascade]++;
+		}
+		m_casterMasks[i] = mask;
+	}
+
+	if (slot >= m_slots.size())
+		m_slots.resize(slot + 1);
+	SlotState& state = m_slots[slot];
+
+	m_redrawMask = 0;
+	for (uint32_t cascade = 0; cascade < CASCADE_COUNT; cascade++)
+	{
+		const uint8_t bit = static_cast<uint8_t>(1u << cascade);
+		if (!(state.ValidMask & bit) || state.Hashes[cascade] != hashes[cascade])
+			m_redrawMask |= bit;
+		state.Hashes[cascade] = hashes[cascade];
+	}
+	state.ValidMask = static_cast<uint8_t>((1u << CASCADE_COUNT) - 1);
+}
+
+uint64_t ShadowCascades::HashCaster(const void* mesh, const glm::mat4& modelMatrix)
+{
+	const uint64_t hash = HashBytes(&mesh, sizeof(mesh));
+	return HashBytes(glm::value_ptr(modelMatrix), sizeof(glm::mat4), hash);
+}
+
+void ShadowCascades::calcSplits()
+{
+	const float near = m_settings.Near;
+	const float far = m_settings.Far;
+	for (uint32_t i = 0; i <= CASCADE_COUNT; i++)
+	{
+		const float t = static_cast<float>(i) / static_cast<float>(CASCADE_COUNT);
+		const float uniformSplit = near + (far - near) * t;
+		const float logSplit = near * glm::pow(far / near, t);
+		m_splits[i] = glm::mix(uniformSplit, logSplit, m_settings.SplitLambda);
+	}
+}
+
+glm::mat4 ShadowCascades::calcShadowMatrix(uint32_t cascade)
+{
+	// corners of the camera frustum slice, view space has +z forward
+	std::array<glm::vec3, 8> corners;
+	size_t cornerIndex = 0;
+	for (const float depth : { m_splits[cascade], m_splits[cascade + 1] })
+	{
+		const float halfHeight = depth * m_tanHalfFovY;
+		const float halfWidth = halfHeight * m_aspectRatio;
+		for (const float y : { -1.0f, 1.0f })
+		{
+			for (const float x : { -1.0f, 1.0f })
+			{
+				corners[cornerIndex++] = glm::vec3(m_inverseView * glm::vec4(x * halfWidth, y * halfHeight, depth, 1.0f));
+			}
+		}
+	}
+
+	// a bounding sphere keeps the projection size fixed while the camera turns
+	glm::vec3 center(0.0f);
+	for (const glm::vec3& corner : corners)
+		center += corner;
+	center /= static_cast<float>(corners.size());
+
+	float radius = 0.0f;
+	for (const glm::vec3& corner : corners)
+		radius = glm::max(radius, glm::length(corner - center));
+	radius = glm::ceil(radius * 16.0f) / 16.0f;
+
+	const glm::vec3 forward = -glm::normalize(m_lightDirection);
+	const glm::vec3 up = glm::abs(forward.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), forward, up);
+
+	// moving the projection in whole texels keeps shadow edges from crawling when the camera moves.
+	// The last position is kept until the center is a whole texel away, so a camera bobbing around a texel edge
+	// doesn't move the projection (and redraw the cascade) every frame.
+	const float texelSize = 2.0f * radius / static_cast<float>(m_settings.Resolution);
+	glm::vec3 lightCenter = lightView * glm::vec4(center, 1.0f);
+	glm::vec2& snappedCenter = m_snappedCenters[cascade];
+	if (m_snappedTexelSizes[cascade] != texelSize || glm::any(glm::greaterThanEqual(glm::abs(glm::vec2(lightCenter) - snappedCenter), glm::vec2(texelSize))))
+	{
+		snappedCenter = glm::round(glm::vec2(lightCenter) / texelSize) * texelSize;
+		m_snappedTexelSizes[cascade] = texelSize;
+	}
+	lightCenter.x = snappedCenter.x;
+	lightCenter.y = snappedCenter.y;
+
+	// the depth range covers the whole world, so casters between the light and the cascade are kept
+	float minZ = lightCenter.z - radius;
+	float maxZ = lightCenter.z + radius;
+	for (int i = 0; i < 8; i++)
+	{
+		const glm::vec3 worldCorner{
+			(i & 1) ? m_worldMax.x : m_worldMin.x,
+			(i & 2) ? m_worldMax.y : m_worldMin.y,
+			(i & 4) ? m_worldMax.z : m_worldMin.z };
+		const float z = (lightView * glm::vec4(worldCorner, 1.0f)).z;
+		minZ = glm::min(minZ, z);
+		maxZ = glm::max(maxZ, z);
+	}
+	// whole units, so small camera moves don't change the matrix
+	minZ = glm::floor(minZ);
+	maxZ = glm::ceil(maxZ);
+
+	const glm::mat4 projection = glm::ortho(
+		lightCenter.x - radius, lightCenter.x + radius,
+		lightCenter.y - radius, lightCenter.y + radius,
+		minZ, maxZ
+	);
+	return projection * lightView;
+}
+
+#pragma endregion
@@ -0,0 +1,78 @@
+#pragma once
+
+#pragma region ShadowCascades
+
+struct ShadowCascadeSettings final
+{
+	float    Near = 0.01f;       // View depth where the first cascade starts
+	float    Far = 64.0f;        // View depth where the last cascade ends
+	float    SplitLambda = 0.5f; // Split scheme: 0 is uniform, 1 is logarithmic, in between blends both
+	uint32_t Resolution = 4096;  // Shadow map size in texels, projections are snapped to this texel grid
+};
+
+// World space box of a shadow caster and a hash of everything that changes its depth (mesh and transform).
+struct ShadowCaster final
+{
+	glm::vec3 Center;
+	glm::vec3 HalfSize;
+	uint64_t  Hash;
+};
+
+// Computes texel-snapped cascade matrices for the directional light, assigns casters to the cascades they overlap
+// and tracks which cascades of each shadow map have to be redrawn.
+// Shadow maps are indexed by slot (the buffering index), each slot remembers what its layers were last drawn with.
+// Has no GPU dependencies, so it can be run on its own.
+class ShadowCascades final
+{
+public:
+	static constexpr uint32_t CASCADE_COUNT = 4;
+
+	void SetSettings(const ShadowCascadeSettings& settings) { m_settings = settings; }
+	void SetCamera(const glm::mat4& view, float fovY, float aspectRatio);
+	void SetLightDirection(const glm::vec3& lightDirection);
+	void SetWorldBounds(const glm::vec3& min, const glm::vec3& max);
+
+	// Computes the cascades for this frame and the layers of the slot's shadow map that are out of date.
+	// The caller must redraw every layer in GetRedrawMask(), they are considered up to date afterwards.
+	void Update(std::span<const ShadowCaster> casters, uint32_t slot);
+
+	[[nodiscard]] const glm::mat4& GetShadowMatrix(uint32_t cascade) const { return m_shadowMatrices[cascade]; }
+	// View depth where each cascade but the last one ends
+	[[nodiscard]] glm::vec3 GetSplits() const { return { m_splits[1], m_splits[2], m_splits[3] }; }
+	// Bit per cascade the caster overlaps, indexed like the casters passed to Update
+	[[nodiscard]] const std::vector<uint8_t>& GetCasterMasks() const { return m_casterMasks; }
+	[[nodiscard]] uint8_t GetRedrawMask() const { return m_redrawMask; }
+	[[nodiscard]] uint32_t GetCasterCount(uint32_t cascade) const { return m_casterCounts[cascade]; }
+
+	static uint64_t HashCaster(const void* mesh, const glm::mat4& modelMatrix);
+
+private:
+	struct SlotState final
+	{
+		std::array<uint64_t, CASCADE_COUNT> Hashes{};
+		uint8_t                             ValidMask = 0;
+	};
+
+	void calcSplits();
+	[[nodiscard]] glm::mat4 calcShadowMatrix(uint32_t cascade);
+
+	ShadowCascadeSettings m_settings;
+
+	glm::mat4 m_inverseView{ 1.0f };
+	float     m_tanHalfFovY = 1.0f;
+	float     m_aspectRatio = 1.0f;
+	glm::vec3 m_lightDirection{ 0.0f, 1.0f, 0.0f }; // Points towards the light
+	glm::vec3 m_worldMin{ 0.0f };
+	glm::vec3 m_worldMax{ 0.0f };
+
+	std::array<float, CASCADE_COUNT + 1>     m_splits{};
+	std::array<glm::mat4, CASCADE_COUNT>     m_shadowMatrices{};
+	std::array<uint32_t, CASCADE_COUNT>      m_casterCounts{};
+	std::array<glm::vec2, CASCADE_COUNT>     m_snappedCenters{};    // Light space projection centers on the texel grid
+	std::array<float, CASCADE_COUNT>         m_snappedTexelSizes{}; // Grid of each snapped center, 0 if there is none yet
+	std::vector<uint8_t>                     m_casterMasks;
+	std::vector<SlotState>                   m_slots;
+	uint8_t                                  m_redrawMask = 0;
+};
+
+#pragma endregion
@@ -142,6 +142,8 @@ vk::RenderPass VulkanRender::CreateRenderPass(
 
 	if (depthStencilAttachmentFormat != vk::Format::eUndefined)
 	{
+		// a depth attachment read by shaders is kept in the shader read layout between passes
+		const vk::ImageLayout depthLayout = options.ShaderReadsDepth ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eDepthStencilAttachmentOptimal;
 		attachments.emplace_back(
 			vk::AttachmentDescriptionFlags{},
 			depthStencilAttachmentFormat,
@@ -150,8 +152,8 @@ vk::RenderPass VulkanRender::CreateRenderPass(
 			vk::AttachmentStoreOp::eStore,
 			vk::AttachmentLoadOp::eDontCare,
 			vk::AttachmentStoreOp::eDontCare,
-			options.PreserveDepth ? vk::ImageLayout::eDepthStencilAttachmentOptimal : vk::ImageLayout::eUndefined,
-			options.ShaderReadsDepth ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eDepthStencilAttachmentOptimal
+			options.PreserveDepth ? depthLayout : vk::ImageLayout::eUndefined,
+			depthLayout
 		);
 
 		depthStencilAttachmentRef = { attachmentIndex, vk::ImageLayout::eDepthStencilAttachmentOptimal };
@@ -235,14 +237,15 @@ void VulkanRender::WriteCombinedImageSamplerToDescriptorSet(
 }
 
 void VulkanRender::WriteDynamicUniformBufferToDescriptorSet(
-	vk::Buffer        buffer,
-	vk::DeviceSize    size,
-	vk::DescriptorSet descriptorSet,
-	uint32_t          binding
+	vk::Buffer         buffer,
+	vk::DeviceSize     size,
+	vk::DescriptorSet  descriptorSet,
+	uint32_t           binding,
+	vk::DescriptorType type
 )
 {
 	const vk::DescriptorBufferInfo bufferInfo(buffer, 0, size);
-	const vk::WriteDescriptorSet   writeDescriptorSet(descriptorSet, binding, 0, vk::DescriptorType::eUniformBufferDynamic, {}, bufferInfo);
+	const vk::WriteDescriptorSet   writeDescriptorSet(descriptorSet, binding, 0, type, {}, bufferInfo);
 	WriteDescriptorSet(writeDescriptorSet);
 }
 
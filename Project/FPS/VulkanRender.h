@@ -126,7 +126,13 @@ public:
 
 	void WriteCombinedImageSamplerToDescriptorSet(vk::Sampler sampler, vk::ImageView imageView, vk::DescriptorSet descriptorSet, uint32_t binding);
 
-	void WriteDynamicUniformBufferToDescriptorSet(vk::Buffer buffer, vk::DeviceSize size, vk::DescriptorSet descriptorSet, uint32_t binding);
+	void WriteDynamicUniformBufferToDescriptorSet(
+		vk::Buffer         buffer,
+		vk::DeviceSize     size,
+		vk::DescriptorSet  descriptorSet,
+		uint32_t           binding,
+		vk::DescriptorType type = vk::DescriptorType::eUniformBufferDynamic
+	);
 
 	vk::PipelineLayout CreatePipelineLayout(
 		const std::initializer_list<vk::DescriptorSetLayout>& descriptorSetLayouts,
@@ -1,9 +1,17 @@
 ﻿#include "GameApp.h"
+#include "Benchmarks.h"
 //-----------------------------------------------------------------------------
 int main(
 	[[maybe_unused]] int   argc,
 	[[maybe_unused]] char* argv[])
 {
+	// FPS --bench <name|all> [args...]: runs CPU side checks and benchmarks without window and GPU and exits
+	if (argc >= 2 && std::string_view(argv[1]) == "--bench")
+	{
+		const std::vector<std::string> args(argv + std::min(argc, 3), argv + argc);
+		return RunBenchmarks(argc >= 3 ? argv[2] : "", args) ? 0 : 1;
+	}
+
 	if (EngineApp::Create({}))
 	{
 		if (GameApp::Create())
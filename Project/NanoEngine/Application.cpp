@@ -43,9 +43,11 @@ EngineApplication::EngineApplication()
 EngineApplication::~EngineApplication()
 {
 	m_physics.Shutdown();
-	m_render.Shutdown();
+	if (!IsHeadless())
+		m_render.Shutdown();
 	m_input.Shutdown();
 	m_window.Shutdown();
+	UnmountAllAssetPacks();
 	shutdownLog();
 }
 
@@ -58,6 +60,11 @@ void EngineApplication::Run()
 		return;
 
 	// Main Loop
+	if (IsHeadless())
+	{
+		runHeadless();
+	}
+	else
 	{
 		while (m_status == StatusApp::Success)
 		{
@@ -88,23 +95,33 @@ void EngineApplication::Run()
 			m_render.TestDraw();
 			Render();
 		}
+		m_render.WaitIdle();
 	}
-	m_render.WaitIdle();
 	Shutdown();
 }
 
 bool EngineApplication::setup()
 {
 	EngineApplicationCreateInfo createInfo = Config();
+	m_headless = createInfo.headless;
 
 	if (!initializeLog(createInfo.logFilePath))
 		return false;
 
-	if (!m_window.Setup(createInfo.window))
+	for (const std::filesystem::path& packPath : createInfo.assetPacks)
+	{
+		std::error_code errorCode;
+		if (std::filesystem::exists(packPath, errorCode) && !MountAssetPack(packPath))
+			return false;
+	}
+
+	if (IsHeadless())
+		m_window.SetupHeadless(createInfo.window);
+	else if (!m_window.Setup(createInfo.window))
 		return false;
 	if (!m_input.Setup())
 		return false;
-	if (!m_render.Setup(createInfo.render))
+	if (!IsHeadless() && !m_render.Setup(createInfo.render))
 		return false;
 	if (!m_physics.Setup(createInfo.physics))
 		return false;
@@ -118,11 +135,90 @@ bool EngineApplication::setup()
 	if (m_status != StatusApp::Success)
 		return false;
 
-	m_lastFrameTime = static_cast<float>(glfwGetTime());
+	m_lastFrameTime = IsHeadless() ? 0.0f : static_cast<float>(glfwGetTime());
 
 	return true;
 }
 
+void EngineApplication::runHeadless()
+{
+	struct FrameStats
+	{
+		Time fixedUpdateTime;
+		Time updateTime;
+		bool fixedStep = false;
+	};
+	std::vector<FrameStats> frames;
+	frames.reserve(m_headless.frameCount);
+
+	Print("Headless run: " + std::to_string(m_headless.frameCount) + " frames of " + std::to_string(m_headless.frameTime * 1000.0f) + " ms");
+	const Clock runClock;
+	for (uint32_t frame = 0; (frame < m_headless.frameCount) && (m_status == StatusApp::Success); ++frame)
+	{
+		// Same sequence as the windowed loop, only the clock advances by exactly frameTime every frame so that runs
+		// are reproducible no matter how long a frame takes to simulate
+		m_deltaTime = m_headless.frameTime;
+		m_lastFrameTime += m_deltaTime;
+		m_timeSinceLastTick += m_deltaTime;
+
+		FrameStats stats;
+		Clock      clock;
+		m_input.ClearState();
+		m_input.Update();
+
+		// Fixed Update
+		if (m_timeSinceLastTick >= m_fixedTimestep)
+		{
+			m_physics.FixedUpdate();
+			FixedUpdate(m_fixedTimestep);
+			m_timeSinceLastTick -= m_fixedTimestep;
+			stats.fixedStep = true;
+		}
+		stats.fixedUpdateTime = clock.Restart();
+
+		Update();
+		stats.updateTime = clock.GetElapsedTime();
+		frames.push_back(stats);
+	}
+	const Time runTime = runClock.GetElapsedTime();
+	if (frames.empty()) return;
+
+	std::vector<int64_t> frameTimes;
+	frameTimes.reserve(frames.size());
+	int64_t  fixedUpdateTotal = 0;
+	int64_t  updateTotal = 0;
+	uint32_t fixedSteps = 0;
+	for (const FrameStats& stats : frames)
+	{
+		frameTimes.push_back(stats.fixedUpdateTime.AsMicroseconds() + stats.updateTime.AsMicroseconds());
+		fixedUpdateTotal += stats.fixedUpdateTime.AsMicroseconds();
+		updateTotal += stats.updateTime.AsMicroseconds();
+		fixedSteps += stats.fixedStep ? 1 : 0;
+	}
+	std::sort(frameTimes.begin(), frameTimes.end());
+	const auto percentile = [&](size_t p) { return std::to_string(frameTimes[(frameTimes.size() - 1) * p / 100]); };
+	const int64_t frameCount = static_cast<int64_t>(frames.size());
+
+	Print("Headless run: " + std::to_string(frames.size()) + " frames (" + std::to_string(fixedSteps) + " fixed steps) simulating "
+		+ std::to_string(static_cast<float>(frames.size()) * m_headless.frameTime) + " s in " + std::to_string(runTime.AsMilliseconds()) + " ms");
+	Print("  frame us: avg " + std::to_string((fixedUpdateTotal + updateTotal) / frameCount) + ", min " + std::to_string(frameTimes.front())
+		+ ", p50 " + percentile(50) + ", p95 " + percentile(95) + ", p99 " + percentile(99) + ", max " + std::to_string(frameTimes.back()));
+	Print("  avg us: fixed update " + std::to_string(fixedUpdateTotal / frameCount) + ", update " + std::to_string(updateTotal / frameCount));
+
+	if (!m_headless.statsFilePath.empty())
+	{
+		std::ofstream file{ std::filesystem::path(m_headless.statsFilePath) };
+		if (!file.is_open())
+		{
+			Warning("Failed to write headless frame stats to '" + std::string(m_headless.statsFilePath) + "'.");
+			return;
+		}
+		file << "frame,fixed_step,fixed_update_us,update_us\n";
+		for (size_t i = 0; i < frames.size(); ++i)
+			file << i << ',' << (frames[i].fixedStep ? 1 : 0) << ',' << frames[i].fixedUpdateTime.AsMicroseconds() << ',' << frames[i].updateTime.AsMicroseconds() << '\n';
+	}
+}
+
 bool EngineApplication::initializeLog(std::string_view filePath)
 {
 	if (!filePath.empty())
@@ -7,12 +7,28 @@
 //=============================================================================
 #pragma region [ Create Application Info ]
 
+// Runs the application without a window, swapchain or render system. FixedUpdate and Update are driven by a
+// synthetic clock for frameCount frames, Render is never called. Setup() has to skip its GPU work (see
+// EngineApplication::IsHeadless), everything else - gameplay, physics, CPU side asset loading - runs as usual, so it
+// can be profiled on a machine without a GPU.
+struct HeadlessCreateInfo final
+{
+	bool             enable = false;
+	uint32_t         frameCount = 600;
+	float            frameTime = 1.0f / 60.0f;              // Simulated seconds per frame, independent of wall time
+	std::string_view statsFilePath = "HeadlessFrames.csv"; // Per frame timings, empty to only log the summary
+};
+
 struct EngineApplicationCreateInfo final
 {
 	std::string_view      logFilePath = "Log.txt";
+	// Mounted in order before anything loads, later packs take precedence. Missing packs are skipped, the loose
+	// files are used instead.
+	std::vector<std::filesystem::path> assetPacks;
 	WindowCreateInfo      window{};
 	vkr::RenderCreateInfo render{};
 	ph::PhysicsCreateInfo physics{};
+	HeadlessCreateInfo    headless{};
 };
 
 #pragma endregion
@@ -90,6 +106,8 @@ public:
 	bool IsWindowIconified() const;
 	bool IsWindowMaximized() const;
 
+	[[nodiscard]] bool IsHeadless() const { return m_headless.enable; }
+
 	[[nodiscard]] float GetDeltaTime() const { return m_deltaTime; }
 	[[nodiscard]] float GetFixedTimestep() const { return m_fixedTimestep; }
 	[[nodiscard]] float GetFixedUpdateTimeError() const { return m_timeSinceLastTick; }
@@ -97,6 +115,7 @@ public:
 
 private:
 	bool setup();
+	void runHeadless();
 
 	bool initializeLog(std::string_view filePath);
 	void shutdownLog();
@@ -125,6 +144,8 @@ private:
 	float             m_deltaTime{};
 	float             m_fixedTimestep{ 0.02f };
 	float             m_timeSinceLastTick{ 0.0f };
+
+	HeadlessCreateInfo m_headless{};
 };
 
 #pragma endregion
\ No newline at end of file
@@ -47,6 +47,7 @@
 #include <memory>
 #include <filesystem>
 #include <functional>
+#include <utility>
 #include <ostream>
 #include <fstream>
 #include <sstream>
@@ -56,6 +57,7 @@
 #include <span>
 #include <array>
 #include <deque>
+#include <list>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -64,6 +66,10 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <random>
 
 #define VK_NO_PROTOTYPES
 #include <vulkan/vulkan_core.h>
@@ -81,6 +87,11 @@
 #	include <ShellScalingApi.h>
 #endif
 
+#if defined(_M_X64) || defined(__SSE2__)
+#	include <emmintrin.h>
+#	define SIMD_SSE2 1
+#endif
+
 /*
 Left handed
 	Y   Z
@@ -1,6 +1,21 @@
 ﻿#include "stdafx.h"
 #include "Core.h"
 
+#if defined(_WIN32)
+#	include <Windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	define MAPPED_FILE_POSIX 1
+#endif
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#	include <linux/io_uring.h>
+#	include <sys/syscall.h>
+#	define ASYNC_IO_URING 1
+#endif
+
 //=============================================================================
 #pragma region [ Base Types ]
 
@@ -81,6 +96,161 @@ inline Time Clock::Reset()
 //=============================================================================
 #pragma region [ IO ]
 
+// Defined with the asset packs. ERROR_PATH_DOES_NOT_EXIST when no mounted pack holds path. Uncompressed entries come
+// back as a view into the pack and *pOwner keeps the pack alive, compressed ones are decompressed into *pBuffer.
+static Result FindInAssetPacks(const std::filesystem::path& path, std::shared_ptr<void>* pOwner, std::span<const char>* pView, std::vector<char>* pBuffer);
+
+// Maps the whole file read only and returns the base address, or nullptr when the file can't be mapped (empty files
+// included). The mapping is private, but the pages are shared with the OS cache until something writes to them,
+// which nothing does.
+static void* MapWholeFile(const std::filesystem::path& path, size_t* pSize)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+	void*         view = nullptr;
+	LARGE_INTEGER size = {};
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && static_cast<uint64_t>(size.QuadPart) <= SIZE_MAX)
+	{
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr)
+		{
+			view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping); // The view keeps the mapping object alive
+		}
+	}
+	CloseHandle(file);
+	if (view != nullptr) *pSize = static_cast<size_t>(size.QuadPart);
+	return view;
+#elif defined(MAPPED_FILE_POSIX)
+	const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return nullptr;
+
+	void*       view = nullptr;
+	struct stat info = {};
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+	{
+		view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED) view = nullptr;
+	}
+	close(fd); // The mapping holds its own reference to the file
+	if (view != nullptr) *pSize = static_cast<size_t>(info.st_size);
+	return view;
+#else
+	(void)path;
+	(void)pSize;
+	return nullptr;
+#endif
+}
+
+static void UnmapWholeFile(void* view, size_t size)
+{
+#if defined(_WIN32)
+	(void)size;
+	UnmapViewOfFile(view);
+#elif defined(MAPPED_FILE_POSIX)
+	munmap(view, size);
+#else
+	(void)view;
+	(void)size;
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		// Moving the vector keeps its storage, so m_data stays valid for the fallback buffer too
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_mapping = std::exchange(other.m_mapping, nullptr);
+		m_owner = std::move(other.m_owner);
+		m_buffer = std::move(other.m_buffer);
+		m_valid = std::exchange(other.m_valid, false);
+		other.m_buffer.clear();
+	}
+	return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path, bool readIfMapFails)
+{
+	Close();
+
+	std::span<const char> view;
+	const Result          packResult = FindInAssetPacks(path, &m_owner, &view, &m_buffer);
+	if (packResult != ERROR_PATH_DOES_NOT_EXIST)
+	{
+		if (Failed(packResult))
+		{
+			Error("Failed to read '" + path.string() + "' from its asset pack.");
+			Close();
+			return false;
+		}
+		m_data = view.data();
+		m_size = view.size();
+		m_valid = true;
+		return true;
+	}
+
+	size_t size = 0;
+	m_mapping = MapWholeFile(path, &size);
+	if (m_mapping != nullptr)
+	{
+		m_data = static_cast<const char*>(m_mapping);
+		m_size = size;
+		m_valid = true;
+		return true;
+	}
+	if (!readIfMapFails) return false;
+
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if (!stream.is_open()) return false;
+	const std::streamoff length = stream.tellg();
+	if (length < 0) return false;
+
+	m_buffer.resize(static_cast<size_t>(length));
+	stream.seekg(0, std::ios::beg);
+	if (!stream.read(m_buffer.data(), static_cast<std::streamsize>(length)))
+	{
+		m_buffer = {};
+		return false;
+	}
+
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+	m_valid = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_mapping != nullptr) UnmapWholeFile(m_mapping, m_size);
+	m_mapping = nullptr;
+	m_owner.reset();
+	m_buffer = {};
+	m_data = nullptr;
+	m_size = 0;
+	m_valid = false;
+}
+
+std::span<const char> MappedFile::GetView(size_t offset, size_t count) const
+{
+	offset = std::min(offset, m_size);
+	return { m_data + offset, std::min(count, m_size - offset) };
+}
+
 File::~File()
 {
 	m_stream.close();
@@ -88,6 +258,16 @@ File::~File()
 
 bool File::Open(const std::filesystem::path& path)
 {
+	m_stream.close();
+	m_stream.clear();
+	m_fileOffset = 0;
+
+	if (m_mapping.Open(path, false))
+	{
+		m_fileSize = m_mapping.GetLength();
+		return true;
+	}
+
 	m_stream.open(path, std::ios::binary);
 	if (!m_stream.good())
 		return false;
@@ -95,19 +275,26 @@ bool File::Open(const std::filesystem::path& path)
 	m_stream.seekg(0, std::ios::end);
 	m_fileSize = static_cast<size_t>(m_stream.tellg());
 	m_stream.seekg(0, std::ios::beg);
-	m_fileOffset = 0;
 	return true;
 }
 
 bool File::IsValid() const
 {
-	return m_stream.good();
+	return m_mapping.IsValid() || m_stream.good();
 }
 
 size_t File::Read(void* buffer, size_t count)
 {
 	assert(IsValid() && "Calling File::Read() on an invalid file.");
 
+	if (m_mapping.IsValid())
+	{
+		const std::span<const char> view = m_mapping.GetView(m_fileOffset, count);
+		std::memcpy(buffer, view.data(), view.size());
+		m_fileOffset += view.size();
+		return view.size();
+	}
+
 	m_stream.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(count));
 	size_t readCount = static_cast<size_t>(m_stream.gcount());
 	m_fileOffset += readCount;
@@ -119,16 +306,50 @@ size_t File::GetLength() const
 	return m_fileSize;
 }
 
-bool FileStream::Open(const char* path)
+bool File::IsMapped() const
+{
+	return m_mapping.IsMapped();
+}
+
+const char* File::GetMappedData() const
 {
-	auto optionalBuffer = LoadFile(path);
-	if (!optionalBuffer.has_value())
+	return m_mapping.GetData();
+}
+
+bool FileStream::Open(const std::filesystem::path& path)
+{
+	if (!m_file.Open(path))
+	{
+		setg(nullptr, nullptr, nullptr);
 		return false;
-	m_buffer = optionalBuffer.value();
-	setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + m_buffer.size());
+	}
+	// std::streambuf wants a mutable get area, but nothing writes through it: putback only moves the read position
+	// back over matching characters and pbackfail() is not overridden.
+	char* begin = const_cast<char*>(m_file.GetData());
+	setg(begin, begin, begin + m_file.GetLength());
 	return true;
 }
 
+FileStream::pos_type FileStream::seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	if ((which & std::ios_base::in) == 0) return pos_type(off_type(-1));
+
+	off_type base = 0;
+	if (dir == std::ios_base::cur) base = gptr() - eback();
+	else if (dir == std::ios_base::end) base = egptr() - eback();
+
+	const off_type target = base + offset;
+	if (target < 0 || target > egptr() - eback()) return pos_type(off_type(-1));
+
+	setg(eback(), eback() + target, egptr());
+	return pos_type(target);
+}
+
+FileStream::pos_type FileStream::seekpos(pos_type position, std::ios_base::openmode which)
+{
+	return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
 std::optional<std::vector<char>> LoadFile(const std::filesystem::path& path)
 {
 	File file;
@@ -609,6 +830,46 @@ void OBB::GetPoints(glm::vec3 obbVertices[8]) const
 	obbVertices[7] = m_center + w + v + w;
 }
 
+void Frustum::Set(const glm::mat4& viewProjection)
+{
+	const glm::vec4 row0 = glm::row(viewProjection, 0);
+	const glm::vec4 row1 = glm::row(viewProjection, 1);
+	const glm::vec4 row2 = glm::row(viewProjection, 2);
+	const glm::vec4 row3 = glm::row(viewProjection, 3);
+
+	const glm::vec4 equations[6] = {
+		row3 + row0, // left
+		row3 - row0, // right
+		row3 + row1, // bottom
+		row3 - row1, // top
+		row2,        // near
+		row3 - row2, // far
+	};
+
+	for (size_t i = 0; i < 6; i++)
+	{
+		const float length = glm::length(glm::vec3(equations[i]));
+		planes[i].n = glm::vec3(equations[i]) / length;
+		planes[i].d = equations[i].w / length;
+	}
+}
+
+bool Frustum::Intersects(const AABB& aabb) const
+{
+	for (const Plane& plane : planes)
+	{
+		// the box corner furthest along the plane normal
+		const glm::vec3 positive = glm::vec3(
+			plane.n.x >= 0.0f ? aabb.max.x : aabb.min.x,
+			plane.n.y >= 0.0f ? aabb.max.y : aabb.min.y,
+			plane.n.z >= 0.0f ? aabb.max.z : aabb.min.z);
+
+		if (glm::dot(plane.n, positive) + plane.d < 0.0f)
+			return false;
+	}
+	return true;
+}
+
 Transform::Transform(const glm::vec3& translation)
 {
 	SetTranslation(translation);
@@ -766,4 +1027,1202 @@ glm::vec3 Transform::GetHorizontalForwardVector() const
 	return { glm::sin(yaw), 0, glm::cos(yaw) };
 }
 
-#pragma endregion
\ No newline at end of file
+#pragma endregion
+
+//=============================================================================
+#pragma region [ Async IO ]
+
+double AsyncFileReaderStats::GetThroughput() const
+{
+	const double seconds = static_cast<double>(busyTime.AsMicroseconds()) / 1000000.0;
+	return (seconds > 0.0) ? static_cast<double>(bytesRead) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+// Checks the requested range against the file length and returns how many bytes to read.
+static Result GetReadRange(uint64_t fileLength, const FileReadRequest& request, uint64_t* pCount)
+{
+	if (request.offset > fileLength) return ERROR_OUT_OF_RANGE;
+	const uint64_t count = (request.size != 0) ? request.size : fileLength - request.offset;
+	if ((count > fileLength - request.offset) || (count > SIZE_MAX)) return ERROR_OUT_OF_RANGE;
+	*pCount = count;
+	return SUCCESS;
+}
+
+// Copies the requested range of a file held in a mounted asset pack. ERROR_PATH_DOES_NOT_EXIST when it isn't in one.
+static Result ReadFromAssetPacks(const FileReadRequest& request, std::vector<char>* pData)
+{
+	std::shared_ptr<void> owner;
+	std::span<const char> view;
+	std::vector<char>     buffer;
+	Result ppxres = FindInAssetPacks(request.path, &owner, &view, &buffer);
+	if (Failed(ppxres)) return ppxres;
+
+	uint64_t count = 0;
+	ppxres = GetReadRange(view.size(), request, &count);
+	if (Failed(ppxres)) return ppxres;
+
+	if ((request.offset == 0) && (count == buffer.size()) && !buffer.empty())
+	{
+		*pData = std::move(buffer);
+		return SUCCESS;
+	}
+	const std::span<const char> range = view.subspan(static_cast<size_t>(request.offset), static_cast<size_t>(count));
+	pData->assign(range.begin(), range.end());
+	return SUCCESS;
+}
+
+// Blocking read of the thread pool backend.
+static Result ReadFileRange(const FileReadRequest& request, std::vector<char>* pData)
+{
+	const Result packResult = ReadFromAssetPacks(request, pData);
+	if (packResult != ERROR_PATH_DOES_NOT_EXIST) return packResult;
+
+	std::ifstream stream(request.path, std::ios::binary | std::ios::ate);
+	if (!stream.is_open()) return ERROR_PATH_DOES_NOT_EXIST;
+	const std::streamoff length = stream.tellg();
+	if (length < 0) return ERROR_BAD_DATA_SOURCE;
+
+	uint64_t count = 0;
+	Result ppxres = GetReadRange(static_cast<uint64_t>(length), request, &count);
+	if (Failed(ppxres)) return ppxres;
+
+	pData->resize(static_cast<size_t>(count));
+	stream.seekg(static_cast<std::streamoff>(request.offset), std::ios::beg);
+	if (!stream.read(pData->data(), static_cast<std::streamsize>(count))) return ERROR_BAD_DATA_SOURCE;
+	return SUCCESS;
+}
+
+#if defined(ASYNC_IO_URING)
+// Just enough io_uring on top of the raw system calls for AsyncFileReader: the same thread fills the submission
+// queue and reaps the completion queue.
+class IoUring final
+{
+public:
+	IoUring() = default;
+	IoUring(const IoUring&) = delete;
+	IoUring& operator=(const IoUring&) = delete;
+	~IoUring() { Shutdown(); }
+
+	bool Setup(uint32_t entries)
+	{
+		io_uring_params params = {};
+		m_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+		if (m_fd < 0) return false;
+		// IORING_OP_READ came with Linux 5.6, the same release as this feature bit
+		if ((params.features & IORING_FEAT_RW_CUR_POS) == 0)
+		{
+			Shutdown();
+			return false;
+		}
+
+		m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		m_sqRing = MapRing(m_sqRingSize, IORING_OFF_SQ_RING);
+		m_cqRing = MapRing(m_cqRingSize, IORING_OFF_CQ_RING);
+		m_sqes = static_cast<io_uring_sqe*>(MapRing(m_sqesSize, IORING_OFF_SQES));
+		if (IsNull(m_sqRing) || IsNull(m_cqRing) || IsNull(m_sqes))
+		{
+			Shutdown();
+			return false;
+		}
+
+		char* sq = static_cast<char*>(m_sqRing);
+		m_sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+		m_sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+		m_sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+		m_sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+		char* cq = static_cast<char*>(m_cqRing);
+		m_cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+		m_cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+		m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+		m_cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+		m_entries = params.sq_entries;
+		m_localTail = *m_sqTail;
+		return true;
+	}
+
+	void Shutdown()
+	{
+		if (!IsNull(m_sqes)) munmap(m_sqes, m_sqesSize);
+		if (!IsNull(m_cqRing)) munmap(m_cqRing, m_cqRingSize);
+		if (!IsNull(m_sqRing)) munmap(m_sqRing, m_sqRingSize);
+		if (m_fd >= 0) close(m_fd);
+		m_sqes = nullptr;
+		m_cqRing = nullptr;
+		m_sqRing = nullptr;
+		m_fd = -1;
+	}
+
+	// Queues a read, false when the submission queue is full.
+	bool PrepareRead(int fd, void* pBuffer, uint32_t length, uint64_t offset, uint64_t userData)
+	{
+		if (m_localTail - std::atomic_ref<uint32_t>(*m_sqHead).load(std::memory_order_acquire) >= m_entries) return false;
+
+		const uint32_t index = m_localTail & m_sqMask;
+		io_uring_sqe& sqe = m_sqes[index];
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = fd;
+		sqe.addr = reinterpret_cast<uint64_t>(pBuffer);
+		sqe.len = length;
+		sqe.off = offset;
+		sqe.user_data = userData;
+		m_sqArray[index] = index;
+		m_localTail++;
+		m_toSubmit++;
+		return true;
+	}
+
+	// Hands the queued reads to the kernel and blocks until at least waitCount have completed.
+	bool Submit(uint32_t waitCount)
+	{
+		std::atomic_ref<uint32_t>(*m_sqTail).store(m_localTail, std::memory_order_release);
+		for (;;)
+		{
+			const long ret = syscall(__NR_io_uring_enter, m_fd, m_toSubmit, waitCount, (waitCount > 0) ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+			if (ret >= 0)
+			{
+				m_toSubmit -= static_cast<uint32_t>(ret);
+				return true;
+			}
+			if (errno == EINTR) continue;
+			return (errno == EAGAIN) || (errno == EBUSY); // Out of resources for now, completions will free some
+		}
+	}
+
+	// Takes back the reads the kernel hasn't consumed from the submission queue and calls func(userData) for each.
+	template<typename Func>
+	void DropUnsubmitted(Func&& func)
+	{
+		const uint32_t head = std::atomic_ref<uint32_t>(*m_sqHead).load(std::memory_order_acquire);
+		for (uint32_t i = head; i != m_localTail; ++i)
+			func(m_sqes[m_sqArray[i & m_sqMask]].user_data);
+		m_localTail = head;
+		m_toSubmit = 0;
+		std::atomic_ref<uint32_t>(*m_sqTail).store(m_localTail, std::memory_order_release);
+	}
+
+	// Blocks until there is a completion, false when the ring can't be waited on any more.
+	bool WaitCompletion()
+	{
+		for (;;)
+		{
+			if (syscall(__NR_io_uring_enter, m_fd, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) return true;
+			if (errno != EINTR) return false;
+		}
+	}
+
+	// Calls func(userData, res) for every completion.
+	template<typename Func>
+	void ForEachCompletion(Func&& func)
+	{
+		uint32_t       head = *m_cqHead;
+		const uint32_t tail = std::atomic_ref<uint32_t>(*m_cqTail).load(std::memory_order_acquire);
+		for (; head != tail; ++head)
+		{
+			const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+			func(cqe.user_data, cqe.res);
+		}
+		std::atomic_ref<uint32_t>(*m_cqHead).store(head, std::memory_order_release);
+	}
+
+private:
+	void* MapRing(size_t size, off_t offset)
+	{
+		void* pMemory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, offset);
+		return (pMemory == MAP_FAILED) ? nullptr : pMemory;
+	}
+
+	int           m_fd = -1;
+	void*         m_sqRing = nullptr;
+	void*         m_cqRing = nullptr;
+	io_uring_sqe* m_sqes = nullptr;
+	size_t        m_sqRingSize = 0;
+	size_t        m_cqRingSize = 0;
+	size_t        m_sqesSize = 0;
+	uint32_t*     m_sqHead = nullptr;
+	uint32_t*     m_sqTail = nullptr;
+	uint32_t*     m_sqArray = nullptr;
+	uint32_t      m_sqMask = 0;
+	uint32_t*     m_cqHead = nullptr;
+	uint32_t*     m_cqTail = nullptr;
+	io_uring_cqe* m_cqes = nullptr;
+	uint32_t      m_cqMask = 0;
+	uint32_t      m_entries = 0;
+	uint32_t      m_localTail = 0;
+	uint32_t      m_toSubmit = 0;
+};
+#endif
+
+struct AsyncFileReader::Impl
+{
+	using Completion = std::pair<FileReadCallback, FileReadResult>;
+
+	AsyncFileReaderCreateInfo createInfo;
+	std::atomic<IoBackend>    backend = IoBackend::ThreadPool; // The io_uring worker can fall back to the thread pool
+	bool                      running = false;
+	std::vector<std::jthread> threads;
+#if defined(ASYNC_IO_URING)
+	IoUring ring;
+#endif
+
+	// Everything below is guarded by mutex
+	std::mutex                                                                mutex;
+	std::condition_variable                                                   wake; // Work for the I/O threads
+	std::condition_variable                                                   idle; // Completions for Wait()
+	std::array<std::deque<FileReadRequest>, static_cast<size_t>(IoPriority::Count)> pending;
+	uint32_t                                                                  pendingCount = 0;
+	uint32_t                                                                  inFlight = 0;
+	bool                                                                      stop = false;
+	std::vector<Completion>                                                   completed;
+	AsyncFileReaderStats                                                      stats;
+	Clock                                                                     busyClock;
+
+	uint32_t GetOutstanding() const { return pendingCount + inFlight; }
+	// Finished reads count until Poll() takes them, so an I/O thread running ahead of the consumer can't pile up
+	// an unbounded number of buffers.
+	bool CanStart() const { return inFlight + completed.size() < createInfo.queueDepth; }
+
+	// Moves the oldest request of the highest priority into pRequest and counts it as in flight.
+	bool Start(FileReadRequest* pRequest)
+	{
+		for (std::deque<FileReadRequest>& queue : pending)
+		{
+			if (queue.empty()) continue;
+			*pRequest = std::move(queue.front());
+			queue.pop_front();
+			pendingCount--;
+			inFlight++;
+			stats.maxInFlight = std::max(stats.maxInFlight, inFlight);
+			return true;
+		}
+		return false;
+	}
+
+	void AddBusyTime()
+	{
+		stats.busyTime = stats.busyTime.ToDuration() + busyClock.GetElapsedTime().ToDuration();
+	}
+
+	void Finish(FileReadCallback&& callback, FileReadResult&& result)
+	{
+		const std::lock_guard<std::mutex> lock(mutex);
+		inFlight--;
+		if (GetOutstanding() == 0) AddBusyTime();
+		stats.completed++;
+		if (Failed(result.result)) stats.failed++;
+		else stats.bytesRead += result.data.size();
+		completed.emplace_back(std::move(callback), std::move(result));
+		idle.notify_all();
+	}
+
+	void ThreadPoolWorker()
+	{
+		for (;;)
+		{
+			FileReadRequest request;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [this] { return stop || ((pendingCount > 0) && CanStart()); });
+				if (stop) return;
+				Start(&request);
+			}
+
+			FileReadResult result;
+			result.path = request.path;
+			result.result = ReadFileRange(request, &result.data);
+			Finish(std::move(request.onComplete), std::move(result));
+		}
+	}
+
+#if defined(ASYNC_IO_URING)
+	struct UringRead
+	{
+		FileReadRequest request;
+		FileReadResult  result;
+		int             fd = -1;
+		uint64_t        done = 0;
+		bool            queued = false; // The kernel may be writing into result.data
+	};
+
+	void UringWorker()
+	{
+		// Files are opened on this thread, only the reads themselves are asynchronous
+		std::vector<UringRead> reads(createInfo.queueDepth);
+		std::vector<uint32_t>  freeSlots;
+		std::vector<uint32_t>  started;
+		for (uint32_t i = createInfo.queueDepth; i > 0; --i) freeSlots.push_back(i - 1);
+		uint32_t active = 0;
+
+		const auto finishRead = [&](uint32_t slot, Result result) {
+			UringRead& read = reads[slot];
+			if (read.fd >= 0) close(read.fd);
+			read.result.result = result;
+			if (Failed(result)) read.result.data = {};
+			Finish(std::move(read.request.onComplete), std::move(read.result));
+			read = {};
+			freeSlots.push_back(slot);
+			active--;
+		};
+		const auto readNext = [&](uint32_t slot) {
+			UringRead&     read = reads[slot];
+			const uint64_t remaining = read.result.data.size() - read.done;
+			const uint32_t length = static_cast<uint32_t>(std::min<uint64_t>(remaining, 1u << 30));
+			// There is one slot per submission queue entry, so the queue can't be full
+			ring.PrepareRead(read.fd, read.result.data.data() + read.done, length, read.request.offset + read.done, slot);
+			read.queued = true;
+		};
+		const auto startRead = [&](uint32_t slot) {
+			UringRead& read = reads[slot];
+			read.result.path = read.request.path;
+			// Packed files are already in memory, there is nothing to queue
+			const Result packResult = ReadFromAssetPacks(read.request, &read.result.data);
+			if (packResult != ERROR_PATH_DOES_NOT_EXIST) return finishRead(slot, packResult);
+
+			read.fd = open(read.request.path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (read.fd < 0) return finishRead(slot, ERROR_PATH_DOES_NOT_EXIST);
+
+			struct stat info = {};
+			if (fstat(read.fd, &info) != 0 || info.st_size < 0) return finishRead(slot, ERROR_BAD_DATA_SOURCE);
+			uint64_t count = 0;
+			const Result ppxres = GetReadRange(static_cast<uint64_t>(info.st_size), read.request, &count);
+			if (Failed(ppxres)) return finishRead(slot, ppxres);
+			if (count == 0) return finishRead(slot, SUCCESS);
+
+			read.result.data.resize(static_cast<size_t>(count));
+			readNext(slot);
+		};
+
+		for (;;)
+		{
+			started.clear();
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return stop || (active > 0) || ((pendingCount > 0) && CanStart()); });
+				if (stop && (active == 0)) return;
+				while (!stop && CanStart() && Start(&reads[freeSlots.back()].request))
+				{
+					started.push_back(freeSlots.back());
+					freeSlots.pop_back();
+					active++;
+				}
+			}
+
+			for (uint32_t slot : started) startRead(slot);
+			if (active == 0) continue;
+
+			if (!ring.Submit(1))
+			{
+				Error("io_uring_enter failed with errno " + std::to_string(errno) + ", falling back to the thread pool");
+				return FallBackToThreadPool(reads);
+			}
+
+			ring.ForEachCompletion([&](uint64_t userData, int32_t res) {
+				const uint32_t slot = static_cast<uint32_t>(userData);
+				UringRead&     read = reads[slot];
+				read.queued = false;
+				if ((res == -EINTR) || (res == -EAGAIN)) return readNext(slot);
+				if (res <= 0) return finishRead(slot, ERROR_BAD_DATA_SOURCE); // Error, or the file got shorter
+				read.done += static_cast<uint64_t>(res);
+				if (read.done == read.result.data.size()) return finishRead(slot, SUCCESS);
+				readNext(slot);
+			});
+		}
+	}
+
+	// The ring is unusable: the reads it holds are reaped before their buffers are touched, every active read is
+	// redone with a blocking read, and this thread carries on as a thread pool worker.
+	void FallBackToThreadPool(std::vector<UringRead>& reads)
+	{
+		const auto reaped = [&](uint64_t userData, int32_t = 0) { reads[userData].queued = false; };
+		const auto anyQueued = [&] { return std::any_of(reads.begin(), reads.end(), [](const UringRead& read) { return read.queued; }); };
+		ring.DropUnsubmitted(reaped);
+		ring.ForEachCompletion(reaped);
+		while (anyQueued() && ring.WaitCompletion())
+			ring.ForEachCompletion(reaped);
+
+		for (UringRead& read : reads)
+		{
+			if (read.fd < 0) continue;
+			close(read.fd);
+			// The kernel still owns this buffer, it is leaked rather than freed under a read that may yet land in it
+			if (read.queued) new std::vector<char>(std::move(read.result.data));
+
+			read.result.data = {};
+			read.result.result = ReadFileRange(read.request, &read.result.data);
+			Finish(std::move(read.request.onComplete), std::move(read.result));
+		}
+		reads.clear();
+
+		backend = IoBackend::ThreadPool;
+		ThreadPoolWorker();
+	}
+#endif
+};
+
+AsyncFileReader::AsyncFileReader()
+	: m_impl(std::make_unique<Impl>())
+{
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+	Shutdown();
+}
+
+bool AsyncFileReader::Setup(const AsyncFileReaderCreateInfo& createInfo)
+{
+	Shutdown();
+
+	Impl& impl = *m_impl;
+	impl.createInfo = createInfo;
+	impl.createInfo.queueDepth = std::max(createInfo.queueDepth, 1u);
+	impl.stop = false;
+	impl.running = true;
+
+#if defined(ASYNC_IO_URING)
+	if (createInfo.allowIoUring && impl.ring.Setup(impl.createInfo.queueDepth))
+	{
+		impl.backend = IoBackend::IoUring;
+		impl.threads.emplace_back([&impl] { impl.UringWorker(); });
+		return true;
+	}
+#endif
+
+	impl.backend = IoBackend::ThreadPool;
+	const uint32_t threadCount = std::clamp(createInfo.threadCount, 1u, impl.createInfo.queueDepth);
+	for (uint32_t i = 0; i < threadCount; ++i)
+		impl.threads.emplace_back([&impl] { impl.ThreadPoolWorker(); });
+	return true;
+}
+
+void AsyncFileReader::Shutdown()
+{
+	Impl& impl = *m_impl;
+	if (!impl.running) return;
+
+	{
+		const std::lock_guard<std::mutex> lock(impl.mutex);
+		impl.stop = true;
+		// Dropping the queue ends the busy period, unless reads in flight end it in Finish()
+		const bool droppedLast = (impl.pendingCount > 0) && (impl.inFlight == 0);
+		for (std::deque<FileReadRequest>& queue : impl.pending) queue.clear();
+		impl.pendingCount = 0;
+		if (droppedLast) impl.AddBusyTime();
+	}
+	impl.wake.notify_all();
+	impl.threads.clear();
+#if defined(ASYNC_IO_URING)
+	impl.ring.Shutdown();
+#endif
+
+	impl.completed.clear();
+	impl.running = false;
+}
+
+void AsyncFileReader::Submit(FileReadRequest&& request)
+{
+	Submit(std::span<FileReadRequest>(&request, 1));
+}
+
+void AsyncFileReader::Submit(std::span<FileReadRequest> requests)
+{
+	Impl& impl = *m_impl;
+	assert(impl.running && "Calling AsyncFileReader::Submit() before Setup().");
+	if (requests.empty()) return;
+
+	{
+		const std::lock_guard<std::mutex> lock(impl.mutex);
+		if (impl.GetOutstanding() == 0) impl.busyClock.Restart();
+		for (FileReadRequest& request : requests)
+		{
+			const size_t priority = std::min(static_cast<size_t>(request.priority), impl.pending.size() - 1);
+			impl.pending[priority].push_back(std::move(request));
+		}
+		impl.pendingCount += static_cast<uint32_t>(requests.size());
+		impl.stats.submitted += requests.size();
+		impl.stats.maxQueueDepth = std::max(impl.stats.maxQueueDepth, impl.GetOutstanding());
+	}
+	if (impl.backend == IoBackend::ThreadPool && requests.size() == 1) impl.wake.notify_one();
+	else impl.wake.notify_all();
+}
+
+size_t AsyncFileReader::Poll()
+{
+	Impl& impl = *m_impl;
+	std::vector<Impl::Completion> completed;
+	{
+		const std::lock_guard<std::mutex> lock(impl.mutex);
+		completed.swap(impl.completed);
+	}
+	if (!completed.empty()) impl.wake.notify_all();
+	for (Impl::Completion& completion : completed)
+	{
+		if (completion.first) completion.first(completion.second);
+	}
+	return completed.size();
+}
+
+void AsyncFileReader::Wait()
+{
+	Impl& impl = *m_impl;
+	std::unique_lock<std::mutex> lock(impl.mutex);
+	for (;;)
+	{
+		if (!impl.completed.empty())
+		{
+			lock.unlock();
+			Poll();
+			lock.lock();
+			continue;
+		}
+		if (impl.GetOutstanding() == 0) return;
+		impl.idle.wait(lock);
+	}
+}
+
+IoBackend AsyncFileReader::GetBackend() const
+{
+	return m_impl->backend;
+}
+
+AsyncFileReaderStats AsyncFileReader::GetStats() const
+{
+	const std::lock_guard<std::mutex> lock(m_impl->mutex);
+	AsyncFileReaderStats stats = m_impl->stats;
+	stats.queueDepth = m_impl->GetOutstanding();
+	if (stats.queueDepth > 0) stats.busyTime = stats.busyTime.ToDuration() + m_impl->busyClock.GetElapsedTime().ToDuration();
+	return stats;
+}
+
+#pragma endregion
+
+//=============================================================================
+#pragma region [ Asset Pack ]
+
+namespace Lz4
+{
+	namespace
+	{
+		constexpr size_t   MinMatch = 4;
+		constexpr size_t   LastLiterals = 5;  // The last bytes of a block are always literals
+		constexpr size_t   MatchFindLimit = 12; // and the last match starts at least this far before the end
+		constexpr size_t   MaxOffset = 65535;
+		constexpr size_t   MaxInputSize = 0x7E000000;
+		constexpr uint32_t HashLog = 16;
+
+		inline uint32_t Read32(const uint8_t* p)
+		{
+			uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		inline uint32_t Hash(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - HashLog);
+		}
+
+		inline size_t LengthExtraBytes(size_t length)
+		{
+			return (length >= 15) ? (length - 15) / 255 + 1 : 0;
+		}
+
+		inline uint8_t* WriteLengthExtra(uint8_t* op, size_t length)
+		{
+			for (length -= 15; length >= 255; length -= 255) *op++ = 255;
+			*op++ = static_cast<uint8_t>(length);
+			return op;
+		}
+
+		// Literal run of a sequence with its token, nullptr when it doesn't fit.
+		uint8_t* WriteLiterals(uint8_t* op, const uint8_t* oend, const uint8_t* anchor, size_t length, uint8_t** ppToken)
+		{
+			if (static_cast<size_t>(oend - op) < 1 + LengthExtraBytes(length) + length) return nullptr;
+			*ppToken = op++;
+			**ppToken = static_cast<uint8_t>(std::min<size_t>(length, 15) << 4);
+			if (length >= 15) op = WriteLengthExtra(op, length);
+			std::memcpy(op, anchor, length);
+			return op + length;
+		}
+	} // namespace
+
+	size_t CompressBound(size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	size_t Compress(const char* pSrc, size_t srcSize, char* pDst, size_t dstCapacity)
+	{
+		if (srcSize > MaxInputSize) return 0;
+
+		const uint8_t* const src = reinterpret_cast<const uint8_t*>(pSrc);
+		const uint8_t* const iend = src + srcSize;
+		const uint8_t*       ip = src;
+		const uint8_t*       anchor = src;
+		uint8_t*             op = reinterpret_cast<uint8_t*>(pDst);
+		const uint8_t* const oend = op + dstCapacity;
+		uint8_t*             token = nullptr;
+
+		if (srcSize > MatchFindLimit)
+		{
+			const uint8_t* const matchStartLimit = iend - MatchFindLimit;
+			const uint8_t* const matchEndLimit = iend - LastLiterals;
+			std::vector<uint32_t> table(size_t(1) << HashLog, 0);
+
+			ip++;
+			while (ip <= matchStartLimit)
+			{
+				// Look for a match, stepping faster through data that doesn't compress
+				const uint8_t* match = nullptr;
+				for (uint32_t attempts = 1u << 6; ip <= matchStartLimit; ip += attempts++ >> 6)
+				{
+					const uint32_t sequence = Read32(ip);
+					uint32_t&      slot = table[Hash(sequence)];
+					const uint8_t* candidate = src + slot;
+					slot = static_cast<uint32_t>(ip - src);
+					if ((static_cast<size_t>(ip - candidate) <= MaxOffset) && (Read32(candidate) == sequence))
+					{
+						match = candidate;
+						break;
+					}
+				}
+				if (match == nullptr) break;
+
+				while ((ip > anchor) && (match > src) && (ip[-1] == match[-1]))
+				{
+					ip--;
+					match--;
+				}
+
+				op = WriteLiterals(op, oend, anchor, static_cast<size_t>(ip - anchor), &token);
+				if (op == nullptr) return 0;
+
+				const size_t offset = static_cast<size_t>(ip - match);
+				const uint8_t* matchEnd = ip + MinMatch;
+				for (const uint8_t* ref = match + MinMatch; (matchEnd < matchEndLimit) && (*matchEnd == *ref); ++ref) ++matchEnd;
+				const size_t matchLength = static_cast<size_t>(matchEnd - ip) - MinMatch;
+
+				if (static_cast<size_t>(oend - op) < 2 + LengthExtraBytes(matchLength)) return 0;
+				*op++ = static_cast<uint8_t>(offset);
+				*op++ = static_cast<uint8_t>(offset >> 8);
+				*token |= static_cast<uint8_t>(std::min<size_t>(matchLength, 15));
+				if (matchLength >= 15) op = WriteLengthExtra(op, matchLength);
+
+				table[Hash(Read32(matchEnd - 2))] = static_cast<uint32_t>(matchEnd - 2 - src);
+				ip = anchor = matchEnd;
+			}
+		}
+
+		op = WriteLiterals(op, oend, anchor, static_cast<size_t>(iend - anchor), &token);
+		return (op != nullptr) ? static_cast<size_t>(op - reinterpret_cast<uint8_t*>(pDst)) : 0;
+	}
+
+	bool Decompress(const char* pSrc, size_t srcSize, char* pDst, size_t dstSize)
+	{
+		const uint8_t*       ip = reinterpret_cast<const uint8_t*>(pSrc);
+		const uint8_t* const iend = ip + srcSize;
+		uint8_t* const       dst = reinterpret_cast<uint8_t*>(pDst);
+		uint8_t*             op = dst;
+		uint8_t* const       oend = dst + dstSize;
+
+		const auto readLength = [&](size_t* pLength) {
+			for (;;)
+			{
+				if (ip == iend) return false;
+				const uint8_t byte = *ip++;
+				*pLength += byte;
+				if (byte != 255) return true;
+			}
+		};
+
+		for (;;)
+		{
+			if (ip == iend) return false;
+			const uint8_t token = *ip++;
+
+			size_t literalLength = token >> 4;
+			if ((literalLength == 15) && !readLength(&literalLength)) return false;
+			if ((literalLength > static_cast<size_t>(iend - ip)) || (literalLength > static_cast<size_t>(oend - op))) return false;
+			std::memcpy(op, ip, literalLength);
+			op += literalLength;
+			ip += literalLength;
+			if (ip == iend) break; // The last sequence has no match
+
+			if (iend - ip < 2) return false;
+			const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+			ip += 2;
+			if ((offset == 0) || (offset > static_cast<size_t>(op - dst))) return false;
+
+			size_t matchLength = token & 15;
+			if ((matchLength == 15) && !readLength(&matchLength)) return false;
+			matchLength += MinMatch;
+			if (matchLength > static_cast<size_t>(oend - op)) return false;
+
+			const uint8_t* match = op - offset;
+			if (offset >= matchLength)
+			{
+				std::memcpy(op, match, matchLength);
+				op += matchLength;
+			}
+			else
+			{
+				// Overlapping copy repeats the last offset bytes
+				for (size_t i = 0; i < matchLength; ++i) *op++ = *match++;
+			}
+		}
+		return op == oend;
+	}
+} // namespace Lz4
+
+// Packed names are relative, '/' separated and hashed lower case, so lookups don't depend on how a path was spelled.
+static std::string NormalizeAssetPackName(std::string_view name)
+{
+	std::string result(name);
+	for (char& c : result)
+	{
+		if (c == '\\') c = '/';
+		else if ((c >= 'A') && (c <= 'Z')) c = static_cast<char>(c - 'A' + 'a');
+	}
+	return result;
+}
+
+static uint64_t HashAssetPackName(std::string_view normalizedName)
+{
+	return XXH64(normalizedName.data(), normalizedName.size(), 0);
+}
+
+bool AssetPack::Open(const std::filesystem::path& path)
+{
+	m_entries = {};
+	m_names = {};
+	m_path = path;
+	if (!m_file.Open(path))
+	{
+		Error("Failed to open asset pack '" + path.string() + "'.");
+		return false;
+	}
+
+	const auto fail = [&](const std::string& reason) {
+		Error("Asset pack '" + path.string() + "' is invalid: " + reason);
+		m_file.Close();
+		return false;
+	};
+
+	const uint64_t fileSize = m_file.GetLength();
+	if (fileSize < sizeof(AssetPackHeader)) return fail("too small");
+	AssetPackHeader header;
+	std::memcpy(&header, m_file.GetData(), sizeof(header));
+	if (header.magic != AssetPackMagic) return fail("bad magic");
+	if (header.version != AssetPackVersion) return fail("unsupported version " + std::to_string(header.version));
+	if ((header.alignment == 0) || ((header.alignment & (header.alignment - 1)) != 0)) return fail("bad alignment");
+
+	// The entry table is read in place, so it has to be aligned within the mapping
+	const uint64_t indexSize = uint64_t(header.entryCount) * sizeof(AssetPackEntry);
+	if ((header.indexOffset % alignof(AssetPackEntry)) != 0 || (header.indexOffset < sizeof(AssetPackHeader))
+		|| (header.indexOffset > fileSize) || (indexSize > fileSize - header.indexOffset))
+		return fail("entry table out of range");
+	if ((header.namesOffset != header.indexOffset + indexSize) || (header.namesSize > fileSize - header.namesOffset))
+		return fail("names out of range");
+	if (XXH64(m_file.GetData() + header.indexOffset, static_cast<size_t>(indexSize + header.namesSize), 0) != header.indexChecksum)
+		return fail("index checksum mismatch");
+
+	const auto* pEntries = reinterpret_cast<const AssetPackEntry*>(m_file.GetData() + header.indexOffset);
+	const std::span<const AssetPackEntry> entries(pEntries, header.entryCount);
+	for (const AssetPackEntry& entry : entries)
+	{
+		if ((entry.offset > header.indexOffset) || (entry.storedSize > header.indexOffset - entry.offset))
+			return fail("entry data out of range");
+		if ((uint64_t(entry.nameOffset) + entry.nameLength) > header.namesSize) return fail("entry name out of range");
+		if (((entry.flags & ASSET_PACK_ENTRY_COMPRESSED_LZ4) == 0) && (entry.storedSize != entry.size))
+			return fail("entry size mismatch");
+	}
+	if (!std::is_sorted(entries.begin(), entries.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.pathHash < b.pathHash; }))
+		return fail("entry table is not sorted");
+
+	m_entries = entries;
+	m_names = std::string_view(m_file.GetData() + header.namesOffset, static_cast<size_t>(header.namesSize));
+	return true;
+}
+
+const AssetPackEntry* AssetPack::Find(std::string_view path) const
+{
+	const std::string name = NormalizeAssetPackName(path);
+	const uint64_t    hash = HashAssetPackName(name);
+
+	auto it = std::lower_bound(m_entries.begin(), m_entries.end(), hash, [](const AssetPackEntry& entry, uint64_t value) { return entry.pathHash < value; });
+	for (; (it != m_entries.end()) && (it->pathHash == hash); ++it)
+	{
+		if (NormalizeAssetPackName(GetName(*it)) == name) return &*it;
+	}
+	return nullptr;
+}
+
+std::string_view AssetPack::GetName(const AssetPackEntry& entry) const
+{
+	return m_names.substr(entry.nameOffset, entry.nameLength);
+}
+
+std::span<const char> AssetPack::GetStoredData(const AssetPackEntry& entry) const
+{
+	return m_file.GetView(static_cast<size_t>(entry.offset), static_cast<size_t>(entry.storedSize));
+}
+
+bool AssetPack::Read(const AssetPackEntry& entry, std::vector<char>* pData) const
+{
+	const std::span<const char> stored = GetStoredData(entry);
+	if ((entry.flags & ASSET_PACK_ENTRY_COMPRESSED_LZ4) == 0)
+	{
+		pData->assign(stored.begin(), stored.end());
+		return true;
+	}
+
+	pData->resize(static_cast<size_t>(entry.size));
+	if (!Lz4::Decompress(stored.data(), stored.size(), pData->data(), pData->size()))
+	{
+		Error("Corrupt entry '" + std::string(GetName(entry)) + "' in asset pack '" + m_path.string() + "'.");
+		pData->clear();
+		return false;
+	}
+	return true;
+}
+
+Result BuildAssetPack(const std::filesystem::path& sourceDir, const std::filesystem::path& packPath, const AssetPackBuildSettings& settings, AssetPackBuildStats* pStats)
+{
+	const Clock clock;
+	if ((settings.alignment == 0) || ((settings.alignment & (settings.alignment - 1)) != 0))
+	{
+		Error("BuildAssetPack: alignment must be a power of two.");
+		return ERROR_INVALID_CREATE_ARGUMENT;
+	}
+
+	std::error_code errorCode;
+	if (!std::filesystem::is_directory(sourceDir, errorCode))
+	{
+		Error("BuildAssetPack: '" + sourceDir.string() + "' is not a directory.");
+		return ERROR_PATH_DOES_NOT_EXIST;
+	}
+
+	struct SourceFile
+	{
+		std::filesystem::path path;
+		std::string           name;
+		uint64_t              pathHash = 0;
+		std::vector<char>     data;
+		std::vector<char>     packed;
+		uint64_t              contentHash = 0;
+		bool                  readFailed = false;
+	};
+
+	const std::filesystem::path root = std::filesystem::absolute(sourceDir).lexically_normal();
+	const std::filesystem::path packFile = std::filesystem::absolute(packPath).lexically_normal();
+	std::filesystem::path       tempFile = packFile;
+	tempFile += ".tmp";
+
+	std::vector<SourceFile> files;
+	for (const auto& item : std::filesystem::recursive_directory_iterator(root, errorCode))
+	{
+		if (!item.is_regular_file()) continue;
+		const std::filesystem::path path = item.path().lexically_normal();
+		if ((path == packFile) || (path == tempFile)) continue;
+
+		SourceFile& file = files.emplace_back();
+		file.path = path;
+		file.name = path.lexically_relative(root).generic_string();
+		file.pathHash = HashAssetPackName(NormalizeAssetPackName(file.name));
+	}
+	if (errorCode)
+	{
+		Error("BuildAssetPack: failed to list '" + sourceDir.string() + "': " + errorCode.message());
+		return ERROR_BAD_DATA_SOURCE;
+	}
+
+	// Entries are written in name order so that files of one directory end up next to each other
+	std::sort(files.begin(), files.end(), [](const SourceFile& a, const SourceFile& b) { return a.name < b.name; });
+	std::vector<size_t> byHash(files.size());
+	for (size_t i = 0; i < byHash.size(); ++i) byHash[i] = i;
+	std::sort(byHash.begin(), byHash.end(), [&](size_t a, size_t b) { return files[a].pathHash < files[b].pathHash; });
+	for (size_t i = 0; i < byHash.size(); ++i)
+	{
+		for (size_t j = i + 1; (j < byHash.size()) && (files[byHash[j]].pathHash == files[byHash[i]].pathHash); ++j)
+		{
+			if (NormalizeAssetPackName(files[byHash[j]].name) == NormalizeAssetPackName(files[byHash[i]].name))
+			{
+				Error("BuildAssetPack: '" + files[byHash[i]].name + "' and '" + files[byHash[j]].name + "' only differ in case.");
+				return ERROR_DUPLICATE_ELEMENT;
+			}
+		}
+	}
+
+	std::ofstream stream(tempFile, std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		Error("BuildAssetPack: failed to create '" + tempFile.string() + "'.");
+		return ERROR_FAILED;
+	}
+
+	AssetPackHeader header;
+	header.alignment = settings.alignment;
+	uint64_t position = sizeof(header);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	const auto pad = [&](uint64_t alignment) {
+		static const char zeros[256] = {};
+		for (uint64_t count = RoundUp(position, alignment) - position; count > 0;)
+		{
+			const uint64_t chunk = std::min<uint64_t>(count, sizeof(zeros));
+			stream.write(zeros, static_cast<std::streamsize>(chunk));
+			position += chunk;
+			count -= chunk;
+		}
+	};
+
+	AssetPackBuildStats stats;
+	std::vector<AssetPackEntry> entries(files.size());
+	std::string names;
+	// Identical files (the same texture in two places) share one copy of the data
+	std::unordered_multimap<uint64_t, size_t> written;
+
+	// Files are read and compressed in batches to bound memory use on large trees
+	constexpr uint64_t kBatchBytes = 64ull * 1024 * 1024;
+	for (size_t batchBegin = 0; batchBegin < files.size();)
+	{
+		size_t   batchEnd = batchBegin;
+		uint64_t batchBytes = 0;
+		while ((batchEnd < files.size()) && ((batchEnd == batchBegin) || (batchBytes < kBatchBytes)))
+		{
+			batchBytes += std::filesystem::file_size(files[batchEnd].path, errorCode);
+			batchEnd++;
+		}
+
+		ParallelFor(batchEnd - batchBegin, [&](size_t i) {
+			SourceFile& file = files[batchBegin + i];
+			// Read the loose file itself, never a mounted pack's copy
+			std::ifstream input(file.path, std::ios::binary | std::ios::ate);
+			const std::streamoff length = input.is_open() ? static_cast<std::streamoff>(input.tellg()) : -1;
+			if (length < 0)
+			{
+				file.readFailed = true;
+				return;
+			}
+			file.data.resize(static_cast<size_t>(length));
+			input.seekg(0, std::ios::beg);
+			if (!input.read(file.data.data(), length))
+			{
+				file.readFailed = true;
+				return;
+			}
+			file.contentHash = XXH64(file.data.data(), file.data.size(), 0);
+
+			if (!settings.compress || file.data.empty()) return;
+			// Only worth decompressing at load when it saves at least an eighth, anything larger doesn't fit
+			file.packed.resize(file.data.size() - file.data.size() / 8);
+			file.packed.resize(Lz4::Compress(file.data.data(), file.data.size(), file.packed.data(), file.packed.size()));
+		});
+
+		for (size_t index = batchBegin; index < batchEnd; ++index)
+		{
+			SourceFile& file = files[index];
+			if (file.readFailed)
+			{
+				Error("BuildAssetPack: failed to read '" + file.path.string() + "'.");
+				stream.close();
+				std::filesystem::remove(tempFile, errorCode);
+				return ERROR_BAD_DATA_SOURCE;
+			}
+
+			AssetPackEntry& entry = entries[index];
+			entry.pathHash = file.pathHash;
+			entry.size = file.data.size();
+			entry.contentHash = file.contentHash;
+			entry.nameOffset = static_cast<uint32_t>(names.size());
+			entry.nameLength = static_cast<uint32_t>(file.name.size());
+			names += file.name;
+
+			stats.fileCount++;
+			stats.sourceSize += file.data.size();
+
+			const AssetPackEntry* pDuplicate = nullptr;
+			for (auto [it, end] = written.equal_range(file.contentHash); (it != end) && (pDuplicate == nullptr); ++it)
+			{
+				if (entries[it->second].size == entry.size) pDuplicate = &entries[it->second];
+			}
+			if (pDuplicate != nullptr)
+			{
+				entry.offset = pDuplicate->offset;
+				entry.storedSize = pDuplicate->storedSize;
+				entry.flags = pDuplicate->flags;
+				stats.duplicateCount++;
+			}
+			else
+			{
+				const bool compressed = !file.packed.empty();
+				const std::vector<char>& stored = compressed ? file.packed : file.data;
+				pad(settings.alignment);
+				entry.offset = position;
+				entry.storedSize = stored.size();
+				if (compressed) entry.flags |= ASSET_PACK_ENTRY_COMPRESSED_LZ4;
+				stream.write(stored.data(), static_cast<std::streamsize>(stored.size()));
+				position += stored.size();
+				written.emplace(file.contentHash, index);
+			}
+			if ((entry.flags & ASSET_PACK_ENTRY_COMPRESSED_LZ4) != 0) stats.compressedCount++;
+
+			file.data = {};
+			file.packed = {};
+		}
+		batchBegin = batchEnd;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.pathHash < b.pathHash; });
+
+	pad(alignof(AssetPackEntry));
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.indexOffset = position;
+	header.namesOffset = position + entries.size() * sizeof(AssetPackEntry);
+	header.namesSize = names.size();
+
+	std::vector<char> index(static_cast<size_t>(entries.size() * sizeof(AssetPackEntry) + names.size()));
+	if (!entries.empty()) std::memcpy(index.data(), entries.data(), entries.size() * sizeof(AssetPackEntry));
+	if (!names.empty()) std::memcpy(index.data() + entries.size() * sizeof(AssetPackEntry), names.data(), names.size());
+	header.indexChecksum = XXH64(index.data(), index.size(), 0);
+	stream.write(index.data(), static_cast<std::streamsize>(index.size()));
+	position += index.size();
+
+	// The header goes in last, a pack that wasn't written completely doesn't open
+	stream.seekp(0, std::ios::beg);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.close();
+	if (!stream.good())
+	{
+		Error("BuildAssetPack: failed to write '" + tempFile.string() + "'.");
+		std::filesystem::remove(tempFile, errorCode);
+		return ERROR_FAILED;
+	}
+
+	std::filesystem::rename(tempFile, packFile, errorCode);
+	if (errorCode)
+	{
+		Error("BuildAssetPack: failed to replace '" + packFile.string() + "': " + errorCode.message());
+		std::filesystem::remove(tempFile, errorCode);
+		return ERROR_FAILED;
+	}
+
+	stats.packSize = position;
+	stats.buildTime = clock.GetElapsedTime();
+	Print("Asset pack '" + packFile.string() + "': " + std::to_string(stats.fileCount) + " files ("
+		+ std::to_string(stats.compressedCount) + " compressed, " + std::to_string(stats.duplicateCount) + " duplicates), "
+		+ std::to_string(stats.sourceSize / 1024) + " KiB -> " + std::to_string(stats.packSize / 1024) + " KiB in "
+		+ std::to_string(stats.buildTime.AsMilliseconds()) + " ms");
+	if (pStats) *pStats = stats;
+	return SUCCESS;
+}
+
+namespace
+{
+	struct AssetPackMount final
+	{
+		std::shared_ptr<AssetPack> pack;
+		std::filesystem::path      root;
+		std::filesystem::path      packPath;
+	};
+
+	std::mutex                  sAssetPackMutex;
+	std::vector<AssetPackMount> sAssetPackMounts;
+	// Lets lookups skip the lock and the path work entirely while nothing is mounted
+	std::atomic<uint32_t>       sAssetPackMountCount = 0;
+} // namespace
+
+static Result FindInAssetPacks(const std::filesystem::path& path, std::shared_ptr<void>* pOwner, std::span<const char>* pView, std::vector<char>* pBuffer)
+{
+	if (sAssetPackMountCount.load(std::memory_order_acquire) == 0) return ERROR_PATH_DOES_NOT_EXIST;
+
+	std::error_code             errorCode;
+	const std::filesystem::path fullPath = std::filesystem::absolute(path, errorCode).lexically_normal();
+	if (errorCode) return ERROR_PATH_DOES_NOT_EXIST;
+
+	std::shared_ptr<AssetPack> pack;
+	const AssetPackEntry*      pEntry = nullptr;
+	{
+		const std::lock_guard<std::mutex> lock(sAssetPackMutex);
+		for (auto it = sAssetPackMounts.rbegin(); (it != sAssetPackMounts.rend()) && (pEntry == nullptr); ++it)
+		{
+			const std::filesystem::path relative = fullPath.lexically_relative(it->root);
+			if (relative.empty() || (*relative.begin() == "..")) continue;
+			pEntry = it->pack->Find(relative.generic_string());
+			if (pEntry != nullptr) pack = it->pack;
+		}
+	}
+	if (pEntry == nullptr) return ERROR_PATH_DOES_NOT_EXIST;
+
+	if ((pEntry->flags & ASSET_PACK_ENTRY_COMPRESSED_LZ4) != 0)
+	{
+		if (!pack->Read(*pEntry, pBuffer)) return ERROR_BAD_DATA_SOURCE;
+		*pView = *pBuffer;
+		return SUCCESS;
+	}
+	*pView = pack->GetStoredData(*pEntry);
+	*pOwner = std::move(pack);
+	return SUCCESS;
+}
+
+bool MountAssetPack(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint)
+{
+	auto pack = std::make_shared<AssetPack>();
+	if (!pack->Open(packPath)) return false;
+
+	std::error_code       errorCode;
+	std::filesystem::path root = mountPoint.empty() ? packPath.parent_path() : mountPoint;
+	root = root.empty() ? std::filesystem::current_path(errorCode) : std::filesystem::absolute(root, errorCode);
+	root = root.lexically_normal();
+	if (errorCode)
+	{
+		Error("Failed to mount asset pack '" + packPath.string() + "': " + errorCode.message());
+		return false;
+	}
+	if (!root.has_filename() && root.has_relative_path()) root = root.parent_path();
+
+	const size_t entryCount = pack->GetEntries().size();
+	{
+		const std::lock_guard<std::mutex> lock(sAssetPackMutex);
+		sAssetPackMounts.push_back({ std::move(pack), root, packPath });
+		sAssetPackMountCount.store(static_cast<uint32_t>(sAssetPackMounts.size()), std::memory_order_release);
+	}
+	Print("Mounted asset pack '" + packPath.string() + "' (" + std::to_string(entryCount) + " files) at '" + root.string() + "'");
+	return true;
+}
+
+void UnmountAssetPack(const std::filesystem::path& packPath)
+{
+	// Open MappedFiles keep their pack mapped until they are closed
+	const std::lock_guard<std::mutex> lock(sAssetPackMutex);
+	std::erase_if(sAssetPackMounts, [&](const AssetPackMount& mount) { return mount.packPath == packPath; });
+	sAssetPackMountCount.store(static_cast<uint32_t>(sAssetPackMounts.size()), std::memory_order_release);
+}
+
+void UnmountAllAssetPacks()
+{
+	const std::lock_guard<std::mutex> lock(sAssetPackMutex);
+	sAssetPackMounts.clear();
+	sAssetPackMountCount.store(0, std::memory_order_release);
+}
+
+bool FileExists(const std::filesystem::path& path)
+{
+	if (sAssetPackMountCount.load(std::memory_order_acquire) != 0)
+	{
+		std::error_code             errorCode;
+		const std::filesystem::path fullPath = std::filesystem::absolute(path, errorCode).lexically_normal();
+		const std::lock_guard<std::mutex> lock(sAssetPackMutex);
+		for (const AssetPackMount& mount : sAssetPackMounts)
+		{
+			const std::filesystem::path relative = fullPath.lexically_relative(mount.root);
+			if (!relative.empty() && (*relative.begin() != "..") && (mount.pack->Find(relative.generic_string()) != nullptr)) return true;
+		}
+	}
+	std::error_code errorCode;
+	return std::filesystem::exists(path, errorCode);
+}
+
+#pragma endregion
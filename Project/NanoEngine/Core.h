@@ -389,6 +389,25 @@ inline std::vector<uint8_t> ToBytes(const T& value)
 	return std::vector<uint8_t>{reinterpret_cast<const uint8_t*>(&value), reinterpret_cast<const uint8_t*>(&value) + sizeof(T)};
 }
 
+// Runs func(i) for every i below count, on the calling thread and as many workers as there are cores.
+// func must be safe to call from several threads at once.
+template <typename Func>
+inline void ParallelFor(size_t count, Func&& func)
+{
+	const size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+
+	std::atomic<size_t> next = 0;
+	const auto worker = [&]() {
+		for (size_t i = next++; i < count; i = next++)
+			func(i);
+	};
+
+	std::vector<std::jthread> threads;
+	for (size_t i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+	worker();
+}
+
 #pragma endregion
 
 //=============================================================================
@@ -750,6 +769,45 @@ private:
 //=============================================================================
 #pragma region [ IO ]
 
+// Read only view of a whole file. Where the platform supports it the file is mapped into the address space, so the
+// bytes come straight from the OS page cache without a copy. When mapping is unavailable or fails the file is read
+// once into an owned buffer and the same view is handed out. The view stays valid until Close() or destruction.
+// Paths found in a mounted asset pack are served from the pack first (see MountAssetPack).
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	~MappedFile();
+
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// readIfMapFails = false leaves a loose file closed instead of reading it into memory when it can't be mapped.
+	bool Open(const std::filesystem::path& path, bool readIfMapFails = true);
+	void Close();
+
+	bool IsValid() const { return m_valid; }
+	// True when the view is backed by an OS mapping (of the file itself or of the asset pack holding it) rather than
+	// the fallback buffer.
+	bool IsMapped() const { return (m_mapping != nullptr) || (m_owner != nullptr); }
+
+	const char*           GetData() const { return m_data; }
+	size_t                GetLength() const { return m_size; }
+	std::span<const char> GetView() const { return { m_data, m_size }; }
+	// Clamped to the end of the file.
+	std::span<const char> GetView(size_t offset, size_t count) const;
+
+private:
+	const char*           m_data = nullptr;
+	size_t                m_size = 0;
+	void*                 m_mapping = nullptr;
+	std::shared_ptr<void> m_owner; // Asset pack the view points into
+	std::vector<char>     m_buffer;
+	bool                  m_valid = false;
+};
+
 class File final
 {
 public:
@@ -764,21 +822,34 @@ public:
 
 	size_t GetLength() const;
 
+	// Files are mapped when possible, otherwise Read() goes through a stream.
+	bool        IsMapped() const;
+	const char* GetMappedData() const;
+
 private:
+	MappedFile    m_mapping;
 	std::ifstream m_stream;
 	size_t        m_fileSize = 0;
 	size_t        m_fileOffset = 0;
 };
 
+// std::streambuf whose get area is the file mapping itself, so parsers taking a std::istream read the file without
+// a copy. Seeking is supported.
 class FileStream : public std::streambuf
 {
 public:
-	bool Open(const char* path);
+	bool Open(const std::filesystem::path& path);
+	bool IsMapped() const { return m_file.IsMapped(); }
+
+protected:
+	pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
 
 private:
-	std::vector<char> m_buffer;
+	MappedFile m_file;
 };
 
+// Returns an owned copy of the file. Prefer MappedFile when the bytes are only read.
 std::optional<std::vector<char>> LoadFile(const std::filesystem::path& path);
 
 [[nodiscard]] std::optional<std::string> LoadSourceFile(const std::filesystem::path& path);
@@ -1718,6 +1789,15 @@ public:
 class Frustum final
 {
 public:
+	Frustum() = default;
+	explicit Frustum(const glm::mat4& viewProjection) { Set(viewProjection); }
+
+	// Extracts the planes from a view projection matrix with [0, 1] depth range. Plane normals point inside the frustum.
+	void Set(const glm::mat4& viewProjection);
+
+	// Conservative test: may return true for boxes that are near a frustum corner but outside it.
+	[[nodiscard]] bool Intersects(const AABB& aabb) const;
+
 	Plane planes[6] = {};
 };
 
@@ -1906,3 +1986,213 @@ private:
 };
 
 #pragma endregion
+
+//=============================================================================
+#pragma region [ Async IO ]
+
+enum class IoPriority : uint8_t
+{
+	High,   // Needed right away
+	Normal,
+	Low,    // Prefetch
+	Count
+};
+
+enum class IoBackend : uint8_t
+{
+	ThreadPool,
+	IoUring,
+};
+
+struct FileReadResult final
+{
+	std::filesystem::path path;
+	Result                result = SUCCESS;
+	std::vector<char>     data;
+};
+
+using FileReadCallback = std::function<void(FileReadResult& result)>;
+
+struct FileReadRequest final
+{
+	std::filesystem::path path;
+	uint64_t              offset = 0;
+	uint64_t              size = 0; // 0 reads from offset to the end of the file
+	IoPriority            priority = IoPriority::Normal;
+	FileReadCallback      onComplete;
+};
+
+struct AsyncFileReaderCreateInfo final
+{
+	uint32_t queueDepth = 64;     // Reads in flight, or finished and not yet taken by Poll()
+	uint32_t threadCount = 4;     // Workers of the thread pool backend
+	bool     allowIoUring = true; // false forces the thread pool
+};
+
+struct AsyncFileReaderStats final
+{
+	uint64_t submitted = 0;
+	uint64_t completed = 0;
+	uint64_t failed = 0;
+	uint64_t bytesRead = 0;
+	uint32_t queueDepth = 0;    // Pending and in flight right now
+	uint32_t maxQueueDepth = 0;
+	uint32_t maxInFlight = 0;
+	Time     busyTime;          // Time with at least one read outstanding
+
+	// MB/s while busy.
+	double GetThroughput() const;
+};
+
+// Reads files in the background, in batches. Requests wait in one queue per priority and the highest priority is
+// started first; a running read is never preempted. On Linux the reads go through io_uring, queueDepth of them in
+// flight from a single thread. Elsewhere, or when the kernel refuses io_uring, a pool of threads does blocking reads.
+// Callbacks run on the thread calling Poll() or Wait(), never on an I/O thread, so they may touch engine state and
+// submit more requests.
+class AsyncFileReader final
+{
+public:
+	AsyncFileReader();
+	AsyncFileReader(const AsyncFileReader&) = delete;
+	AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+	~AsyncFileReader();
+
+	bool Setup(const AsyncFileReaderCreateInfo& createInfo = {});
+	// Reads still pending are dropped without their callbacks, reads in flight are waited for.
+	void Shutdown();
+
+	void Submit(FileReadRequest&& request);
+	// One lock and one wake up for the whole batch. The requests are moved from.
+	void Submit(std::span<FileReadRequest> requests);
+
+	// Runs the callbacks of finished reads and returns how many ran.
+	size_t Poll();
+	// Blocks until every submitted read has finished and its callback has run.
+	void Wait();
+
+	[[nodiscard]] IoBackend            GetBackend() const;
+	[[nodiscard]] AsyncFileReaderStats GetStats() const;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
+
+#pragma endregion
+
+//=============================================================================
+#pragma region [ Asset Pack ]
+
+// LZ4 block format, without the frame. Output is interchangeable with the reference LZ4_compress_default() and
+// LZ4_decompress_safe().
+namespace Lz4
+{
+	size_t CompressBound(size_t size);
+	// Returns the compressed size, or 0 when pDst is too small or the input is too large for the format.
+	size_t Compress(const char* pSrc, size_t srcSize, char* pDst, size_t dstCapacity);
+	// Fails on malformed input and when the output doesn't come out at exactly dstSize bytes.
+	bool   Decompress(const char* pSrc, size_t srcSize, char* pDst, size_t dstSize);
+} // namespace Lz4
+
+//! Pack file layout, little endian:
+//!   AssetPackHeader
+//!   entry data, every entry starting at a multiple of the header's alignment
+//!   AssetPackEntry table sorted by pathHash, then the names blob
+//! Paths are stored relative to the packed directory with '/' separators and are matched ignoring ASCII case.
+constexpr uint32_t AssetPackMagic = 0x4B41504E; // "NPAK"
+constexpr uint32_t AssetPackVersion = 1;
+
+struct AssetPackHeader final
+{
+	uint32_t magic = AssetPackMagic;
+	uint32_t version = AssetPackVersion;
+	uint32_t entryCount = 0;
+	uint32_t alignment = 0;
+	uint64_t indexOffset = 0;
+	uint64_t namesOffset = 0;
+	uint64_t namesSize = 0;
+	uint64_t indexChecksum = 0; // XXH64 of the entry table followed by the names
+};
+
+enum AssetPackEntryFlag : uint32_t
+{
+	ASSET_PACK_ENTRY_COMPRESSED_LZ4 = 0x1,
+};
+
+struct AssetPackEntry final
+{
+	uint64_t pathHash = 0;
+	uint64_t offset = 0;
+	uint64_t size = 0;        // Uncompressed
+	uint64_t storedSize = 0;  // In the pack
+	uint64_t contentHash = 0; // XXH64 of the uncompressed bytes, entries with equal content share their data
+	uint32_t nameOffset = 0;
+	uint32_t nameLength = 0;
+	uint32_t flags = 0;
+	uint32_t reserved = 0;
+};
+
+static_assert(sizeof(AssetPackHeader) == 48);
+static_assert(sizeof(AssetPackEntry) == 56);
+
+// Read only access to a pack. The whole pack is mapped: uncompressed entries are handed out as views into the
+// mapping, LZ4 entries are decompressed on read.
+class AssetPack final
+{
+public:
+	bool Open(const std::filesystem::path& path);
+
+	// path is relative to the packed directory.
+	[[nodiscard]] const AssetPackEntry* Find(std::string_view path) const;
+
+	[[nodiscard]] std::span<const AssetPackEntry> GetEntries() const { return m_entries; }
+	[[nodiscard]] std::string_view                GetName(const AssetPackEntry& entry) const;
+	[[nodiscard]] const std::filesystem::path&    GetPath() const { return m_path; }
+
+	// Entry bytes as stored, the file contents themselves unless the entry is compressed.
+	[[nodiscard]] std::span<const char> GetStoredData(const AssetPackEntry& entry) const;
+	bool                                Read(const AssetPackEntry& entry, std::vector<char>* pData) const;
+
+private:
+	MappedFile                      m_file;
+	std::filesystem::path           m_path;
+	std::span<const AssetPackEntry> m_entries;
+	std::string_view                m_names;
+};
+
+struct AssetPackBuildSettings final
+{
+	bool     compress = true;
+	uint32_t alignment = 16; // Power of two
+};
+
+struct AssetPackBuildStats final
+{
+	uint32_t fileCount = 0;
+	uint32_t compressedCount = 0;
+	uint32_t duplicateCount = 0;
+	uint64_t sourceSize = 0;
+	uint64_t packSize = 0;
+	Time     buildTime;
+};
+
+// Packs every file below sourceDir into packPath. An entry is kept LZ4 compressed when that saves at least an eighth
+// of it; already compressed formats (PNG, JPG, ...) are stored as they are and read straight from the mapping. A pack
+// inside sourceDir is left out of itself. The pack is written next to packPath and renamed into place.
+Result BuildAssetPack(
+	const std::filesystem::path&  sourceDir,
+	const std::filesystem::path&  packPath,
+	const AssetPackBuildSettings& settings = {},
+	AssetPackBuildStats*          pStats = nullptr);
+
+// Mounted packs sit in front of the loose file system: MappedFile, File, FileStream, LoadFile and AsyncFileReader
+// look a path up in them, latest mount first, before opening the file on disk. mountPoint is the directory whose
+// contents the pack holds, by default the directory of the pack itself.
+bool MountAssetPack(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint = {});
+void UnmountAssetPack(const std::filesystem::path& packPath);
+void UnmountAllAssetPacks();
+
+// True when path is in a mounted pack or exists on disk.
+[[nodiscard]] bool FileExists(const std::filesystem::path& path);
+
+#pragma endregion
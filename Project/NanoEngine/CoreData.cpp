@@ -472,25 +472,15 @@ static Result IsRadianceImage(const size_t dataSize, const void* pData, bool& is
 
 Result Bitmap::StbiInfo(const std::filesystem::path& path, int* pX, int* pY, int* pComp)
 {
-	File file;
+	MappedFile file;
 	if (!file.Open(path)) return ERROR_IMAGE_FILE_LOAD_FAILED;
 
-	int stbiResult = 0;
-	//if (file.IsMapped())
-	//{
-	//	stbiResult = stbi_info_from_memory(
-	//		reinterpret_cast<const stbi_uc*>(file.GetMappedData()),
-	//		static_cast<int>(file.GetLength()),
-	//		pX,
-	//		pY,
-	//		pComp);
-	//}
-	//else 
-	{
-		std::vector<uint8_t> buffer(file.GetLength());
-		file.Read(buffer.data(), buffer.size());
-		stbiResult = stbi_info_from_memory(buffer.data(), static_cast<int>(buffer.size()), pX, pY, pComp);
-	}
+	const int stbiResult = stbi_info_from_memory(
+		reinterpret_cast<const stbi_uc*>(file.GetData()),
+		static_cast<int>(file.GetLength()),
+		pX,
+		pY,
+		pComp);
 
 	return stbiResult ? SUCCESS : ERROR_IMAGE_FILE_LOAD_FAILED;
 }
@@ -503,7 +493,7 @@ bool Bitmap::IsBitmapFile(const std::filesystem::path& path)
 
 Result Bitmap::GetFileProperties(const std::filesystem::path& path, uint32_t* pWidth, uint32_t* pHeight, Bitmap::Format* pFormat)
 {
-	if (!std::filesystem::exists(path)) return ERROR_PATH_DOES_NOT_EXIST;
+	if (!FileExists(path)) return ERROR_PATH_DOES_NOT_EXIST;
 
 	int x = 0;
 	int y = 0;
@@ -525,16 +515,10 @@ Result Bitmap::GetFileProperties(const std::filesystem::path& path, uint32_t* pW
 
 char* Bitmap::StbiLoad(const std::filesystem::path& path, Bitmap::Format format, int* pWidth, int* pHeight, int* pChannels, int desiredChannels)
 {
-	File file;
+	MappedFile file;
 	if (!file.Open(path)) return nullptr;
 
-	std::vector<stbi_uc> buffer(0);
-	//if (!file.IsMapped()) {
-	buffer.resize(file.GetLength());
-	file.Read(buffer.data(), buffer.size());
-	//}
-
-	const stbi_uc* readPtr = /*file.IsMapped() ? reinterpret_cast<const stbi_uc*>(file.GetMappedData()) :*/ buffer.data();
+	const stbi_uc* readPtr = reinterpret_cast<const stbi_uc*>(file.GetData());
 	if (format == Bitmap::FORMAT_RGBA_FLOAT)
 	{
 		return reinterpret_cast<char*>(stbi_loadf_from_memory(readPtr, static_cast<int>(file.GetLength()), pWidth, pHeight, pChannels, desiredChannels));
@@ -544,7 +528,7 @@ char* Bitmap::StbiLoad(const std::filesystem::path& path, Bitmap::Format format,
 
 Result Bitmap::LoadFile(const std::filesystem::path& path, Bitmap* pBitmap)
 {
-	if (!std::filesystem::exists(path)) return ERROR_PATH_DOES_NOT_EXIST;
+	if (!FileExists(path)) return ERROR_PATH_DOES_NOT_EXIST;
 
 	bool isRadiance = false;
 	Result ppxres = IsRadianceFile(path, isRadiance);
@@ -628,6 +612,676 @@ Result Bitmap::LoadFromMemory(const size_t dataSize, const void* pData, Bitmap*
 
 #pragma endregion
 
+//=============================================================================
+#pragma region [ Pixel Conversion ]
+
+// Scalar kernels. The SSE2 loops perform the same operations in the same order, so both paths agree to the bit.
+
+static inline float UnormToFloat(uint32_t value, float maxValue)
+{
+	return static_cast<float>(value) / maxValue;
+}
+
+static inline uint32_t FloatToUnorm(float value, float maxValue)
+{
+	// Same as max/min in SSE: NaN becomes 0
+	value = (value > 0.0f) ? value : 0.0f;
+	value = (value < 1.0f) ? value : 1.0f;
+	return static_cast<uint32_t>(static_cast<int32_t>(value * maxValue + 0.5f));
+}
+
+static inline uint16_t FloatToHalfScalar(float value)
+{
+	uint32_t f = 0;
+	memcpy(&f, &value, sizeof(f));
+	const uint32_t sign = f & 0x80000000u;
+	f ^= sign;
+
+	uint32_t h = 0;
+	if (f >= 0x47800000u) {
+		// Too large for a half, infinity or NaN
+		h = (f > 0x7F800000u) ? 0x7E00u : 0x7C00u;
+	}
+	else if (f < 0x38800000u) {
+		// Half denormal: adding 0.5 moves the mantissa down to the lowest bits and rounds it
+		float denormal = 0.0f;
+		memcpy(&denormal, &f, sizeof(f));
+		denormal += 0.5f;
+		memcpy(&h, &denormal, sizeof(h));
+		h -= 0x3F000000u;
+	}
+	else {
+		// Rebias the exponent and round the mantissa to nearest even
+		const uint32_t mantissaOdd = (f >> 13) & 1u;
+		h = (f + 0xC8000FFFu + mantissaOdd) >> 13;
+	}
+	return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+static inline float HalfToFloatScalar(uint16_t value)
+{
+	uint32_t       f = (value & 0x7FFFu) << 13;
+	const uint32_t exponent = f & 0x0F800000u;
+	f += 0x38000000u;
+	if (exponent == 0x0F800000u) {
+		// Infinity or NaN
+		f += 0x38000000u;
+	}
+	else if (exponent == 0) {
+		// Denormal: renormalize by subtracting the implicit one
+		f += 0x00800000u;
+		float denormal = 0.0f;
+		memcpy(&denormal, &f, sizeof(f));
+		denormal -= 6.103515625e-05f; // 2^-14
+		memcpy(&f, &denormal, sizeof(f));
+	}
+	f |= static_cast<uint32_t>(value & 0x8000u) << 16;
+
+	float result = 0.0f;
+	memcpy(&result, &f, sizeof(f));
+	return result;
+}
+
+static double SRGBToLinearValue(double value)
+{
+	return (value <= 0.04045) ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+}
+
+static double LinearToSRGBValue(double value)
+{
+	return (value <= 0.0031308) ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+// LinearToSRGB looks up linear values from 2^-13 up to 1 in buckets of the exponent and the top 7 mantissa bits. sRGB
+// values are spaced far enough apart that a bucket holds at most one step, so each bucket stores its first sRGB value
+// and the smallest linear value rounding to the next one. Below 2^-13 everything rounds to 0.
+constexpr uint32_t kSRGBBucketExponentMin = 127 - 13;
+constexpr uint32_t kSRGBBucketCount = 13 << 7;
+
+struct SRGBEncodeTable final
+{
+	std::array<float, kSRGBBucketCount>    thresholds;
+	std::array<uint32_t, kSRGBBucketCount> values;
+};
+
+static uint8_t LinearToSRGBRounded(float value)
+{
+	const double clamped = (value > 0.0f) ? std::min(static_cast<double>(value), 1.0) : 0.0;
+	return static_cast<uint8_t>(LinearToSRGBValue(clamped) * 255.0 + 0.5);
+}
+
+static const SRGBEncodeTable& GetSRGBEncodeTable()
+{
+	static const SRGBEncodeTable table = []() {
+		SRGBEncodeTable result;
+		for (uint32_t i = 0; i < kSRGBBucketCount; ++i) {
+			uint32_t first = (kSRGBBucketExponentMin << 23) + (i << 16);
+			uint32_t last = first + 0xFFFFu;
+			float    firstValue = 0.0f;
+			float    lastValue = 0.0f;
+			memcpy(&firstValue, &first, sizeof(first));
+			memcpy(&lastValue, &last, sizeof(last));
+
+			const uint8_t value = LinearToSRGBRounded(firstValue);
+			result.values[i] = value;
+			result.thresholds[i] = 2.0f;
+			if (LinearToSRGBRounded(lastValue) == value) continue;
+
+			// Smallest value in the bucket rounding to the next step
+			while (first < last) {
+				const uint32_t middle = first + (last - first) / 2;
+				float          middleValue = 0.0f;
+				memcpy(&middleValue, &middle, sizeof(middle));
+				if (LinearToSRGBRounded(middleValue) == value) first = middle + 1;
+				else last = middle;
+			}
+			memcpy(&result.thresholds[i], &first, sizeof(first));
+		}
+		return result;
+	}();
+	return table;
+}
+
+static inline uint8_t LinearToSRGBScalar(const SRGBEncodeTable& table, float value)
+{
+	if (!(value >= 1.220703125e-04f)) return 0; // 2^-13, also catches NaN
+	if (value >= 1.0f) return 255;
+
+	uint32_t bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint32_t bucket = (bits >> 16) - (kSRGBBucketExponentMin << 7);
+	return static_cast<uint8_t>(table.values[bucket] + ((value >= table.thresholds[bucket]) ? 1 : 0));
+}
+
+static inline float PremultiplyScalar(float color, float alpha)
+{
+	if (!std::isnan(color)) return color * alpha;
+
+	uint32_t bits = 0;
+	memcpy(&bits, &color, sizeof(bits));
+	bits |= 0x00400000u; // quiet
+	memcpy(&color, &bits, sizeof(bits));
+	return color;
+}
+
+#if defined(SIMD_SSE2)
+static inline __m128i FloatToUnormSSE2(__m128 value, __m128 maxValue)
+{
+	value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, maxValue), _mm_set1_ps(0.5f)));
+}
+
+// Packs eight 32 bit values up to 65535 into 16 bits, SSE2 only has a signed saturating pack
+static inline __m128i PackU32ToU16SSE2(__m128i lo, __m128i hi)
+{
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+	return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32)), bias16);
+}
+
+static inline __m128i FloatToHalfSSE2(__m128 value)
+{
+	const __m128i signMask = _mm_set1_epi32(static_cast<int>(0x80000000u));
+	__m128i       f = _mm_castps_si128(value);
+	const __m128i sign = _mm_and_si128(f, signMask);
+	f = _mm_xor_si128(f, sign);
+
+	const __m128i isNaN = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x7F800000));
+	const __m128i infNaN = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(isNaN, _mm_set1_epi32(0x0200)));
+	const __m128i isLarge = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x477FFFFF));
+	const __m128i isDenormal = _mm_cmplt_epi32(f, _mm_set1_epi32(0x38800000));
+
+	const __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), _mm_set1_ps(0.5f))), _mm_set1_epi32(0x3F000000));
+	const __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(1));
+	const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(f, _mm_set1_epi32(static_cast<int>(0xC8000FFFu))), mantissaOdd), 13);
+
+	__m128i h = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+	h = _mm_or_si128(_mm_and_si128(isLarge, infNaN), _mm_andnot_si128(isLarge, h));
+	return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+}
+
+static inline __m128 HalfToFloatSSE2(__m128i value)
+{
+	__m128i       f = _mm_slli_epi32(_mm_and_si128(value, _mm_set1_epi32(0x7FFF)), 13);
+	const __m128i exponent = _mm_and_si128(f, _mm_set1_epi32(0x0F800000));
+	f = _mm_add_epi32(f, _mm_set1_epi32(0x38000000));
+
+	const __m128i isInfNaN = _mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x0F800000));
+	const __m128i isDenormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+	const __m128i infNaN = _mm_add_epi32(f, _mm_set1_epi32(0x38000000));
+	const __m128i denormal = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(f, _mm_set1_epi32(0x00800000))), _mm_set1_ps(6.103515625e-05f)));
+
+	f = _mm_or_si128(_mm_and_si128(isInfNaN, infNaN), _mm_andnot_si128(isInfNaN, f));
+	f = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, f));
+	f = _mm_or_si128(f, _mm_slli_epi32(_mm_and_si128(value, _mm_set1_epi32(0x8000)), 16));
+	return _mm_castsi128_ps(f);
+}
+#endif
+
+namespace PixelConvert
+{
+	static bool sSimdEnabled = true;
+
+	void SetSimdEnabled(bool enabled)
+	{
+		sSimdEnabled = enabled;
+	}
+
+	bool IsSimdEnabled()
+	{
+#if defined(SIMD_SSE2)
+		return sSimdEnabled;
+#else
+		return false;
+#endif
+	}
+
+	void U8ToFloat(const uint8_t* pSrc, float* pDst, size_t count)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		const __m128  maxValue = _mm_set1_ps(255.0f);
+		const __m128i zero = _mm_setzero_si128();
+		for (; sSimdEnabled && i + 16 <= count; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+			const __m128i lo = _mm_unpacklo_epi8(v, zero);
+			const __m128i hi = _mm_unpackhi_epi8(v, zero);
+			_mm_storeu_ps(pDst + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), maxValue));
+			_mm_storeu_ps(pDst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), maxValue));
+			_mm_storeu_ps(pDst + i + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), maxValue));
+			_mm_storeu_ps(pDst + i + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), maxValue));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = UnormToFloat(pSrc[i], 255.0f);
+	}
+
+	void U16ToFloat(const uint16_t* pSrc, float* pDst, size_t count)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		const __m128  maxValue = _mm_set1_ps(65535.0f);
+		const __m128i zero = _mm_setzero_si128();
+		for (; sSimdEnabled && i + 8 <= count; i += 8) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+			_mm_storeu_ps(pDst + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), maxValue));
+			_mm_storeu_ps(pDst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), maxValue));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = UnormToFloat(pSrc[i], 65535.0f);
+	}
+
+	void FloatToU8(const float* pSrc, uint8_t* pDst, size_t count)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		const __m128 maxValue = _mm_set1_ps(255.0f);
+		for (; sSimdEnabled && i + 16 <= count; i += 16) {
+			const __m128i v0 = FloatToUnormSSE2(_mm_loadu_ps(pSrc + i + 0), maxValue);
+			const __m128i v1 = FloatToUnormSSE2(_mm_loadu_ps(pSrc + i + 4), maxValue);
+			const __m128i v2 = FloatToUnormSSE2(_mm_loadu_ps(pSrc + i + 8), maxValue);
+			const __m128i v3 = FloatToUnormSSE2(_mm_loadu_ps(pSrc + i + 12), maxValue);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3)));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = static_cast<uint8_t>(FloatToUnorm(pSrc[i], 255.0f));
+	}
+
+	void FloatToU16(const float* pSrc, uint16_t* pDst, size_t count)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		const __m128 maxValue = _mm_set1_ps(65535.0f);
+		for (; sSimdEnabled && i + 8 <= count; i += 8) {
+			const __m128i v0 = FloatToUnormSSE2(_mm_loadu_ps(pSrc + i + 0), maxValue);
+			const __m128i v1 = FloatToUnormSSE2(_mm_loadu_ps(pSrc + i + 4), maxValue);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), PackU32ToU16SSE2(v0, v1));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = static_cast<uint16_t>(FloatToUnorm(pSrc[i], 65535.0f));
+	}
+
+	void U8ToU16(const uint8_t* pSrc, uint16_t* pDst, size_t count)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		for (; sSimdEnabled && i + 16 <= count; i += 16) {
+			// Interleaving a byte with itself multiplies it by 257
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i + 0), _mm_unpacklo_epi8(v, v));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i + 8), _mm_unpackhi_epi8(v, v));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = static_cast<uint16_t>(pSrc[i] * 257u);
+	}
+
+	void U16ToU8(const uint16_t* pSrc, uint8_t* pDst, size_t count)
+	{
+		// (v * 255 + 32895) >> 16 is v / 257 rounded, for every 16 bit v
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		const __m128i scale = _mm_set1_epi16(255);
+		const __m128i bias = _mm_set1_epi32(32895);
+		for (; sSimdEnabled && i + 16 <= count; i += 16) {
+			__m128i packed[2];
+			for (size_t j = 0; j < 2; ++j) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + j * 8));
+				const __m128i lo = _mm_mullo_epi16(v, scale);
+				const __m128i hi = _mm_mulhi_epu16(v, scale);
+				const __m128i p0 = _mm_srli_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), bias), 16);
+				const __m128i p1 = _mm_srli_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), bias), 16);
+				packed[j] = _mm_packs_epi32(p0, p1);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_packus_epi16(packed[0], packed[1]));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = static_cast<uint8_t>((pSrc[i] * 255u + 32895u) >> 16);
+	}
+
+	void FloatToHalf(const float* pSrc, uint16_t* pDst, size_t count)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		for (; sSimdEnabled && i + 8 <= count; i += 8) {
+			const __m128i h0 = FloatToHalfSSE2(_mm_loadu_ps(pSrc + i + 0));
+			const __m128i h1 = FloatToHalfSSE2(_mm_loadu_ps(pSrc + i + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), PackU32ToU16SSE2(h0, h1));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = FloatToHalfScalar(pSrc[i]);
+	}
+
+	void HalfToFloat(const uint16_t* pSrc, float* pDst, size_t count)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		for (; sSimdEnabled && i + 8 <= count; i += 8) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+			_mm_storeu_ps(pDst + i + 0, HalfToFloatSSE2(_mm_unpacklo_epi16(v, zero)));
+			_mm_storeu_ps(pDst + i + 4, HalfToFloatSSE2(_mm_unpackhi_epi16(v, zero)));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = HalfToFloatScalar(pSrc[i]);
+	}
+
+	void SRGBToLinear(const uint8_t* pSrc, float* pDst, size_t count)
+	{
+		// A table lookup on every CPU, SSE2 has no gather that would beat it
+		static const std::array<float, 256> table = []() {
+			std::array<float, 256> result;
+			for (size_t i = 0; i < result.size(); ++i)
+				result[i] = static_cast<float>(LinearColor::sRGBToLinearTable[i]);
+			return result;
+		}();
+
+		for (size_t i = 0; i < count; ++i)
+			pDst[i] = table[pSrc[i]];
+	}
+
+	void LinearToSRGB(const float* pSrc, uint8_t* pDst, size_t count)
+	{
+		const SRGBEncodeTable& table = GetSRGBEncodeTable();
+
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		// Buckets are found and compared four at a time, only the table loads are scalar
+		const __m128  minValue = _mm_set1_ps(1.220703125e-04f);
+		const __m128  one = _mm_set1_ps(1.0f);
+		const __m128i bucketBias = _mm_set1_epi32(static_cast<int>(kSRGBBucketExponentMin << 7));
+		alignas(16) int32_t buckets[4];
+		alignas(16) float   thresholds[4];
+		alignas(16) int32_t values[4];
+		for (; sSimdEnabled && i + 4 <= count; i += 4) {
+			const __m128 v = _mm_loadu_ps(pSrc + i);
+			const __m128 inTable = _mm_and_ps(_mm_cmpge_ps(v, minValue), _mm_cmplt_ps(v, one));
+			const __m128i bucket = _mm_and_si128(_mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(v), 16), bucketBias), _mm_castps_si128(inTable));
+			_mm_store_si128(reinterpret_cast<__m128i*>(buckets), bucket);
+			for (size_t j = 0; j < 4; ++j) {
+				thresholds[j] = table.thresholds[static_cast<size_t>(buckets[j])];
+				values[j] = static_cast<int32_t>(table.values[static_cast<size_t>(buckets[j])]);
+			}
+
+			// value + 1 above the threshold, 0 below the table and 255 above it
+			__m128i result = _mm_sub_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(values)), _mm_castps_si128(_mm_cmpge_ps(v, _mm_load_ps(thresholds))));
+			result = _mm_and_si128(result, _mm_castps_si128(inTable));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_castps_si128(_mm_cmpge_ps(v, one)), _mm_set1_epi32(255)));
+			result = _mm_packs_epi32(result, result);
+			const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(result, result));
+			memcpy(pDst + i, &packed, sizeof(packed));
+		}
+#endif
+		for (; i < count; ++i)
+			pDst[i] = LinearToSRGBScalar(table, pSrc[i]);
+	}
+
+	void PremultiplyAlpha(uint8_t* pRGBA, size_t pixelCount)
+	{
+		// t = c * a + 128, (t + (t >> 8)) >> 8 is c * a / 255 rounded. Alpha is multiplied by 255 to keep it.
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+		const __m128i alphaScale = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+		const __m128i bias = _mm_set1_epi16(128);
+		const auto    premultiply = [&](__m128i pixels) {
+			__m128i scale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			scale = _mm_or_si128(_mm_and_si128(scale, colorMask), alphaScale);
+			const __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, scale), bias);
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		};
+		for (; sSimdEnabled && i + 4 <= pixelCount; i += 4) {
+			__m128i* pPixels = reinterpret_cast<__m128i*>(pRGBA + i * 4);
+			const __m128i v = _mm_loadu_si128(pPixels);
+			_mm_storeu_si128(pPixels, _mm_packus_epi16(premultiply(_mm_unpacklo_epi8(v, zero)), premultiply(_mm_unpackhi_epi8(v, zero))));
+		}
+#endif
+		for (; i < pixelCount; ++i) {
+			uint8_t*       pPixel = pRGBA + i * 4;
+			const uint32_t alpha = pPixel[3];
+			for (size_t c = 0; c < 3; ++c)
+				pPixel[c] = static_cast<uint8_t>((pPixel[c] * alpha + 127u) / 255u);
+		}
+	}
+
+	void PremultiplyAlpha(float* pRGBA, size_t pixelCount)
+	{
+		size_t i = 0;
+#if defined(SIMD_SSE2)
+		// Alpha is copied, not multiplied by one, which would quiet a signaling NaN. Which NaN a product of two NaNs
+		// returns depends on the operand order the compiler picks, so NaN channels are quieted explicitly.
+		const __m128 colorMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		const __m128 quietBit = _mm_castsi128_ps(_mm_set1_epi32(0x00400000));
+		for (; sSimdEnabled && i < pixelCount; ++i) {
+			float* pPixel = pRGBA + i * 4;
+			const __m128 v = _mm_loadu_ps(pPixel);
+			const __m128 isNaN = _mm_cmpunord_ps(v, v);
+			__m128       premultiplied = _mm_mul_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+			premultiplied = _mm_or_ps(_mm_and_ps(isNaN, _mm_or_ps(v, quietBit)), _mm_andnot_ps(isNaN, premultiplied));
+			_mm_storeu_ps(pPixel, _mm_or_ps(_mm_and_ps(premultiplied, colorMask), _mm_andnot_ps(colorMask, v)));
+		}
+#endif
+		for (; i < pixelCount; ++i) {
+			float* pPixel = pRGBA + i * 4;
+			for (size_t c = 0; c < 3; ++c)
+				pPixel[c] = PremultiplyScalar(pPixel[c], pPixel[3]);
+		}
+	}
+
+	void RGBToRGBA(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+	{
+		// Whole pixels are moved as 32 bit words, the byte after each RGB triple is replaced by alpha. The last pixel
+		// goes byte by byte so nothing past the source is read.
+		const uint32_t alphaBits = static_cast<uint32_t>(alpha) << 24;
+		size_t         i = 0;
+		for (; i + 1 < pixelCount; ++i) {
+			uint32_t pixel = 0;
+			memcpy(&pixel, pSrc + i * 3, sizeof(pixel));
+			pixel = (pixel & 0x00FFFFFFu) | alphaBits;
+			memcpy(pDst + i * 4, &pixel, sizeof(pixel));
+		}
+		for (; i < pixelCount; ++i) {
+			pDst[i * 4 + 0] = pSrc[i * 3 + 0];
+			pDst[i * 4 + 1] = pSrc[i * 3 + 1];
+			pDst[i * 4 + 2] = pSrc[i * 3 + 2];
+			pDst[i * 4 + 3] = alpha;
+		}
+	}
+
+	void RGBAToRGB(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount)
+	{
+		// Each 32 bit store spills one byte into the next pixel, which the next store overwrites
+		size_t i = 0;
+		for (; i + 1 < pixelCount; ++i) {
+			uint32_t pixel = 0;
+			memcpy(&pixel, pSrc + i * 4, sizeof(pixel));
+			memcpy(pDst + i * 3, &pixel, sizeof(pixel));
+		}
+		for (; i < pixelCount; ++i) {
+			pDst[i * 3 + 0] = pSrc[i * 4 + 0];
+			pDst[i * 3 + 1] = pSrc[i * 4 + 1];
+			pDst[i * 3 + 2] = pSrc[i * 4 + 2];
+		}
+	}
+} // namespace PixelConvert
+
+// Converts a row of any data type to floats, keeping the channel layout
+static void RowToFloat(const char* pSrc, Bitmap::DataType type, size_t count, bool srgb, uint32_t channelCount, float* pDst)
+{
+	switch (type) {
+	case Bitmap::DATA_TYPE_UINT8:
+		if (srgb) {
+			PixelConvert::SRGBToLinear(reinterpret_cast<const uint8_t*>(pSrc), pDst, count);
+			// Alpha is never sRGB
+			if (channelCount == 4) {
+				for (size_t i = 3; i < count; i += 4)
+					pDst[i] = UnormToFloat(reinterpret_cast<const uint8_t*>(pSrc)[i], 255.0f);
+			}
+			return;
+		}
+		PixelConvert::U8ToFloat(reinterpret_cast<const uint8_t*>(pSrc), pDst, count);
+		break;
+	case Bitmap::DATA_TYPE_UINT16:
+		PixelConvert::U16ToFloat(reinterpret_cast<const uint16_t*>(pSrc), pDst, count);
+		break;
+	case Bitmap::DATA_TYPE_UINT32:
+		for (size_t i = 0; i < count; ++i)
+			pDst[i] = static_cast<float>(static_cast<double>(reinterpret_cast<const uint32_t*>(pSrc)[i]) / 4294967295.0);
+		break;
+	default:
+		memcpy(pDst, pSrc, count * sizeof(float));
+		break;
+	}
+
+	if (srgb) {
+		for (size_t i = 0; i < count; ++i) {
+			if ((channelCount != 4) || ((i % 4) != 3))
+				pDst[i] = static_cast<float>(SRGBToLinearValue(pDst[i]));
+		}
+	}
+}
+
+// Converts a row of floats to any data type, keeping the channel layout
+static void FloatToRow(float* pSrc, Bitmap::DataType type, size_t count, bool srgb, uint32_t channelCount, char* pDst)
+{
+	if (srgb && (type == Bitmap::DATA_TYPE_UINT8)) {
+		uint8_t* pDst8 = reinterpret_cast<uint8_t*>(pDst);
+		PixelConvert::LinearToSRGB(pSrc, pDst8, count);
+		if (channelCount == 4) {
+			for (size_t i = 3; i < count; i += 4)
+				pDst8[i] = static_cast<uint8_t>(FloatToUnorm(pSrc[i], 255.0f));
+		}
+		return;
+	}
+
+	if (srgb) {
+		for (size_t i = 0; i < count; ++i) {
+			if ((channelCount != 4) || ((i % 4) != 3))
+				pSrc[i] = static_cast<float>(LinearToSRGBValue(std::clamp(pSrc[i], 0.0f, 1.0f)));
+		}
+	}
+
+	switch (type) {
+	case Bitmap::DATA_TYPE_UINT8:
+		PixelConvert::FloatToU8(pSrc, reinterpret_cast<uint8_t*>(pDst), count);
+		break;
+	case Bitmap::DATA_TYPE_UINT16:
+		PixelConvert::FloatToU16(pSrc, reinterpret_cast<uint16_t*>(pDst), count);
+		break;
+	case Bitmap::DATA_TYPE_UINT32:
+		for (size_t i = 0; i < count; ++i) {
+			const double value = std::clamp(static_cast<double>(pSrc[i]), 0.0, 1.0);
+			reinterpret_cast<uint32_t*>(pDst)[i] = static_cast<uint32_t>(value * 4294967295.0 + 0.5);
+		}
+		break;
+	default:
+		memcpy(pDst, pSrc, count * sizeof(float));
+		break;
+	}
+}
+
+Result ConvertBitmap(const Bitmap& src, Bitmap::Format format, Bitmap* pDst, const BitmapConversion& conversion)
+{
+	if (IsNull(pDst)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
+	if (!src.IsOk() || (format == Bitmap::FORMAT_UNDEFINED) || (pDst == &src)) return ERROR_IMAGE_INVALID_FORMAT;
+
+	Result ppxres = Bitmap::Create(src.GetWidth(), src.GetHeight(), format, pDst);
+	if (Failed(ppxres)) return ppxres;
+
+	const Bitmap::DataType srcType = Bitmap::ChannelDataType(src.GetFormat());
+	const Bitmap::DataType dstType = Bitmap::ChannelDataType(format);
+	const uint32_t         srcChannels = src.GetChannelCount();
+	const uint32_t         dstChannels = pDst->GetChannelCount();
+	const size_t           width = src.GetWidth();
+	const bool             premultiply = conversion.premultiplyAlpha && (srcChannels == 4);
+	const bool             valuesOnly = !conversion.srgbToLinear && !conversion.linearToSrgb && !premultiply;
+
+	const auto convertRow = [&](uint32_t y, std::vector<float>& srcRow, std::vector<float>& dstRow) {
+		const char* pSrcRow = src.GetPixelAddress(0, y);
+		char*       pDstRow = pDst->GetPixelAddress(0, y);
+
+		// Conversions that don't need to go through floats
+		if (valuesOnly && (src.GetFormat() == format)) {
+			memcpy(pDstRow, pSrcRow, width * src.GetPixelStride());
+			return;
+		}
+		if (valuesOnly && (srcType == Bitmap::DATA_TYPE_UINT8) && (dstType == Bitmap::DATA_TYPE_UINT8)) {
+			if ((srcChannels == 3) && (dstChannels == 4)) {
+				PixelConvert::RGBToRGBA(reinterpret_cast<const uint8_t*>(pSrcRow), reinterpret_cast<uint8_t*>(pDstRow), width);
+				return;
+			}
+			if ((srcChannels == 4) && (dstChannels == 3)) {
+				PixelConvert::RGBAToRGB(reinterpret_cast<const uint8_t*>(pSrcRow), reinterpret_cast<uint8_t*>(pDstRow), width);
+				return;
+			}
+		}
+		if (valuesOnly && (srcChannels == dstChannels)) {
+			const size_t count = width * srcChannels;
+			if ((srcType == Bitmap::DATA_TYPE_UINT8) && (dstType == Bitmap::DATA_TYPE_UINT16)) {
+				PixelConvert::U8ToU16(reinterpret_cast<const uint8_t*>(pSrcRow), reinterpret_cast<uint16_t*>(pDstRow), count);
+				return;
+			}
+			if ((srcType == Bitmap::DATA_TYPE_UINT16) && (dstType == Bitmap::DATA_TYPE_UINT8)) {
+				PixelConvert::U16ToU8(reinterpret_cast<const uint16_t*>(pSrcRow), reinterpret_cast<uint8_t*>(pDstRow), count);
+				return;
+			}
+		}
+		if ((src.GetFormat() == Bitmap::FORMAT_RGBA_UINT8) && (format == Bitmap::FORMAT_RGBA_UINT8) && !conversion.srgbToLinear && !conversion.linearToSrgb) {
+			memcpy(pDstRow, pSrcRow, width * 4);
+			PixelConvert::PremultiplyAlpha(reinterpret_cast<uint8_t*>(pDstRow), width);
+			return;
+		}
+
+		// Everything else goes through float RGBA
+		srcRow.resize(width * srcChannels);
+		dstRow.resize(width * 4);
+		RowToFloat(pSrcRow, srcType, srcRow.size(), conversion.srgbToLinear, srcChannels, srcRow.data());
+		if (srcChannels == 4) {
+			dstRow.swap(srcRow);
+		}
+		else {
+			for (size_t x = 0; x < width; ++x) {
+				for (uint32_t c = 0; c < 4; ++c)
+					dstRow[x * 4 + c] = (c < srcChannels) ? srcRow[x * srcChannels + c] : ((c == 3) ? 1.0f : 0.0f);
+			}
+		}
+
+		if (premultiply) {
+			PixelConvert::PremultiplyAlpha(dstRow.data(), width);
+		}
+
+		if (dstChannels != 4) {
+			for (size_t x = 0; x < width; ++x) {
+				for (uint32_t c = 0; c < dstChannels; ++c)
+					dstRow[x * dstChannels + c] = dstRow[x * 4 + c];
+			}
+		}
+		FloatToRow(dstRow.data(), dstType, width * dstChannels, conversion.linearToSrgb, dstChannels, pDstRow);
+	};
+
+	// Bands of about 64K pixels are converted in parallel
+	const uint32_t rowsPerBand = std::max<uint32_t>(1, static_cast<uint32_t>(65536 / width));
+	const uint32_t bandCount = (src.GetHeight() + rowsPerBand - 1) / rowsPerBand;
+	ParallelFor(bandCount, [&](size_t band) {
+		std::vector<float> srcRow;
+		std::vector<float> dstRow;
+		const uint32_t     rowEnd = std::min(static_cast<uint32_t>(band + 1) * rowsPerBand, src.GetHeight());
+		for (uint32_t y = static_cast<uint32_t>(band) * rowsPerBand; y < rowEnd; ++y)
+			convertRow(y, srcRow, dstRow);
+	});
+
+	return SUCCESS;
+}
+
+#pragma endregion
+
 //=============================================================================
 #pragma region [ Mipmap ]
 
@@ -839,8 +1493,8 @@ Result Mipmap::LoadFile(const std::filesystem::path& path, uint32_t baseWidth, u
 	if ((width != baseWidth) || (height < totalHeight)) return ERROR_BITMAP_FOOTPRINT_MISMATCH;
 
 	// Load file
-	auto fileBytes = ::LoadFile(path);
-	if (!fileBytes.has_value()) return ERROR_IMAGE_FILE_LOAD_FAILED;
+	MappedFile file;
+	if (!file.Open(path)) return ERROR_IMAGE_FILE_LOAD_FAILED;
 
 	// Load bitmap
 	void* pStbiData = nullptr;
@@ -851,8 +1505,8 @@ Result Mipmap::LoadFile(const std::filesystem::path& path, uint32_t baseWidth, u
 	if (Bitmap::ChannelDataType(format) == Bitmap::DATA_TYPE_UINT8)
 	{
 		pStbiData = stbi_load_from_memory(
-			reinterpret_cast<const stbi_uc*>(fileBytes.value().data()),
-			static_cast<int>(fileBytes.value().size()),
+			reinterpret_cast<const stbi_uc*>(file.GetData()),
+			static_cast<int>(file.GetLength()),
 			&stbiWidth,
 			&stbiHeight,
 			&stbiChannels,
@@ -861,8 +1515,8 @@ Result Mipmap::LoadFile(const std::filesystem::path& path, uint32_t baseWidth, u
 	else if (Bitmap::ChannelDataType(format) == Bitmap::DATA_TYPE_FLOAT)
 	{
 		pStbiData = stbi_loadf_from_memory(
-			reinterpret_cast<const stbi_uc*>(fileBytes.value().data()),
-			static_cast<int>(fileBytes.value().size()),
+			reinterpret_cast<const stbi_uc*>(file.GetData()),
+			static_cast<int>(file.GetLength()),
 			&stbiWidth,
 			&stbiHeight,
 			&stbiChannels,
@@ -911,48 +1565,761 @@ Result Mipmap::LoadFile(const std::filesystem::path& path, uint32_t baseWidth, u
 #pragma endregion
 
 //=============================================================================
-#pragma region [ Font ]
+#pragma region [ Block Compression ]
 
-void Font::AcquireFontMetrics()
+const char* ToString(BlockFormat format)
 {
-	stbtt_GetFontVMetrics(&mObject->fontInfo, &mObject->ascent, &mObject->descent, &mObject->lineGap);
+	switch (format)
+	{
+	case BlockFormat::BC1: return "BC1";
+	case BlockFormat::BC3: return "BC3";
+	case BlockFormat::BC4: return "BC4";
+	case BlockFormat::BC5: return "BC5";
+	case BlockFormat::BC7: return "BC7";
+	default: return "Undefined";
+	}
 }
 
-Result Font::CreateFromFile(const std::filesystem::path& path, Font* pFont)
+uint32_t BlockFormatSize(BlockFormat format)
 {
-	if (IsNull(pFont)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
-
-	if (!std::filesystem::exists(path)) return ERROR_PATH_DOES_NOT_EXIST;
+	switch (format)
+	{
+	case BlockFormat::BC1:
+	case BlockFormat::BC4: return 8;
+	case BlockFormat::BC3:
+	case BlockFormat::BC5:
+	case BlockFormat::BC7: return 16;
+	default: return 0;
+	}
+}
 
-	std::ifstream is(path.c_str(), std::ios::binary);
-	if (!is.is_open()) return ERROR_BAD_DATA_SOURCE;
+gli::format ToGliFormat(BlockFormat format)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1: return gli::FORMAT_RGBA_DXT1_UNORM_BLOCK8;
+	case BlockFormat::BC3: return gli::FORMAT_RGBA_DXT5_UNORM_BLOCK16;
+	case BlockFormat::BC4: return gli::FORMAT_R_ATI1N_UNORM_BLOCK8;
+	case BlockFormat::BC5: return gli::FORMAT_RG_ATI2N_UNORM_BLOCK16;
+	case BlockFormat::BC7: return gli::FORMAT_RGBA_BP_UNORM_BLOCK16;
+	default: return gli::FORMAT_UNDEFINED;
+	}
+}
 
-	is.seekg(0, std::ios::end);
-	size_t size = static_cast<size_t>(is.tellg());
-	is.seekg(0, std::ios::beg);
+// 4x4 pixels, row by row
+using BlockPixels = std::array<std::array<uint8_t, 4>, 16>;
 
-	auto object = std::make_shared<Font::Object>();
-	if (!object) return ERROR_ALLOCATION_FAILED;
+static void FetchBlock(const Bitmap& bitmap, uint32_t blockX, uint32_t blockY, BlockPixels& block)
+{
+	const uint32_t maxX = bitmap.GetWidth() - 1;
+	const uint32_t maxY = bitmap.GetHeight() - 1;
+	for (uint32_t y = 0; y < 4; ++y)
+	{
+		const uint32_t py = std::min(blockY * 4 + y, maxY);
+		for (uint32_t x = 0; x < 4; ++x)
+		{
+			const uint32_t px = std::min(blockX * 4 + x, maxX);
+			std::memcpy(block[y * 4 + x].data(), bitmap.GetPixelAddress(px, py), 4);
+		}
+	}
+}
 
-	object->fontData.resize(size);
-	is.read(reinterpret_cast<char*>(object->fontData.data()), static_cast<std::streamsize>(size));
+// Endpoints of the line through the points along their principal axis, found by power iteration on the covariance matrix.
+template <size_t N>
+static void FitLine(const std::array<std::array<float, N>, 16>& points, std::array<float, N>& end0, std::array<float, N>& end1)
+{
+	std::array<float, N> mean{};
+	for (const auto& p : points)
+		for (size_t c = 0; c < N; ++c) mean[c] += p[c] / 16.0f;
 
-	int stbres = stbtt_InitFont(&object->fontInfo, object->fontData.data(), 0);
-	if (stbres == 0) return Result::ERROR_FONT_PARSE_FAILED;
+	float cov[N][N] = {};
+	for (const auto& p : points)
+		for (size_t a = 0; a < N; ++a)
+			for (size_t b = 0; b < N; ++b) cov[a][b] += (p[a] - mean[a]) * (p[b] - mean[b]);
 
-	pFont->mObject = object;
-	pFont->AcquireFontMetrics();
+	// Start from the largest extent so blocks with a dominant channel converge at once
+	std::array<float, N> axis{};
+	for (const auto& p : points)
+		for (size_t c = 0; c < N; ++c) axis[c] = std::max(axis[c], std::abs(p[c] - mean[c]));
+	for (int iteration = 0; iteration < 8; ++iteration)
+	{
+		std::array<float, N> next{};
+		for (size_t a = 0; a < N; ++a)
+			for (size_t b = 0; b < N; ++b) next[a] += cov[a][b] * axis[b];
+		float length = 0.0f;
+		for (size_t c = 0; c < N; ++c) length = std::max(length, std::abs(next[c]));
+		if (length < 1e-6f) break;
+		for (size_t c = 0; c < N; ++c) axis[c] = next[c] / length;
+	}
+	float lengthSq = 0.0f;
+	for (size_t c = 0; c < N; ++c) lengthSq += axis[c] * axis[c];
+	if (lengthSq < 1e-12f)
+	{
+		end0 = mean;
+		end1 = mean;
+		return;
+	}
 
-	return SUCCESS;
+	float minT = FLT_MAX;
+	float maxT = -FLT_MAX;
+	for (const auto& p : points)
+	{
+		float t = 0.0f;
+		for (size_t c = 0; c < N; ++c) t += (p[c] - mean[c]) * axis[c];
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+	for (size_t c = 0; c < N; ++c)
+	{
+		end0[c] = std::clamp(mean[c] + axis[c] * minT / lengthSq, 0.0f, 255.0f);
+		end1[c] = std::clamp(mean[c] + axis[c] * maxT / lengthSq, 0.0f, 255.0f);
+	}
 }
 
-Result Font::CreateFromMemory(size_t size, const char* pData, Font* pFont)
+// Least squares endpoints for points interpolated between them with the given weights (0 at end0, 1 at end1).
+// Returns false if the weights don't pin down both endpoints.
+template <size_t N>
+static bool RefineLine(const std::array<std::array<float, N>, 16>& points, const std::array<float, 16>& weights, std::array<float, N>& end0, std::array<float, N>& end1)
 {
-	if (IsNull(pFont)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
-	if ((size == 0) || IsNull(pData)) return ERROR_BAD_DATA_SOURCE;
-
-	auto object = std::make_shared<Font::Object>();
-	if (!object) return ERROR_ALLOCATION_FAILED;
+	float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+	std::array<float, N> ax{}, bx{};
+	for (size_t i = 0; i < 16; ++i)
+	{
+		const float b = weights[i];
+		const float a = 1.0f - b;
+		aa += a * a;
+		bb += b * b;
+		ab += a * b;
+		for (size_t c = 0; c < N; ++c)
+		{
+			ax[c] += a * points[i][c];
+			bx[c] += b * points[i][c];
+		}
+	}
+	const float det = aa * bb - ab * ab;
+	if (std::abs(det) < 1e-6f) return false;
+	for (size_t c = 0; c < N; ++c)
+	{
+		end0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+		end1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+	}
+	return true;
+}
+
+static void PutBits(uint8_t* pData, uint32_t& bitOffset, uint32_t value, uint32_t bitCount)
+{
+	for (uint32_t i = 0; i < bitCount; ++i, ++bitOffset)
+		pData[bitOffset / 8] |= static_cast<uint8_t>(((value >> i) & 1) << (bitOffset % 8));
+}
+
+// BC1 color block, always in 4 color mode so it can be used inside BC3 as well.
+// Returns the squared error over RGB.
+static uint32_t EncodeColorBlock(const BlockPixels& block, uint8_t* pOutput)
+{
+	std::array<std::array<float, 3>, 16> points;
+	for (size_t i = 0; i < 16; ++i)
+		for (size_t c = 0; c < 3; ++c) points[i][c] = block[i][c];
+
+	const auto pack565 = [](const std::array<float, 3>& color) {
+		const uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+		const uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+		const uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	};
+	const auto unpack565 = [](uint16_t value, int* pColor) {
+		const int r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+		pColor[0] = (r << 3) | (r >> 2);
+		pColor[1] = (g << 2) | (g >> 4);
+		pColor[2] = (b << 3) | (b >> 2);
+	};
+
+	uint32_t bestError = UINT32_MAX;
+	uint16_t bestEnds[2] = {};
+	uint32_t bestIndices = 0;
+	std::array<float, 16> weights{};
+	const auto evaluate = [&](uint16_t c0, uint16_t c1) {
+		// c0 > c1 selects 4 color mode, equal endpoints decode the same in both modes
+		if (c0 < c1) std::swap(c0, c1);
+		int palette[4][3];
+		unpack565(c0, palette[0]);
+		unpack565(c1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		static constexpr float kWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+		uint32_t error = 0;
+		uint32_t indices = 0;
+		std::array<float, 16> blockWeights;
+		for (size_t i = 0; i < 16; ++i)
+		{
+			uint32_t bestPixelError = UINT32_MAX;
+			uint32_t bestIndex = 0;
+			for (uint32_t k = 0; k < (c0 == c1 ? 1u : 4u); ++k)
+			{
+				uint32_t pixelError = 0;
+				for (int c = 0; c < 3; ++c)
+				{
+					const int d = palette[k][c] - block[i][c];
+					pixelError += static_cast<uint32_t>(d * d);
+				}
+				if (pixelError < bestPixelError)
+				{
+					bestPixelError = pixelError;
+					bestIndex = k;
+				}
+			}
+			error += bestPixelError;
+			indices |= bestIndex << (2 * i);
+			blockWeights[i] = kWeights[bestIndex];
+		}
+		if (error < bestError)
+		{
+			bestError = error;
+			bestEnds[0] = c0;
+			bestEnds[1] = c1;
+			bestIndices = indices;
+			weights = blockWeights;
+		}
+	};
+
+	std::array<float, 3> end0, end1;
+	FitLine(points, end0, end1);
+	evaluate(pack565(end1), pack565(end0));
+	for (int iteration = 0; iteration < 2 && bestError > 0; ++iteration)
+	{
+		// weights are relative to the first endpoint of the best block
+		if (!RefineLine(points, weights, end0, end1)) break;
+		const uint32_t previousError = bestError;
+		evaluate(pack565(end0), pack565(end1));
+		if (bestError == previousError) break;
+	}
+
+	std::memcpy(pOutput, &bestEnds[0], 2);
+	std::memcpy(pOutput + 2, &bestEnds[1], 2);
+	std::memcpy(pOutput + 4, &bestIndices, 4);
+	return bestError;
+}
+
+// BC4 block for one channel in 8 value mode. Returns the squared error.
+static uint32_t EncodeChannelBlock(const BlockPixels& block, uint32_t channel, uint8_t* pOutput)
+{
+	int minValue = 255, maxValue = 0;
+	for (const auto& pixel : block)
+	{
+		minValue = std::min<int>(minValue, pixel[channel]);
+		maxValue = std::max<int>(maxValue, pixel[channel]);
+	}
+
+	int palette[8] = { maxValue, minValue };
+	for (int k = 2; k < 8; ++k)
+		palette[k] = ((8 - k) * maxValue + (k - 1) * minValue) / 7;
+
+	std::memset(pOutput, 0, 8);
+	pOutput[0] = static_cast<uint8_t>(maxValue);
+	pOutput[1] = static_cast<uint8_t>(minValue);
+	uint32_t error = 0;
+	uint32_t bitOffset = 16;
+	for (const auto& pixel : block)
+	{
+		uint32_t bestIndex = 0;
+		int bestDistance = 256;
+		for (uint32_t k = 0; k < (maxValue == minValue ? 1u : 8u); ++k)
+		{
+			const int distance = std::abs(palette[k] - pixel[channel]);
+			if (distance < bestDistance)
+			{
+				bestDistance = distance;
+				bestIndex = k;
+			}
+		}
+		error += static_cast<uint32_t>(bestDistance * bestDistance);
+		PutBits(pOutput, bitOffset, bestIndex, 3);
+	}
+	return error;
+}
+
+// BC7 mode 6: one subset, RGBA endpoints with 7 bits and a p-bit each, 4-bit indices. Returns the squared error over RGBA.
+static uint32_t EncodeBC7Mode6(const BlockPixels& block, uint8_t* pOutput)
+{
+	static constexpr int kWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	std::array<std::array<float, 4>, 16> points;
+	for (size_t i = 0; i < 16; ++i)
+		for (size_t c = 0; c < 4; ++c) points[i][c] = block[i][c];
+
+	struct Candidate
+	{
+		uint32_t error = UINT32_MAX;
+		int      ends[2][4] = {}; // 7 bits
+		int      pBits[2] = {};
+		uint8_t  indices[16] = {};
+	};
+	Candidate best;
+	std::array<float, 16> weights{};
+
+	const auto evaluate = [&](const std::array<float, 4>& end0, const std::array<float, 4>& end1) {
+		for (int p = 0; p < 4; ++p)
+		{
+			Candidate candidate;
+			candidate.pBits[0] = p & 1;
+			candidate.pBits[1] = p >> 1;
+			int colors[2][4];
+			for (int c = 0; c < 4; ++c)
+			{
+				const float ends[2] = { end0[c], end1[c] };
+				for (int e = 0; e < 2; ++e)
+				{
+					candidate.ends[e][c] = std::clamp(static_cast<int>((ends[e] - candidate.pBits[e]) / 2.0f + 0.5f), 0, 127);
+					colors[e][c] = (candidate.ends[e][c] << 1) | candidate.pBits[e];
+				}
+			}
+
+			int direction[4];
+			int lengthSq = 0;
+			for (int c = 0; c < 4; ++c)
+			{
+				direction[c] = colors[1][c] - colors[0][c];
+				lengthSq += direction[c] * direction[c];
+			}
+
+			uint32_t error = 0;
+			for (size_t i = 0; i < 16 && error < best.error; ++i)
+			{
+				// Project onto the line for a first guess, then check the neighbouring weights
+				int guess = 0;
+				if (lengthSq > 0)
+				{
+					int dot = 0;
+					for (int c = 0; c < 4; ++c) dot += (block[i][c] - colors[0][c]) * direction[c];
+					const int t = std::clamp((dot * 64 + lengthSq / 2) / lengthSq, 0, 64);
+					while (guess < 15 && kWeights[guess + 1] <= t) ++guess;
+				}
+				uint32_t bestPixelError = UINT32_MAX;
+				for (int k = std::max(guess - 1, 0); k <= std::min(guess + 1, 15); ++k)
+				{
+					uint32_t pixelError = 0;
+					for (int c = 0; c < 4; ++c)
+					{
+						const int value = ((64 - kWeights[k]) * colors[0][c] + kWeights[k] * colors[1][c] + 32) >> 6;
+						const int d = value - block[i][c];
+						pixelError += static_cast<uint32_t>(d * d);
+					}
+					if (pixelError < bestPixelError)
+					{
+						bestPixelError = pixelError;
+						candidate.indices[i] = static_cast<uint8_t>(k);
+					}
+				}
+				error += bestPixelError;
+			}
+			candidate.error = error;
+			if (candidate.error < best.error)
+			{
+				best = candidate;
+				for (size_t i = 0; i < 16; ++i) weights[i] = kWeights[best.indices[i]] / 64.0f;
+			}
+		}
+	};
+
+	std::array<float, 4> end0, end1;
+	FitLine(points, end0, end1);
+	evaluate(end0, end1);
+	for (int iteration = 0; iteration < 2 && best.error > 0; ++iteration)
+	{
+		if (!RefineLine(points, weights, end0, end1)) break;
+		const uint32_t previousError = best.error;
+		evaluate(end0, end1);
+		if (best.error == previousError) break;
+	}
+
+	// The anchor index is stored without its top bit, so the first pixel must use the lower half of the weights
+	if (best.indices[0] >= 8)
+	{
+		std::swap(best.ends[0], best.ends[1]);
+		std::swap(best.pBits[0], best.pBits[1]);
+		for (auto& index : best.indices) index = static_cast<uint8_t>(15 - index);
+	}
+
+	std::memset(pOutput, 0, 16);
+	uint32_t bitOffset = 0;
+	PutBits(pOutput, bitOffset, 1 << 6, 7);
+	for (int c = 0; c < 4; ++c)
+	{
+		PutBits(pOutput, bitOffset, static_cast<uint32_t>(best.ends[0][c]), 7);
+		PutBits(pOutput, bitOffset, static_cast<uint32_t>(best.ends[1][c]), 7);
+	}
+	PutBits(pOutput, bitOffset, static_cast<uint32_t>(best.pBits[0]), 1);
+	PutBits(pOutput, bitOffset, static_cast<uint32_t>(best.pBits[1]), 1);
+	for (size_t i = 0; i < 16; ++i)
+		PutBits(pOutput, bitOffset, best.indices[i], i == 0 ? 3 : 4);
+	return best.error;
+}
+
+// Fits N channels of the block starting at firstChannel to endpoints with the given bit count and the 4 weights of BC7 mode 5.
+// Returns the squared error, the anchor index is already in the lower half.
+template <size_t N>
+static uint32_t FitBC7Mode5Part(const BlockPixels& block, size_t firstChannel, uint32_t bitCount, int (&ends)[2][N], uint8_t (&indices)[16])
+{
+	static constexpr int kWeights[4] = { 0, 21, 43, 64 };
+	const float maxValue = static_cast<float>((1 << bitCount) - 1);
+
+	std::array<std::array<float, N>, 16> points;
+	for (size_t i = 0; i < 16; ++i)
+		for (size_t c = 0; c < N; ++c) points[i][c] = block[i][firstChannel + c];
+
+	uint32_t bestError = UINT32_MAX;
+	std::array<float, 16> weights{};
+	const auto evaluate = [&](const std::array<float, N>& end0, const std::array<float, N>& end1) {
+		int quantized[2][N];
+		int colors[2][N];
+		for (size_t c = 0; c < N; ++c)
+		{
+			quantized[0][c] = static_cast<int>(end0[c] * maxValue / 255.0f + 0.5f);
+			quantized[1][c] = static_cast<int>(end1[c] * maxValue / 255.0f + 0.5f);
+			for (int e = 0; e < 2; ++e)
+				colors[e][c] = (bitCount == 8) ? quantized[e][c] : (quantized[e][c] << (8 - bitCount)) | (quantized[e][c] >> (2 * bitCount - 8));
+		}
+
+		uint32_t error = 0;
+		uint8_t blockIndices[16];
+		for (size_t i = 0; i < 16; ++i)
+		{
+			uint32_t bestPixelError = UINT32_MAX;
+			for (uint8_t k = 0; k < 4; ++k)
+			{
+				uint32_t pixelError = 0;
+				for (size_t c = 0; c < N; ++c)
+				{
+					const int value = ((64 - kWeights[k]) * colors[0][c] + kWeights[k] * colors[1][c] + 32) >> 6;
+					const int d = value - block[i][firstChannel + c];
+					pixelError += static_cast<uint32_t>(d * d);
+				}
+				if (pixelError < bestPixelError)
+				{
+					bestPixelError = pixelError;
+					blockIndices[i] = k;
+				}
+			}
+			error += bestPixelError;
+		}
+		if (error < bestError)
+		{
+			bestError = error;
+			std::memcpy(ends, quantized, sizeof(ends));
+			std::memcpy(indices, blockIndices, sizeof(indices));
+			for (size_t i = 0; i < 16; ++i) weights[i] = kWeights[indices[i]] / 64.0f;
+		}
+	};
+
+	std::array<float, N> end0, end1;
+	FitLine(points, end0, end1);
+	evaluate(end0, end1);
+	for (int iteration = 0; iteration < 2 && bestError > 0; ++iteration)
+	{
+		if (!RefineLine(points, weights, end0, end1)) break;
+		const uint32_t previousError = bestError;
+		evaluate(end0, end1);
+		if (bestError == previousError) break;
+	}
+
+	if (indices[0] >= 2)
+	{
+		std::swap(ends[0], ends[1]);
+		for (auto& index : indices) index = static_cast<uint8_t>(3 - index);
+	}
+	return bestError;
+}
+
+// BC7 mode 5: RGB endpoints with 7 bits and alpha endpoints with 8 bits, each with their own 2-bit indices, for blocks
+// whose alpha doesn't follow the color. Returns the squared error over RGBA.
+static uint32_t EncodeBC7Mode5(const BlockPixels& block, uint8_t* pOutput)
+{
+	int colorEnds[2][3];
+	int alphaEnds[2][1];
+	uint8_t colorIndices[16];
+	uint8_t alphaIndices[16];
+	const uint32_t error = FitBC7Mode5Part(block, 0, 7, colorEnds, colorIndices) + FitBC7Mode5Part(block, 3, 8, alphaEnds, alphaIndices);
+
+	std::memset(pOutput, 0, 16);
+	uint32_t bitOffset = 0;
+	PutBits(pOutput, bitOffset, 1 << 5, 6);
+	PutBits(pOutput, bitOffset, 0, 2); // No channel rotation
+	for (int c = 0; c < 3; ++c)
+	{
+		PutBits(pOutput, bitOffset, static_cast<uint32_t>(colorEnds[0][c]), 7);
+		PutBits(pOutput, bitOffset, static_cast<uint32_t>(colorEnds[1][c]), 7);
+	}
+	PutBits(pOutput, bitOffset, static_cast<uint32_t>(alphaEnds[0][0]), 8);
+	PutBits(pOutput, bitOffset, static_cast<uint32_t>(alphaEnds[1][0]), 8);
+	for (size_t i = 0; i < 16; ++i)
+		PutBits(pOutput, bitOffset, colorIndices[i], i == 0 ? 1 : 2);
+	for (size_t i = 0; i < 16; ++i)
+		PutBits(pOutput, bitOffset, alphaIndices[i], i == 0 ? 1 : 2);
+	return error;
+}
+
+static uint32_t EncodeBC7Block(const BlockPixels& block, uint8_t* pOutput)
+{
+	const uint32_t error = EncodeBC7Mode6(block, pOutput);
+
+	bool constantAlpha = true;
+	for (const auto& pixel : block) constantAlpha = constantAlpha && (pixel[3] == block[0][3]);
+	if (constantAlpha || error == 0) return error;
+
+	uint8_t mode5[16];
+	const uint32_t mode5Error = EncodeBC7Mode5(block, mode5);
+	if (mode5Error >= error) return error;
+	std::memcpy(pOutput, mode5, 16);
+	return mode5Error;
+}
+
+static uint32_t EncodeBlock(BlockFormat format, const BlockPixels& block, uint8_t* pOutput)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1: return EncodeColorBlock(block, pOutput);
+	case BlockFormat::BC3: return EncodeChannelBlock(block, 3, pOutput) + EncodeColorBlock(block, pOutput + 8);
+	case BlockFormat::BC4: return EncodeChannelBlock(block, 0, pOutput);
+	case BlockFormat::BC5: return EncodeChannelBlock(block, 0, pOutput) + EncodeChannelBlock(block, 1, pOutput + 8);
+	case BlockFormat::BC7: return EncodeBC7Block(block, pOutput);
+	default: return 0;
+	}
+}
+
+static uint32_t BlockFormatChannelCount(BlockFormat format)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1: return 3;
+	case BlockFormat::BC4: return 1;
+	case BlockFormat::BC5: return 2;
+	default: return 4;
+	}
+}
+
+Result CompressBitmap(const Bitmap& bitmap, BlockFormat format, std::vector<char>* pBlocks, double* pPsnr)
+{
+	if (IsNull(pBlocks)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
+	if (!bitmap.IsOk() || (bitmap.GetFormat() != Bitmap::FORMAT_RGBA_UINT8)) return ERROR_IMAGE_INVALID_FORMAT;
+	const uint32_t blockSize = BlockFormatSize(format);
+	if (blockSize == 0) return ERROR_IMAGE_INVALID_FORMAT;
+
+	const uint32_t blocksX = (bitmap.GetWidth() + 3) / 4;
+	const uint32_t blocksY = (bitmap.GetHeight() + 3) / 4;
+	pBlocks->assign(static_cast<size_t>(blocksX) * blocksY * blockSize, 0);
+
+	std::vector<uint64_t> rowErrors(blocksY, 0);
+	ParallelFor(blocksY, [&](size_t blockY) {
+		uint8_t* pOutput = reinterpret_cast<uint8_t*>(pBlocks->data()) + blockY * blocksX * blockSize;
+		BlockPixels block;
+		for (uint32_t blockX = 0; blockX < blocksX; ++blockX, pOutput += blockSize)
+		{
+			FetchBlock(bitmap, blockX, static_cast<uint32_t>(blockY), block);
+			rowErrors[blockY] += EncodeBlock(format, block, pOutput);
+		}
+	});
+
+	if (!IsNull(pPsnr))
+	{
+		uint64_t error = 0;
+		for (uint64_t rowError : rowErrors) error += rowError;
+		const double sampleCount = static_cast<double>(blocksX) * blocksY * 16.0 * BlockFormatChannelCount(format);
+		const double mse = static_cast<double>(error) / sampleCount;
+		*pPsnr = (mse > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+	}
+	return SUCCESS;
+}
+
+#pragma endregion
+
+//=============================================================================
+#pragma region [ Texture Cache ]
+
+namespace TextureCache
+{
+	// Bump when the encoder output changes, so textures cooked by an older version are cooked again
+	constexpr uint64_t kCookVersion = 1;
+	constexpr XXH64_hash_t kSeed = 0x7c1e3f9a5b20d846;
+
+	static std::filesystem::path sDirectory = "TextureCache";
+	static TextureCacheStats     sStats;
+	static std::mutex            sStatsMutex;
+
+	static uint64_t GetRGBA8Size(const gli::texture& texture)
+	{
+		uint64_t size = 0;
+		for (size_t level = 0; level < texture.levels(); ++level)
+			size += static_cast<uint64_t>(texture.extent(level).x) * texture.extent(level).y * 4;
+		return size;
+	}
+
+	void SetDirectory(const std::filesystem::path& directory)
+	{
+		sDirectory = directory;
+	}
+
+	Result Cook(const Bitmap& bitmap, const TextureCookSettings& settings, gli::texture* pTexture, double* pPsnr)
+	{
+		if (IsNull(pTexture)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
+		const gli::format format = ToGliFormat(settings.format);
+		if (format == gli::FORMAT_UNDEFINED || !bitmap.IsOk() || Bitmap::ChannelDataType(bitmap.GetFormat()) == Bitmap::DATA_TYPE_FLOAT) return ERROR_IMAGE_INVALID_FORMAT;
+
+		// Blocks are encoded from 8 bit RGBA, other integer formats are converted first
+		if (bitmap.GetFormat() != Bitmap::FORMAT_RGBA_UINT8)
+		{
+			Bitmap rgba;
+			Result ppxres = ConvertBitmap(bitmap, Bitmap::FORMAT_RGBA_UINT8, &rgba);
+			if (Failed(ppxres)) return ppxres;
+			return Cook(rgba, settings, pTexture, pPsnr);
+		}
+
+		// Levels smaller than a block are dropped by CreateImageFromCompressedImage anyway
+		uint32_t levelCount = 0;
+		for (uint32_t width = bitmap.GetWidth(), height = bitmap.GetHeight(); levelCount < settings.mipLevelCount && width >= 4 && height >= 4; width /= 2, height /= 2)
+			++levelCount;
+		levelCount = std::max(levelCount, 1u);
+
+		Mipmap mipmap(bitmap, levelCount);
+		if (!mipmap.IsOk()) return ERROR_FAILED;
+
+		gli::texture2d texture(format, gli::extent2d(bitmap.GetWidth(), bitmap.GetHeight()), levelCount);
+		std::vector<char> blocks;
+		for (uint32_t level = 0; level < levelCount; ++level)
+		{
+			double psnr = 0.0;
+			Result ppxres = CompressBitmap(*mipmap.GetMip(level), settings.format, &blocks, (level == 0) ? &psnr : nullptr);
+			if (Failed(ppxres)) return ppxres;
+			if (blocks.size() != texture.size(level)) return ERROR_BITMAP_FOOTPRINT_MISMATCH;
+			std::memcpy(texture.data(0, 0, level), blocks.data(), blocks.size());
+			if ((level == 0) && !IsNull(pPsnr)) *pPsnr = psnr;
+		}
+
+		*pTexture = texture;
+		return SUCCESS;
+	}
+
+	Result Load(const std::filesystem::path& path, const TextureCookSettings& settings, gli::texture* pTexture)
+	{
+		if (IsNull(pTexture)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
+		if (ToGliFormat(settings.format) == gli::FORMAT_UNDEFINED) return ERROR_IMAGE_INVALID_FORMAT;
+
+		Clock clock;
+		MappedFile source;
+		if (!source.Open(path) || source.GetLength() == 0) return ERROR_IMAGE_FILE_LOAD_FAILED;
+
+		const uint64_t key[] = { XXH64(source.GetData(), source.GetLength(), kSeed), kCookVersion, static_cast<uint64_t>(settings.format), settings.mipLevelCount };
+		char name[17];
+		snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(XXH64(key, sizeof(key), kSeed)));
+		const std::filesystem::path cachePath = sDirectory / (path.stem().string() + "-" + name + ".dds");
+
+		std::error_code errorCode;
+		if (std::filesystem::exists(cachePath, errorCode))
+		{
+			gli::texture texture = gli::load(cachePath.string());
+			if (!texture.empty() && texture.format() == ToGliFormat(settings.format))
+			{
+				const std::lock_guard<std::mutex> lock(sStatsMutex);
+				sStats.cachedTextures++;
+				sStats.uncompressedSize += GetRGBA8Size(texture);
+				sStats.compressedSize += texture.size();
+				sStats.loadTime = sStats.loadTime.ToDuration() + clock.GetElapsedTime().ToDuration();
+				*pTexture = texture;
+				return SUCCESS;
+			}
+			Warning("Cooking texture again, the cached file '" + cachePath.string() + "' can't be read");
+		}
+
+		Bitmap bitmap;
+		Result ppxres = Bitmap::LoadFromMemory(source.GetLength(), source.GetData(), &bitmap);
+		if (Failed(ppxres)) return ppxres;
+
+		double psnr = 0.0;
+		gli::texture texture;
+		ppxres = Cook(bitmap, settings, &texture, &psnr);
+		if (Failed(ppxres)) return ppxres;
+
+		// Write next to the final name and rename, so an interrupted write never leaves a truncated file in the cache
+		std::vector<char> file;
+		std::filesystem::path tempPath = cachePath;
+		tempPath += ".tmp";
+		std::filesystem::create_directories(sDirectory, errorCode);
+		if (gli::save_dds(texture, file))
+		{
+			std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+			stream.write(file.data(), static_cast<std::streamsize>(file.size()));
+			stream.close();
+			if (stream) std::filesystem::rename(tempPath, cachePath, errorCode);
+			if (!stream || errorCode)
+			{
+				Warning("Failed to write cooked texture '" + cachePath.string() + "'");
+				std::filesystem::remove(tempPath, errorCode);
+			}
+		}
+
+		const Time cookTime = clock.GetElapsedTime();
+		Print("Cooked texture '" + path.string() + "' to " + ToString(settings.format) + ": "
+			+ std::to_string(bitmap.GetWidth()) + "x" + std::to_string(bitmap.GetHeight()) + ", " + std::to_string(texture.levels()) + " levels, "
+			+ std::to_string(GetRGBA8Size(texture) / 1024) + " KB -> " + std::to_string(texture.size() / 1024) + " KB, PSNR " + FloatString(static_cast<float>(psnr), 2) + " dB, "
+			+ std::to_string(cookTime.AsMilliseconds()) + " ms");
+
+		const std::lock_guard<std::mutex> lock(sStatsMutex);
+		sStats.minPsnr = (sStats.cookedTextures == 0) ? psnr : std::min(sStats.minPsnr, psnr);
+		sStats.cookedTextures++;
+		sStats.uncompressedSize += GetRGBA8Size(texture);
+		sStats.compressedSize += texture.size();
+		sStats.cookTime = sStats.cookTime.ToDuration() + cookTime.ToDuration();
+		*pTexture = texture;
+		return SUCCESS;
+	}
+
+	TextureCacheStats GetStats()
+	{
+		const std::lock_guard<std::mutex> lock(sStatsMutex);
+		return sStats;
+	}
+} // namespace TextureCache
+
+#pragma endregion
+
+//=============================================================================
+#pragma region [ Font ]
+
+void Font::AcquireFontMetrics()
+{
+	stbtt_GetFontVMetrics(&mObject->fontInfo, &mObject->ascent, &mObject->descent, &mObject->lineGap);
+}
+
+Result Font::CreateFromFile(const std::filesystem::path& path, Font* pFont)
+{
+	if (IsNull(pFont)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
+
+	if (!FileExists(path)) return ERROR_PATH_DOES_NOT_EXIST;
+
+	auto object = std::make_shared<Font::Object>();
+	if (!object) return ERROR_ALLOCATION_FAILED;
+
+	// stbtt keeps pointing into the font data, so the mapping lives as long as the font
+	if (!object->fontFile.Open(path) || object->fontFile.GetLength() == 0) return ERROR_BAD_DATA_SOURCE;
+
+	int stbres = stbtt_InitFont(&object->fontInfo, reinterpret_cast<const unsigned char*>(object->fontFile.GetData()), 0);
+	if (stbres == 0) return Result::ERROR_FONT_PARSE_FAILED;
+
+	pFont->mObject = object;
+	pFont->AcquireFontMetrics();
+
+	return SUCCESS;
+}
+
+Result Font::CreateFromMemory(size_t size, const char* pData, Font* pFont)
+{
+	if (IsNull(pFont)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
+	if ((size == 0) || IsNull(pData)) return ERROR_BAD_DATA_SOURCE;
+
+	auto object = std::make_shared<Font::Object>();
+	if (!object) return ERROR_ALLOCATION_FAILED;
 
 	object->fontData.resize(size);
 	std::memcpy(object->fontData.data(), pData, size);
@@ -1030,4 +2397,284 @@ void Font::RenderGlyphBitmap(float fontSizeInPixels, uint32_t codepoint, float s
 		static_cast<int>(codepoint));
 }
 
-#pragma endregion
\ No newline at end of file
+Result Font::RenderGlyphSDF(float fontSizeInPixels, uint32_t codepoint, uint32_t padding, Bitmap* pBitmap, GlyphBox* pBox) const
+{
+	if (IsNull(pBitmap) || IsNull(pBox)) return ERROR_UNEXPECTED_NULL_ARGUMENT;
+
+	const float scale = GetScale(fontSizeInPixels);
+	const float pixelDistScale = 128.0f / static_cast<float>(std::max(padding, 1u));
+
+	int            width = 0;
+	int            height = 0;
+	int            xoff = 0;
+	int            yoff = 0;
+	unsigned char* pSdf = stbtt_GetCodepointSDF(&mObject->fontInfo, scale, static_cast<int>(codepoint), static_cast<int>(padding), 128, pixelDistScale, &width, &height, &xoff, &yoff);
+	if (IsNull(pSdf)) {
+		*pBitmap = Bitmap();
+		*pBox = {};
+		return SUCCESS;
+	}
+
+	Result ppxres = Bitmap::Create(static_cast<uint32_t>(width), static_cast<uint32_t>(height), Bitmap::FORMAT_R_UINT8, pBitmap);
+	if (!Failed(ppxres)) {
+		for (uint32_t y = 0; y < pBitmap->GetHeight(); ++y)
+			memcpy(pBitmap->GetPixelAddress(0, y), pSdf + y * static_cast<uint32_t>(width), static_cast<size_t>(width));
+		*pBox = GlyphBox{ xoff, yoff, xoff + width, yoff + height };
+	}
+	stbtt_FreeSDF(pSdf, nullptr);
+	return ppxres;
+}
+
+#pragma endregion
+//=============================================================================
+#pragma region [ Glyph Atlas ]
+
+ShelfPacker::ShelfPacker(uint32_t width, uint32_t height)
+	: mWidth(width)
+	, mHeight(height)
+{
+}
+
+bool ShelfPacker::allocateOnShelf(Shelf& shelf, uint32_t width, uint32_t height, AtlasRect* pRect)
+{
+	auto it = std::find_if(shelf.freeSpans.begin(), shelf.freeSpans.end(), [width](const Span& span) { return span.width >= width; });
+	if (it == shelf.freeSpans.end()) return false;
+
+	*pRect = AtlasRect{ it->x, shelf.y, width, height };
+	it->x += width;
+	it->width -= width;
+	if (it->width == 0) shelf.freeSpans.erase(it);
+
+	mUsedArea += static_cast<uint64_t>(width) * height;
+	return true;
+}
+
+bool ShelfPacker::Allocate(uint32_t width, uint32_t height, AtlasRect* pRect)
+{
+	if (IsNull(pRect) || width == 0 || height == 0 || width > mWidth || height > mHeight) return false;
+
+	const auto hasSpan = [width](const Shelf& shelf) {
+		return std::any_of(shelf.freeSpans.begin(), shelf.freeSpans.end(), [width](const Span& span) { return span.width >= width; });
+	};
+
+	// Open shelf wasting the least height, as long as it wastes less than half of the rectangle height
+	Shelf*   pBest = nullptr;
+	uint32_t bestWaste = height / 2 + 1;
+	for (Shelf& shelf : mShelves) {
+		if (shelf.height < height || shelf.height - height >= bestWaste || !hasSpan(shelf)) continue;
+		pBest = &shelf;
+		bestWaste = shelf.height - height;
+		if (bestWaste == 0) break;
+	}
+	if (pBest) return allocateOnShelf(*pBest, width, height, pRect);
+
+	// New shelf. Heights are rounded up so rectangles of similar heights end up sharing shelves.
+	if (mHeight - mShelvesEnd >= height) {
+		Shelf shelf;
+		shelf.y = mShelvesEnd;
+		shelf.height = std::min(RoundUp<uint32_t>(height, 4), mHeight - mShelvesEnd);
+		shelf.freeSpans.push_back(Span{ 0, mWidth });
+		mShelvesEnd += shelf.height;
+		mShelves.push_back(std::move(shelf));
+		return allocateOnShelf(mShelves.back(), width, height, pRect);
+	}
+
+	// Out of room for shelves, settle for any shelf tall enough
+	bestWaste = UINT32_MAX;
+	for (Shelf& shelf : mShelves) {
+		if (shelf.height < height || shelf.height - height >= bestWaste || !hasSpan(shelf)) continue;
+		pBest = &shelf;
+		bestWaste = shelf.height - height;
+	}
+	if (pBest) return allocateOnShelf(*pBest, width, height, pRect);
+
+	// Every shelf is too low or full. Merge the shortest run of empty shelves that is tall enough into one shelf.
+	const auto isEmpty = [this](const Shelf& shelf) { return shelf.freeSpans.size() == 1 && shelf.freeSpans[0].width == mWidth; };
+	size_t   bestFirst = 0, bestLast = 0;
+	uint32_t bestHeight = UINT32_MAX;
+	for (size_t first = 0; first < mShelves.size(); ++first) {
+		uint32_t runHeight = 0;
+		for (size_t last = first; last < mShelves.size() && isEmpty(mShelves[last]) && runHeight < height; ++last) {
+			runHeight += mShelves[last].height;
+			if (runHeight >= height && runHeight < bestHeight) {
+				bestFirst = first;
+				bestLast = last;
+				bestHeight = runHeight;
+			}
+		}
+	}
+	if (bestHeight == UINT32_MAX) return false;
+
+	mShelves[bestFirst].height = bestHeight;
+	mShelves.erase(mShelves.begin() + static_cast<ptrdiff_t>(bestFirst + 1), mShelves.begin() + static_cast<ptrdiff_t>(bestLast + 1));
+	return allocateOnShelf(mShelves[bestFirst], width, height, pRect);
+}
+
+void ShelfPacker::Free(const AtlasRect& rect)
+{
+	if (rect.width == 0 || rect.height == 0) return;
+
+	auto shelfIt = std::lower_bound(mShelves.begin(), mShelves.end(), rect.y, [](const Shelf& shelf, uint32_t y) { return shelf.y < y; });
+	if (shelfIt == mShelves.end() || shelfIt->y != rect.y) {
+		Error("ShelfPacker: freed rectangle isn't on a shelf");
+		return;
+	}
+
+	// Insert the span and merge it with its neighbours
+	std::vector<Span>& spans = shelfIt->freeSpans;
+	size_t             index = static_cast<size_t>(std::lower_bound(spans.begin(), spans.end(), rect.x, [](const Span& span, uint32_t x) { return span.x < x; }) - spans.begin());
+	spans.insert(spans.begin() + static_cast<ptrdiff_t>(index), Span{ rect.x, rect.width });
+	if (index + 1 < spans.size() && spans[index].x + spans[index].width == spans[index + 1].x) {
+		spans[index].width += spans[index + 1].width;
+		spans.erase(spans.begin() + static_cast<ptrdiff_t>(index + 1));
+	}
+	if (index > 0 && spans[index - 1].x + spans[index - 1].width == spans[index].x) {
+		spans[index - 1].width += spans[index].width;
+		spans.erase(spans.begin() + static_cast<ptrdiff_t>(index));
+	}
+
+	mUsedArea -= static_cast<uint64_t>(rect.width) * rect.height;
+
+	// Close empty shelves at the bottom so the space can be opened again with another height
+	while (!mShelves.empty() && mShelves.back().freeSpans.size() == 1 && mShelves.back().freeSpans[0].width == mWidth) {
+		mShelvesEnd = mShelves.back().y;
+		mShelves.pop_back();
+	}
+}
+
+void ShelfPacker::Clear()
+{
+	mShelves.clear();
+	mShelvesEnd = 0;
+	mUsedArea = 0;
+}
+
+SdfGlyphAtlas::SdfGlyphAtlas(const Font& font, const SdfGlyphAtlasCreateInfo& createInfo)
+	: mFont(font)
+	, mCreateInfo(createInfo)
+	, mPacker(createInfo.atlasSize, createInfo.atlasSize)
+{
+	mFont.GetFontMetrics(mCreateInfo.baseSize, &mFontMetrics);
+
+	if (Failed(Bitmap::Create(mCreateInfo.atlasSize, mCreateInfo.atlasSize, Bitmap::FORMAT_R_UINT8, &mBitmap))) return;
+	memset(mBitmap.GetData(), 0, mBitmap.GetFootprintSize());
+	// The whole bitmap starts out dirty so the texture can be created from it
+	mDirtyRects.push_back(AtlasRect{ 0, 0, mCreateInfo.atlasSize, mCreateInfo.atlasSize });
+}
+
+const SdfGlyph* SdfGlyphAtlas::GetGlyph(uint32_t codepoint)
+{
+	if (!IsOk()) return nullptr;
+
+	auto it = mGlyphs.find(codepoint);
+	if (it != mGlyphs.end()) {
+		mLru.splice(mLru.begin(), mLru, it->second.lruIt);
+		it->second.glyph.lastUsedFrame = mFrame;
+		return &it->second.glyph;
+	}
+
+	Clock    clock;
+	Bitmap   sdf;
+	GlyphBox box;
+	if (Failed(mFont.RenderGlyphSDF(mCreateInfo.baseSize, codepoint, mCreateInfo.padding, &sdf, &box))) return nullptr;
+
+	SdfGlyph glyph;
+	glyph.codepoint = codepoint;
+	glyph.box = box;
+	glyph.lastUsedFrame = mFrame;
+
+	GlyphMetrics metrics;
+	mFont.GetGlyphMetrics(mCreateInfo.baseSize, codepoint, 0.0f, 0.0f, &metrics);
+	glyph.advance = metrics.advance;
+
+	if (sdf.IsOk()) {
+		// One pixel gutter to the right and below keeps linear filtering from reaching into the next glyph
+		AtlasRect rect;
+		if (!allocate(sdf.GetWidth() + 1, sdf.GetHeight() + 1, &rect)) {
+			mStats.failedGlyphs++;
+			mStats.rasterizeTime = mStats.rasterizeTime.ToDuration() + clock.GetElapsedTime().ToDuration();
+			return nullptr;
+		}
+
+		for (uint32_t y = 0; y < rect.height; ++y) {
+			char* pDst = mBitmap.GetPixelAddress(rect.x, rect.y + y);
+			if (y < sdf.GetHeight()) {
+				memcpy(pDst, sdf.GetPixelAddress(0, y), sdf.GetWidth());
+				pDst[sdf.GetWidth()] = 0;
+			}
+			else {
+				memset(pDst, 0, rect.width);
+			}
+		}
+		addDirtyRect(rect);
+
+		glyph.rect = AtlasRect{ rect.x, rect.y, sdf.GetWidth(), sdf.GetHeight() };
+	}
+
+	mLru.push_front(codepoint);
+	Entry& entry = mGlyphs[codepoint];
+	entry.glyph = glyph;
+	entry.lruIt = mLru.begin();
+
+	mStats.glyphs = static_cast<uint32_t>(mGlyphs.size());
+	mStats.rasterizedGlyphs++;
+	mStats.rasterizeTime = mStats.rasterizeTime.ToDuration() + clock.GetElapsedTime().ToDuration();
+	return &entry.glyph;
+}
+
+const SdfGlyph* SdfGlyphAtlas::FindGlyph(uint32_t codepoint) const
+{
+	auto it = mGlyphs.find(codepoint);
+	return it != mGlyphs.end() ? &it->second.glyph : nullptr;
+}
+
+std::vector<AtlasRect> SdfGlyphAtlas::TakeDirtyRects()
+{
+	for (const AtlasRect& rect : mDirtyRects)
+		mStats.uploadedBytes += static_cast<uint64_t>(rect.width) * rect.height;
+
+	std::vector<AtlasRect> rects;
+	rects.swap(mDirtyRects);
+	return rects;
+}
+
+bool SdfGlyphAtlas::allocate(uint32_t width, uint32_t height, AtlasRect* pRect)
+{
+	// Evict the least recently used glyphs until the new one fits, but never one the current frame still draws
+	while (!mPacker.Allocate(width, height, pRect)) {
+		if (mLru.empty()) return false;
+
+		auto it = mGlyphs.find(mLru.back());
+		if (it->second.glyph.lastUsedFrame == mFrame) return false;
+
+		const AtlasRect& rect = it->second.glyph.rect;
+		if (rect.width > 0) mPacker.Free(AtlasRect{ rect.x, rect.y, rect.width + 1, rect.height + 1 });
+
+		mGlyphs.erase(it);
+		mLru.pop_back();
+		mStats.evictedGlyphs++;
+	}
+	mStats.glyphs = static_cast<uint32_t>(mGlyphs.size());
+	return true;
+}
+
+void SdfGlyphAtlas::addDirtyRect(const AtlasRect& rect)
+{
+	// Glyphs packed one after another on a shelf grow a single rectangle
+	for (AtlasRect& dirty : mDirtyRects) {
+		const bool sameShelf = (dirty.y == rect.y);
+		const bool touching = (rect.x <= dirty.x + dirty.width) && (dirty.x <= rect.x + rect.width);
+		const bool inside = (rect.x >= dirty.x) && (rect.y >= dirty.y) && (rect.x + rect.width <= dirty.x + dirty.width) && (rect.y + rect.height <= dirty.y + dirty.height);
+		if (inside) return;
+		if (!sameShelf || !touching) continue;
+
+		const uint32_t x1 = std::max(dirty.x + dirty.width, rect.x + rect.width);
+		dirty.x = std::min(dirty.x, rect.x);
+		dirty.width = x1 - dirty.x;
+		dirty.height = std::max(dirty.height, rect.height);
+		return;
+	}
+	mDirtyRects.push_back(rect);
+}
+
+#pragma endregion
@@ -207,6 +207,55 @@ void Bitmap::Fill(PixelDataType r, PixelDataType g, PixelDataType b, PixelDataTy
 
 #pragma endregion
 
+//=============================================================================
+#pragma region [ Pixel Conversion ]
+
+// Bulk conversions of channel values. With SSE2 (every x64 CPU) several values go through each instruction, the scalar
+// code converts the remaining values and serves other CPUs. Both give bit-identical results.
+namespace PixelConvert
+{
+	// Off runs only the scalar code, as on CPUs without SSE2. Meant for comparing both, don't switch during conversions.
+	void SetSimdEnabled(bool enabled);
+	bool IsSimdEnabled();
+
+	void U8ToFloat(const uint8_t* pSrc, float* pDst, size_t count);     // v / 255
+	void U16ToFloat(const uint16_t* pSrc, float* pDst, size_t count);   // v / 65535
+	void FloatToU8(const float* pSrc, uint8_t* pDst, size_t count);     // Clamped to [0, 1] and rounded, NaN gives 0
+	void FloatToU16(const float* pSrc, uint16_t* pDst, size_t count);   // Clamped to [0, 1] and rounded, NaN gives 0
+	void U8ToU16(const uint8_t* pSrc, uint16_t* pDst, size_t count);    // v * 257
+	void U16ToU8(const uint16_t* pSrc, uint8_t* pDst, size_t count);    // Rounded v / 257
+
+	// IEEE half floats, rounded to nearest even. Overflow gives infinity, NaN stays NaN.
+	void FloatToHalf(const float* pSrc, uint16_t* pDst, size_t count);
+	void HalfToFloat(const uint16_t* pSrc, float* pDst, size_t count);
+
+	// Same values as LinearColor::FromSRGBColor
+	void SRGBToLinear(const uint8_t* pSrc, float* pDst, size_t count);
+	// Rounded to the nearest sRGB value, unlike LinearColor::ToFColor which rounds down
+	void LinearToSRGB(const float* pSrc, uint8_t* pDst, size_t count);
+
+	// RGB in place times A. For 8 bit pixels the result is rounded.
+	void PremultiplyAlpha(uint8_t* pRGBA, size_t pixelCount);
+	void PremultiplyAlpha(float* pRGBA, size_t pixelCount);
+
+	// Alpha of the added channel is set to alpha
+	void RGBToRGBA(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha = 255);
+	void RGBAToRGB(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount);
+} // namespace PixelConvert
+
+struct BitmapConversion final
+{
+	bool srgbToLinear = false;     // Decode the RGB channels of the source from sRGB
+	bool linearToSrgb = false;     // Encode the RGB channels of the result to sRGB
+	bool premultiplyAlpha = false;
+};
+
+// Converts the bitmap to another format. Channels missing in the source are set to 0, or 1 for alpha. UINT32 channels
+// are normalized to [0, 1] like the 8 and 16 bit ones. Large bitmaps are converted in parallel.
+Result ConvertBitmap(const Bitmap& src, Bitmap::Format format, Bitmap* pDst, const BitmapConversion& conversion = {});
+
+#pragma endregion
+
 //=============================================================================
 #pragma region [ Mipmap ]
 
@@ -262,6 +311,68 @@ private:
 
 #pragma endregion
 
+//=============================================================================
+#pragma region [ Block Compression ]
+
+enum class BlockFormat
+{
+	Undefined = 0,
+	BC1, // RGB, 8 bytes per block. Alpha is dropped.
+	BC3, // RGBA, 16 bytes per block
+	BC4, // R, 8 bytes per block
+	BC5, // RG, 16 bytes per block
+	BC7, // RGBA, 16 bytes per block. Only the single subset modes 5 and 6 are used.
+};
+
+const char* ToString(BlockFormat format);
+// Size of one 4x4 block in bytes, 0 if the format is undefined
+uint32_t    BlockFormatSize(BlockFormat format);
+gli::format ToGliFormat(BlockFormat format);
+
+// Encodes a FORMAT_RGBA_UINT8 bitmap into 4x4 blocks, stored row of blocks after row of blocks. Bitmaps whose size isn't a
+// multiple of 4 are padded by repeating the edge pixels. Rows of blocks are encoded in parallel.
+// If pPsnr isn't null it receives the PSNR in dB of the channels the format stores.
+Result CompressBitmap(const Bitmap& bitmap, BlockFormat format, std::vector<char>* pBlocks, double* pPsnr = nullptr);
+
+#pragma endregion
+
+//=============================================================================
+#pragma region [ Texture Cache ]
+
+struct TextureCookSettings final
+{
+	BlockFormat format = BlockFormat::BC7;
+	uint32_t    mipLevelCount = RemainingMipLevels;
+};
+
+struct TextureCacheStats final
+{
+	uint32_t cookedTextures = 0;
+	uint32_t cachedTextures = 0;   // Loaded from the cache without cooking
+	uint64_t uncompressedSize = 0; // Size the same textures and mips take as RGBA8
+	uint64_t compressedSize = 0;
+	double   minPsnr = 0.0;        // Over the cooked textures, in dB
+	Time     cookTime;
+	Time     loadTime;             // Spent loading cached textures
+};
+
+// Cooks image files into block-compressed DDS files kept in a cache directory. A cooked file is named after the hash
+// of the source file contents and the cook settings, so changing either cooks the texture again on the next load.
+namespace TextureCache
+{
+	void SetDirectory(const std::filesystem::path& directory);
+
+	// Compresses the bitmap and its mips, levels smaller than a block are left out. Integer formats other than
+	// FORMAT_RGBA_UINT8 are converted to it first, float bitmaps can't be cooked.
+	Result Cook(const Bitmap& bitmap, const TextureCookSettings& settings, gli::texture* pTexture, double* pPsnr = nullptr);
+	// Loads the cooked texture from the cache, cooking and storing it first if it isn't there yet.
+	Result Load(const std::filesystem::path& path, const TextureCookSettings& settings, gli::texture* pTexture);
+
+	TextureCacheStats GetStats();
+} // namespace TextureCache
+
+#pragma endregion
+
 //=============================================================================
 #pragma region [ Font ]
 
@@ -314,13 +425,25 @@ public:
 		uint32_t       rowStride,
 		unsigned char* pOutput) const;
 
+	// Renders the signed distance field of a glyph into a new FORMAT_R_UINT8 bitmap: 128 on the outline, growing
+	// inwards and shrinking outwards by 128 / padding per pixel, so the field fades out padding pixels around the glyph.
+	// pBox receives the bitmap rectangle relative to the pen position on the baseline. Glyphs without an outline
+	// (space) give an empty bitmap.
+	Result RenderGlyphSDF(
+		float     fontSizeInPixels,
+		uint32_t  codepoint,
+		uint32_t  padding,
+		Bitmap*   pBitmap,
+		GlyphBox* pBox) const;
+
 private:
 	void AcquireFontMetrics();
 
 private:
 	struct Object
 	{
-		std::vector<unsigned char> fontData;
+		std::vector<unsigned char> fontData; // Copy made by CreateFromMemory
+		MappedFile                 fontFile; // File opened by CreateFromFile
 		stbtt_fontinfo             fontInfo;
 		int                        ascent = 0;
 		int                        descent = 0;
@@ -330,3 +453,145 @@ private:
 };
 
 #pragma endregion
+
+//=============================================================================
+#pragma region [ Glyph Atlas ]
+
+struct AtlasRect final
+{
+	uint32_t x = 0;
+	uint32_t y = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+};
+
+// Packs rectangles that come and go into a fixed size area. The area is split into shelves, full width rows opened
+// from the top as they are needed, and a rectangle goes on the shelf whose height wastes the least space. Freed
+// rectangles leave free spans on their shelf that later rectangles reuse, and an emptied last shelf is closed again.
+// Once no shelf fits a rectangle, a run of empty shelves next to each other is merged into one tall enough for it.
+class ShelfPacker final
+{
+public:
+	ShelfPacker() = default;
+	ShelfPacker(uint32_t width, uint32_t height);
+
+	// Returns false if there is no room left for the rectangle.
+	bool Allocate(uint32_t width, uint32_t height, AtlasRect* pRect);
+	void Free(const AtlasRect& rect);
+	void Clear();
+
+	uint32_t GetWidth() const { return mWidth; }
+	uint32_t GetHeight() const { return mHeight; }
+	uint64_t GetUsedArea() const { return mUsedArea; }
+	// Area of the shelves opened so far. GetUsedArea() / GetShelfArea() is the packing efficiency.
+	uint64_t GetShelfArea() const { return static_cast<uint64_t>(mWidth) * mShelvesEnd; }
+
+private:
+	struct Span final
+	{
+		uint32_t x = 0;
+		uint32_t width = 0;
+	};
+
+	struct Shelf final
+	{
+		uint32_t          y = 0;
+		uint32_t          height = 0;
+		std::vector<Span> freeSpans; // Sorted by x, never touching each other
+	};
+
+	bool allocateOnShelf(Shelf& shelf, uint32_t width, uint32_t height, AtlasRect* pRect);
+
+	uint32_t           mWidth = 0;
+	uint32_t           mHeight = 0;
+	uint32_t           mShelvesEnd = 0; // Bottom of the last shelf
+	uint64_t           mUsedArea = 0;
+	std::vector<Shelf> mShelves;        // Sorted by y
+};
+
+struct SdfGlyph final
+{
+	uint32_t  codepoint = 0;
+	AtlasRect rect;             // Empty for glyphs without an outline
+	GlyphBox  box;              // Of rect relative to the pen position on the baseline, at the base size
+	float     advance = 0;      // At the base size
+	uint64_t  lastUsedFrame = 0;
+};
+
+struct SdfGlyphAtlasCreateInfo final
+{
+	uint32_t atlasSize = 1024; // Width and height of the atlas bitmap
+	float    baseSize = 48.0f; // Glyphs are rasterized at this size in pixels and scaled to whatever size they are drawn at
+	uint32_t padding = 6;      // Pixels of distance field around each glyph, limits how far outlines and glows can reach
+};
+
+struct SdfGlyphAtlasStats final
+{
+	uint32_t glyphs = 0;           // In the atlas now
+	uint32_t rasterizedGlyphs = 0;
+	uint32_t evictedGlyphs = 0;
+	uint32_t failedGlyphs = 0;     // Didn't fit even after evicting every glyph not used in the current frame
+	uint64_t uploadedBytes = 0;    // Covered by the dirty rectangles taken so far
+	Time     rasterizeTime;
+};
+
+// Signed distance field glyphs of one font, rasterized when they are first asked for and packed into a single R8
+// bitmap shared by every size the font is drawn at. When the atlas is full, the least recently used glyphs that
+// weren't used in the current frame are evicted to make room. Changed parts of the bitmap are collected as dirty
+// rectangles so only they need to be uploaded. Has no GPU dependencies.
+class SdfGlyphAtlas final
+{
+public:
+	SdfGlyphAtlas() = default;
+	SdfGlyphAtlas(const Font& font, const SdfGlyphAtlasCreateInfo& createInfo = {});
+	SdfGlyphAtlas(const SdfGlyphAtlas&) = delete;
+	SdfGlyphAtlas(SdfGlyphAtlas&&) = default;
+
+	SdfGlyphAtlas& operator=(const SdfGlyphAtlas&) = delete;
+	SdfGlyphAtlas& operator=(SdfGlyphAtlas&&) = default;
+
+	bool IsOk() const { return mBitmap.IsOk(); }
+
+	// Starts a new frame. Glyphs returned by GetGlyph since the last call stay in the atlas until the next one.
+	void BeginFrame() { mFrame++; }
+
+	// Returns null if the glyph doesn't fit into the atlas. The pointer is valid until the next GetGlyph call.
+	const SdfGlyph* GetGlyph(uint32_t codepoint);
+	// Returns null if the glyph isn't in the atlas, doesn't rasterize or mark it used.
+	const SdfGlyph* FindGlyph(uint32_t codepoint) const;
+
+	const Bitmap&      GetBitmap() const { return mBitmap; }
+	const FontMetrics& GetFontMetrics() const { return mFontMetrics; } // At the base size
+	float              GetBaseSize() const { return mCreateInfo.baseSize; }
+	uint32_t           GetPadding() const { return mCreateInfo.padding; }
+	const ShelfPacker& GetPacker() const { return mPacker; }
+
+	// Parts of the bitmap changed since the last TakeDirtyRects call, rectangles next to each other on a shelf are merged.
+	bool                   HasDirtyRects() const { return !mDirtyRects.empty(); }
+	std::vector<AtlasRect> TakeDirtyRects();
+
+	const SdfGlyphAtlasStats& GetStats() const { return mStats; }
+
+private:
+	struct Entry final
+	{
+		SdfGlyph                      glyph;
+		std::list<uint32_t>::iterator lruIt;
+	};
+
+	bool allocate(uint32_t width, uint32_t height, AtlasRect* pRect);
+	void addDirtyRect(const AtlasRect& rect);
+
+	Font                                mFont;
+	SdfGlyphAtlasCreateInfo             mCreateInfo;
+	FontMetrics                         mFontMetrics;
+	Bitmap                              mBitmap;
+	ShelfPacker                         mPacker;
+	std::unordered_map<uint32_t, Entry> mGlyphs;
+	std::list<uint32_t>                 mLru; // Codepoints, most recently used first
+	std::vector<AtlasRect>              mDirtyRects;
+	uint64_t                            mFrame = 1;
+	SdfGlyphAtlasStats                  mStats;
+};
+
+#pragma endregion
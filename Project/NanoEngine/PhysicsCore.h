@@ -32,6 +32,112 @@ using CharacterControllerPtr = std::shared_ptr<CharacterController>;
 
 #pragma endregion
 
+//=============================================================================
+#pragma region [ Object Pool ]
+
+// Typed storage for physics objects. Objects live in fixed-size blocks so addresses stay stable, freed slots are reused and the whole pool can be released at once.
+// Handles returned by Create() keep only a weak link to the pool: dropping a handle after Clear() (or after the pool is gone) does nothing.
+template<typename T, size_t BlockSize = 64>
+class PhysicsPool final : public std::enable_shared_from_this<PhysicsPool<T, BlockSize>>
+{
+public:
+	PhysicsPool() = default;
+	PhysicsPool(const PhysicsPool&) = delete;
+	PhysicsPool& operator=(const PhysicsPool&) = delete;
+	~PhysicsPool() { Clear(); }
+
+	template<typename... Args>
+	[[nodiscard]] T* Allocate(Args&&... args)
+	{
+		Slot& slot = acquireSlot();
+		T* object = new (slot.storage) T(std::forward<Args>(args)...);
+		slot.alive = true;
+		m_liveCount++;
+		return object;
+	}
+
+	template<typename... Args>
+	[[nodiscard]] std::shared_ptr<T> Create(Args&&... args)
+	{
+		T* object = Allocate(std::forward<Args>(args)...);
+		const uint32_t generation = toSlot(object)->generation;
+		std::weak_ptr<PhysicsPool> pool = this->weak_from_this();
+		return std::shared_ptr<T>(object, [pool, generation](T* ptr)
+			{
+				if (auto p = pool.lock()) p->free(ptr, generation);
+			});
+	}
+
+	void Free(T* object)
+	{
+		if (object) free(object, toSlot(object)->generation);
+	}
+
+	// Destroys every live object. Slots stay allocated and are reused by later Allocate() calls.
+	void Clear()
+	{
+		for (auto& block : m_blocks)
+		{
+			for (size_t i = 0; i < BlockSize; i++)
+			{
+				if (block[i].alive) free(reinterpret_cast<T*>(block[i].storage), block[i].generation);
+			}
+		}
+	}
+
+	[[nodiscard]] size_t GetLiveCount() const { return m_liveCount; }
+	[[nodiscard]] size_t GetCapacity() const { return m_blocks.size() * BlockSize; }
+
+private:
+	struct Slot final
+	{
+		alignas(T) unsigned char storage[sizeof(T)];
+		uint32_t index = 0;
+		uint32_t generation = 0;
+		bool     alive = false;
+	};
+	static_assert(std::is_standard_layout_v<Slot>);
+
+	static Slot* toSlot(T* object) { return reinterpret_cast<Slot*>(object); }
+
+	Slot& acquireSlot()
+	{
+		if (m_freeList.empty())
+		{
+			const uint32_t first = static_cast<uint32_t>(GetCapacity());
+			auto& block = m_blocks.emplace_back(std::make_unique<Slot[]>(BlockSize));
+			for (size_t i = BlockSize; i > 0; i--)
+			{
+				block[i - 1].index = first + static_cast<uint32_t>(i - 1);
+				m_freeList.push_back(block[i - 1].index);
+			}
+		}
+
+		const uint32_t index = m_freeList.back();
+		m_freeList.pop_back();
+		return m_blocks[index / BlockSize][index % BlockSize];
+	}
+
+	void free(T* object, uint32_t generation)
+	{
+		Slot* slot = toSlot(object);
+		if (!slot->alive || slot->generation != generation) return;
+
+		// the slot is marked dead before the destructor runs, so objects released from inside it are not freed twice
+		slot->alive = false;
+		object->~T();
+		slot->generation++;
+		m_freeList.push_back(slot->index);
+		m_liveCount--;
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> m_blocks;
+	std::vector<uint32_t>                m_freeList;
+	size_t                               m_liveCount = 0;
+};
+
+#pragma endregion
+
 //=============================================================================
 #pragma region [ Layers ]
 
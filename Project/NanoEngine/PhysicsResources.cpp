@@ -296,7 +296,7 @@ BaseActor::~BaseActor()
 	if (m_actor != nullptr)
 	{
 		auto scene = m_actor->getScene();
-		delete m_actor->userData;
+		m_engine.GetPhysicsScene().FreeUserData(m_actor->userData);
 		scene->removeActor(*m_actor);
 		PX_RELEASE(m_actor);
 	}
@@ -304,27 +304,27 @@ BaseActor::~BaseActor()
 
 void BaseActor::AttachCollider(const BoxColliderCreateInfo& createInfo)
 {
-	AttachCollider(std::make_shared<BoxCollider>(m_engine, this, createInfo));
+	AttachCollider(m_engine.GetPhysicsScene().CreateCollider(this, createInfo));
 }
 
 void BaseActor::AttachCollider(const SphereColliderCreateInfo& createInfo)
 {
-	AttachCollider(std::make_shared<SphereCollider>(m_engine, this, createInfo));
+	AttachCollider(m_engine.GetPhysicsScene().CreateCollider(this, createInfo));
 }
 
 void BaseActor::AttachCollider(const CapsuleColliderCreateInfo& createInfo)
 {
-	AttachCollider(std::make_shared<CapsuleCollider>(m_engine, this, createInfo));
+	AttachCollider(m_engine.GetPhysicsScene().CreateCollider(this, createInfo));
 }
 
 void BaseActor::AttachCollider(const MeshColliderCreateInfo& createInfo)
 {
-	AttachCollider(std::make_shared<MeshCollider>(m_engine, this, createInfo));
+	AttachCollider(m_engine.GetPhysicsScene().CreateCollider(this, createInfo));
 }
 
 void BaseActor::AttachCollider(const ConvexMeshColliderCreateInfo& createInfo)
 {
-	AttachCollider(std::make_shared<ConvexMeshCollider>(m_engine, this, createInfo));
+	AttachCollider(m_engine.GetPhysicsScene().CreateCollider(this, createInfo));
 }
 
 void BaseActor::AttachCollider(ColliderPtr collider)
@@ -432,7 +432,7 @@ StaticBody::StaticBody(EngineApplication& engine, const StaticActorCreateInfo& c
 		PxQuat(createInfo.worldRotation.x, createInfo.worldRotation.y, createInfo.worldRotation.z, createInfo.worldRotation.w) };
 
 	m_actor = m_engine.GetPhysicsSystem().GetPxPhysics()->createRigidStatic(transform);
-	m_actor->userData = new UserData{ .type = UserDataType::StaticBody, .ptr = this };
+	m_actor->userData = m_engine.GetPhysicsScene().AllocateUserData(UserDataType::StaticBody, this);
 	auto scene = m_engine.GetPhysicsSystem().GetScene().GetPxScene();
 	scene->addActor(*m_actor);
 }
@@ -478,7 +478,7 @@ RigidBody::RigidBody(EngineApplication& engine, const RigidBodyCreateInfo& creat
 	auto actor = m_engine.GetPhysicsSystem().GetPxPhysics()->createRigidDynamic(PxTransform(PxVec3(0, 0, 0)));
 	PxRigidBodyExt::updateMassAndInertia(*actor, createInfo.density);
 	m_actor = actor;
-	m_actor->userData = new UserData{ .type = UserDataType::RigidBody, .ptr = this };
+	m_actor->userData = m_engine.GetPhysicsScene().AllocateUserData(UserDataType::RigidBody, this);
 	scene->addActor(*m_actor);
 }
 
@@ -846,12 +846,12 @@ CharacterController::CharacterController(EngineApplication& engine, const Charac
 	m_rigidbody = m_controller->getActor();
 	PhysicsForEachActorShape(m_rigidbody, [&filterData](PxShape* shape) { shape->setQueryFilterData(filterData); });
 
-	m_rigidbody->userData = new UserData{ .type = UserDataType::CharacterController, .ptr = this };
+	m_rigidbody->userData = m_engine.GetPhysicsScene().AllocateUserData(UserDataType::CharacterController, this);
 }
 
 CharacterController::~CharacterController()
 {
-	delete m_rigidbody->userData;
+	m_engine.GetPhysicsScene().FreeUserData(m_rigidbody->userData);
 	PX_RELEASE(m_controller);
 }
 
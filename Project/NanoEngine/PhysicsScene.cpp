@@ -199,6 +199,11 @@ bool PhysicsScene::Setup(const PhysicsSceneCreateInfo& createInfo)
 
 void PhysicsScene::Shutdown()
 {
+	ReleaseAll();
+	const PhysicsPoolStats stats = GetPoolStats();
+	if (stats.Total() > 0)
+		Warning("Physics scene leaked " + std::to_string(stats.Total()) + " pooled objects.");
+
 	PX_RELEASE(m_controllerManager);
 	PX_RELEASE(m_scene);
 }
@@ -212,6 +217,91 @@ void PhysicsScene::FixedUpdate()
 		Warning("Physics simulation failed. Error code: " + std::to_string(errorState));
 }
 
+StaticActorPtr PhysicsScene::CreateStaticBody(const StaticActorCreateInfo& createInfo)
+{
+	return m_staticBodies->Create(m_engine, createInfo);
+}
+
+RigidBodyPtr PhysicsScene::CreateRigidBody(const RigidBodyCreateInfo& createInfo)
+{
+	return m_rigidBodies->Create(m_engine, createInfo);
+}
+
+CharacterControllerPtr PhysicsScene::CreateCharacterController(const CharacterControllerCreateInfo& createInfo)
+{
+	return m_characterControllers->Create(m_engine, createInfo);
+}
+
+ColliderPtr PhysicsScene::CreateCollider(BaseActor* owner, const BoxColliderCreateInfo& createInfo)
+{
+	return m_boxColliders->Create(m_engine, owner, createInfo);
+}
+
+ColliderPtr PhysicsScene::CreateCollider(BaseActor* owner, const SphereColliderCreateInfo& createInfo)
+{
+	return m_sphereColliders->Create(m_engine, owner, createInfo);
+}
+
+ColliderPtr PhysicsScene::CreateCollider(BaseActor* owner, const CapsuleColliderCreateInfo& createInfo)
+{
+	return m_capsuleColliders->Create(m_engine, owner, createInfo);
+}
+
+ColliderPtr PhysicsScene::CreateCollider(BaseActor* owner, const MeshColliderCreateInfo& createInfo)
+{
+	return m_meshColliders->Create(m_engine, owner, createInfo);
+}
+
+ColliderPtr PhysicsScene::CreateCollider(BaseActor* owner, const ConvexMeshColliderCreateInfo& createInfo)
+{
+	return m_convexMeshColliders->Create(m_engine, owner, createInfo);
+}
+
+UserData* PhysicsScene::AllocateUserData(UserDataType type, void* ptr)
+{
+	return m_userData->Allocate(UserData{ .type = type, .ptr = ptr });
+}
+
+void PhysicsScene::FreeUserData(void* userData)
+{
+	m_userData->Free(static_cast<UserData*>(userData));
+}
+
+void PhysicsScene::ReleaseAll()
+{
+	const size_t count = GetPoolStats().Total();
+	if (count == 0) return;
+
+	Clock clock;
+	// controllers own their PxController actors, shapes must go before the actors they are attached to, and user data is referenced by both
+	m_characterControllers->Clear();
+	m_boxColliders->Clear();
+	m_sphereColliders->Clear();
+	m_capsuleColliders->Clear();
+	m_meshColliders->Clear();
+	m_convexMeshColliders->Clear();
+	m_rigidBodies->Clear();
+	m_staticBodies->Clear();
+	m_userData->Clear();
+
+	Print("Physics scene released " + std::to_string(count) + " objects in " + std::to_string(clock.GetElapsedTime().AsMicroseconds()) + " us");
+}
+
+PhysicsPoolStats PhysicsScene::GetPoolStats() const
+{
+	PhysicsPoolStats stats{};
+	stats.staticBodies         = m_staticBodies->GetLiveCount();
+	stats.rigidBodies          = m_rigidBodies->GetLiveCount();
+	stats.characterControllers = m_characterControllers->GetLiveCount();
+	stats.colliders            = m_boxColliders->GetLiveCount()
+		+ m_sphereColliders->GetLiveCount()
+		+ m_capsuleColliders->GetLiveCount()
+		+ m_meshColliders->GetLiveCount()
+		+ m_convexMeshColliders->GetLiveCount();
+	stats.userData             = m_userData->GetLiveCount();
+	return stats;
+}
+
 physx::PxRaycastBuffer PhysicsScene::Raycast(const physx::PxVec3& origin, const physx::PxVec3& unitDir, const float distance, PhysicsLayer layer) const
 {
 	physx::PxQueryFilterData queryFilterData;
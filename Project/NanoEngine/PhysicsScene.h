@@ -12,6 +12,18 @@ struct PhysicsSceneCreateInfo final
 	glm::vec3 gravity{ 0.0f, -9.81f, 0.0f };
 };
 
+// Number of live objects in each pool of the scene.
+struct PhysicsPoolStats final
+{
+	size_t staticBodies = 0;
+	size_t rigidBodies = 0;
+	size_t characterControllers = 0;
+	size_t colliders = 0;
+	size_t userData = 0;
+
+	[[nodiscard]] size_t Total() const { return staticBodies + rigidBodies + characterControllers + colliders + userData; }
+};
+
 class PhysicsScene final
 {
 	friend EngineApplication;
@@ -23,7 +35,25 @@ public:
 	void Shutdown();
 
 	void FixedUpdate();
-	
+
+	// Bodies, colliders and user data are owned by the scene pools. The returned handles may be dropped in any order, even after ReleaseAll() or Shutdown().
+	[[nodiscard]] StaticActorPtr CreateStaticBody(const StaticActorCreateInfo& createInfo);
+	[[nodiscard]] RigidBodyPtr CreateRigidBody(const RigidBodyCreateInfo& createInfo);
+	[[nodiscard]] CharacterControllerPtr CreateCharacterController(const CharacterControllerCreateInfo& createInfo);
+
+	[[nodiscard]] ColliderPtr CreateCollider(BaseActor* owner, const BoxColliderCreateInfo& createInfo);
+	[[nodiscard]] ColliderPtr CreateCollider(BaseActor* owner, const SphereColliderCreateInfo& createInfo);
+	[[nodiscard]] ColliderPtr CreateCollider(BaseActor* owner, const CapsuleColliderCreateInfo& createInfo);
+	[[nodiscard]] ColliderPtr CreateCollider(BaseActor* owner, const MeshColliderCreateInfo& createInfo);
+	[[nodiscard]] ColliderPtr CreateCollider(BaseActor* owner, const ConvexMeshColliderCreateInfo& createInfo);
+
+	[[nodiscard]] UserData* AllocateUserData(UserDataType type, void* ptr);
+	void FreeUserData(void* userData);
+
+	// Bulk release of all pooled objects in dependency order: character controllers, colliders, bodies, user data. Used for level teardown.
+	void ReleaseAll();
+	[[nodiscard]] PhysicsPoolStats GetPoolStats() const;
+
 	[[nodiscard]] physx::PxRaycastBuffer Raycast(const physx::PxVec3& origin, const physx::PxVec3& unitDir, float distance, PhysicsLayer layer) const;
 	[[nodiscard]] physx::PxSweepBuffer Sweep(const physx::PxGeometry& geometry, const physx::PxTransform& pose, const physx::PxVec3& unitDir, float distance, PhysicsLayer layer) const;
 
@@ -36,6 +66,18 @@ private:
 	physx::PxPhysics*           m_physics{ nullptr };
 	physx::PxScene*             m_scene{ nullptr };
 	physx::PxControllerManager* m_controllerManager{ nullptr };
+
+	// Declared in reverse release order: a scene destroyed without Shutdown() (failed setup) tears the pools down in the
+	// same dependency order as ReleaseAll(), and user data outlives the bodies that free it.
+	std::shared_ptr<PhysicsPool<UserData, 256>>       m_userData = std::make_shared<PhysicsPool<UserData, 256>>();
+	std::shared_ptr<PhysicsPool<StaticBody>>          m_staticBodies = std::make_shared<PhysicsPool<StaticBody>>();
+	std::shared_ptr<PhysicsPool<RigidBody>>           m_rigidBodies = std::make_shared<PhysicsPool<RigidBody>>();
+	std::shared_ptr<PhysicsPool<ConvexMeshCollider>>  m_convexMeshColliders = std::make_shared<PhysicsPool<ConvexMeshCollider>>();
+	std::shared_ptr<PhysicsPool<MeshCollider>>        m_meshColliders = std::make_shared<PhysicsPool<MeshCollider>>();
+	std::shared_ptr<PhysicsPool<CapsuleCollider>>     m_capsuleColliders = std::make_shared<PhysicsPool<CapsuleCollider>>();
+	std::shared_ptr<PhysicsPool<SphereCollider>>      m_sphereColliders = std::make_shared<PhysicsPool<SphereCollider>>();
+	std::shared_ptr<PhysicsPool<BoxCollider>>         m_boxColliders = std::make_shared<PhysicsPool<BoxCollider>>();
+	std::shared_ptr<PhysicsPool<CharacterController>> m_characterControllers = std::make_shared<PhysicsPool<CharacterController>>();
 };
 
 #pragma endregion
@@ -297,14 +297,24 @@ bool Window::Setup(const WindowCreateInfo& createInfo)
 	return true;
 }
 
+void Window::SetupHeadless(const WindowCreateInfo& createInfo)
+{
+	m_width = static_cast<uint32_t>(createInfo.width);
+	m_height = static_cast<uint32_t>(createInfo.height);
+	m_headless = true;
+}
+
 void Window::Shutdown()
 {
+	if (m_headless) return;
+
 	glfwDestroyWindow(m_window);
 	glfwTerminate();
 }
 
 bool Window::ShouldClose() const
 {
+	if (m_headless) return false;
 	return glfwWindowShouldClose(m_window) == GLFW_TRUE;
 }
 
@@ -504,13 +514,17 @@ void Input::Update()
 	//m_mouseState.lastPosition = m_mouseState.position;
 }
 
+// Without a window (headless runs) nothing is ever pressed and cursor changes are ignored.
+
 bool Input::IsPressed(int key)
 {
+	if (!m_engine.GetWindow().m_window) return false;
 	return glfwGetKey(m_engine.GetWindow().m_window, key) == GLFW_PRESS;
 }
 
 float Input::GetKeyAxis(int posKey, int negKey)
 {
+	if (!m_engine.GetWindow().m_window) return 0.0f;
 	float value = 0.0f;
 	if (glfwGetKey(m_engine.GetWindow().m_window, posKey)) value += 1.0f;
 	if (glfwGetKey(m_engine.GetWindow().m_window, negKey)) value -= 1.0f;
@@ -519,6 +533,7 @@ float Input::GetKeyAxis(int posKey, int negKey)
 
 bool Input::IsButtonDown(MouseButton button)
 {
+	if (!m_engine.GetWindow().m_window) return false;
 	return glfwGetMouseButton(m_engine.GetWindow().m_window, static_cast<int>(button)) == GLFW_PRESS;
 }
 
@@ -534,6 +549,7 @@ const glm::ivec2 Input::GetDeltaPosition()
 
 void Input::SetPosition(const glm::ivec2& position)
 {
+	if (!m_engine.GetWindow().m_window) return;
 	glfwSetCursorPos(m_engine.GetWindow().m_window, position.x, position.y);
 }
 
@@ -544,6 +560,7 @@ void Input::SetCursorMode(CursorMode mode)
 	if (mode == CursorMode::Disabled) mod = GLFW_CURSOR_DISABLED;
 	else if (mode == CursorMode::Disabled) mod = GLFW_CURSOR_HIDDEN;
 
+	if (!m_engine.GetWindow().m_window) return;
 	glfwSetInputMode(m_engine.GetWindow().m_window, GLFW_CURSOR, mod);
 }
 
@@ -32,6 +32,8 @@ public:
 	Window(EngineApplication& engine);
 
 	[[nodiscard]] bool Setup(const WindowCreateInfo& createInfo);
+	// No GLFW and no OS window, only the size from createInfo is reported.
+	void SetupHeadless(const WindowCreateInfo& createInfo);
 	void Shutdown();
 
 	[[nodiscard]] bool ShouldClose() const;
@@ -51,6 +53,7 @@ private:
 	uint32_t           m_width = 0;
 	uint32_t           m_height = 0;
 	WindowState        m_state = WINDOW_STATE_RESTORED;
+	bool               m_headless = false;
 };
 
 #pragma endregion
@@ -5216,6 +5216,96 @@ namespace vkrUtil
 		return SUCCESS;
 	}
 
+	Result CreateImageArrayFromBitmaps(
+		Queue* pQueue,
+		uint32_t bitmapCount,
+		const Bitmap* pBitmaps,
+		Image** ppImage,
+		const ImageOptions& options)
+	{
+		ASSERT_NULL_ARG(pQueue);
+		ASSERT_NULL_ARG(pBitmaps);
+		ASSERT_NULL_ARG(ppImage);
+
+		if (bitmapCount == 0) {
+			return ERROR_UNEXPECTED_COUNT_VALUE;
+		}
+
+		const uint32_t width = pBitmaps[0].GetWidth();
+		const uint32_t height = pBitmaps[0].GetHeight();
+		const Bitmap::Format format = pBitmaps[0].GetFormat();
+		for (uint32_t layer = 1; layer < bitmapCount; ++layer) {
+			if (pBitmaps[layer].GetWidth() != width || pBitmaps[layer].GetHeight() != height || pBitmaps[layer].GetFormat() != format) {
+				return ERROR_IMAGE_INVALID_FORMAT;
+			}
+		}
+
+		Result ppxres = ERROR_FAILED;
+
+		// Scoped destroy
+		ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+
+		// Cap mip level count
+		uint32_t maxMipLevelCount = Mipmap::CalculateLevelCount(width, height);
+		uint32_t mipLevelCount = std::min<uint32_t>(options.mMipLevelCount, maxMipLevelCount);
+
+		// Create target image
+		ImagePtr targetImage;
+		{
+			ImageCreateInfo ci = {};
+			ci.type = ImageType::Image2D;
+			ci.width = width;
+			ci.height = height;
+			ci.depth = 1;
+			ci.format = ToGrfxFormat(format);
+			ci.sampleCount = SampleCount::Sample1;
+			ci.mipLevelCount = mipLevelCount;
+			ci.arrayLayerCount = bitmapCount;
+			ci.usageFlags.bits.transferDst = true;
+			ci.usageFlags.bits.sampled = true;
+			ci.memoryUsage = MemoryUsage::GPUOnly;
+			ci.initialState = ResourceState::ShaderResource;
+
+			ci.usageFlags.flags |= options.mAdditionalUsage;
+
+			ppxres = pQueue->GetDevice()->CreateImage(ci, &targetImage);
+			if (Failed(ppxres)) {
+				return ppxres;
+			}
+			SCOPED_DESTROYER.AddObject(targetImage);
+		}
+
+		// Copy mips of every layer to image
+		for (uint32_t layer = 0; layer < bitmapCount; ++layer) {
+			Mipmap mipmap = Mipmap(pBitmaps[layer], mipLevelCount, /* useStaticPool= */ true);
+			if (!mipmap.IsOk()) {
+				return ERROR_FAILED;
+			}
+
+			for (uint32_t mipLevel = 0; mipLevel < mipLevelCount; ++mipLevel) {
+				ppxres = CopyBitmapToImage(
+					pQueue,
+					mipmap.GetMip(mipLevel),
+					targetImage,
+					mipLevel,
+					layer,
+					ResourceState::ShaderResource,
+					ResourceState::ShaderResource);
+				if (Failed(ppxres)) {
+					return ppxres;
+				}
+			}
+		}
+
+		// Change ownership to reference so object doesn't get destroyed
+		targetImage->SetOwnership(Ownership::Reference);
+
+		// Assign output
+		*ppImage = targetImage;
+
+		return SUCCESS;
+	}
+
 	Result CreateImageFromBitmapGpu(
 		Queue* pQueue,
 		const Bitmap* pBitmap,
@@ -5746,7 +5836,13 @@ namespace vkrUtil
 		//ScopedTimer timer("Image creation from file '" + path.string() + "'");
 
 		Result ppxres;
-		if (Bitmap::IsBitmapFile(path))
+		gli::texture cookedImage;
+		if ((options.mBlockFormat != BlockFormat::Undefined) && Bitmap::IsBitmapFile(path)
+			&& !Failed(TextureCache::Load(path, { options.mBlockFormat, options.mMipLevelCount }, &cookedImage)))
+		{
+			ppxres = CreateImageFromCompressedImage(pQueue, cookedImage, ppImage, options);
+		}
+		else if (Bitmap::IsBitmapFile(path))
 		{
 			// Load bitmap
 			Bitmap bitmap;
@@ -5771,7 +5867,8 @@ namespace vkrUtil
 		else if (IsDDSFile(path))
 		{
 			// Generate a bitmap out of a DDS
-			gli::texture image = gli::load(path.string().c_str());
+			MappedFile   file;
+			gli::texture image = file.Open(path) ? gli::load(file.GetData(), file.GetLength()) : gli::texture();
 			if (image.empty()) {
 				return Result::ERROR_IMAGE_FILE_LOAD_FAILED;
 			}
@@ -5994,6 +6091,29 @@ namespace vkrUtil
 
 		//ScopedTimer timer("Texture creation from image file '" + path.string() + "'");
 
+		// The cooked image ends up in the shader resource state, so other initial states and Ycbcr conversions take the uncompressed path
+		gli::texture cookedImage;
+		if ((options.mBlockFormat != BlockFormat::Undefined) && (options.mInitialState == ResourceState::ShaderResource) && IsNull(options.mYcbcrConversion)
+			&& !Failed(TextureCache::Load(path, { options.mBlockFormat, options.mMipLevelCount }, &cookedImage)))
+		{
+			Image* pImage = nullptr;
+			Result ppxres = CreateImageFromCompressedImage(pQueue, cookedImage, &pImage, ImageOptions().AdditionalUsage(options.mAdditionalUsage).MipLevelCount(options.mMipLevelCount));
+			if (Failed(ppxres)) return ppxres;
+
+			TextureCreateInfo ci = {};
+			ci.image = pImage;
+			ci.ownership = Ownership::Reference;
+			ppxres = pQueue->GetDevice()->CreateTexture(ci, ppTexture);
+			if (Failed(ppxres))
+			{
+				pQueue->GetDevice()->DestroyImage(pImage);
+				return ppxres;
+			}
+			// The texture destroys the image with itself
+			pImage->SetOwnership(Ownership::Exclusive);
+			return SUCCESS;
+		}
+
 		// Load bitmap
 		Bitmap bitmap;
 		Result ppxres = Bitmap::LoadFile(path, &bitmap);
@@ -2223,10 +2223,13 @@ namespace vkrUtil
 
 		ImageOptions& AdditionalUsage(ImageUsageFlags flags) { mAdditionalUsage = flags; return *this; }
 		ImageOptions& MipLevelCount(uint32_t levelCount) { mMipLevelCount = levelCount; return *this; }
+		// Image files are cooked to this format through the TextureCache. Files that can't be cooked are loaded uncompressed.
+		ImageOptions& BlockCompression(BlockFormat format) { mBlockFormat = format; return *this; }
 
 	private:
 		ImageUsageFlags mAdditionalUsage = ImageUsageFlags();
 		uint32_t              mMipLevelCount = RemainingMipLevels;
+		BlockFormat           mBlockFormat = BlockFormat::Undefined;
 
 		friend Result CreateImageFromBitmap(
 			Queue* pQueue,
@@ -2234,6 +2237,13 @@ namespace vkrUtil
 			Image** ppImage,
 			const ImageOptions& options);
 
+		friend Result CreateImageArrayFromBitmaps(
+			Queue* pQueue,
+			uint32_t bitmapCount,
+			const Bitmap* pBitmaps,
+			Image** ppImage,
+			const ImageOptions& options);
+
 		friend Result CreateImageFromCompressedImage(
 			Queue* pQueue,
 			const gli::texture& image,
@@ -2269,6 +2279,14 @@ namespace vkrUtil
 		Image** ppImage,
 		const ImageOptions& options = ImageOptions());
 
+	// Creates a 2D array image with one layer per bitmap. All bitmaps must have the same size and format.
+	Result CreateImageArrayFromBitmaps(
+		Queue* pQueue,
+		uint32_t bitmapCount,
+		const Bitmap* pBitmaps,
+		Image** ppImage,
+		const ImageOptions& options = ImageOptions());
+
 	Result CreateImageFromFile(
 		Queue* pQueue,
 		const std::filesystem::path& path,
@@ -2292,12 +2310,15 @@ namespace vkrUtil
 		TextureOptions& InitialState(ResourceState state) { mInitialState = state; return *this; }
 		TextureOptions& MipLevelCount(uint32_t levelCount) { mMipLevelCount = levelCount; return *this; }
 		TextureOptions& SamplerYcbcrConversion(SamplerYcbcrConversion* pYcbcrConversion) { mYcbcrConversion = pYcbcrConversion; return *this; }
+		// Image files are cooked to this format through the TextureCache. Files that can't be cooked are loaded uncompressed.
+		TextureOptions& BlockCompression(BlockFormat format) { mBlockFormat = format; return *this; }
 
 	private:
 		ImageUsageFlags         mAdditionalUsage = ImageUsageFlags();
 		ResourceState           mInitialState = ResourceState::ShaderResource;
 		uint32_t                      mMipLevelCount = 1;
 		vkr::SamplerYcbcrConversion* mYcbcrConversion = nullptr;
+		BlockFormat                  mBlockFormat = BlockFormat::Undefined;
 
 		friend Result CreateTextureFromBitmap(
 			Queue* pQueue,
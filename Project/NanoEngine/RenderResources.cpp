@@ -7373,6 +7373,10 @@ Result TextureFont::createApiObjects(const TextureFontCreateInfo& pCreateInfo)
 		return ERROR_INVALID_UTF8_STRING;
 	}
 
+	if (pCreateInfo.signedDistanceField) {
+		return createSdfApiObjects(pCreateInfo);
+	}
+
 	// Font metrics
 	pCreateInfo.font.GetFontMetrics(pCreateInfo.size, &mFontMetrics);
 
@@ -7467,14 +7471,154 @@ Result TextureFont::createApiObjects(const TextureFontCreateInfo& pCreateInfo)
 	return SUCCESS;
 }
 
+Result TextureFont::createSdfApiObjects(const TextureFontCreateInfo& pCreateInfo)
+{
+	mSdfAtlas = SdfGlyphAtlas(pCreateInfo.font, pCreateInfo.sdfAtlas);
+	if (!mSdfAtlas.IsOk()) {
+		return ERROR_ALLOCATION_FAILED;
+	}
+	mFontMetrics = mSdfAtlas.GetFontMetrics();
+
+	Result ppxres = vkrUtil::CreateTextureFromBitmap(GetDevice()->GetGraphicsQueue(), &mSdfAtlas.GetBitmap(), &mTexture);
+	if (Failed(ppxres)) return ppxres;
+	mSdfAtlas.TakeDirtyRects();
+
+	// The atlas holds on to the font for the glyphs rasterized later
+	m_createInfo.font = Font();
+
+	const std::string& characters = m_createInfo.characters;
+	utf8::iterator<std::string::const_iterator> it(characters.begin(), characters.begin(), characters.end());
+	utf8::iterator<std::string::const_iterator> it_end(characters.end(), characters.begin(), characters.end());
+	while (it != it_end) {
+		GetGlyphMetrics(utf8::next(it, it_end));
+	}
+	GetGlyphMetrics(32);
+
+	return UploadDirtyRects(GetDevice()->GetGraphicsQueue());
+}
+
 void TextureFont::destroyApiObjects()
 {
+	for (BufferPtr& stagingBuffer : mSdfStagingBuffers) {
+		if (stagingBuffer) {
+			GetDevice()->DestroyBuffer(stagingBuffer);
+		}
+	}
+	mSdfStagingBuffers.clear();
+
 	if (mTexture) {
 		GetDevice()->DestroyTexture(mTexture);
 		mTexture.Reset();
 	}
 }
 
+void TextureFont::BeginFrame()
+{
+	mSdfAtlas.BeginFrame();
+}
+
+Result TextureFont::UploadDirtyRects(Queue* pQueue)
+{
+	std::vector<BufferToImageCopyInfo> copyInfos;
+	Buffer*                            pStagingBuffer = nullptr;
+	Result                             ppxres = stageDirtyRects(&copyInfos, &pStagingBuffer);
+	if (Failed(ppxres) || copyInfos.empty()) {
+		return ppxres;
+	}
+
+	return pQueue->CopyBufferToImage(copyInfos, pStagingBuffer, mTexture->GetImage(), ResourceState::ShaderResource, ResourceState::ShaderResource);
+}
+
+Result TextureFont::UploadDirtyRects(CommandBuffer* pCommandBuffer)
+{
+	std::vector<BufferToImageCopyInfo> copyInfos;
+	Buffer*                            pStagingBuffer = nullptr;
+	Result                             ppxres = stageDirtyRects(&copyInfos, &pStagingBuffer);
+	if (Failed(ppxres) || copyInfos.empty()) {
+		return ppxres;
+	}
+
+	pCommandBuffer->TransitionImageLayout(mTexture->GetImage(), ALL_SUBRESOURCES, ResourceState::ShaderResource, ResourceState::CopyDst);
+	pCommandBuffer->CopyBufferToImage(copyInfos, pStagingBuffer, mTexture->GetImage());
+	pCommandBuffer->TransitionImageLayout(mTexture->GetImage(), ALL_SUBRESOURCES, ResourceState::CopyDst, ResourceState::ShaderResource);
+
+	return SUCCESS;
+}
+
+Result TextureFont::stageDirtyRects(std::vector<BufferToImageCopyInfo>* pCopyInfos, Buffer** ppStagingBuffer)
+{
+	if (!mSdfAtlas.HasDirtyRects()) {
+		return SUCCESS;
+	}
+	const std::vector<AtlasRect> rects = mSdfAtlas.TakeDirtyRects();
+
+	// Rectangles are packed tightly one after another into the staging buffer
+	std::vector<BufferToImageCopyInfo>& copyInfos = *pCopyInfos;
+	copyInfos.resize(rects.size());
+	uint64_t stagingSize = 0;
+	for (size_t i = 0; i < rects.size(); ++i) {
+		const AtlasRect& rect = rects[i];
+
+		BufferToImageCopyInfo& copyInfo = copyInfos[i];
+		copyInfo.srcBuffer.imageWidth = rect.width;
+		copyInfo.srcBuffer.imageHeight = rect.height;
+		copyInfo.srcBuffer.imageRowStride = rect.width;
+		copyInfo.srcBuffer.footprintOffset = stagingSize;
+		copyInfo.srcBuffer.footprintWidth = rect.width;
+		copyInfo.srcBuffer.footprintHeight = rect.height;
+		copyInfo.srcBuffer.footprintDepth = 1;
+		copyInfo.dstImage.mipLevel = 0;
+		copyInfo.dstImage.arrayLayer = 0;
+		copyInfo.dstImage.arrayLayerCount = 1;
+		copyInfo.dstImage.x = rect.x;
+		copyInfo.dstImage.y = rect.y;
+		copyInfo.dstImage.z = 0;
+		copyInfo.dstImage.width = rect.width;
+		copyInfo.dstImage.height = rect.height;
+		copyInfo.dstImage.depth = 1;
+
+		stagingSize = RoundUp<uint64_t>(stagingSize + static_cast<uint64_t>(rect.width) * rect.height, 4);
+	}
+
+	// A recorded copy may still be reading the previous buffers, so each upload takes the next one
+	mSdfStagingBuffers.resize(std::max<uint32_t>(m_createInfo.sdfStagingBufferCount, 1));
+	mSdfStagingIndex = (mSdfStagingIndex + 1) % static_cast<uint32_t>(mSdfStagingBuffers.size());
+	BufferPtr& stagingBuffer = mSdfStagingBuffers[mSdfStagingIndex];
+
+	if (!stagingBuffer || (stagingBuffer->GetSize() < stagingSize)) {
+		if (stagingBuffer) {
+			GetDevice()->DestroyBuffer(stagingBuffer);
+			stagingBuffer.Reset();
+		}
+
+		BufferCreateInfo createInfo = {};
+		createInfo.size = std::max<uint64_t>(stagingSize, mSdfAtlas.GetBitmap().GetFootprintSize() / 4);
+		createInfo.usageFlags.bits.transferSrc = true;
+		createInfo.memoryUsage = MemoryUsage::CPUToGPU;
+
+		Result ppxres = GetDevice()->CreateBuffer(createInfo, &stagingBuffer);
+		if (Failed(ppxres)) return ppxres;
+	}
+
+	void*  pBufferAddress = nullptr;
+	Result ppxres = stagingBuffer->MapMemory(0, &pBufferAddress);
+	if (Failed(ppxres)) return ppxres;
+
+	const Bitmap& bitmap = mSdfAtlas.GetBitmap();
+	for (size_t i = 0; i < rects.size(); ++i) {
+		const AtlasRect& rect = rects[i];
+		char*            pDst = static_cast<char*>(pBufferAddress) + copyInfos[i].srcBuffer.footprintOffset;
+		for (uint32_t y = 0; y < rect.height; ++y) {
+			memcpy(pDst + static_cast<size_t>(y) * rect.width, bitmap.GetPixelAddress(rect.x, rect.y + y), rect.width);
+		}
+	}
+
+	stagingBuffer->UnmapMemory();
+
+	*ppStagingBuffer = stagingBuffer;
+	return SUCCESS;
+}
+
 const TextureFontGlyphMetrics* TextureFont::GetGlyphMetrics(uint32_t codepoint) const
 {
 	const TextureFontGlyphMetrics* ptr = nullptr;
@@ -7486,9 +7630,37 @@ const TextureFontGlyphMetrics* TextureFont::GetGlyphMetrics(uint32_t codepoint)
 	if (it != std::end(mGlyphMetrics)) {
 		ptr = &(*it);
 	}
+	else if (IsSignedDistanceField() && mSdfAtlas.FindGlyph(codepoint)) {
+		ptr = &mSdfGlyphMetrics.at(codepoint);
+	}
 	return ptr;
 }
 
+const TextureFontGlyphMetrics* TextureFont::GetGlyphMetrics(uint32_t codepoint)
+{
+	if (!IsSignedDistanceField()) {
+		return std::as_const(*this).GetGlyphMetrics(codepoint);
+	}
+
+	const SdfGlyph* pGlyph = mSdfAtlas.GetGlyph(codepoint);
+	if (IsNull(pGlyph)) {
+		return nullptr;
+	}
+
+	// Refreshed every time since evicted glyphs come back at another place in the atlas
+	const float              invAtlasSize = 1.0f / static_cast<float>(mSdfAtlas.GetBitmap().GetWidth());
+	TextureFontGlyphMetrics& metrics = mSdfGlyphMetrics[codepoint];
+	metrics.codepoint = codepoint;
+	metrics.glyphMetrics.advance = pGlyph->advance;
+	metrics.glyphMetrics.box = pGlyph->box;
+	metrics.size = float2(pGlyph->rect.width, pGlyph->rect.height);
+	metrics.uvRect.u0 = static_cast<float>(pGlyph->rect.x) * invAtlasSize;
+	metrics.uvRect.v0 = static_cast<float>(pGlyph->rect.y) * invAtlasSize;
+	metrics.uvRect.u1 = static_cast<float>(pGlyph->rect.x + pGlyph->rect.width) * invAtlasSize;
+	metrics.uvRect.v1 = static_cast<float>(pGlyph->rect.y + pGlyph->rect.height) * invAtlasSize;
+	return &metrics;
+}
+
 struct Vertex
 {
 	float2   position;
@@ -7835,10 +8007,12 @@ void TextDraw::AddString(
 	utf8::iterator<std::string::const_iterator> it(string.begin(), string.begin(), string.end());
 	utf8::iterator<std::string::const_iterator> it_end(string.end(), string.begin(), string.end());
 	float2                                      baseline = position;
+	const float                                 fontSize = (mFontSize > 0.0f) ? mFontSize : m_createInfo.pFont->GetSize();
+	const float                                 scale = fontSize / m_createInfo.pFont->GetMetricsSize();
 	float                                       ascent = m_createInfo.pFont->GetAscent();
 	float                                       descent = m_createInfo.pFont->GetDescent();
 	float                                       lineGap = m_createInfo.pFont->GetLineGap();
-	lineSpacing = lineSpacing * (ascent - descent + lineGap);
+	lineSpacing = lineSpacing * (ascent - descent + lineGap) * scale;
 
 	while (it != it_end) {
 		uint32_t codepoint = utf8::next(it, it_end);
@@ -7849,13 +8023,18 @@ void TextDraw::AddString(
 		}
 		else if (codepoint == '\t') {
 			const TextureFontGlyphMetrics* pMetrics = m_createInfo.pFont->GetGlyphMetrics(32);
-			baseline.x += tabSpacing * pMetrics->glyphMetrics.advance;
+			if (!IsNull(pMetrics)) {
+				baseline.x += tabSpacing * pMetrics->glyphMetrics.advance * scale;
+			}
 			continue;
 		}
 
 		const TextureFontGlyphMetrics* pMetrics = m_createInfo.pFont->GetGlyphMetrics(codepoint);
 		if (IsNull(pMetrics)) {
 			pMetrics = m_createInfo.pFont->GetGlyphMetrics(32);
+			if (IsNull(pMetrics)) {
+				continue;
+			}
 		}
 
 		size_t indexBufferOffset = mTextLength * kGlyphIndicesSize;
@@ -7869,11 +8048,12 @@ void TextDraw::AddString(
 		uint32_t* pIndices = reinterpret_cast<uint32_t*>(pIndicesBaseAddr + indexBufferOffset);
 		Vertex* pVertices = reinterpret_cast<Vertex*>(pVerticesBaseAddr + vertexBufferOffset);
 
-		float2 P = baseline + float2(pMetrics->glyphMetrics.box.x0, pMetrics->glyphMetrics.box.y0);
+		float2 P = baseline + float2(pMetrics->glyphMetrics.box.x0, pMetrics->glyphMetrics.box.y0) * scale;
+		float2 size = pMetrics->size * scale;
 		float2 P0 = P;
-		float2 P1 = P + float2(0, pMetrics->size.y);
-		float2 P2 = P + pMetrics->size;
-		float2 P3 = P + float2(pMetrics->size.x, 0);
+		float2 P1 = P + float2(0, size.y);
+		float2 P2 = P + size;
+		float2 P3 = P + float2(size.x, 0);
 		float2 uv0 = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v0);
 		float2 uv1 = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v1);
 		float2 uv2 = float2(pMetrics->uvRect.u1, pMetrics->uvRect.v1);
@@ -7893,7 +8073,7 @@ void TextDraw::AddString(
 		pIndices[5] = vertexCount + 3;
 
 		mTextLength += 1;
-		baseline.x += pMetrics->glyphMetrics.advance;
+		baseline.x += pMetrics->glyphMetrics.advance * scale;
 	}
 
 	mCpuIndexBuffer->UnmapMemory();
@@ -7911,6 +8091,13 @@ void TextDraw::AddString(
 
 Result TextDraw::UploadToGpu(Queue* pQueue)
 {
+	if (m_createInfo.pFont->IsSignedDistanceField()) {
+		Result ppxres = m_createInfo.pFont->UploadDirtyRects(pQueue);
+		if (Failed(ppxres)) {
+			return ppxres;
+		}
+	}
+
 	BufferToBufferCopyInfo copyInfo = {};
 	copyInfo.size = mCpuIndexBuffer->GetSize();
 	copyInfo.srcBuffer.offset = 0;
@@ -7932,6 +8119,13 @@ Result TextDraw::UploadToGpu(Queue* pQueue)
 
 void TextDraw::UploadToGpu(CommandBuffer* pCommandBuffer)
 {
+	if (m_createInfo.pFont->IsSignedDistanceField()) {
+		Result ppxres = m_createInfo.pFont->UploadDirtyRects(pCommandBuffer);
+		if (Failed(ppxres)) {
+			Error("TextDraw: failed uploading new glyphs");
+		}
+	}
+
 	BufferToBufferCopyInfo copyInfo = {};
 	copyInfo.size = mTextLength * kGlyphIndicesSize;
 	copyInfo.srcBuffer.offset = 0;
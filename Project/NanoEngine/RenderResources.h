@@ -2508,6 +2508,13 @@ struct TextureFontCreateInfo
 	Font   font;
 	float       size = 16.0f;
 	std::string characters = ""; // Default characters if empty
+
+	// Rasterize glyphs as they are used into a signed distance field atlas shared by every size the font is drawn at,
+	// instead of baking characters at size. characters are only rasterized up front. Draw with TextDraw.hlsl (psmain_sdf).
+	bool                    signedDistanceField = false;
+	SdfGlyphAtlasCreateInfo sdfAtlas = {};
+	// Staging buffers UploadDirtyRects(CommandBuffer*) cycles through, at least the number of frames in flight
+	uint32_t                sdfStagingBufferCount = 2;
 };
 
 class TextureFont : public DeviceObject<TextureFontCreateInfo>
@@ -2523,19 +2530,44 @@ public:
 	std::string      GetCharacters() const { return m_createInfo.characters; }
 	TexturePtr GetTexture() const { return mTexture; }
 
+	bool             IsSignedDistanceField() const { return m_createInfo.signedDistanceField; }
+	// Size the metrics are given at: the atlas base size for SDF fonts, GetSize() otherwise
+	float            GetMetricsSize() const { return IsSignedDistanceField() ? m_createInfo.sdfAtlas.baseSize : m_createInfo.size; }
+	const SdfGlyphAtlas& GetSdfAtlas() const { return mSdfAtlas; }
+
 	float                                GetAscent() const { return mFontMetrics.ascent; }
 	float                                GetDescent() const { return mFontMetrics.descent; }
 	float                                GetLineGap() const { return mFontMetrics.lineGap; }
+	// Only finds glyphs already in the atlas for SDF fonts
 	const TextureFontGlyphMetrics* GetGlyphMetrics(uint32_t codepoint) const;
+	// Rasterizes missing glyphs of SDF fonts, call UploadDirtyRects before drawing them
+	const TextureFontGlyphMetrics* GetGlyphMetrics(uint32_t codepoint);
+
+	// SDF fonts only. Glyphs drawn since the previous BeginFrame are never evicted to make room for new ones, so call
+	// it once per frame before adding text. Without it the atlas just stops taking glyphs once it is full.
+	void   BeginFrame();
+	// SDF fonts only. Copies the parts of the atlas changed by new glyphs to the texture and waits for the copy.
+	Result UploadDirtyRects(Queue* pQueue);
+	// SDF fonts only. Records the copy of the changed parts of the atlas into the command buffer.
+	Result UploadDirtyRects(CommandBuffer* pCommandBuffer);
 
 protected:
 	Result createApiObjects(const TextureFontCreateInfo& pCreateInfo) final;
 	void   destroyApiObjects() final;
 
 private:
+	Result createSdfApiObjects(const TextureFontCreateInfo& pCreateInfo);
+	// Writes the dirty rectangles to the next staging buffer, pCopyInfos stays empty if there are none
+	Result stageDirtyRects(std::vector<BufferToImageCopyInfo>* pCopyInfos, Buffer** ppStagingBuffer);
+
 	FontMetrics                                mFontMetrics;
 	std::vector<TextureFontGlyphMetrics> mGlyphMetrics;
 	TexturePtr                           mTexture;
+
+	SdfGlyphAtlas                                         mSdfAtlas;
+	std::unordered_map<uint32_t, TextureFontGlyphMetrics> mSdfGlyphMetrics;
+	std::vector<BufferPtr>                                mSdfStagingBuffers;
+	uint32_t                                              mSdfStagingIndex = 0;
 };
 
 struct TextDrawCreateInfo
@@ -2543,7 +2575,7 @@ struct TextDrawCreateInfo
 	TextureFont* pFont = nullptr;
 	uint32_t              maxTextLength = 4096;
 	ShaderStageInfo VS = {}; // Use basic/shaders/TextDraw.hlsl (vsmain) for now
-	ShaderStageInfo PS = {}; // Use basic/shaders/TextDraw.hlsl (psmain) for now
+	ShaderStageInfo PS = {}; // Use basic/shaders/TextDraw.hlsl (psmain, psmain_sdf in TextDrawSDF.ps for SDF fonts) for now
 	BlendMode       blendMode = BLEND_MODE_PREMULT_ALPHA;
 	Format          renderTargetFormat = Format::Undefined;
 	Format          depthStencilFormat = Format::Undefined;
@@ -2557,6 +2589,9 @@ public:
 
 	void Clear();
 
+	// Size the following strings are drawn at, 0 draws them at the font size. Only SDF fonts stay sharp when scaled.
+	void SetFontSize(float size) { mFontSize = size; }
+
 	void AddString(
 		const float2& position,
 		const std::string& string,
@@ -2571,10 +2606,10 @@ public:
 		const float3& color = float3(1, 1, 1),
 		float              opacity = 1.0f);
 
-	// Use this if text is static
+	// Use this if text is static. New glyphs of SDF fonts are uploaded as well.
 	Result UploadToGpu(Queue* pQueue);
 
-	// Use this if text is dynamic
+	// Use this if text is dynamic. New glyphs of SDF fonts are copied in the same command buffer.
 	void UploadToGpu(CommandBuffer* pCommandBuffer);
 
 	void PrepareDraw(const float4x4& MVP, CommandBuffer* pCommandBuffer);
@@ -2586,6 +2621,7 @@ protected:
 
 private:
 	uint32_t                     mTextLength = 0;
+	float                        mFontSize = 0.0f;
 	BufferPtr              mCpuIndexBuffer;
 	BufferPtr              mCpuVertexBuffer;
 	BufferPtr              mGpuIndexBuffer;
@@ -1944,6 +1944,36 @@ namespace scene {
 		return ident;
 	}
 
+	// cgltf file callbacks that map the .gltf/.glb file and its external buffers instead of reading them into heap
+	// copies. cgltf only treats the data as read only. It hands back just the data pointer on release, so the open
+	// mappings are kept by base address until cgltf_free().
+	static std::mutex                                 sGltfMappingMutex;
+	static std::unordered_map<const void*, MappedFile> sGltfMappings;
+
+	static cgltf_result MapGltfFile(const cgltf_memory_options*, const cgltf_file_options*, const char* path, cgltf_size* size, void** data)
+	{
+		MappedFile file;
+		if (!file.Open(path)) return cgltf_result_file_not_found;
+
+		// Buffers pass their declared byte length, the file may be longer but not shorter
+		const cgltf_size requested = IsNull(size) ? 0 : *size;
+		if (file.GetLength() == 0 || requested > file.GetLength()) return cgltf_result_io_error;
+
+		void* pData = const_cast<char*>(file.GetData());
+		if (!IsNull(size)) *size = (requested != 0) ? requested : file.GetLength();
+		if (!IsNull(data)) *data = pData;
+
+		const std::lock_guard<std::mutex> lock(sGltfMappingMutex);
+		sGltfMappings.emplace(pData, std::move(file));
+		return cgltf_result_success;
+	}
+
+	static void UnmapGltfFile(const cgltf_memory_options*, const cgltf_file_options*, void* data)
+	{
+		const std::lock_guard<std::mutex> lock(sGltfMappingMutex);
+		sGltfMappings.erase(data);
+	}
+
 	GltfLoader::GltfLoader(
 		const std::filesystem::path& filePath,
 		const std::filesystem::path& textureDirPath,
@@ -1985,12 +2015,15 @@ namespace scene {
 			return ERROR_UNEXPECTED_NULL_ARGUMENT;
 		}
 
-		if (!(std::filesystem::exists(filePath) && std::filesystem::exists(textureDirPath))) {
+		// Packed directories don't exist on disk, missing images are reported when they are loaded
+		if (!FileExists(filePath)) {
 			return ERROR_PATH_DOES_NOT_EXIST;
 		}
 
 		// Parse gltf data
 		cgltf_options cgltfOptions = {};
+		cgltfOptions.file.read = MapGltfFile;
+		cgltfOptions.file.release = UnmapGltfFile;
 		cgltf_data* pGltfData = nullptr;
 
 		cgltf_result cgres = cgltf_parse_file(
@@ -2251,7 +2284,7 @@ namespace scene {
 		//
 		if (!IsNull(pGltfImage->uri)) {
 			std::filesystem::path filePath = mGltfTextureDir / ToStringSafe(pGltfImage->uri);
-			if (!std::filesystem::exists(filePath)) {
+			if (!FileExists(filePath)) {
 				Error("GLTF file references an image file that doesn't exist (image=" + ToStringSafe(pGltfImage->name) + ", uri=" + ToStringSafe(pGltfImage->uri) + ", file=" + filePath.string());
 				return ERROR_PATH_DOES_NOT_EXIST;
 			}
@@ -2259,7 +2292,8 @@ namespace scene {
 			auto ppxres = vkr::vkrUtil::CreateImageFromFile(
 				loadParams.pDevice->GetGraphicsQueue(),
 				filePath,
-				&pGrfxImage);
+				&pGrfxImage,
+				vkr::vkrUtil::ImageOptions().BlockCompression(loadParams.imageBlockFormat));
 			if (Failed(ppxres)) {
 				return ppxres;
 			}
@@ -4192,6 +4226,7 @@ namespace scene {
 		loadParams.pDevice = pDevice;
 		loadParams.pMaterialFactory = loadOptions.GetMaterialFactory();
 		loadParams.requiredVertexAttributes = loadOptions.GetRequiredAttributes();
+		loadParams.imageBlockFormat = loadOptions.GetImageBlockFormat();
 
 		// Use default material factory if one wasn't supplied
 		if (IsNull(loadParams.pMaterialFactory)) {
@@ -4258,6 +4293,7 @@ namespace scene {
 		loadParams.pDevice = pDevice;
 		loadParams.pMaterialFactory = loadOptions.GetMaterialFactory();
 		loadParams.requiredVertexAttributes = loadOptions.GetRequiredAttributes();
+		loadParams.imageBlockFormat = loadOptions.GetImageBlockFormat();
 
 		// Use default material factory if one wasn't supplied
 		if (IsNull(loadParams.pMaterialFactory)) {
@@ -4369,6 +4405,7 @@ namespace scene {
 		loadParams.pDevice = pDevice;
 		loadParams.pMaterialFactory = loadOptions.GetMaterialFactory();
 		loadParams.requiredVertexAttributes = loadOptions.GetRequiredAttributes();
+		loadParams.imageBlockFormat = loadOptions.GetImageBlockFormat();
 
 		// Use default material factory if one wasn't supplied
 		if (IsNull(loadParams.pMaterialFactory)) {
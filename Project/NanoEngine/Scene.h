@@ -1067,6 +1067,17 @@ namespace scene
 		// Clears required attributes (sets required attributs to none)
 		void ClearRequiredAttributes() { SetRequiredAttributes(scene::VertexAttributeFlags::None()); }
 
+		// Returns the format image files are cooked to, or BlockFormat::Undefined if they're loaded uncompressed.
+		BlockFormat GetImageBlockFormat() const { return mImageBlockFormat; }
+
+		// Cooks image files to a block compressed format through the TextureCache.
+		// A cache miss cooks synchronously, which can take seconds per large image.
+		LoadOptions& SetImageBlockFormat(BlockFormat format)
+		{
+			mImageBlockFormat = format;
+			return *this;
+		}
+
 	private:
 		// Pointer to custom material factory for loader to use.
 		scene::MaterialFactory* mMaterialFactory = nullptr;
@@ -1077,6 +1088,9 @@ namespace scene
 		// default value is used - usually zeroes.
 		//
 		scene::VertexAttributeFlags mRequiredVertexAttributes = scene::VertexAttributeFlags::None();
+
+		// Block format for image files, loaded uncompressed by default.
+		BlockFormat mImageBlockFormat = BlockFormat::Undefined;
 	};
 
 } // namespace scene
@@ -1311,6 +1325,7 @@ namespace scene {
 			vkr::RenderDevice* pDevice = nullptr;
 			scene::MaterialFactory* pMaterialFactory = nullptr;
 			scene::VertexAttributeFlags       requiredVertexAttributes = scene::VertexAttributeFlags::None();
+			BlockFormat                       imageBlockFormat = BlockFormat::Undefined;
 			scene::ResourceManager* pResourceManager = nullptr;
 			MeshMaterialVertexAttributeMasks* pMeshMaterialVertexAttributeMasks = nullptr;
 			bool                              transformOnly = false;
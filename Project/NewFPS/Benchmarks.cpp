@@ -0,0 +1,1538 @@
+﻿#include "stdafx.h"
+#include "Benchmarks.h"
+#include "LoaderMapData.h"
+#include "MapGeometry.h"
+
+#if defined(_WIN32)
+#	include <Windows.h>
+#	include <Psapi.h>
+#elif defined(__linux__)
+#	include <fcntl.h>
+#	include <malloc.h>
+#	include <unistd.h>
+#endif
+
+namespace
+{
+	using BenchmarkFunc = bool (*)(BenchmarkApplication& app, std::span<const std::string> args);
+
+	struct Benchmark final
+	{
+		std::string_view name;
+		std::string_view usage;
+		BenchmarkFunc    func;
+	};
+
+	uint32_t ArgU32(std::span<const std::string> args, size_t index, uint32_t defaultValue)
+	{
+		return (index < args.size()) ? static_cast<uint32_t>(std::max(std::atoi(args[index].c_str()), 1)) : defaultValue;
+	}
+
+	bool Check(bool condition, const std::string& what)
+	{
+		if (!condition) Error("Check failed: " + what);
+		return condition;
+	}
+
+	// Median of the samples in microseconds, the samples are sorted.
+	int64_t Median(std::vector<int64_t>& samples)
+	{
+		std::sort(samples.begin(), samples.end());
+		return samples.empty() ? 0 : samples[samples.size() / 2];
+	}
+
+	// Builds and tears down a level's worth of physics objects over and over. Every ReleaseAll() has to leave all pools
+	// empty, handles dropped after it must be harmless, and the teardown time is reported.
+	bool PhysicsPools(BenchmarkApplication& app, std::span<const std::string> args)
+	{
+		const uint32_t iterations = ArgU32(args, 0, 50);
+		const uint32_t bodyCount = ArgU32(args, 1, 2000);
+
+		ph::PhysicsScene&    scene = app.GetPhysicsScene();
+		std::vector<int64_t> teardownTimes;
+		bool                 ok = true;
+		for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+		{
+			std::vector<ph::StaticActorPtr>         staticBodies;
+			std::vector<ph::RigidBodyPtr>           rigidBodies;
+			std::vector<ph::CharacterControllerPtr> controllers;
+			for (uint32_t i = 0; i < bodyCount; ++i)
+			{
+				const glm::vec3 cell{ static_cast<float>(i % 64) * 3.0f, 0.0f, static_cast<float>(i / 64) * 3.0f };
+
+				ph::StaticActorCreateInfo staticInfo{};
+				staticInfo.worldPosition = cell;
+				staticBodies.push_back(scene.CreateStaticBody(staticInfo));
+				staticBodies.back()->AttachCollider(ph::BoxColliderCreateInfo{});
+
+				rigidBodies.push_back(scene.CreateRigidBody(ph::RigidBodyCreateInfo{}));
+				rigidBodies.back()->AttachCollider(ph::SphereColliderCreateInfo{ .radius = 0.5f });
+				rigidBodies.back()->SetPosition(cell + glm::vec3(0.0f, 3.0f, 0.0f));
+
+				if (i % 16 == 0)
+				{
+					ph::CharacterControllerCreateInfo controllerInfo{};
+					controllerInfo.position = cell + glm::vec3(1.5f, 2.0f, 1.5f);
+					controllers.push_back(scene.CreateCharacterController(controllerInfo));
+				}
+			}
+			for (int step = 0; step < 10; ++step)
+				app.GetPhysicsSystem().FixedUpdate();
+
+			const ph::PhysicsPoolStats live = scene.GetPoolStats();
+			ok &= Check(live.staticBodies == staticBodies.size() && live.rigidBodies == rigidBodies.size()
+				&& live.characterControllers == controllers.size() && live.colliders == staticBodies.size() + rigidBodies.size()
+				&& live.userData == staticBodies.size() + rigidBodies.size() + controllers.size(), "live pool counts after load");
+
+			Clock clock;
+			scene.ReleaseAll();
+			teardownTimes.push_back(clock.GetElapsedTime().AsMicroseconds());
+			ok &= Check(scene.GetPoolStats().Total() == 0, "pools empty after ReleaseAll, iteration " + std::to_string(iteration));
+			// the handles are dropped here, after the release
+		}
+		ok &= Check(scene.GetPoolStats().Total() == 0, "pools empty after dropping the handles");
+
+		const int64_t median = Median(teardownTimes);
+		const uint32_t objectCount = bodyCount * 2 * 2 + (bodyCount + 15) / 16; // bodies and colliders, controllers
+		Print("physics-pools: " + std::to_string(iterations) + " load/unload cycles of " + std::to_string(objectCount)
+			+ " objects, teardown us: min " + std::to_string(teardownTimes.front()) + ", median " + std::to_string(median)
+			+ ", max " + std::to_string(teardownTimes.back()));
+		return ok;
+	}
+
+	bool SameMap(const LoaderMapData& a, const LoaderMapData& b)
+	{
+		if (a.GetTexturePaths() != b.GetTexturePaths() || a.GetModelPaths() != b.GetModelPaths()) return false;
+		if (a.GetCameraPosition() != b.GetCameraPosition() || a.GetCameraAngles() != b.GetCameraAngles()) return false;
+
+		const fileMapData::TileGrid& tilesA = a.GetTileGrid();
+		const fileMapData::TileGrid& tilesB = b.GetTileGrid();
+		if (tilesA.GetWidth() != tilesB.GetWidth() || tilesA.GetHeight() != tilesB.GetHeight() || tilesA.GetLength() != tilesB.GetLength()) return false;
+		const size_t tileCount = tilesA.GetWidth() * tilesA.GetHeight() * tilesA.GetLength();
+		for (size_t i = 0; i < tileCount; i++)
+			if (tilesA.GetTile(static_cast<int>(i)) != tilesB.GetTile(static_cast<int>(i))) return false;
+
+		const std::vector<fileMapData::Ent> entsA = a.GetEntityGrid().GetEntList();
+		const std::vector<fileMapData::Ent> entsB = b.GetEntityGrid().GetEntList();
+		if (entsA.size() != entsB.size()) return false;
+		for (size_t i = 0; i < entsA.size(); i++)
+		{
+			const fileMapData::Ent& entA = entsA[i];
+			const fileMapData::Ent& entB = entsB[i];
+			if (entA.display != entB.display || entA.color.DWColor() != entB.color.DWColor() || entA.radius != entB.radius
+				|| entA.position != entB.position || entA.yaw != entB.yaw || entA.pitch != entB.pitch
+				|| entA.model != entB.model || entA.texture != entB.texture || entA.properties != entB.properties)
+				return false;
+		}
+		return true;
+	}
+
+	// The shipped .te3 maps, sorted.
+	std::vector<std::filesystem::path> FindMaps()
+	{
+		std::vector<std::filesystem::path> maps;
+		std::error_code ec;
+		for (const char* directory : { "GameData/Maps", "assets/maps" })
+			for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+				if (entry.path().extension() == ".te3") maps.push_back(entry.path());
+		std::sort(maps.begin(), maps.end());
+		return maps;
+	}
+
+	// Parses every shipped map from its .te3 source and loads the same map from a freshly compiled .te3c, checks both
+	// give the same map and reports the median load time of each.
+	bool MapLoad(BenchmarkApplication&, std::span<const std::string> args)
+	{
+		const uint32_t iterations = ArgU32(args, 0, 20);
+
+		const std::vector<std::filesystem::path> maps = FindMaps();
+		if (!Check(!maps.empty(), "no .te3 maps found in GameData/Maps or assets/maps")) return false;
+
+		bool ok = true;
+		std::error_code ec;
+		for (const std::filesystem::path& map : maps)
+		{
+			const std::filesystem::path compiledPath = std::filesystem::temp_directory_path(ec) / map.filename().replace_extension(COMPILED_MAP_EXTENSION);
+			if (!Check(LoaderMapData::CompileMap(map, compiledPath), "compile '" + map.string() + "'"))
+			{
+				ok = false;
+				continue;
+			}
+
+			std::vector<int64_t> sourceTimes, compiledTimes;
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				LoaderMapData source, compiled;
+				Clock clock;
+				ok &= Check(source.Load(map), "parse '" + map.string() + "'");
+				sourceTimes.push_back(clock.Restart().AsMicroseconds());
+				ok &= Check(compiled.Load(compiledPath), "load '" + compiledPath.string() + "'");
+				compiledTimes.push_back(clock.GetElapsedTime().AsMicroseconds());
+				if (i == 0) ok &= Check(SameMap(source, compiled), "compiled '" + map.string() + "' matches its source");
+			}
+			std::filesystem::remove(compiledPath, ec);
+
+			const int64_t sourceTime = Median(sourceTimes);
+			const int64_t compiledTime = Median(compiledTimes);
+			Print("map-load: '" + map.filename().string() + "' source " + std::to_string(sourceTime) + " us, compiled "
+				+ std::to_string(compiledTime) + " us (x" + std::to_string(static_cast<double>(sourceTime) / static_cast<double>(std::max<int64_t>(compiledTime, 1))) + ")");
+		}
+		return ok;
+	}
+
+	// Builds the geometry of a small map with three texture slots, two of them pointing at the same file, and checks
+	// every vertex against the source shape: position moved to its tile, shape UV, and the array layer of the tile's
+	// texture slot. The expected layers are written out here, not taken from MapGeometry.
+	bool MapGeometryLayers(BenchmarkApplication&, std::span<const std::string>)
+	{
+		const std::vector<std::string> textures = { "assets/textures/tiles/grass.png", "assets/textures/tiles/brickwall.png", "assets/textures/tiles/grass.png" };
+		const std::vector<std::string> shapes = { "assets/models/shapes/cube.obj", "assets/models/shapes/wedge.obj" };
+		const uint32_t expectedLayers[] = { 0, 1, 0 };
+		constexpr int Width = 5, Height = 3, Length = 5;
+
+		// tiles on every other cell, so no face is hidden and the tiles can be told apart
+		fileMapData::TileGrid expectedGrid(Width, Height, Length);
+		std::vector<fileMapData::Tile> tiles(Width * Height * Length, fileMapData::Tile{ fileMapData::NO_MODEL, 0, fileMapData::NO_TEX, 0 });
+		for (int x = 0; x < Width; x += 2)
+			for (int y = 0; y < Height; y += 2)
+				for (int z = 0; z < Length; z += 2)
+					tiles[expectedGrid.FlatIndex(x, y, z)] = fileMapData::Tile{ (x + z) / 2 % 2, 0, (x + y + z) / 2 % 3, 0 };
+
+		nlohmann::json map;
+		map["tiles"] = {
+			{ "textures", textures }, { "shapes", shapes },
+			{ "width", Width }, { "height", Height }, { "length", Length },
+			{ "data", base64::encode(reinterpret_cast<const uint8_t*>(tiles.data()), tiles.size() * sizeof(fileMapData::Tile)) },
+		};
+		map["ents"] = nlohmann::json::array();
+
+		std::error_code ec;
+		const std::filesystem::path mapPath = std::filesystem::temp_directory_path(ec) / "MapGeometryLayers.te3";
+		std::ofstream(mapPath) << map.dump();
+		LoaderMapData mapData;
+		const bool loaded = mapData.Load(mapPath);
+		std::filesystem::remove(mapPath, ec);
+		if (!Check(loaded, "load the generated map")) return false;
+
+		MapGeometry geometry;
+		MapGeometryCreateInfo createInfo{};
+		createInfo.chunkSize = 64;
+		createInfo.removeHiddenFaces = false;
+		if (!Check(geometry.Build(mapData, createInfo), "build the map geometry")) return false;
+
+		bool ok = Check(geometry.GetLayerTextures().size() == 2, "two texture layers for three slots")
+			& Check(geometry.GetChunks().size() == 1, "a single chunk");
+		if (!ok) return false;
+
+		std::vector<vkr::TriMesh> sourceShapes(shapes.size());
+		const vkr::TriMeshOptions options = vkr::TriMeshOptions().Indices().VertexColors().Normals().TexCoords().ObjectColor(float3(1.0f, 1.0f, 1.0f));
+		for (size_t i = 0; i < shapes.size(); i++)
+			if (!Check(Success(vkr::TriMesh::CreateFromOBJ(shapes[i], options, &sourceShapes[i])), "load " + shapes[i])) return false;
+
+		// the chunk holds the tiles in build order (x, y, z), each with all triangles of its shape
+		const vkr::TriMesh& mesh = geometry.GetChunks()[0].mesh;
+		const float spacing = expectedGrid.GetSpacing();
+		uint32_t triangle = 0;
+		uint32_t mismatches = 0;
+		for (int x = 0; x < Width; x++)
+			for (int y = 0; y < Height; y++)
+				for (int z = 0; z < Length; z++)
+				{
+					const fileMapData::Tile tile = tiles[expectedGrid.FlatIndex(x, y, z)];
+					if (!tile) continue;
+
+					const vkr::TriMesh& shape = sourceShapes[tile.shape];
+					const float3 translate = float3{ x, y, z } * spacing;
+					for (uint32_t i = 0; i < shape.GetCountTriangles() && triangle < mesh.GetCountTriangles(); i++, triangle++)
+					{
+						uint32_t source[3], built[3];
+						shape.GetTriangle(i, source[0], source[1], source[2]);
+						mesh.GetTriangle(triangle, built[0], built[1], built[2]);
+						for (int v = 0; v < 3; v++)
+						{
+							const float3 texCoord = *mesh.GetDataTexCoords3(built[v]);
+							if (*mesh.GetDataPositions(built[v]) != *shape.GetDataPositions(source[v]) + translate
+								|| float2(texCoord) != *shape.GetDataTexCoords2(source[v])
+								|| texCoord.z != static_cast<float>(expectedLayers[tile.texture]))
+								mismatches++;
+						}
+					}
+				}
+		ok &= Check(triangle == mesh.GetCountTriangles(), "triangle count matches the source shapes");
+		ok &= Check(mismatches == 0, std::to_string(mismatches) + " vertices with a wrong position, uv or layer");
+		Print("map-geometry: " + std::to_string(triangle) + " triangles checked");
+		return ok;
+	}
+
+	// Position, normal, texcoord and color of the three vertices of a built triangle.
+	using BuiltTriangle = std::array<float, 36>;
+
+	std::vector<BuiltTriangle> GetBuiltTriangles(const MapGeometry& geometry)
+	{
+		std::vector<BuiltTriangle> triangles;
+		for (const MapChunk& chunk : geometry.GetChunks())
+		{
+			for (uint32_t i = 0; i < chunk.mesh.GetCountTriangles(); i++)
+			{
+				uint32_t vertices[3];
+				chunk.mesh.GetTriangle(i, vertices[0], vertices[1], vertices[2]);
+				BuiltTriangle& triangle = triangles.emplace_back();
+				for (int v = 0; v < 3; v++)
+				{
+					const float3 attributes[4] = { *chunk.mesh.GetDataPositions(vertices[v]), *chunk.mesh.GetDataNormalls(vertices[v]),
+						*chunk.mesh.GetDataTexCoords3(vertices[v]), *chunk.mesh.GetDataColors(vertices[v]) };
+					for (int a = 0; a < 4; a++)
+						for (int c = 0; c < 3; c++)
+							triangle[v * 12 + a * 3 + c] = attributes[a][c];
+				}
+			}
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// A cell side of the tile grid and the direction a face on it looks at: axis, side plane, cell in the other two
+	// axes and the sign of the normal. Cells are centered on multiples of the spacing, so sides lie at half spacings.
+	using CellSide = std::array<int, 5>;
+
+	// False when the triangle doesn't lie on a cell side facing along an axis.
+	bool GetCellSide(const BuiltTriangle& triangle, float spacing, CellSide& side)
+	{
+		const float3 p[3] = { { triangle[0], triangle[1], triangle[2] }, { triangle[12], triangle[13], triangle[14] }, { triangle[24], triangle[25], triangle[26] } };
+		const float3 normal(triangle[3], triangle[4], triangle[5]);
+		const int axis = (glm::abs(normal.x) > 0.99f) ? 0 : ((glm::abs(normal.y) > 0.99f) ? 1 : ((glm::abs(normal.z) > 0.99f) ? 2 : -1));
+		if (axis < 0) return false;
+
+		const float plane = p[0][axis] / spacing - 0.5f;
+		const float epsilon = 1e-3f;
+		if (glm::abs(plane - glm::round(plane)) > epsilon || glm::abs(p[1][axis] - p[0][axis]) > epsilon * spacing || glm::abs(p[2][axis] - p[0][axis]) > epsilon * spacing)
+			return false;
+
+		const float3 cell = glm::floor((p[0] + p[1] + p[2]) / (3.0f * spacing) + 0.5f);
+		side = { axis, static_cast<int>(glm::round(plane)), static_cast<int>(cell[(axis + 1) % 3]), static_cast<int>(cell[(axis + 2) % 3]), normal[axis] > 0.0f ? 1 : -1 };
+		return true;
+	}
+
+	// True when the point on the plane of the triangle lies inside it, edges included.
+	bool TriangleCoversPoint(const BuiltTriangle& triangle, int axis, const float2& point)
+	{
+		const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+		const float2 a(triangle[u], triangle[v]), b(triangle[12 + u], triangle[12 + v]), c(triangle[24 + u], triangle[24 + v]);
+		const auto edge = [](const float2& from, const float2& to, const float2& p) { return (to.x - from.x) * (p.y - from.y) - (to.y - from.y) * (p.x - from.x); };
+		const float e0 = edge(a, b, point), e1 = edge(b, c, point), e2 = edge(c, a, point);
+		constexpr float Epsilon = 1e-5f;
+		return (e0 >= -Epsilon && e1 >= -Epsilon && e2 >= -Epsilon) || (e0 <= Epsilon && e1 <= Epsilon && e2 <= Epsilon);
+	}
+
+	// Builds the geometry of every shipped map with and without hidden face removal and logs its chunks with their
+	// triangle counts. The triangles left with removal have to be exactly triangles of the full build, and every removed
+	// one has to lie on a cell side whose whole area is covered by faces of the neighbour looking the other way, checked
+	// on a grid of points over the side.
+	bool ShippedMapGeometry()
+	{
+		const std::vector<std::filesystem::path> maps = FindMaps();
+		if (!Check(!maps.empty(), "no .te3 maps found in GameData/Maps or assets/maps")) return false;
+
+		bool ok = true;
+		for (const std::filesystem::path& map : maps)
+		{
+			const std::string name = map.filename().string();
+			LoaderMapData mapData;
+			MapGeometry culled, full;
+			MapGeometryCreateInfo fullInfo{};
+			fullInfo.removeHiddenFaces = false;
+			if (!Check(mapData.Load(map) && culled.Build(mapData, MapGeometryCreateInfo{}) && full.Build(mapData, fullInfo), "build '" + map.string() + "'"))
+			{
+				ok = false;
+				continue;
+			}
+			Print("map-geometry: '" + name + "'");
+			culled.PrintStats();
+
+			const std::vector<BuiltTriangle> culledTriangles = GetBuiltTriangles(culled);
+			const std::vector<BuiltTriangle> fullTriangles = GetBuiltTriangles(full);
+			std::vector<BuiltTriangle> removed;
+			std::set_difference(fullTriangles.begin(), fullTriangles.end(), culledTriangles.begin(), culledTriangles.end(), std::back_inserter(removed));
+			ok &= Check(std::includes(fullTriangles.begin(), fullTriangles.end(), culledTriangles.begin(), culledTriangles.end()),
+				"'" + name + "': the exposed faces are the same with and without hidden face removal");
+			ok &= Check(full.GetHiddenTriangleCount() == 0 && removed.size() == culled.GetHiddenTriangleCount()
+				&& fullTriangles.size() == culledTriangles.size() + removed.size(), "'" + name + "': removed triangle count");
+
+			const float spacing = mapData.GetTileGrid().GetSpacing();
+			std::map<CellSide, std::vector<size_t>> sideFaces;
+			for (size_t i = 0; i < fullTriangles.size(); i++)
+			{
+				CellSide side;
+				if (GetCellSide(fullTriangles[i], spacing, side)) sideFaces[side].push_back(i);
+			}
+
+			constexpr int SamplesPerRow = 7;
+			uint32_t offSide = 0, uncovered = 0;
+			std::set<CellSide> checkedSides;
+			for (const BuiltTriangle& triangle : removed)
+			{
+				CellSide side;
+				if (!GetCellSide(triangle, spacing, side))
+				{
+					offSide++;
+					continue;
+				}
+				if (!checkedSides.insert(side).second) continue;
+
+				CellSide opposite = side;
+				opposite[4] = -side[4];
+				const auto faces = sideFaces.find(opposite);
+				bool covered = faces != sideFaces.end();
+				for (int i = 0; i < SamplesPerRow * SamplesPerRow && covered; i++)
+				{
+					const float2 point = (float2(side[2], side[3]) + (float2(i % SamplesPerRow, i / SamplesPerRow) + 0.5f) / float(SamplesPerRow) - 0.5f) * spacing;
+					covered = std::any_of(faces->second.begin(), faces->second.end(), [&](size_t face) { return TriangleCoversPoint(fullTriangles[face], side[0], point); });
+				}
+				uncovered += !covered;
+			}
+			ok &= Check(offSide == 0, "'" + name + "': " + std::to_string(offSide) + " removed triangles don't lie on a cell side");
+			ok &= Check(uncovered == 0, "'" + name + "': " + std::to_string(uncovered) + " cell sides lost faces without being fully covered by the neighbour");
+			Print("map-geometry: '" + name + "' " + std::to_string(fullTriangles.size()) + " triangles without hidden face removal, "
+				+ std::to_string(culledTriangles.size()) + " with, " + std::to_string(removed.size()) + " removed from " + std::to_string(checkedSides.size()) + " covered cell sides");
+		}
+		return ok;
+	}
+
+	bool MapGeometryBuilds(BenchmarkApplication& app, std::span<const std::string> args)
+	{
+		const bool layersOk = MapGeometryLayers(app, args);
+		return ShippedMapGeometry() && layersOk;
+	}
+
+	// Rectangles of random sizes come and go in a ShelfPacker. Every live rectangle has to lie inside the area and
+	// overlap no other one, checked on a separate occupancy grid, and the used area has to be their summed area.
+	bool ShelfPacking(BenchmarkApplication&, std::span<const std::string> args)
+	{
+		const uint32_t operations = ArgU32(args, 0, 20000);
+		const uint32_t size = ArgU32(args, 1, 512);
+
+		ShelfPacker packer(size, size);
+		std::vector<AtlasRect> live;
+		std::mt19937 random(1234);
+		std::uniform_int_distribution<uint32_t> side(4, 40);
+		uint32_t allocations = 0, failures = 0, resized = 0;
+		double efficiency = 0.0;
+		Clock clock;
+		for (uint32_t i = 0; i < operations; i++)
+		{
+			// mostly allocations until the area fills up, then about as many frees as allocations
+			if (!live.empty() && (random() % 100 < (failures > 0 ? 50u : 20u)))
+			{
+				const size_t index = random() % live.size();
+				packer.Free(live[index]);
+				live[index] = live.back();
+				live.pop_back();
+				continue;
+			}
+			AtlasRect rect;
+			const uint32_t width = side(random), height = side(random);
+			if (!packer.Allocate(width, height, &rect))
+			{
+				failures++;
+				continue;
+			}
+			allocations++;
+			if (rect.width != width || rect.height != height) resized++;
+			live.push_back(rect);
+			efficiency += static_cast<double>(packer.GetUsedArea()) / static_cast<double>(std::max<uint64_t>(packer.GetShelfArea(), 1));
+		}
+		const int64_t time = clock.GetElapsedTime().AsMicroseconds();
+
+		std::vector<uint8_t> occupied(static_cast<size_t>(size) * size, 0);
+		uint64_t area = 0;
+		uint32_t badRects = 0;
+		for (const AtlasRect& rect : live)
+		{
+			area += static_cast<uint64_t>(rect.width) * rect.height;
+			if (rect.x + rect.width > size || rect.y + rect.height > size)
+			{
+				badRects++;
+				continue;
+			}
+			for (uint32_t y = rect.y; y < rect.y + rect.height; y++)
+				for (uint32_t x = rect.x; x < rect.x + rect.width; x++)
+					if (occupied[static_cast<size_t>(y) * size + x]++) badRects++;
+		}
+		bool ok = Check(badRects == 0, std::to_string(badRects) + " rectangle pixels out of bounds or overlapping");
+		ok &= Check(resized == 0, std::to_string(resized) + " rectangles not of the requested size");
+		ok &= Check(packer.GetUsedArea() == area, "used area " + std::to_string(packer.GetUsedArea()) + " is the live area " + std::to_string(area));
+		ok &= Check(failures > 0, "the area filled up at least once");
+
+		for (const AtlasRect& rect : live) packer.Free(rect);
+		ok &= Check(packer.GetUsedArea() == 0 && packer.GetShelfArea() == 0, "empty after freeing everything");
+
+		Print("shelf-packing: " + std::to_string(allocations) + " allocations, " + std::to_string(failures) + " full, "
+			+ std::to_string(operations * 1000000.0 / static_cast<double>(std::max<int64_t>(time, 1))) + " operations/s, shelves "
+			+ std::to_string(static_cast<int>(100.0 * efficiency / std::max(allocations, 1u))) + "% used on average");
+		return ok;
+	}
+
+	// Codepoints of the Latin, Greek and Cyrillic blocks, more glyphs than the default atlas holds.
+	std::vector<uint32_t> SdfCodepoints()
+	{
+		std::vector<uint32_t> codepoints;
+		for (const auto [first, last] : { std::pair{ 0x20u, 0x7Eu }, std::pair{ 0xA0u, 0x24Fu }, std::pair{ 0x391u, 0x3C9u }, std::pair{ 0x400u, 0x52Fu }, std::pair{ 0x1E00u, 0x1EFFu } })
+			for (uint32_t codepoint = first; codepoint <= last; codepoint++)
+				codepoints.push_back(codepoint);
+		return codepoints;
+	}
+
+	// Checks every glyph in the atlas against a fresh rasterization of the font and against the other glyphs: pixels
+	// and box identical, rectangle plus its gutter inside the atlas and overlapping no other glyph, used area exact.
+	bool CheckSdfAtlas(const SdfGlyphAtlas& atlas, const Font& font, std::span<const uint32_t> codepoints)
+	{
+		const uint32_t size = atlas.GetBitmap().GetWidth();
+		std::vector<uint8_t> occupied(static_cast<size_t>(size) * size, 0);
+		uint64_t area = 0;
+		uint32_t badPixels = 0, wrongGlyphs = 0;
+		for (uint32_t codepoint : codepoints)
+		{
+			const SdfGlyph* pGlyph = atlas.FindGlyph(codepoint);
+			if (!pGlyph || pGlyph->rect.width == 0) continue;
+
+			Bitmap sdf;
+			GlyphBox box;
+			if (Failed(font.RenderGlyphSDF(atlas.GetBaseSize(), codepoint, atlas.GetPadding(), &sdf, &box)) || !sdf.IsOk()
+				|| sdf.GetWidth() != pGlyph->rect.width || sdf.GetHeight() != pGlyph->rect.height
+				|| box.x0 != pGlyph->box.x0 || box.y0 != pGlyph->box.y0 || box.x1 != pGlyph->box.x1 || box.y1 != pGlyph->box.y1)
+			{
+				wrongGlyphs++;
+				continue;
+			}
+			for (uint32_t y = 0; y < sdf.GetHeight(); y++)
+				if (memcmp(sdf.GetPixelAddress(0, y), atlas.GetBitmap().GetPixelAddress(pGlyph->rect.x, pGlyph->rect.y + y), sdf.GetWidth()) != 0)
+					wrongGlyphs++;
+
+			// one pixel gutter to the right and below
+			const uint32_t width = pGlyph->rect.width + 1, height = pGlyph->rect.height + 1;
+			area += static_cast<uint64_t>(width) * height;
+			if (pGlyph->rect.x + width > size || pGlyph->rect.y + height > size)
+			{
+				badPixels++;
+				continue;
+			}
+			for (uint32_t y = pGlyph->rect.y; y < pGlyph->rect.y + height; y++)
+				for (uint32_t x = pGlyph->rect.x; x < pGlyph->rect.x + width; x++)
+					if (occupied[static_cast<size_t>(y) * size + x]++) badPixels++;
+		}
+		return Check(wrongGlyphs == 0, std::to_string(wrongGlyphs) + " glyphs differ from their rasterization")
+			& Check(badPixels == 0, std::to_string(badPixels) + " glyph pixels out of bounds or overlapping")
+			& Check(atlas.GetPacker().GetUsedArea() == area, "used area " + std::to_string(atlas.GetPacker().GetUsedArea()) + " is the glyph area " + std::to_string(area));
+	}
+
+	// Fills an SDF glyph atlas with Roboto until it is full and reports the packing and rasterization rate. Then draws
+	// frames of glyphs from a drifting working set, so old glyphs get evicted, and reports the upload per frame.
+	bool SdfAtlas(BenchmarkApplication&, std::span<const std::string> args)
+	{
+		SdfGlyphAtlasCreateInfo createInfo{};
+		createInfo.atlasSize = ArgU32(args, 0, 1024);
+		createInfo.baseSize = static_cast<float>(ArgU32(args, 1, 48));
+		createInfo.padding = ArgU32(args, 2, 6);
+		const uint32_t frames = ArgU32(args, 3, 2000);
+		constexpr uint32_t GlyphsPerFrame = 120, WorkingSet = 300;
+
+		Font font;
+		if (!Check(Success(Font::CreateFromFile("basic/fonts/Roboto/Roboto-Regular.ttf", &font)), "load Roboto")) return false;
+		const std::vector<uint32_t> codepoints = SdfCodepoints();
+
+		// packing: one frame, nothing can be evicted
+		bool ok = true;
+		{
+			SdfGlyphAtlas atlas(font, createInfo);
+			if (!Check(atlas.IsOk(), "create the atlas")) return false;
+			atlas.BeginFrame();
+			uint32_t fitted = 0;
+			Clock clock;
+			for (uint32_t codepoint : codepoints)
+			{
+				if (!atlas.GetGlyph(codepoint)) break;
+				fitted++;
+			}
+			const int64_t time = clock.GetElapsedTime().AsMicroseconds();
+			ok &= CheckSdfAtlas(atlas, font, codepoints);
+
+			const ShelfPacker& packer = atlas.GetPacker();
+			Print("sdf-atlas: " + std::to_string(fitted) + " of " + std::to_string(codepoints.size()) + " glyphs fit at "
+				+ std::to_string(fitted * 1000000.0 / static_cast<double>(std::max<int64_t>(time, 1))) + " glyphs/s, shelves "
+				+ std::to_string(100 * packer.GetUsedArea() / std::max<uint64_t>(packer.GetShelfArea(), 1)) + "% used, atlas "
+				+ std::to_string(100 * packer.GetUsedArea() / (static_cast<uint64_t>(packer.GetWidth()) * packer.GetHeight())) + "% full");
+		}
+
+		// throughput: the working set slides through the codepoints, one step every four frames
+		{
+			SdfGlyphAtlas atlas(font, createInfo);
+			std::mt19937 random(1234);
+			uint64_t uploadedBytes = 0, dirtyRects = 0, fill = 0;
+			Clock clock;
+			for (uint32_t frame = 0; frame < frames; frame++)
+			{
+				atlas.BeginFrame();
+				const size_t start = (frame / 4) % codepoints.size();
+				for (uint32_t i = 0; i < GlyphsPerFrame; i++)
+					atlas.GetGlyph(codepoints[(start + random() % WorkingSet) % codepoints.size()]);
+				for (const AtlasRect& rect : atlas.TakeDirtyRects())
+				{
+					uploadedBytes += static_cast<uint64_t>(rect.width) * rect.height;
+					dirtyRects++;
+				}
+				fill += atlas.GetPacker().GetUsedArea();
+			}
+			const int64_t time = clock.GetElapsedTime().AsMicroseconds();
+			ok &= CheckSdfAtlas(atlas, font, codepoints);
+
+			const SdfGlyphAtlasStats& stats = atlas.GetStats();
+			ok &= Check(stats.failedGlyphs == 0, std::to_string(stats.failedGlyphs) + " glyphs didn't fit");
+			ok &= Check(stats.uploadedBytes == uploadedBytes, "upload statistics match the dirty rectangles");
+			const uint64_t atlasBytes = static_cast<uint64_t>(createInfo.atlasSize) * createInfo.atlasSize;
+			Print("sdf-atlas: " + std::to_string(frames) + " frames of " + std::to_string(GlyphsPerFrame) + " glyphs in "
+				+ std::to_string(time / 1000) + " ms, " + std::to_string(stats.rasterizedGlyphs) + " rasterized, "
+				+ std::to_string(stats.evictedGlyphs) + " evicted, atlas " + std::to_string(100 * fill / frames / atlasBytes)
+				+ "% full on average, upload per frame " + std::to_string(uploadedBytes / frames) + " bytes in "
+				+ std::to_string(static_cast<double>(dirtyRects) / frames) + " rectangles (atlas " + std::to_string(atlasBytes) + " bytes)");
+		}
+		return ok;
+	}
+
+	// Random channel values for the pixel conversion kernels. Floats are half arbitrary bit patterns, so NaN, infinity,
+	// denormals and huge values show up, half uniform in [-0.25, 1.25], plus the special values at the start.
+	struct PixelInputs final
+	{
+		std::vector<uint8_t>  u8;
+		std::vector<uint16_t> u16;
+		std::vector<float>    f32;
+	};
+
+	PixelInputs MakePixelInputs(size_t count)
+	{
+		PixelInputs inputs;
+		inputs.u8.resize(count);
+		inputs.u16.resize(count);
+		inputs.f32.resize(count);
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> unit(-0.25f, 1.25f);
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint32_t bits = random();
+			inputs.u8[i] = static_cast<uint8_t>(bits);
+			inputs.u16[i] = static_cast<uint16_t>(bits >> 8);
+			if (i % 2) inputs.f32[i] = unit(random);
+			else memcpy(&inputs.f32[i], &bits, sizeof(bits));
+		}
+		const float specials[] = { 0.0f, -0.0f, 1.0f, 0.5f, 1.0f / 255.0f, 65504.0f, 65520.0f, 6.1e-5f, 5.96e-8f, 1e-45f, -1.0f,
+			std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::signaling_NaN() };
+		std::copy(std::begin(specials), std::end(specials), inputs.f32.begin());
+		return inputs;
+	}
+
+	// Runs the conversion with and without SSE2. Returns false if the outputs differ in any bit.
+	template <typename Output>
+	bool SameWithAndWithoutSimd(const std::string& name, size_t count, const std::function<void(std::vector<Output>&)>& convert)
+	{
+		std::vector<Output> simd(count), scalar(count);
+		PixelConvert::SetSimdEnabled(true);
+		convert(simd);
+		PixelConvert::SetSimdEnabled(false);
+		convert(scalar);
+		PixelConvert::SetSimdEnabled(true);
+		return Check(memcmp(simd.data(), scalar.data(), count * sizeof(Output)) == 0, name + ": SSE2 and scalar outputs are bit-identical");
+	}
+
+	// Median Mpix/s of a conversion of pixelCount RGBA pixels.
+	double MegapixelsPerSecond(size_t pixelCount, uint32_t iterations, const std::function<void()>& convert)
+	{
+		std::vector<int64_t> times;
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			Clock clock;
+			convert();
+			times.push_back(clock.GetElapsedTime().AsMicroseconds());
+		}
+		return static_cast<double>(pixelCount) / static_cast<double>(std::max<int64_t>(Median(times), 1));
+	}
+
+	// Checks that the SSE2 pixel conversion kernels give bit-identical results to the scalar code (the SIMD_SSE2
+	// undefined build) on random, NaN and infinite inputs, checks the integer kernels against their formulas for every
+	// input, and reports Mpix/s of both paths on an RGBA image.
+	bool PixelConversion(BenchmarkApplication&, std::span<const std::string> args)
+	{
+		const uint32_t size = ArgU32(args, 0, 2048);
+		const uint32_t iterations = ArgU32(args, 1, 5);
+		if (!PixelConvert::IsSimdEnabled()) Warning("pixel-convert: built without SSE2, both paths are the scalar code");
+
+		// one odd count so every kernel runs its scalar tail after the SIMD blocks
+		const size_t count = (size_t(1) << 22) + 13;
+		const PixelInputs in = MakePixelInputs(count);
+		bool ok = true;
+		ok &= SameWithAndWithoutSimd<float>("U8ToFloat", count, [&](std::vector<float>& out) { PixelConvert::U8ToFloat(in.u8.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<float>("U16ToFloat", count, [&](std::vector<float>& out) { PixelConvert::U16ToFloat(in.u16.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<uint8_t>("FloatToU8", count, [&](std::vector<uint8_t>& out) { PixelConvert::FloatToU8(in.f32.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<uint16_t>("FloatToU16", count, [&](std::vector<uint16_t>& out) { PixelConvert::FloatToU16(in.f32.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<uint16_t>("U8ToU16", count, [&](std::vector<uint16_t>& out) { PixelConvert::U8ToU16(in.u8.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<uint8_t>("U16ToU8", count, [&](std::vector<uint8_t>& out) { PixelConvert::U16ToU8(in.u16.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<uint16_t>("FloatToHalf", count, [&](std::vector<uint16_t>& out) { PixelConvert::FloatToHalf(in.f32.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<float>("HalfToFloat", count, [&](std::vector<float>& out) { PixelConvert::HalfToFloat(in.u16.data(), out.data(), count); });
+		ok &= SameWithAndWithoutSimd<uint8_t>("LinearToSRGB", count, [&](std::vector<uint8_t>& out) { PixelConvert::LinearToSRGB(in.f32.data(), out.data(), count); });
+		const size_t pixels = count / 4;
+		ok &= SameWithAndWithoutSimd<uint8_t>("PremultiplyAlpha u8", pixels * 4, [&](std::vector<uint8_t>& out) { out.assign(in.u8.begin(), in.u8.begin() + pixels * 4); PixelConvert::PremultiplyAlpha(out.data(), pixels); });
+		ok &= SameWithAndWithoutSimd<float>("PremultiplyAlpha float", pixels * 4, [&](std::vector<float>& out) { out.assign(in.f32.begin(), in.f32.begin() + pixels * 4); PixelConvert::PremultiplyAlpha(out.data(), pixels); });
+
+		// the formulas, over every input
+		{
+			std::vector<uint16_t> all16(65536);
+			for (uint32_t v = 0; v < 65536; v++) all16[v] = static_cast<uint16_t>(v);
+			std::vector<uint8_t> to8(all16.size());
+			PixelConvert::U16ToU8(all16.data(), to8.data(), all16.size());
+			uint32_t wrong = 0;
+			for (uint32_t v = 0; v < 65536; v++)
+				wrong += to8[v] != std::lround(v / 257.0);
+			ok &= Check(wrong == 0, std::to_string(wrong) + " U16ToU8 values aren't v / 257 rounded");
+
+			// every half to float and back, NaNs only have to stay NaN
+			std::vector<float> halfs(all16.size());
+			std::vector<uint16_t> back(all16.size());
+			PixelConvert::HalfToFloat(all16.data(), halfs.data(), all16.size());
+			PixelConvert::FloatToHalf(halfs.data(), back.data(), halfs.size());
+			wrong = 0;
+			for (uint32_t h = 0; h < 65536; h++)
+			{
+				const bool nan = (h & 0x7C00) == 0x7C00 && (h & 0x3FF) != 0;
+				const int exponent = (h >> 10) & 0x1F;
+				const double magnitude = (exponent == 0) ? std::ldexp(h & 0x3FF, -24) : std::ldexp((h & 0x3FF) | 0x400, exponent - 25);
+				const double expected = (h & 0x8000) ? -magnitude : magnitude;
+				if (nan) wrong += !std::isnan(halfs[h]) || (back[h] & 0x7C00) != 0x7C00 || (back[h] & 0x3FF) == 0;
+				else if (exponent == 0x1F) wrong += !std::isinf(halfs[h]) || std::signbit(halfs[h]) != bool(h & 0x8000) || back[h] != h;
+				else wrong += static_cast<double>(halfs[h]) != expected || back[h] != h;
+			}
+			ok &= Check(wrong == 0, std::to_string(wrong) + " halfs don't convert to their value or back");
+
+			std::vector<uint8_t> rgba;
+			for (uint32_t a = 0; a < 256; a++)
+				for (uint32_t c = 0; c < 256; c++)
+					rgba.insert(rgba.end(), { uint8_t(c), uint8_t(255 - c), uint8_t(c), uint8_t(a) });
+			PixelConvert::PremultiplyAlpha(rgba.data(), rgba.size() / 4);
+			wrong = 0;
+			for (uint32_t a = 0; a < 256; a++)
+				for (uint32_t c = 0; c < 256; c++)
+				{
+					const uint8_t* pPixel = &rgba[(a * 256 + c) * 4];
+					wrong += pPixel[0] != std::lround(c * a / 255.0) || pPixel[1] != std::lround((255 - c) * a / 255.0) || pPixel[3] != a;
+				}
+			ok &= Check(wrong == 0, std::to_string(wrong) + " premultiplied pixels aren't c * a / 255 rounded");
+
+			// sRGB encoding against the transfer function in double precision, away from the rounding boundaries
+			const std::vector<float> linear(in.f32.begin(), in.f32.begin() + 65536);
+			std::vector<uint8_t> srgb(linear.size());
+			PixelConvert::LinearToSRGB(linear.data(), srgb.data(), linear.size());
+			wrong = 0;
+			for (size_t i = 0; i < linear.size(); i++)
+			{
+				const double v = std::isnan(linear[i]) ? 0.0 : std::clamp<double>(linear[i], 0.0, 1.0);
+				const double encoded = 255.0 * ((v <= 0.0031308) ? 12.92 * v : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055);
+				if (std::abs(encoded - std::floor(encoded) - 0.5) > 1e-3) wrong += srgb[i] != std::lround(encoded);
+			}
+			ok &= Check(wrong == 0, std::to_string(wrong) + " sRGB values aren't the rounded transfer function");
+		}
+
+		// Mpix/s on size x size RGBA, SSE2 then scalar
+		const size_t pixelCount = static_cast<size_t>(size) * size;
+		const size_t channels = pixelCount * 4;
+		std::vector<uint8_t> u8(channels), u8Out(channels);
+		std::vector<uint16_t> u16(channels), u16Out(channels);
+		std::vector<float> f32(channels), f32Out(channels);
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		for (size_t i = 0; i < channels; i++)
+		{
+			u8[i] = in.u8[i % count];
+			u16[i] = in.u16[i % count];
+			f32[i] = unit(random);
+		}
+		u8Out = u8;
+		const std::pair<std::string_view, std::function<void()>> kernels[] = {
+			{ "RGBA8 -> float", [&] { PixelConvert::U8ToFloat(u8.data(), f32Out.data(), channels); } },
+			{ "float -> RGBA8", [&] { PixelConvert::FloatToU8(f32.data(), u8Out.data(), channels); } },
+			{ "RGBA16 -> RGBA8", [&] { PixelConvert::U16ToU8(u16.data(), u8Out.data(), channels); } },
+			{ "premultiply RGBA8", [&] { PixelConvert::PremultiplyAlpha(u8Out.data(), pixelCount); } },
+			{ "float -> half", [&] { PixelConvert::FloatToHalf(f32.data(), u16Out.data(), channels); } },
+			{ "half -> float", [&] { PixelConvert::HalfToFloat(u16.data(), f32Out.data(), channels); } },
+			{ "float -> sRGB8", [&] { PixelConvert::LinearToSRGB(f32.data(), u8Out.data(), channels); } },
+		};
+		for (const auto& [name, convert] : kernels)
+		{
+			PixelConvert::SetSimdEnabled(true);
+			const double simd = MegapixelsPerSecond(pixelCount, iterations, convert);
+			PixelConvert::SetSimdEnabled(false);
+			const double scalar = MegapixelsPerSecond(pixelCount, iterations, convert);
+			PixelConvert::SetSimdEnabled(true);
+			Print("pixel-convert: " + std::string(name) + ": SSE2 " + std::to_string(simd) + " Mpix/s, scalar " + std::to_string(scalar) + " Mpix/s");
+		}
+		return ok;
+	}
+
+	// Private memory of the process in bytes: the commit charge on Windows, resident anonymous pages on Linux. Pages of a
+	// mapped file are backed by the file and don't count.
+	int64_t PrivateMemory()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS_EX counters{};
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) return 0;
+		return static_cast<int64_t>(counters.PrivateUsage);
+#elif defined(__linux__)
+		std::ifstream status("/proc/self/status");
+		std::string   line;
+		while (std::getline(status, line))
+			if (line.starts_with("RssAnon:")) return std::atoll(line.c_str() + 8) * 1024;
+		return 0;
+#else
+		return 0;
+#endif
+	}
+
+	// Gives freed heap pages back to the system, so reusing them shows up in PrivateMemory() again.
+	void TrimHeap()
+	{
+#if defined(__GLIBC__)
+		malloc_trim(0);
+#endif
+	}
+
+	// How files were loaded before MappedFile: the whole file read into a vector the caller owns.
+	std::optional<std::vector<char>> ReadWithStream(const std::filesystem::path& path)
+	{
+		std::ifstream stream(path, std::ios::binary | std::ios::ate);
+		if (!stream.is_open()) return std::nullopt;
+		const std::streamoff length = stream.tellg();
+		if (length < 0) return std::nullopt;
+		std::vector<char> data(static_cast<size_t>(length));
+		stream.seekg(0, std::ios::beg);
+		if (!stream.read(data.data(), static_cast<std::streamsize>(length))) return std::nullopt;
+		return data;
+	}
+
+	// Every regular file under the directory, recursively.
+	std::vector<std::filesystem::path> ListFiles(const std::filesystem::path& directory)
+	{
+		std::vector<std::filesystem::path> files;
+		std::error_code                    error;
+		for (auto it = std::filesystem::recursive_directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, error);
+			it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			if (it->is_regular_file(error)) files.push_back(it->path());
+		}
+		return files;
+	}
+
+	struct LoadStats final
+	{
+		std::vector<int64_t> times;       // microseconds per pass over all files
+		int64_t              peakGrowth = 0; // largest private memory growth while one loaded file was held
+	};
+
+	// load(index, held) loads files[index] and calls held() while everything the load produced is still alive. The
+	// first pass samples the private memory growth in held(), the next passes are timed without sampling.
+	template<typename Load>
+	LoadStats MeasureLoads(const std::vector<std::filesystem::path>& files, uint32_t iterations, Load&& load)
+	{
+		LoadStats stats;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			TrimHeap();
+			const int64_t before = PrivateMemory();
+			load(i, [&] { stats.peakGrowth = std::max(stats.peakGrowth, PrivateMemory() - before); });
+		}
+		for (uint32_t pass = 0; pass < iterations; pass++)
+		{
+			Clock clock;
+			for (size_t i = 0; i < files.size(); i++)
+				load(i, [] {});
+			stats.times.push_back(clock.GetElapsedTime().AsMicroseconds());
+		}
+		return stats;
+	}
+
+	std::string Megabytes(int64_t bytes)
+	{
+		return std::to_string(static_cast<double>(bytes) / (1024.0 * 1024.0)) + " MB";
+	}
+
+	// Reads every file under a directory through a stream into a vector (the old path) and through MappedFile, and
+	// decodes the images in it from the vector and with Bitmap::LoadFile. Both paths have to give the same bytes and the
+	// same pixels; the time and the private memory held per load are reported, with the bytes each path copied.
+	bool MappedIo(BenchmarkApplication&, std::span<const std::string> args)
+	{
+		const std::filesystem::path directory = args.empty() ? std::filesystem::path(".") : std::filesystem::path(args[0]);
+		const uint32_t              iterations = ArgU32(args, 1, 3);
+
+		const std::vector<std::filesystem::path> files = ListFiles(directory);
+		std::vector<std::filesystem::path>       images;
+		std::copy_if(files.begin(), files.end(), std::back_inserter(images), [](const std::filesystem::path& path) { return Bitmap::IsBitmapFile(path); });
+		if (!Check(!files.empty(), "no files under '" + directory.string() + "'")) return false;
+
+		// the same bytes both ways, and what each way copied into private memory
+		bool     ok = true;
+		int64_t  totalBytes = 0;
+		int64_t  largestFile = 0;
+		int64_t  mappedCopies = 0;
+		uint32_t unreadable = 0;
+		uint32_t different = 0;
+		for (const std::filesystem::path& path : files)
+		{
+			const std::optional<std::vector<char>> data = ReadWithStream(path);
+			MappedFile                             mapped;
+			if (!data || !mapped.Open(path))
+			{
+				unreadable++;
+				continue;
+			}
+			different += (mapped.GetLength() != data->size()) || !std::equal(data->begin(), data->end(), mapped.GetData());
+			totalBytes += static_cast<int64_t>(data->size());
+			largestFile = std::max(largestFile, static_cast<int64_t>(data->size()));
+			if (!mapped.IsMapped()) mappedCopies += static_cast<int64_t>(mapped.GetLength());
+		}
+		ok &= Check(unreadable == 0, std::to_string(unreadable) + " files could only be read one way");
+		ok &= Check(different == 0, std::to_string(different) + " files read differently through MappedFile");
+
+		uint64_t        sink = 0;
+		const LoadStats streamHash = MeasureLoads(files, iterations, [&](size_t i, auto&& held) {
+			const std::optional<std::vector<char>> data = ReadWithStream(files[i]);
+			if (!data) return;
+			sink += XXH64(data->data(), data->size(), 0);
+			held();
+		});
+		const LoadStats mappedHash = MeasureLoads(files, iterations, [&](size_t i, auto&& held) {
+			MappedFile mapped;
+			if (!mapped.Open(files[i])) return;
+			sink += XXH64(mapped.GetData(), mapped.GetLength(), 0);
+			held();
+		});
+
+		// the same pixels both ways
+		uint32_t differentImages = 0;
+		for (const std::filesystem::path& path : images)
+		{
+			const std::optional<std::vector<char>> data = ReadWithStream(path);
+			Bitmap fromVector;
+			Bitmap fromFile;
+			const bool decodedVector = data && !data->empty() && Success(Bitmap::LoadFromMemory(data->size(), data->data(), &fromVector));
+			const bool decodedFile = Success(Bitmap::LoadFile(path, &fromFile));
+			if (decodedVector != decodedFile) differentImages++;
+			else if (decodedVector)
+				differentImages += fromVector.GetFormat() != fromFile.GetFormat() || fromVector.GetWidth() != fromFile.GetWidth()
+					|| fromVector.GetHeight() != fromFile.GetHeight() || fromVector.GetFootprintSize() != fromFile.GetFootprintSize()
+					|| std::memcmp(fromVector.GetData(), fromFile.GetData(), fromVector.GetFootprintSize()) != 0;
+		}
+		ok &= Check(differentImages == 0, std::to_string(differentImages) + " images decode differently from the file than from a copy");
+
+		const LoadStats streamDecode = MeasureLoads(images, iterations, [&](size_t i, auto&& held) {
+			const std::optional<std::vector<char>> data = ReadWithStream(images[i]);
+			if (!data || data->empty()) return;
+			Bitmap bitmap;
+			if (Failed(Bitmap::LoadFromMemory(data->size(), data->data(), &bitmap))) return;
+			sink += bitmap.GetWidth();
+			held();
+		});
+		const LoadStats mappedDecode = MeasureLoads(images, iterations, [&](size_t i, auto&& held) {
+			Bitmap bitmap;
+			if (Failed(Bitmap::LoadFile(images[i], &bitmap))) return;
+			sink += bitmap.GetWidth();
+			held();
+		});
+
+		ok &= Check(sink != 0, "nothing was loaded");
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+		ok &= Check(mappedCopies == 0, Megabytes(mappedCopies) + " copied by MappedFile where the files could be mapped");
+		// a megabyte copy shows up in the private memory whatever the page and heap granularity
+		if (largestFile >= 1024 * 1024)
+			ok &= Check(mappedHash.peakGrowth < streamHash.peakGrowth, "MappedFile holds less private memory than the copy");
+#endif
+
+		auto report = [&](std::string_view what, size_t count, LoadStats stream, LoadStats mapped) {
+			Print("mapped-io: " + std::string(what) + " " + std::to_string(count) + " files, median ms: stream "
+				+ std::to_string(Median(stream.times) / 1000.0) + ", mapped " + std::to_string(Median(mapped.times) / 1000.0)
+				+ "; peak private memory held per load: stream " + Megabytes(stream.peakGrowth) + ", mapped " + Megabytes(mapped.peakGrowth));
+		};
+		Print("mapped-io: " + std::to_string(files.size()) + " files, " + Megabytes(totalBytes) + " (largest " + Megabytes(largestFile)
+			+ "); bytes copied: stream " + Megabytes(totalBytes) + ", mapped " + Megabytes(mappedCopies));
+		report("read+hash", files.size(), streamHash, mappedHash);
+		report("decode", images.size(), streamDecode, mappedDecode);
+		return ok;
+	}
+
+	// Drops the file from the OS page cache so the next read has to go to the disk, false when that isn't possible.
+	bool EvictFromCache(const std::filesystem::path& path)
+	{
+#if defined(_WIN32)
+		// Opening a file unbuffered throws its cached pages away
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		CloseHandle(file);
+		return true;
+#elif defined(__linux__)
+		const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) return false;
+		const bool evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+		close(fd);
+		return evicted;
+#else
+		return false;
+#endif
+	}
+
+	// Reads every file under a directory from a cold page cache: one after the other on this thread, then through
+	// AsyncFileReader with io_uring (where the kernel has it) and with the thread pool. Every way has to give the bytes
+	// of the sequential reads; the median time and throughput of each are reported.
+	bool AsyncReads(BenchmarkApplication&, std::span<const std::string> args)
+	{
+		const std::filesystem::path directory = args.empty() ? std::filesystem::path(".") : std::filesystem::path(args[0]);
+		const uint32_t              iterations = ArgU32(args, 1, 3);
+		const uint32_t              queueDepth = ArgU32(args, 2, 64);
+
+		const std::vector<std::filesystem::path> files = ListFiles(directory);
+		if (!Check(!files.empty(), "no files under '" + directory.string() + "'")) return false;
+
+		bool                  ok = true;
+		std::vector<uint64_t> expected(files.size());
+		int64_t               totalBytes = 0;
+		uint32_t              unreadable = 0;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			const std::optional<std::vector<char>> data = ReadWithStream(files[i]);
+			if (!data)
+			{
+				unreadable++;
+				continue;
+			}
+			expected[i] = XXH64(data->data(), data->size(), 0);
+			totalBytes += static_cast<int64_t>(data->size());
+		}
+		if (!Check(unreadable == 0, std::to_string(unreadable) + " files can't be read")) return false;
+
+		uint32_t   cachedFiles = 0;
+		const auto evictAll = [&] {
+			for (const std::filesystem::path& path : files)
+				cachedFiles += !EvictFromCache(path);
+		};
+
+		std::vector<int64_t> sequentialTimes;
+		uint32_t             wrongSequential = 0;
+		const auto readSequential = [&] {
+			evictAll();
+			Clock clock;
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				const std::optional<std::vector<char>> data = ReadWithStream(files[i]);
+				wrongSequential += !data || XXH64(data->data(), data->size(), 0) != expected[i];
+			}
+			sequentialTimes.push_back(clock.GetElapsedTime().AsMicroseconds());
+		};
+
+		struct AsyncWay final
+		{
+			bool                 allowIoUring;
+			IoBackend            backend = IoBackend::ThreadPool;
+			std::vector<int64_t> times;
+			uint32_t             wrong = 0;
+		};
+		AsyncWay   ways[] = { { true }, { false } };
+		const auto readAsync = [&](AsyncWay& way) {
+			AsyncFileReaderCreateInfo createInfo{};
+			createInfo.queueDepth = queueDepth;
+			createInfo.allowIoUring = way.allowIoUring;
+			AsyncFileReader reader;
+			reader.Setup(createInfo);
+			way.backend = reader.GetBackend();
+
+			std::vector<FileReadRequest> requests(files.size());
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				requests[i].path = files[i];
+				requests[i].onComplete = [&way, &expected, i](FileReadResult& result) {
+					way.wrong += Failed(result.result) || XXH64(result.data.data(), result.data.size(), 0) != expected[i];
+				};
+			}
+			evictAll();
+			Clock clock;
+			reader.Submit(requests);
+			reader.Wait();
+			way.times.push_back(clock.GetElapsedTime().AsMicroseconds());
+		};
+
+		for (uint32_t iteration = 0; iteration < iterations; iteration++)
+		{
+			readSequential();
+			for (AsyncWay& way : ways) readAsync(way);
+		}
+
+		ok &= Check(wrongSequential == 0, std::to_string(wrongSequential) + " sequential reads changed between passes");
+		for (const AsyncWay& way : ways)
+			ok &= Check(way.wrong == 0, std::to_string(way.wrong) + " async reads don't match the sequential ones");
+
+		const auto report = [&](std::string_view what, std::vector<int64_t> times) {
+			const int64_t median = std::max<int64_t>(Median(times), 1);
+			Print("async-read: " + std::string(what) + ": median " + std::to_string(median / 1000.0) + " ms, "
+				+ std::to_string(static_cast<double>(totalBytes) / static_cast<double>(median)) + " MB/s");
+		};
+		Print("async-read: " + std::to_string(files.size()) + " files, " + Megabytes(totalBytes) + ", queue depth "
+			+ std::to_string(queueDepth) + (cachedFiles == 0 ? ", cold cache" : ", " + std::to_string(cachedFiles) + " file reads couldn't be evicted from the cache"));
+		report("sequential", sequentialTimes);
+		for (const AsyncWay& way : ways)
+			report(way.backend == IoBackend::IoUring ? "io_uring" : (way.allowIoUring ? "thread pool (no io_uring)" : "thread pool"), way.times);
+		return ok;
+	}
+
+	// Packs a directory and loads every file in it through MappedFile, once from the loose files and once from the
+	// mounted pack, each with a cold and then a warm page cache. Both have to give the bytes on disk. The pack size,
+	// the build time and the median load times are reported. The game's own packs are unmounted meanwhile, so the loose
+	// loads really come from loose files.
+	bool AssetPackLoads(BenchmarkApplication& app, std::span<const std::string> args)
+	{
+		const std::filesystem::path directory = args.empty() ? std::filesystem::path(".") : std::filesystem::path(args[0]);
+		const uint32_t              iterations = ArgU32(args, 1, 3);
+
+		const std::vector<std::filesystem::path> files = ListFiles(directory);
+		if (!Check(!files.empty(), "no files under '" + directory.string() + "'")) return false;
+
+		bool                  ok = true;
+		std::vector<uint64_t> expected(files.size());
+		uint32_t              unreadable = 0;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			const std::optional<std::vector<char>> data = ReadWithStream(files[i]);
+			unreadable += !data;
+			if (data) expected[i] = XXH64(data->data(), data->size(), 0);
+		}
+		if (!Check(unreadable == 0, std::to_string(unreadable) + " files can't be read")) return false;
+
+		std::error_code             error;
+		const std::filesystem::path packPath = std::filesystem::temp_directory_path(error) / "NewFPS-bench.npak";
+		AssetPackBuildStats         buildStats;
+		if (!Check(Success(BuildAssetPack(directory, packPath, {}, &buildStats)), "packing '" + directory.string() + "'")) return false;
+
+		AssetPack pack;
+		uint32_t  unpacked = 0;
+		if (Check(pack.Open(packPath), "opening the pack"))
+		{
+			for (const std::filesystem::path& path : files)
+				unpacked += pack.Find(path.lexically_relative(directory).generic_string()) == nullptr;
+		}
+		ok &= Check(unpacked == 0, std::to_string(unpacked) + " files are missing from the pack");
+
+		uint32_t   wrong = 0;
+		const auto loadAll = [&] {
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				MappedFile file;
+				wrong += !file.Open(files[i]) || XXH64(file.GetData(), file.GetLength(), 0) != expected[i];
+			}
+		};
+		uint32_t   cachedFiles = 0;
+		const auto evictAll = [&] {
+			for (const std::filesystem::path& path : files)
+				cachedFiles += !EvictFromCache(path);
+			cachedFiles += !EvictFromCache(packPath);
+		};
+
+		UnmountAllAssetPacks();
+		std::vector<int64_t> looseCold, looseWarm, packCold, packWarm;
+		for (uint32_t iteration = 0; iteration < iterations; iteration++)
+		{
+			evictAll();
+			Clock clock;
+			loadAll();
+			looseCold.push_back(clock.GetElapsedTime().AsMicroseconds());
+			clock.Restart();
+			loadAll();
+			looseWarm.push_back(clock.GetElapsedTime().AsMicroseconds());
+
+			evictAll();
+			clock.Restart();
+			// Mounting is part of loading from a pack
+			ok &= Check(MountAssetPack(packPath, directory), "mounting the pack");
+			loadAll();
+			packCold.push_back(clock.GetElapsedTime().AsMicroseconds());
+			clock.Restart();
+			loadAll();
+			packWarm.push_back(clock.GetElapsedTime().AsMicroseconds());
+			UnmountAssetPack(packPath);
+		}
+		ok &= Check(wrong == 0, std::to_string(wrong) + " loads don't match the files on disk");
+
+		pack = {};
+		std::filesystem::remove(packPath, error);
+		for (const std::filesystem::path& gamePack : app.Config().assetPacks)
+		{
+			if (std::filesystem::exists(gamePack, error)) MountAssetPack(gamePack);
+		}
+
+		Print("asset-pack: " + std::to_string(files.size()) + " files, " + Megabytes(static_cast<int64_t>(buildStats.sourceSize)) + " loose, "
+			+ Megabytes(static_cast<int64_t>(buildStats.packSize)) + " packed (" + std::to_string(buildStats.compressedCount) + " compressed, "
+			+ std::to_string(buildStats.duplicateCount) + " duplicates), built in " + std::to_string(buildStats.buildTime.AsMilliseconds()) + " ms"
+			+ (cachedFiles == 0 ? "" : "; " + std::to_string(cachedFiles) + " file reads couldn't be evicted from the cache"));
+		Print("asset-pack: cold cache, median ms: loose " + std::to_string(Median(looseCold) / 1000.0) + ", pack "
+			+ std::to_string(Median(packCold) / 1000.0) + " (mount included)");
+		Print("asset-pack: warm cache, median ms: loose " + std::to_string(Median(looseWarm) / 1000.0) + ", pack "
+			+ std::to_string(Median(packWarm) / 1000.0));
+		return ok;
+	}
+
+	// Reference decoder for the blocks CompressBitmap writes, following the format specifications, so the PSNR checked
+	// below isn't only the encoder's own error sum. BC7 blocks are only decoded in modes 5 and 6, the ones it writes.
+	void DecodeChannelBlock(const uint8_t* pBlock, uint32_t channel, uint8_t (&pixels)[16][4])
+	{
+		const int end0 = pBlock[0];
+		const int end1 = pBlock[1];
+		int       palette[8] = { end0, end1 };
+		if (end0 > end1)
+		{
+			for (int k = 2; k < 8; ++k) palette[k] = ((8 - k) * end0 + (k - 1) * end1) / 7;
+		}
+		else
+		{
+			for (int k = 2; k < 6; ++k) palette[k] = ((6 - k) * end0 + (k - 1) * end1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (int i = 0; i < 6; ++i) indices |= static_cast<uint64_t>(pBlock[2 + i]) << (8 * i);
+		for (int i = 0; i < 16; ++i) pixels[i][channel] = static_cast<uint8_t>(palette[(indices >> (3 * i)) & 7]);
+	}
+
+	void DecodeColorBlock(const uint8_t* pBlock, bool punchThrough, uint8_t (&pixels)[16][4])
+	{
+		const uint16_t color0 = static_cast<uint16_t>(pBlock[0] | (pBlock[1] << 8));
+		const uint16_t color1 = static_cast<uint16_t>(pBlock[2] | (pBlock[3] << 8));
+		auto           unpack = [](uint16_t color, int (&rgb)[3]) {
+			const int r = color >> 11, g = (color >> 5) & 63, b = color & 31;
+			rgb[0] = (r << 3) | (r >> 2);
+			rgb[1] = (g << 2) | (g >> 4);
+			rgb[2] = (b << 3) | (b >> 2);
+		};
+
+		int palette[4][3];
+		unpack(color0, palette[0]);
+		unpack(color1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			// BC1 blocks with color0 <= color1 have a midpoint and transparent black instead, BC3 colours never do
+			if (punchThrough && color0 <= color1)
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+			else
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+		}
+
+		const uint32_t indices = pBlock[4] | (pBlock[5] << 8) | (pBlock[6] << 16) | (static_cast<uint32_t>(pBlock[7]) << 24);
+		for (int i = 0; i < 16; ++i)
+			for (int c = 0; c < 3; ++c) pixels[i][c] = static_cast<uint8_t>(palette[(indices >> (2 * i)) & 3][c]);
+	}
+
+	bool DecodeBC7Block(const uint8_t* pBlock, uint8_t (&pixels)[16][4])
+	{
+		uint32_t bitOffset = 0;
+		auto     bits = [&](uint32_t count) {
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; ++i, ++bitOffset) value |= ((pBlock[bitOffset / 8] >> (bitOffset % 8)) & 1u) << i;
+			return value;
+		};
+		auto interpolate = [](int end0, int end1, int weight) { return static_cast<uint8_t>(((64 - weight) * end0 + weight * end1 + 32) >> 6); };
+
+		if ((pBlock[0] & 0x7F) == 0x20)
+		{
+			// Mode 5: RGB 7 bits and alpha 8 bits with their own 2 bit indices, no rotation
+			bits(6);
+			if (bits(2) != 0) return false;
+			int ends[2][4];
+			for (int c = 0; c < 3; ++c)
+			{
+				for (int e = 0; e < 2; ++e)
+				{
+					ends[e][c] = static_cast<int>(bits(7));
+					ends[e][c] = (ends[e][c] << 1) | (ends[e][c] >> 6);
+				}
+			}
+			ends[0][3] = static_cast<int>(bits(8));
+			ends[1][3] = static_cast<int>(bits(8));
+
+			constexpr int kWeights[4] = { 0, 21, 43, 64 };
+			uint32_t      colorIndices[16], alphaIndices[16];
+			for (int i = 0; i < 16; ++i) colorIndices[i] = bits(i == 0 ? 1 : 2);
+			for (int i = 0; i < 16; ++i) alphaIndices[i] = bits(i == 0 ? 1 : 2);
+			for (int i = 0; i < 16; ++i)
+			{
+				for (int c = 0; c < 3; ++c) pixels[i][c] = interpolate(ends[0][c], ends[1][c], kWeights[colorIndices[i]]);
+				pixels[i][3] = interpolate(ends[0][3], ends[1][3], kWeights[alphaIndices[i]]);
+			}
+			return true;
+		}
+
+		// Mode 6: RGBA 7 bits plus a p-bit per endpoint, 4 bit indices
+		if (bits(7) != 0x40) return false;
+		int ends[2][4];
+		for (int c = 0; c < 4; ++c)
+		{
+			ends[0][c] = static_cast<int>(bits(7));
+			ends[1][c] = static_cast<int>(bits(7));
+		}
+		const uint32_t pBit0 = bits(1);
+		const uint32_t pBit1 = bits(1);
+		for (int c = 0; c < 4; ++c)
+		{
+			ends[0][c] = (ends[0][c] << 1) | static_cast<int>(pBit0);
+			ends[1][c] = (ends[1][c] << 1) | static_cast<int>(pBit1);
+		}
+
+		constexpr int kWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		for (int i = 0; i < 16; ++i)
+		{
+			const uint32_t index = bits(i == 0 ? 3 : 4);
+			for (int c = 0; c < 4; ++c) pixels[i][c] = interpolate(ends[0][c], ends[1][c], kWeights[index]);
+		}
+		return true;
+	}
+
+	bool DecodeBlock(BlockFormat format, const uint8_t* pBlock, uint8_t (&pixels)[16][4])
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1: DecodeColorBlock(pBlock, true, pixels); return true;
+		case BlockFormat::BC3: DecodeChannelBlock(pBlock, 3, pixels); DecodeColorBlock(pBlock + 8, false, pixels); return true;
+		case BlockFormat::BC4: DecodeChannelBlock(pBlock, 0, pixels); return true;
+		case BlockFormat::BC5: DecodeChannelBlock(pBlock, 0, pixels); DecodeChannelBlock(pBlock + 8, 1, pixels); return true;
+		case BlockFormat::BC7: return DecodeBC7Block(pBlock, pixels);
+		default: return false;
+		}
+	}
+
+	// PSNR in dB of the decoded blocks against an RGBA8 bitmap, over the channels the format stores. Edge blocks repeat
+	// the edge pixels like CompressBitmap pads them. Negative if a block can't be decoded.
+	double DecodedPsnr(const Bitmap& bitmap, BlockFormat format, const std::vector<char>& blocks)
+	{
+		const uint32_t channelCount = (format == BlockFormat::BC1) ? 3 : (format == BlockFormat::BC4) ? 1 : (format == BlockFormat::BC5) ? 2 : 4;
+		const uint32_t blocksX = (bitmap.GetWidth() + 3) / 4;
+		const uint32_t blocksY = (bitmap.GetHeight() + 3) / 4;
+
+		uint64_t squaredError = 0;
+		for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+		{
+			for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+			{
+				uint8_t pixels[16][4] = {};
+				const uint8_t* pBlock = reinterpret_cast<const uint8_t*>(blocks.data()) + (static_cast<size_t>(blockY) * blocksX + blockX) * BlockFormatSize(format);
+				if (!DecodeBlock(format, pBlock, pixels)) return -1.0;
+
+				for (uint32_t i = 0; i < 16; ++i)
+				{
+					const uint32_t x = std::min(blockX * 4 + i % 4, bitmap.GetWidth() - 1);
+					const uint32_t y = std::min(blockY * 4 + i / 4, bitmap.GetHeight() - 1);
+					const uint8_t* pSource = bitmap.GetPixel8u(x, y);
+					for (uint32_t c = 0; c < channelCount; ++c)
+					{
+						const int64_t difference = static_cast<int64_t>(pixels[i][c]) - pSource[c];
+						squaredError += static_cast<uint64_t>(difference * difference);
+					}
+				}
+			}
+		}
+		const double mse = static_cast<double>(squaredError) / (static_cast<double>(blocksX) * blocksY * 16.0 * channelCount);
+		return (mse > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+	}
+
+	// Block compresses the images under a directory to every format, decodes the blocks with the reference decoder
+	// above and checks each texture against a PSNR floor per format. Then the images are loaded as BC7 through an
+	// empty TextureCache, which cooks them, and again, which has to give the same textures from the cache. Reports the
+	// VRAM the textures take as RGBA8 and BC7, and the load times next to decoding and building mips uncompressed.
+	bool TextureCook(BenchmarkApplication&, std::span<const std::string> args)
+	{
+		const std::filesystem::path directory = args.empty() ? std::filesystem::path(".") : std::filesystem::path(args[0]);
+
+		// Floors under the lowest PSNR of the shipped textures. BC7 has no partitioned modes, so small pixel art with
+		// many colours per block gets no more out of it than BC1/BC3.
+		struct FormatFloor final
+		{
+			BlockFormat format;
+			double      floor;
+		};
+		constexpr FormatFloor kFloors[] = {
+			{ BlockFormat::BC1, 17.0 },
+			{ BlockFormat::BC3, 18.0 },
+			{ BlockFormat::BC4, 33.5 },
+			{ BlockFormat::BC5, 33.5 },
+			{ BlockFormat::BC7, 18.5 },
+		};
+
+		std::vector<std::filesystem::path> images = ListFiles(directory);
+		std::erase_if(images, [](const std::filesystem::path& path) { return !Bitmap::IsBitmapFile(path); });
+		std::sort(images.begin(), images.end());
+
+		// 8 bit images only, float images (HDR) can't be cooked and load uncompressed
+		std::vector<std::filesystem::path> textures;
+		std::vector<Bitmap>                bitmaps;
+		for (const std::filesystem::path& path : images)
+		{
+			Bitmap bitmap;
+			if (Failed(Bitmap::LoadFile(path, &bitmap)) || (Bitmap::ChannelDataType(bitmap.GetFormat()) == Bitmap::DATA_TYPE_FLOAT)) continue;
+			Bitmap rgba;
+			if (Failed(ConvertBitmap(bitmap, Bitmap::FORMAT_RGBA_UINT8, &rgba))) continue;
+			textures.push_back(path);
+			bitmaps.push_back(std::move(rgba));
+		}
+		if (!Check(!textures.empty(), "no 8 bit images under '" + directory.string() + "'")) return false;
+
+		bool ok = true;
+		for (const FormatFloor& floor : kFloors)
+		{
+			double                minPsnr = std::numeric_limits<double>::infinity();
+			std::filesystem::path worst;
+			uint32_t              mismatches = 0;
+			for (size_t i = 0; i < textures.size(); ++i)
+			{
+				std::vector<char> blocks;
+				double            reported = 0.0;
+				if (!Check(Success(CompressBitmap(bitmaps[i], floor.format, &blocks, &reported)), std::string(ToString(floor.format)) + " compression of " + textures[i].string()))
+				{
+					ok = false;
+					continue;
+				}
+				const double decoded = DecodedPsnr(bitmaps[i], floor.format, blocks);
+				ok &= Check(decoded >= 0.0, "the reference decoder can't decode the " + std::string(ToString(floor.format)) + " blocks of " + textures[i].string());
+				mismatches += std::isinf(reported) ? !std::isinf(decoded) : (std::abs(decoded - reported) > 0.01);
+				if (decoded < minPsnr)
+				{
+					minPsnr = decoded;
+					worst = textures[i];
+				}
+			}
+			ok &= Check(mismatches == 0, std::to_string(mismatches) + " " + ToString(floor.format) + " textures decode to a different PSNR than CompressBitmap reports");
+			ok &= Check(minPsnr >= floor.floor, std::string(ToString(floor.format)) + " PSNR of " + worst.string() + " under the floor of " + std::to_string(floor.floor) + " dB");
+			Print("texture-cook: " + std::string(ToString(floor.format)) + " lowest PSNR " + std::to_string(minPsnr) + " dB (" + worst.filename().string()
+				+ "), floor " + std::to_string(floor.floor) + " dB");
+		}
+
+		// the uncompressed path: decode and build the mips on the CPU
+		Clock clock;
+		for (const std::filesystem::path& path : textures)
+		{
+			Bitmap bitmap;
+			if (Success(Bitmap::LoadFile(path, &bitmap))) Mipmap mipmap(bitmap, RemainingMipLevels);
+		}
+		const int64_t uncompressedTime = clock.GetElapsedTime().AsMicroseconds();
+
+		std::error_code             error;
+		const std::filesystem::path cacheDirectory = std::filesystem::temp_directory_path(error) / "TextureCookBenchmark";
+		std::filesystem::remove_all(cacheDirectory, error);
+		TextureCache::SetDirectory(cacheDirectory);
+		const TextureCacheStats before = TextureCache::GetStats();
+
+		std::vector<gli::texture> cooked(textures.size());
+		int64_t                   rgba8Size = 0;
+		int64_t                   compressedSize = 0;
+		clock.Restart();
+		for (size_t i = 0; i < textures.size(); ++i)
+			ok &= Check(Success(TextureCache::Load(textures[i], {}, &cooked[i])), "cooking " + textures[i].string());
+		const int64_t           coldTime = clock.GetElapsedTime().AsMicroseconds();
+		const TextureCacheStats cold = TextureCache::GetStats();
+		// files with the same name and contents share a cooked texture, the copies already load from the cache
+		const uint32_t cookedCount = cold.cookedTextures - before.cookedTextures;
+		ok &= Check(cookedCount + cold.cachedTextures - before.cachedTextures == textures.size(), "every texture cooked or loaded once");
+
+		uint32_t different = 0;
+		clock.Restart();
+		for (size_t i = 0; i < textures.size(); ++i)
+		{
+			gli::texture cached;
+			if (Failed(TextureCache::Load(textures[i], {}, &cached)) || (cached.size() != cooked[i].size())
+				|| (std::memcmp(cached.data(), cooked[i].data(), cached.size()) != 0))
+				different++;
+		}
+		const int64_t warmTime = clock.GetElapsedTime().AsMicroseconds();
+
+		const TextureCacheStats after = TextureCache::GetStats();
+		ok &= Check(after.cookedTextures == cold.cookedTextures && after.cachedTextures - cold.cachedTextures == textures.size(),
+			"every texture loaded from the cache the second time");
+		ok &= Check(different == 0, std::to_string(different) + " textures load differently from the cache than they were cooked");
+
+		for (const gli::texture& texture : cooked)
+		{
+			for (size_t level = 0; level < texture.levels(); ++level)
+				rgba8Size += static_cast<int64_t>(texture.extent(level).x) * texture.extent(level).y * 4;
+			compressedSize += static_cast<int64_t>(texture.size());
+		}
+
+		// back to the cache the game uses
+		TextureCache::SetDirectory("TextureCache");
+		std::filesystem::remove_all(cacheDirectory, error);
+
+		Print("texture-cook: " + std::to_string(textures.size()) + " textures (" + std::to_string(cookedCount) + " cooked), VRAM with mips: RGBA8 " + Megabytes(rgba8Size) + ", BC7 " + Megabytes(compressedSize));
+		Print("texture-cook: load ms: decode + mips " + std::to_string(uncompressedTime / 1000.0) + ", cold cache (cook) "
+			+ std::to_string(coldTime / 1000.0) + ", warm cache " + std::to_string(warmTime / 1000.0));
+		return ok;
+	}
+
+	constexpr Benchmark Benchmarks[] = {
+		{ "physics-pools", "[iterations=50] [bodies=2000]", PhysicsPools },
+		{ "map-load",      "[iterations=20]",               MapLoad },
+		{ "map-geometry",  "",                              MapGeometryBuilds },
+		{ "shelf-packing", "[operations=20000] [size=512]",  ShelfPacking },
+		{ "sdf-atlas",     "[atlas=1024] [base=48] [padding=6] [frames=2000]", SdfAtlas },
+		{ "pixel-convert", "[size=2048] [iterations=5]",     PixelConversion },
+		{ "mapped-io",     "[directory=.] [iterations=3]",   MappedIo },
+		{ "async-read",    "[directory=.] [iterations=3] [queueDepth=64]", AsyncReads },
+		{ "asset-pack",    "[directory=.] [iterations=3]",   AssetPackLoads },
+		{ "texture-cook",  "[directory=.]",                  TextureCook },
+	};
+} // namespace
+
+BenchmarkApplication::BenchmarkApplication(std::string_view name, std::vector<std::string> args)
+	: m_name(name)
+	, m_args(std::move(args))
+{
+}
+
+EngineApplicationCreateInfo BenchmarkApplication::Config() const
+{
+	EngineApplicationCreateInfo createInfo{};
+	createInfo.logFilePath = "Benchmark.txt";
+	createInfo.assetPacks = { "assets.npak" };
+	createInfo.physics.enable = true;
+	createInfo.headless.enable = true;
+	createInfo.headless.frameCount = 0;
+	createInfo.headless.statsFilePath = {};
+	return createInfo;
+}
+
+bool BenchmarkApplication::Setup()
+{
+	bool found = false;
+	m_succeeded = true;
+	for (const Benchmark& benchmark : Benchmarks)
+	{
+		if ((m_name != "all") && (m_name != benchmark.name)) continue;
+		found = true;
+
+		Print("--- " + std::string(benchmark.name));
+		const bool succeeded = benchmark.func(*this, m_args);
+		Print(std::string(benchmark.name) + (succeeded ? ": OK" : ": FAILED"));
+		m_succeeded &= succeeded;
+	}
+
+	if (!found)
+	{
+		Print("Usage: NewFPS --bench <name|all> [args...]");
+		for (const Benchmark& benchmark : Benchmarks)
+			Print("  " + std::string(benchmark.name) + " " + std::string(benchmark.usage));
+		m_succeeded = false;
+	}
+	return true;
+}
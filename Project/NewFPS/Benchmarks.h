@@ -0,0 +1,20 @@
+﻿#pragma once
+
+// NewFPS --bench <name> [args...]: engine checks and benchmarks that need neither a window nor a GPU. They run inside a
+// headless application, so the log, asset packs and physics are set up as in the game. Each one prints its numbers
+// and fails the process when a result is wrong. "NewFPS --bench" lists them.
+class BenchmarkApplication final : public EngineApplication
+{
+public:
+	BenchmarkApplication(std::string_view name, std::vector<std::string> args);
+
+	EngineApplicationCreateInfo Config() const final;
+	bool Setup() final;
+
+	[[nodiscard]] bool Succeeded() const { return m_succeeded; }
+
+private:
+	std::string              m_name;
+	std::vector<std::string> m_args;
+	bool                     m_succeeded = false;
+};
@@ -16,14 +16,15 @@ struct GameEntityScene final
 	uint4    UsePCF;                     // Enable/disable PCF
 };
 
-bool GameEntity::Setup(GameApplication* game, vkr::RenderDevice& device, const vkr::TriMesh& mesh, const std::filesystem::path& diffuseTextureFileName, vkr::DescriptorPool* pDescriptorPool, const vkr::DescriptorSetLayout* pDrawSetLayout, ShadowPass& shadowPass)
+bool GameEntity::Setup(GameApplication* game, vkr::RenderDevice& device, const vkr::TriMesh& mesh, const std::filesystem::path& diffuseTextureFileName, vkr::DescriptorPool* pDescriptorPool, const vkr::DescriptorSetLayout* pDrawSetLayout, ShadowPass& shadowPass, BlockFormat textureBlockFormat)
 {
 	vkr::Geometry geo;
 	CHECKED_CALL(vkr::Geometry::Create(mesh, &geo));
 	CHECKED_CALL(vkr::vkrUtil::CreateMeshFromGeometry(device.GetGraphicsQueue(), &geo, &this->mesh));
+	bounds.Set(mesh.GetBoundingBoxMin(), mesh.GetBoundingBoxMax());
 
-	// Load textures
-	vkr::vkrUtil::ImageOptions options = vkr::vkrUtil::ImageOptions().MipLevelCount(RemainingMipLevels);
+	// Load textures. Block compression is opt-in, a TextureCache miss cooks synchronously
+	vkr::vkrUtil::ImageOptions options = vkr::vkrUtil::ImageOptions().MipLevelCount(RemainingMipLevels).BlockCompression(textureBlockFormat);
 	CHECKED_CALL(vkr::vkrUtil::CreateImageFromFile(device.GetGraphicsQueue(), diffuseTextureFileName, &image, options, true));
 	vkr::SampledImageViewCreateInfo viewCreateInfo = vkr::SampledImageViewCreateInfo::GuessFromImage(image);
 	CHECKED_CALL(device.CreateSampledImageView(viewCreateInfo, &sampledImageView));
@@ -117,7 +118,7 @@ bool GameEntity::Setup(GameApplication* game, vkr::RenderDevice& device, const v
 	{
 		ph::StaticActorCreateInfo sbci{};
 		sbci.worldPosition = translate;
-		phBody = std::make_shared<ph::StaticBody>(*game, sbci);
+		phBody = game->GetPhysicsScene().CreateStaticBody(sbci);
 
 		ph::MeshColliderCreateInfo mcci{};
 		mcci.vertices = rawVertex;
@@ -6,13 +6,14 @@ class GameApplication;
 
 struct GameEntity
 {
-	bool Setup(GameApplication* game, vkr::RenderDevice& device, const vkr::TriMesh& mesh, const std::filesystem::path& diffuseTextureFileName, vkr::DescriptorPool* pDescriptorPool, const vkr::DescriptorSetLayout* pDrawSetLayout, ShadowPass& shadowPass);
+	bool Setup(GameApplication* game, vkr::RenderDevice& device, const vkr::TriMesh& mesh, const std::filesystem::path& diffuseTextureFileName, vkr::DescriptorPool* pDescriptorPool, const vkr::DescriptorSetLayout* pDrawSetLayout, ShadowPass& shadowPass, BlockFormat textureBlockFormat = BlockFormat::Undefined);
 
 	void UniformBuffer(const float4x4& viewProj, const DirectionalLight& mainLight, bool UsePCF);
 
 	float3                   translate = float3(0, 0, 0);
 	float3                   rotate = float3(0, 0, 0);
 	float3                   scale = float3(1, 1, 1);
+	AABB                     bounds;
 	vkr::MeshPtr             mesh;
 	vkr::DescriptorSetPtr    drawDescriptorSet;
 	vkr::BufferPtr           drawUniformBuffer;
@@ -8,22 +8,27 @@
 EngineApplicationCreateInfo GameApplication::Config() const
 {
 	EngineApplicationCreateInfo createInfo{};
+	createInfo.assetPacks = { "assets.npak" };
 	createInfo.render.swapChain.depthFormat = vkr::Format::D32_FLOAT;
 	createInfo.render.showImgui = true;
 
 	createInfo.physics.enable = true;
+
+	createInfo.headless.enable = m_headlessFrameCount > 0;
+	createInfo.headless.frameCount = m_headlessFrameCount;
 	return createInfo;
 }
 
 bool GameApplication::Setup()
 {
-	auto& device = GetRenderDevice();
-
-	GameGraphicsCreateInfo ggci = {};
-	ggci.descriptorPool.maxUniformBuffer = game::NumMaxEntities;
-	ggci.descriptorPool.maxSampledImage = game::NumMaxEntities;
-	ggci.descriptorPool.maxSampler = game::NumMaxEntities;
-	if (!m_gameGraphics.Setup(device, ggci)) return false;
+	if (!IsHeadless())
+	{
+		GameGraphicsCreateInfo ggci = {};
+		ggci.descriptorPool.maxUniformBuffer = game::NumMaxEntities;
+		ggci.descriptorPool.maxSampledImage = game::NumMaxEntities;
+		ggci.descriptorPool.maxSampler = game::NumMaxEntities;
+		if (!m_gameGraphics.Setup(GetRenderDevice(), ggci)) return false;
+	}
 
 	WorldCreateInfo worldCI = {};
 	if (!m_world.Setup(this, worldCI)) return false;
@@ -35,9 +40,8 @@ bool GameApplication::Setup()
 
 void GameApplication::Shutdown()
 {
-	auto& device = GetRenderDevice();
-
-	m_gameGraphics.Shutdown(device);
+	if (!IsHeadless())
+		m_gameGraphics.Shutdown(GetRenderDevice());
 
 	m_world.Shutdown();
 	// TODO: очистка
@@ -77,7 +81,7 @@ void GameApplication::Render()
 	CHECKED_CALL(frame.cmd->Begin());
 	{
 		// render pass
-		m_gameGraphics.GetShadowPass().Draw(frame.cmd, m_world.GetEntities());
+		m_gameGraphics.GetShadowPass().Draw(frame.cmd, m_world.GetEntities(), m_world.GetMapRenderer());
 
 		// Render main frame
 		{
@@ -145,6 +149,8 @@ void GameApplication::Render()
 					}
 
 					ImGui::Separator();
+					ImGui::Text("Map chunks drawn: %zu / %zu, texture layers: %zu", m_world.GetMapRenderer().GetVisibleChunkCount(), m_world.GetMapRenderer().GetChunkCount(), m_world.GetMapGeometry().GetLayerTextures().size());
+					ImGui::Text("Entities drawn: %zu / %zu", m_world.GetVisibleEntityCount(), m_world.GetEntities().size());
 					ImGui::Checkbox("Use PCF Shadows", &m_gameGraphics.GetShadowPass().UsePCF());
 				}
 				render.DrawImGui(frame.cmd);
@@ -25,6 +25,9 @@ public:
 
 	GameGraphics& GetGameGraphics() { return m_gameGraphics; }
 
+	// Runs frameCount frames without window and GPU instead of the game (see HeadlessCreateInfo)
+	void SetHeadless(uint32_t frameCount) { m_headlessFrameCount = frameCount; }
+
 private:
 	void processInput();
 
@@ -33,4 +36,5 @@ private:
 	std::set<KeyCode> m_pressedKeys;
 
 	bool m_cursorVisible = true;
+	uint32_t m_headlessFrameCount = 0;
 };
\ No newline at end of file
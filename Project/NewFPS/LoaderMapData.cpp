@@ -1,6 +1,180 @@
 #include "stdafx.h"
 #include "LoaderMapData.h"
 
+namespace
+{
+	// Compiled map layout, all values little endian:
+	//   CompiledMapHeader
+	//   string table: uint32 count, then per string uint32 length + characters
+	//   uint32 texture count, uint32 string index per texture path
+	//   uint32 shape count, uint32 string index per shape path
+	//   uint32 width, height, length; float spacing; Tile[width * height * length]
+	//   float3 camera position, float3 camera angles (radians)
+	//   uint32 ent count, CompiledEnt per ent followed by its (key, value) string index pairs
+	// Tiles and ent records are fixed size, so the payload can be used in place from a mapped file.
+	constexpr uint32_t CompiledMapMagic = 0x43334554; // "TE3C"
+	constexpr uint32_t CompiledMapVersion = 1;
+	constexpr XXH64_hash_t CompiledMapSeed = 0x2d358dccaa6c78a5;
+
+	struct CompiledMapHeader final
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t payloadSize;
+		uint64_t checksum;    // XXH64 of the payload
+	};
+
+	struct CompiledEnt final
+	{
+		uint32_t display;
+		uint32_t color;
+		float    radius;
+		float    position[3];
+		int32_t  yaw;
+		int32_t  pitch;
+		uint32_t model;       // String index
+		uint32_t texture;     // String index
+		uint32_t propertyCount;
+	};
+
+	static_assert(std::is_trivially_copyable_v<fileMapData::Tile> && sizeof(fileMapData::Tile) == 16);
+
+	class CompiledMapWriter final
+	{
+	public:
+		template<typename T>
+		void Write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			WriteBytes(&value, sizeof(T));
+		}
+
+		void WriteBytes(const void* data, size_t size)
+		{
+			const char* bytes = static_cast<const char*>(data);
+			m_payload.insert(m_payload.end(), bytes, bytes + size);
+		}
+
+		// Strings are deduplicated and written once, in the string table.
+		uint32_t AddString(const std::string& str)
+		{
+			auto [it, inserted] = m_stringIndices.try_emplace(str, static_cast<uint32_t>(m_strings.size()));
+			if (inserted) m_strings.push_back(str);
+			return it->second;
+		}
+
+		bool Save(const std::filesystem::path& path) const
+		{
+			std::vector<char> stringTable;
+			auto append = [&](const void* data, size_t size) { stringTable.insert(stringTable.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size); };
+
+			const uint32_t stringCount = static_cast<uint32_t>(m_strings.size());
+			append(&stringCount, sizeof(stringCount));
+			for (const std::string& str : m_strings)
+			{
+				const uint32_t length = static_cast<uint32_t>(str.size());
+				append(&length, sizeof(length));
+				append(str.data(), str.size());
+			}
+
+			XXH64_state_t* state = XXH64_createState();
+			XXH64_reset(state, CompiledMapSeed);
+			XXH64_update(state, stringTable.data(), stringTable.size());
+			XXH64_update(state, m_payload.data(), m_payload.size());
+
+			CompiledMapHeader header;
+			header.magic = CompiledMapMagic;
+			header.version = CompiledMapVersion;
+			header.payloadSize = stringTable.size() + m_payload.size();
+			header.checksum = XXH64_digest(state);
+			XXH64_freeState(state);
+
+			// Written next to the final name and renamed over it: a loaded map may still be mapped (see loadCompiled),
+			// truncating it in place would fault the reader, and an interrupted write never leaves a broken map behind
+			std::filesystem::path tempPath = path;
+			tempPath += ".tmp";
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) return false;
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(stringTable.data(), static_cast<std::streamsize>(stringTable.size()));
+			file.write(m_payload.data(), static_cast<std::streamsize>(m_payload.size()));
+			file.close();
+
+			std::error_code errorCode;
+			if (file.good()) std::filesystem::rename(tempPath, path, errorCode);
+			if (!file.good() || errorCode)
+			{
+				std::filesystem::remove(tempPath, errorCode);
+				return false;
+			}
+			return true;
+		}
+
+	private:
+		std::vector<char>                         m_payload;
+		std::vector<std::string>                  m_strings;
+		std::unordered_map<std::string, uint32_t> m_stringIndices;
+	};
+
+	// Bounds checked cursor over a compiled map payload. Strings are views into the payload.
+	class CompiledMapReader final
+	{
+	public:
+		CompiledMapReader(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+		template<typename T>
+		bool Read(T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			return ReadBytes(&value, sizeof(T));
+		}
+
+		bool ReadBytes(void* dst, size_t size)
+		{
+			if (size > m_size - m_offset) return false;
+			memcpy(dst, m_data + m_offset, size);
+			m_offset += size;
+			return true;
+		}
+
+		bool ReadStringTable()
+		{
+			uint32_t count = 0;
+			if (!Read(count)) return false;
+			m_strings.reserve(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				uint32_t length = 0;
+				if (!Read(length) || length > m_size - m_offset) return false;
+				m_strings.emplace_back(m_data + m_offset, length);
+				m_offset += length;
+			}
+			return true;
+		}
+
+		bool GetString(uint32_t index, std::string_view& str) const
+		{
+			if (index >= m_strings.size()) return false;
+			str = m_strings[index];
+			return true;
+		}
+
+		bool ReadString(std::string_view& str)
+		{
+			uint32_t index = 0;
+			return Read(index) && GetString(index, str);
+		}
+
+		size_t GetRemaining() const { return m_size - m_offset; }
+
+	private:
+		const char*                   m_data = nullptr;
+		size_t                        m_size = 0;
+		size_t                        m_offset = 0;
+		std::vector<std::string_view> m_strings;
+	};
+} // namespace
+
 fileMapData::TileGrid::TileGrid(size_t width, size_t height, size_t length, float spacing, Tile fill)
 	: Grid<Tile>(width, height, length, spacing, fill)
 {
@@ -52,6 +226,12 @@ void fileMapData::TileGrid::SetTileDataBase64(std::string data)
 	}
 }
 
+void fileMapData::TileGrid::SetTileData(const Tile* tiles, size_t count)
+{
+	assert(count == m_grid.size());
+	std::copy(tiles, tiles + count, m_grid.begin());
+}
+
 fileMapData::Ent::Ent(float radius)
 {
 	active = true;
@@ -91,11 +271,74 @@ fileMapData::EntGrid::EntGrid(size_t width, size_t height, size_t length)
 
 bool LoaderMapData::Setup(std::filesystem::path filePath)
 {
-	using namespace nlohmann;
-
 	filePath = "GameData/Maps/" / filePath;
+	const std::filesystem::path compiledPath = std::filesystem::path(filePath).replace_extension(COMPILED_MAP_EXTENSION);
+
+	// the compiled map is used while it is at least as new as the source, when there is no source at all, or when
+	// either of them comes from an asset pack and has no timestamp to compare
+	std::error_code ec;
+	bool compiledIsFresh = false;
+	if (FileExists(compiledPath))
+	{
+		if (!std::filesystem::exists(compiledPath, ec) || !std::filesystem::exists(filePath, ec))
+			compiledIsFresh = true;
+		else
+			compiledIsFresh = std::filesystem::last_write_time(compiledPath, ec) >= std::filesystem::last_write_time(filePath, ec) && !ec;
+	}
+
+	Clock clock;
+	if (compiledIsFresh)
+	{
+		if (loadCompiled(compiledPath))
+		{
+			Print("Loaded compiled map '" + compiledPath.string() + "' in " + std::to_string(clock.GetElapsedTime().AsMicroseconds()) + " us");
+			return true;
+		}
+		Warning("Compiled map '" + compiledPath.string() + "' is invalid or outdated, recompiling from source.");
+		clock.Restart();
+	}
+
+	if (!loadSource(filePath)) return false;
+	Print("Parsed map '" + filePath.string() + "' in " + std::to_string(clock.GetElapsedTime().AsMicroseconds()) + " us");
+
+	if (!saveCompiled(compiledPath))
+		Warning("Failed to write compiled map '" + compiledPath.string() + "'.");
+	return true;
+}
+
+void LoaderMapData::Shutdown()
+{
+}
+
+bool LoaderMapData::Load(const std::filesystem::path& filePath)
+{
+	if (filePath.extension() == COMPILED_MAP_EXTENSION) return loadCompiled(filePath);
+	return loadSource(filePath);
+}
 
-	std::ifstream file(filePath);
+bool LoaderMapData::CompileMap(const std::filesystem::path& sourcePath, const std::filesystem::path& compiledPath)
+{
+	LoaderMapData mapData;
+	if (!mapData.loadSource(sourcePath)) return false;
+	if (!mapData.saveCompiled(compiledPath))
+	{
+		Error("Failed to write compiled map '" + compiledPath.string() + "'.");
+		return false;
+	}
+	return true;
+}
+
+bool LoaderMapData::loadSource(const std::filesystem::path& filePath)
+{
+	using namespace nlohmann;
+
+	FileStream fileStream;
+	if (!fileStream.Open(filePath))
+	{
+		Error("Failed to open map '" + filePath.string() + "'.");
+		return false;
+	}
+	std::istream file(&fileStream);
 	json jsonData;
 	file >> jsonData;
 
@@ -139,9 +382,140 @@ bool LoaderMapData::Setup(std::filesystem::path filePath)
 		json::array_t rotArr = jsonData["editorCamera"]["eulerAngles"];
 		m_defaultCameraAngles = glm::vec3{(float)rotArr[0] * DEG2RAD, (float)rotArr[1] * DEG2RAD, (float)rotArr[2] * DEG2RAD};
 	}
+	else
+	{
+		m_defaultCameraPosition = glm::vec3(0.0f);
+		m_defaultCameraAngles = glm::vec3(0.0f);
+	}
 	return true;
 }
 
-void LoaderMapData::Shutdown()
+bool LoaderMapData::loadCompiled(const std::filesystem::path& filePath)
+{
+	MappedFile file;
+	if (!file.Open(filePath) || file.GetLength() < sizeof(CompiledMapHeader)) return false;
+
+	CompiledMapHeader header;
+	memcpy(&header, file.GetData(), sizeof(header));
+	if (header.magic != CompiledMapMagic || header.version != CompiledMapVersion) return false;
+	if (header.payloadSize != file.GetLength() - sizeof(header)) return false;
+
+	const char* payload = file.GetData() + sizeof(header);
+	if (XXH64(payload, header.payloadSize, CompiledMapSeed) != header.checksum) return false;
+
+	CompiledMapReader reader(payload, header.payloadSize);
+	if (!reader.ReadStringTable()) return false;
+
+	auto readPaths = [&reader](std::vector<std::filesystem::path>& paths)
+		{
+			uint32_t count = 0;
+			if (!reader.Read(count) || count > reader.GetRemaining() / sizeof(uint32_t)) return false;
+			paths.resize(count);
+			for (auto& path : paths)
+			{
+				std::string_view str;
+				if (!reader.ReadString(str)) return false;
+				path = str;
+			}
+			return true;
+		};
+	if (!readPaths(m_texturePaths) || !readPaths(m_modelPaths)) return false;
+
+	uint32_t width = 0, height = 0, length = 0;
+	float spacing = 0.0f;
+	if (!reader.Read(width) || !reader.Read(height) || !reader.Read(length) || !reader.Read(spacing)) return false;
+
+	const size_t tileCount = static_cast<size_t>(width) * height * length;
+	if (tileCount > reader.GetRemaining() / sizeof(fileMapData::Tile)) return false;
+	std::vector<fileMapData::Tile> tiles(tileCount);
+	if (!reader.ReadBytes(tiles.data(), tileCount * sizeof(fileMapData::Tile))) return false;
+	m_tileGrid = fileMapData::TileGrid(width, height, length, spacing, fileMapData::Tile());
+	m_tileGrid.SetTileData(tiles.data(), tiles.size());
+
+	if (!reader.Read(m_defaultCameraPosition) || !reader.Read(m_defaultCameraAngles)) return false;
+
+	uint32_t entCount = 0;
+	if (!reader.Read(entCount)) return false;
+	m_entGrid = fileMapData::EntGrid(width, height, length);
+	for (uint32_t i = 0; i < entCount; i++)
+	{
+		CompiledEnt record;
+		if (!reader.Read(record)) return false;
+
+		fileMapData::Ent ent(record.radius);
+		ent.display = static_cast<fileMapData::Ent::DisplayMode>(record.display);
+		ent.color = Color(record.color);
+		ent.position = glm::vec3{ record.position[0], record.position[1], record.position[2] };
+		ent.yaw = record.yaw;
+		ent.pitch = record.pitch;
+
+		std::string_view model, texture;
+		if (!reader.GetString(record.model, model) || !reader.GetString(record.texture, texture)) return false;
+		ent.model = model;
+		ent.texture = texture;
+
+		for (uint32_t p = 0; p < record.propertyCount; p++)
+		{
+			std::string_view key, value;
+			if (!reader.ReadString(key) || !reader.ReadString(value)) return false;
+			ent.properties.emplace(key, value);
+		}
+
+		const glm::vec3 gridPos = m_entGrid.WorldToGridPos(ent.position);
+		m_entGrid.AddEnt((int)gridPos.x, (int)gridPos.y, (int)gridPos.z, std::move(ent));
+	}
+
+	return reader.GetRemaining() == 0;
+}
+
+bool LoaderMapData::saveCompiled(const std::filesystem::path& filePath) const
 {
+	CompiledMapWriter writer;
+
+	auto writePaths = [&writer](const std::vector<std::filesystem::path>& paths)
+		{
+			writer.Write(static_cast<uint32_t>(paths.size()));
+			for (const auto& path : paths)
+				writer.Write(writer.AddString(path.string()));
+		};
+	writePaths(m_texturePaths);
+	writePaths(m_modelPaths);
+
+	writer.Write(static_cast<uint32_t>(m_tileGrid.GetWidth()));
+	writer.Write(static_cast<uint32_t>(m_tileGrid.GetHeight()));
+	writer.Write(static_cast<uint32_t>(m_tileGrid.GetLength()));
+	writer.Write(m_tileGrid.GetSpacing());
+	const size_t tileCount = m_tileGrid.GetWidth() * m_tileGrid.GetHeight() * m_tileGrid.GetLength();
+	for (size_t i = 0; i < tileCount; i++)
+		writer.Write(m_tileGrid.GetTile(static_cast<int>(i)));
+
+	writer.Write(m_defaultCameraPosition);
+	writer.Write(m_defaultCameraAngles);
+
+	const std::vector<fileMapData::Ent> ents = m_entGrid.GetEntList();
+	writer.Write(static_cast<uint32_t>(ents.size()));
+	for (const fileMapData::Ent& ent : ents)
+	{
+		CompiledEnt record;
+		record.display = static_cast<uint32_t>(ent.display);
+		record.color = ent.color.DWColor();
+		record.radius = ent.radius;
+		record.position[0] = ent.position.x;
+		record.position[1] = ent.position.y;
+		record.position[2] = ent.position.z;
+		record.yaw = ent.yaw;
+		record.pitch = ent.pitch;
+		record.model = writer.AddString(ent.model);
+		record.texture = writer.AddString(ent.texture);
+		record.propertyCount = static_cast<uint32_t>(ent.properties.size());
+		writer.Write(record);
+
+		for (const auto& [key, value] : ent.properties)
+		{
+			writer.Write(writer.AddString(key));
+			writer.Write(writer.AddString(value));
+		}
+	}
+
+	return writer.Save(filePath);
 }
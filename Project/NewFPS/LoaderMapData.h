@@ -192,6 +192,9 @@ namespace fileMapData
 
 		//Assigns tiles based on the binary data encoded in base 64. Assumes that the sizes of the data and the current grid are the same.
 		void SetTileDataBase64(std::string data);
+
+		//Assigns tiles from a flat array in FlatIndex order. The count must match the size of the grid.
+		void SetTileData(const Tile* tiles, size_t count);
 	};
 
 	//This is short for "entity", because "entity" is difficult to type.
@@ -290,12 +293,21 @@ namespace fileMapData
 	};
 }
 
+// Compiled maps are written next to the .te3 source and rebuilt whenever the source is newer.
+constexpr auto COMPILED_MAP_EXTENSION = ".te3c";
+
 class LoaderMapData final
 {
 public:
 	bool Setup(std::filesystem::path filePath);
 	void Shutdown();
 
+	// Loads a .te3 or .te3c file as is, without looking for or writing the compiled map.
+	bool Load(const std::filesystem::path& filePath);
+
+	// Parses a .te3 map and writes it in the compiled binary format.
+	static bool CompileMap(const std::filesystem::path& sourcePath, const std::filesystem::path& compiledPath);
+
 	const std::vector<std::filesystem::path>& GetTexturePaths() const { return m_texturePaths; }
 	const std::vector<std::filesystem::path>& GetModelPaths() const { return m_modelPaths; }
 
@@ -306,6 +318,10 @@ public:
 	const glm::vec3& GetCameraAngles() const { return m_defaultCameraAngles; }
 
 private:
+	bool loadSource(const std::filesystem::path& filePath);
+	bool loadCompiled(const std::filesystem::path& filePath);
+	bool saveCompiled(const std::filesystem::path& filePath) const;
+
 	std::vector<std::filesystem::path> m_texturePaths;
 	std::vector<std::filesystem::path> m_modelPaths;
 
@@ -0,0 +1,287 @@
+﻿#include "stdafx.h"
+#include "MapGeometry.h"
+
+namespace
+{
+	// Grid offset of the neighbour on each side, indexed by fileMapData::Direction
+	const glm::ivec3 SideOffsets[6] = {
+		{ 0, 0, 1 },  // Z_POS
+		{ 0, 0, -1 }, // Z_NEG
+		{ 1, 0, 0 },  // X_POS
+		{ -1, 0, 0 }, // X_NEG
+		{ 0, 1, 0 },  // Y_POS
+		{ 0, -1, 0 }, // Y_NEG
+	};
+
+	uint8_t SideBit(int side)
+	{
+		return static_cast<uint8_t>(1u << side);
+	}
+
+	int OppositeSide(int side)
+	{
+		return side ^ 1; // Directions come in POS/NEG pairs
+	}
+
+	// Returns the cell side the triangle lies on, or -1. Triangles of shapes taller than a cell can lie on the plane of
+	// a side and reach past it, they don't belong to the side: they are never hidden and don't cover it.
+	int ClassifyTriangle(const float3& p0, const float3& p1, const float3& p2, float halfSpacing)
+	{
+		constexpr float Epsilon = 1e-3f;
+
+		const float3 extent = glm::max(glm::abs(p0), glm::max(glm::abs(p1), glm::abs(p2)));
+		for (int side = 0; side < 6; side++)
+		{
+			const int axis = SideOffsets[side].x != 0 ? 0 : (SideOffsets[side].y != 0 ? 1 : 2);
+			const float sign = static_cast<float>(SideOffsets[side][axis]);
+			const float plane = sign * halfSpacing;
+
+			if (glm::abs(p0[axis] - plane) < Epsilon && glm::abs(p1[axis] - plane) < Epsilon && glm::abs(p2[axis] - plane) < Epsilon)
+				return (extent[(axis + 1) % 3] < halfSpacing + Epsilon && extent[(axis + 2) % 3] < halfSpacing + Epsilon) ? side : -1;
+		}
+		return -1;
+	}
+} // namespace
+
+bool MapGeometry::Build(const LoaderMapData& mapData, const MapGeometryCreateInfo& createInfo)
+{
+	Clear();
+
+	const auto& tileGrid = mapData.GetTileGrid();
+	const auto& tileModelFileName = mapData.GetModelPaths();
+	const auto& tileTextureFileName = mapData.GetTexturePaths();
+
+	// every shape is parsed once and then transformed for each tile that uses it
+	const vkr::TriMeshOptions options = vkr::TriMeshOptions()
+		.Indices()
+		.VertexColors()
+		.Normals()
+		.TexCoords()
+		.ObjectColor(float3(1.0f, 1.0f, 1.0f));
+
+	assignTextureLayers(tileTextureFileName);
+
+	m_shapes.resize(tileModelFileName.size());
+	for (size_t i = 0; i < tileModelFileName.size(); i++)
+	{
+		if (Failed(vkr::TriMesh::CreateFromOBJ(tileModelFileName[i], options, &m_shapes[i])))
+		{
+			Error("Failed to load tile shape: " + tileModelFileName[i].string());
+			return false;
+		}
+	}
+
+	const int chunkSize = static_cast<int>(std::max(createInfo.chunkSize, 1u));
+	const glm::ivec3 gridSize = { tileGrid.GetWidth(), tileGrid.GetHeight(), tileGrid.GetLength() };
+	const glm::ivec3 chunkCount = (gridSize + chunkSize - 1) / chunkSize;
+
+	// chunk grid cell -> index in m_chunks, chunks without tiles are never created
+	std::vector<int> chunkIndices(static_cast<size_t>(chunkCount.x) * chunkCount.y * chunkCount.z, -1);
+
+	for (int x = 0; x < gridSize.x; x++)
+	{
+		for (int y = 0; y < gridSize.y; y++)
+		{
+			for (int z = 0; z < gridSize.z; z++)
+			{
+				const fileMapData::Tile tile = tileGrid.GetTile(x, y, z);
+				if (!tile) continue;
+				if (tile.shape >= static_cast<int>(m_shapes.size()) || tile.texture >= static_cast<int>(tileTextureFileName.size()))
+				{
+					Warning("Map tile (" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ") references a missing shape or texture.");
+					continue;
+				}
+
+				const glm::ivec3 coord = glm::ivec3(x, y, z) / chunkSize;
+				const size_t chunkCell = static_cast<size_t>(coord.x) + static_cast<size_t>(coord.y) * chunkCount.x + static_cast<size_t>(coord.z) * chunkCount.x * chunkCount.y;
+				if (chunkIndices[chunkCell] < 0)
+				{
+					chunkIndices[chunkCell] = static_cast<int>(m_chunks.size());
+					m_chunks.emplace_back().coord = coord;
+				}
+				MapChunk& chunk = m_chunks[chunkIndices[chunkCell]];
+
+				const OrientedShape& shape = getOrientedShape(tile, tileGrid.GetSpacing());
+				const uint8_t hiddenSides = createInfo.removeHiddenFaces ? getHiddenSides(tileGrid, x, y, z) : 0;
+				m_hiddenTriangleCount += appendTile(shape, hiddenSides, float3{ x, y, z } * tileGrid.GetSpacing(), m_textureLayers[tile.texture], chunk.mesh);
+			}
+		}
+	}
+
+	// fully enclosed tiles can leave whole chunks without triangles
+	std::erase_if(m_chunks, [](const MapChunk& chunk) { return chunk.mesh.GetCountTriangles() == 0; });
+	for (MapChunk& chunk : m_chunks)
+		chunk.bounds.Set(chunk.mesh.GetBoundingBoxMin(), chunk.mesh.GetBoundingBoxMax());
+
+	return true;
+}
+
+void MapGeometry::Clear()
+{
+	m_chunks.clear();
+	m_layerTextures.clear();
+	m_layerIndices.clear();
+	m_textureLayers.clear();
+	m_orientedShapes.clear();
+	m_shapes.clear();
+	m_hiddenTriangleCount = 0;
+}
+
+int MapGeometry::GetTextureLayer(const std::filesystem::path& textureFileName) const
+{
+	auto it = m_layerIndices.find(textureFileName.string());
+	return it != m_layerIndices.end() ? static_cast<int>(it->second) : -1;
+}
+
+uint32_t MapGeometry::GetTriangleCount() const
+{
+	uint32_t count = 0;
+	for (const MapChunk& chunk : m_chunks)
+		count += chunk.GetTriangleCount();
+	return count;
+}
+
+void MapGeometry::PrintStats() const
+{
+	const uint32_t triangleCount = GetTriangleCount();
+	Print("Map geometry: " + std::to_string(m_chunks.size()) + " chunks, " + std::to_string(m_layerTextures.size()) + " texture layers, "
+		+ std::to_string(triangleCount + m_hiddenTriangleCount) + " triangles before hidden face removal, " + std::to_string(triangleCount) + " after");
+	for (const MapChunk& chunk : m_chunks)
+	{
+		Print("    chunk (" + std::to_string(chunk.coord.x) + ", " + std::to_string(chunk.coord.y) + ", " + std::to_string(chunk.coord.z) + "): "
+			+ std::to_string(chunk.GetTriangleCount()) + " triangles");
+	}
+}
+
+const MapGeometry::OrientedShape& MapGeometry::getOrientedShape(const fileMapData::Tile& tile, float spacing)
+{
+	const auto key = std::make_tuple(tile.shape, tile.angle, tile.pitch);
+	auto it = m_orientedShapes.find(key);
+	if (it != m_orientedShapes.end()) return it->second;
+
+	OrientedShape& oriented = m_orientedShapes[key];
+	oriented.mesh = vkr::TriMesh(vkr::IndexType::Uint32, vkr::TRI_MESH_ATTRIBUTE_DIM_2);
+
+	// same transform order as TriMeshOptions in TriMesh::CreateFromOBJ: yaw, then pitch
+	const float yaw = glm::radians(float(-tile.angle));
+	const float pitch = glm::radians(float(-tile.pitch));
+
+	const vkr::TriMesh& shape = m_shapes[tile.shape];
+	for (uint32_t i = 0; i < shape.GetCountPositions(); i++)
+	{
+		float3 position = *shape.GetDataPositions(i);
+		float3 normal = *shape.GetDataNormalls(i);
+		if (yaw != 0.0f)
+		{
+			position = glm::rotateY(position, yaw);
+			normal = glm::normalize(glm::rotateY(normal, yaw));
+		}
+		if (pitch != 0.0f)
+		{
+			position = glm::rotateX(position, pitch);
+			normal = glm::normalize(glm::rotateX(normal, pitch));
+		}
+
+		oriented.mesh.AppendPosition(position);
+		oriented.mesh.AppendColor(*shape.GetDataColors(i));
+		oriented.mesh.AppendNormal(normal);
+		oriented.mesh.AppendTexCoord(*shape.GetDataTexCoords2(i));
+	}
+
+	// face occupancy: a side is solid when the triangles lying on it cover its whole area
+	const float halfSpacing = spacing / 2.0f;
+	float sideArea[6] = {};
+	oriented.triangleSides.resize(shape.GetCountTriangles(), -1);
+	for (uint32_t i = 0; i < shape.GetCountTriangles(); i++)
+	{
+		uint32_t v0, v1, v2;
+		shape.GetTriangle(i, v0, v1, v2);
+		oriented.mesh.AppendTriangle(v0, v1, v2);
+
+		const float3& p0 = *oriented.mesh.GetDataPositions(v0);
+		const float3& p1 = *oriented.mesh.GetDataPositions(v1);
+		const float3& p2 = *oriented.mesh.GetDataPositions(v2);
+		const int side = ClassifyTriangle(p0, p1, p2, halfSpacing);
+		oriented.triangleSides[i] = static_cast<int8_t>(side);
+		if (side >= 0)
+			sideArea[side] += 0.5f * glm::length(glm::cross(p1 - p0, p2 - p0));
+	}
+
+	for (int side = 0; side < 6; side++)
+	{
+		if (sideArea[side] >= spacing * spacing * 0.999f)
+			oriented.solidSides |= SideBit(side);
+	}
+
+	return oriented;
+}
+
+uint8_t MapGeometry::getHiddenSides(const fileMapData::TileGrid& tileGrid, int x, int y, int z)
+{
+	const glm::ivec3 gridSize = { tileGrid.GetWidth(), tileGrid.GetHeight(), tileGrid.GetLength() };
+
+	uint8_t hiddenSides = 0;
+	for (int side = 0; side < 6; side++)
+	{
+		const glm::ivec3 neighbour = glm::ivec3(x, y, z) + SideOffsets[side];
+		if (glm::any(glm::lessThan(neighbour, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(neighbour, gridSize)))
+			continue;
+
+		const fileMapData::Tile tile = tileGrid.GetTile(neighbour.x, neighbour.y, neighbour.z);
+		if (!tile || tile.shape >= static_cast<int>(m_shapes.size()))
+			continue;
+
+		if (getOrientedShape(tile, tileGrid.GetSpacing()).solidSides & SideBit(OppositeSide(side)))
+			hiddenSides |= SideBit(side);
+	}
+	return hiddenSides;
+}
+
+uint32_t MapGeometry::appendTile(const OrientedShape& shape, uint8_t hiddenSides, const float3& translate, uint32_t layer, vkr::TriMesh& mesh) const
+{
+	// shape vertex -> mesh vertex, vertices of hidden triangles are not copied
+	std::vector<uint32_t> remap(shape.mesh.GetCountPositions(), UINT32_MAX);
+	auto appendVertex = [&](uint32_t index)
+		{
+			if (remap[index] == UINT32_MAX)
+			{
+				remap[index] = mesh.AppendPosition(*shape.mesh.GetDataPositions(index) + translate) - 1;
+				mesh.AppendColor(*shape.mesh.GetDataColors(index));
+				mesh.AppendNormal(*shape.mesh.GetDataNormalls(index));
+				const float2& uv = *shape.mesh.GetDataTexCoords2(index);
+				mesh.AppendTexCoord(float3(uv, static_cast<float>(layer)));
+			}
+			return remap[index];
+		};
+
+	uint32_t hiddenCount = 0;
+	for (uint32_t i = 0; i < shape.mesh.GetCountTriangles(); i++)
+	{
+		const int side = shape.triangleSides[i];
+		if (side >= 0 && (hiddenSides & SideBit(side)))
+		{
+			hiddenCount++;
+			continue;
+		}
+
+		uint32_t v0, v1, v2;
+		shape.mesh.GetTriangle(i, v0, v1, v2);
+		const uint32_t i0 = appendVertex(v0);
+		const uint32_t i1 = appendVertex(v1);
+		const uint32_t i2 = appendVertex(v2);
+		mesh.AppendTriangle(i0, i1, i2);
+	}
+	return hiddenCount;
+}
+
+void MapGeometry::assignTextureLayers(const std::vector<std::filesystem::path>& texturePaths)
+{
+	// several texture slots of a map can point at the same file, they share one layer
+	m_textureLayers.resize(texturePaths.size());
+	for (size_t i = 0; i < texturePaths.size(); i++)
+	{
+		auto [it, inserted] = m_layerIndices.try_emplace(texturePaths[i].string(), static_cast<uint32_t>(m_layerTextures.size()));
+		if (inserted) m_layerTextures.push_back(texturePaths[i]);
+		m_textureLayers[i] = it->second;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "LoaderMapData.h"
+
+struct MapGeometryCreateInfo final
+{
+	uint32_t chunkSize = 16;           // Edge length of a chunk in tiles
+	bool     removeHiddenFaces = true; // Drop tile faces that are completely covered by a solid neighbour
+};
+
+// Fixed-size block of map tiles. Every chunk is culled, drawn and collided on its own.
+struct MapChunk final
+{
+	uint32_t GetTriangleCount() const { return mesh.GetCountTriangles(); }
+
+	glm::ivec3   coord = glm::ivec3(0); // Position of the chunk in the tile grid, in chunks
+	AABB         bounds;                // Tight world space bounds of the chunk geometry
+	vkr::TriMesh mesh{ vkr::IndexType::Uint32, vkr::TRI_MESH_ATTRIBUTE_DIM_3 }; // Texcoord is (u, v, texture array layer)
+};
+
+// Builds the static map geometry from the tile grid, split into spatial chunks.
+// All map textures are assigned to layers of one texture array, so a chunk needs a single draw.
+class MapGeometry final
+{
+public:
+	bool Build(const LoaderMapData& mapData, const MapGeometryCreateInfo& createInfo);
+	void Clear();
+
+	const std::vector<MapChunk>& GetChunks() const { return m_chunks; }
+	const std::vector<std::filesystem::path>& GetLayerTextures() const { return m_layerTextures; } // Texture file per texture array layer
+
+	// Returns the texture array layer of the texture file, or -1 when the map doesn't use it.
+	int GetTextureLayer(const std::filesystem::path& textureFileName) const;
+	uint32_t GetTriangleCount() const;
+	uint32_t GetHiddenTriangleCount() const { return m_hiddenTriangleCount; }
+
+	// Logs the chunk count and triangle totals of every chunk.
+	void PrintStats() const;
+
+private:
+	// A tile shape rotated into one tile orientation, with face occupancy of its cell sides.
+	struct OrientedShape final
+	{
+		vkr::TriMesh        mesh;              // Cell centered at the origin
+		std::vector<int8_t> triangleSides;     // fileMapData::Direction of the cell side each triangle lies on, -1 for inner triangles
+		uint8_t             solidSides = 0;    // Bit per fileMapData::Direction, set when the shape covers the whole side
+	};
+
+	const OrientedShape& getOrientedShape(const fileMapData::Tile& tile, float spacing);
+	uint8_t getHiddenSides(const fileMapData::TileGrid& tileGrid, int x, int y, int z);
+	uint32_t appendTile(const OrientedShape& shape, uint8_t hiddenSides, const float3& translate, uint32_t layer, vkr::TriMesh& mesh) const;
+	void assignTextureLayers(const std::vector<std::filesystem::path>& texturePaths);
+
+	std::vector<vkr::TriMesh>                          m_shapes; // Tile shapes in model space, indexed by ModelID
+	std::map<std::tuple<int, int, int>, OrientedShape> m_orientedShapes; // Keyed by (shape, angle, pitch)
+	std::vector<MapChunk>                              m_chunks;
+	std::vector<std::filesystem::path>                 m_layerTextures;
+	std::unordered_map<std::string, uint32_t>          m_layerIndices;   // Texture file name -> layer
+	std::vector<uint32_t>                              m_textureLayers;  // TexID -> layer
+	uint32_t                                           m_hiddenTriangleCount = 0;
+};
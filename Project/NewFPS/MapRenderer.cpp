@@ -0,0 +1,385 @@
+#include "stdafx.h"
+#include "MapRenderer.h"
+#include "Light.h"
+#include "GameApp.h"
+
+// Same layout as the scene data of GameEntity, the map is drawn with an identity model matrix
+struct MapSceneData final
+{
+	float4x4 ModelMatrix;
+	float4x4 NormalMatrix;
+	float4   Ambient;
+	float4x4 CameraViewProjectionMatrix;
+	float4   LightPosition;
+	float4x4 LightViewProjectionMatrix;
+	uint4    UsePCF;
+};
+
+namespace
+{
+	// Geometry::Create(TriMesh) only knows 2 component texcoords, the layer is copied through the planar buffers directly
+	Result CreateChunkGeometry(const vkr::TriMesh& mesh, vkr::Geometry* pGeometry)
+	{
+		vkr::GeometryCreateInfo createInfo = {};
+		createInfo.vertexAttributeLayout = vkr::GEOMETRY_VERTEX_ATTRIBUTE_LAYOUT_PLANAR;
+		createInfo.indexType = vkr::IndexType::Uint32;
+		createInfo.primitiveTopology = vkr::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		createInfo.AddPosition();
+		createInfo.AddColor();
+		createInfo.AddNormal();
+		createInfo.AddTexCoord(vkr::Format::R32G32B32_FLOAT);
+
+		Result ppxres = vkr::Geometry::Create(createInfo, pGeometry);
+		if (Failed(ppxres)) return ppxres;
+
+		// buffers are in the order the attributes were added
+		const uint32_t vertexCount = mesh.GetCountPositions();
+		pGeometry->GetVertexBuffer(0)->Append(vertexCount, mesh.GetDataPositions());
+		pGeometry->GetVertexBuffer(1)->Append(vertexCount, mesh.GetDataColors());
+		pGeometry->GetVertexBuffer(2)->Append(vertexCount, mesh.GetDataNormalls());
+		pGeometry->GetVertexBuffer(3)->Append(vertexCount, mesh.GetDataTexCoords3());
+		pGeometry->AppendIndicesU32(mesh.GetCountIndices(), mesh.GetDataIndicesU32());
+
+		return SUCCESS;
+	}
+} // namespace
+
+bool MapRenderer::Setup(GameApplication* game, const MapGeometry& geometry)
+{
+	m_game = game;
+	auto& device = m_game->GetRenderDevice();
+
+	if (!setupPipeline(device)) return false;
+	if (!setupTextureArray(device, geometry)) return false;
+	if (!setupDescriptors(device)) return false;
+	if (!setupChunks(device, geometry)) return false;
+
+	return true;
+}
+
+void MapRenderer::Shutdown()
+{
+	m_chunks.clear();
+	m_visibleChunkCount = 0;
+}
+
+void MapRenderer::UpdateUniformBuffer(const float4x4& viewProj, const DirectionalLight& mainLight, bool usePCF)
+{
+	MapSceneData scene = {};
+	scene.ModelMatrix = float4x4(1.0f);
+	scene.NormalMatrix = float4x4(1.0f);
+	scene.Ambient = float4(0.3f);
+	scene.CameraViewProjectionMatrix = viewProj;
+	scene.LightPosition = float4(mainLight.GetPosition(), 0);
+	scene.LightViewProjectionMatrix = mainLight.GetCamera().GetViewProjectionMatrix();
+	scene.UsePCF = uint4(usePCF);
+	m_drawUniformBuffer->CopyFromSource(sizeof(scene), &scene);
+
+	const float4x4 lightViewProj = mainLight.GetCamera().GetViewProjectionMatrix();
+	m_shadowUniformBuffer->CopyFromSource(sizeof(lightViewProj), &lightViewProj);
+}
+
+void MapRenderer::Draw(vkr::CommandBufferPtr cmd, const Frustum& frustum)
+{
+	m_visibleChunkCount = 0;
+	if (m_chunks.empty()) return;
+
+	cmd->BindGraphicsPipeline(m_pipeline);
+	cmd->BindGraphicsDescriptorSets(m_pipelineInterface, 1, &m_drawDescriptorSet);
+	for (const ChunkMesh& chunk : m_chunks)
+	{
+		if (!frustum.Intersects(chunk.bounds)) continue;
+
+		m_visibleChunkCount++;
+		cmd->BindIndexBuffer(chunk.mesh);
+		cmd->BindVertexBuffers(chunk.mesh);
+		cmd->DrawIndexed(chunk.mesh->GetIndexCount());
+	}
+}
+
+void MapRenderer::DrawShadow(vkr::CommandBufferPtr cmd, const vkr::PipelineInterface* pPipelineInterface) const
+{
+	if (m_chunks.empty()) return;
+
+	const vkr::DescriptorSet* pShadowSet = m_shadowDescriptorSet;
+	cmd->BindGraphicsDescriptorSets(pPipelineInterface, 1, &pShadowSet);
+	for (const ChunkMesh& chunk : m_chunks)
+	{
+		cmd->BindIndexBuffer(chunk.mesh);
+		cmd->BindVertexBuffers(chunk.mesh);
+		cmd->DrawIndexed(chunk.mesh->GetIndexCount());
+	}
+}
+
+bool MapRenderer::setupPipeline(vkr::RenderDevice& device)
+{
+	auto& swapChain = m_game->GetRender().GetSwapChain();
+
+	// Descriptor set layout, same bindings as entities but the diffuse texture is an array
+	{
+		vkr::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+		layoutCreateInfo.bindings.push_back(vkr::DescriptorBinding{ 0, vkr::DescriptorType::UniformBuffer, 1, vkr::SHADER_STAGE_ALL_GRAPHICS });
+		layoutCreateInfo.bindings.push_back(vkr::DescriptorBinding{ 1, vkr::DescriptorType::SampledImage, 1, vkr::SHADER_STAGE_PS });
+		layoutCreateInfo.bindings.push_back(vkr::DescriptorBinding{ 2, vkr::DescriptorType::Sampler, 1, vkr::SHADER_STAGE_PS });
+		layoutCreateInfo.bindings.push_back(vkr::DescriptorBinding{ 3, vkr::DescriptorType::SampledImage, 1, vkr::SHADER_STAGE_PS });
+		layoutCreateInfo.bindings.push_back(vkr::DescriptorBinding{ 4, vkr::DescriptorType::Sampler, 1, vkr::SHADER_STAGE_PS });
+
+		CHECKED_CALL_AND_RETURN_FALSE(device.CreateDescriptorSetLayout(layoutCreateInfo, &m_drawSetLayout));
+	}
+
+	// Pipeline interface
+	vkr::PipelineInterfaceCreateInfo piCreateInfo = {};
+	piCreateInfo.setCount = 1;
+	piCreateInfo.sets[0].set = 0;
+	piCreateInfo.sets[0].layout = m_drawSetLayout;
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreatePipelineInterface(piCreateInfo, &m_pipelineInterface));
+
+	// Pipeline
+	vkr::ShaderModulePtr VS;
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreateShader("GameData/Shaders", "MapDiffuseShadow.vs", &VS));
+	vkr::ShaderModulePtr PS;
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreateShader("GameData/Shaders", "MapDiffuseShadow.ps", &PS));
+
+	vkr::VertexAttribute vertexAttribute0 = {
+		.semanticName = "POSITION",
+		.location = 0,
+		.format = vkr::Format::R32G32B32_FLOAT,
+		.binding = 0,
+		.offset = 0,
+		.inputRate = vkr::VertexInputRate::Vertex,
+		.semantic = vkr::VertexSemantic::Position
+	};
+
+	vkr::VertexAttribute vertexAttribute1 = {
+		.semanticName = "COLOR",
+		.location = 1,
+		.format = vkr::Format::R32G32B32_FLOAT,
+		.binding = 1,
+		.offset = 0,
+		.inputRate = vkr::VertexInputRate::Vertex,
+		.semantic = vkr::VertexSemantic::Color
+	};
+
+	vkr::VertexAttribute vertexAttribute2 = {
+		.semanticName = "NORMAL",
+		.location = 2,
+		.format = vkr::Format::R32G32B32_FLOAT,
+		.binding = 2,
+		.offset = 0,
+		.inputRate = vkr::VertexInputRate::Vertex,
+		.semantic = vkr::VertexSemantic::Normal
+	};
+
+	// uv and texture array layer
+	vkr::VertexAttribute vertexAttribute3 = {
+		.semanticName = "TEXCOORD",
+		.location = 3,
+		.format = vkr::Format::R32G32B32_FLOAT,
+		.binding = 3,
+		.offset = 0,
+		.inputRate = vkr::VertexInputRate::Vertex,
+		.semantic = vkr::VertexSemantic::Texcoord
+	};
+
+	vkr::VertexBinding vertexBinding0{};
+	vertexBinding0.SetBinding(0);
+	vertexBinding0.SetStride(12);
+	vertexBinding0.AppendAttribute(vertexAttribute0);
+
+	vkr::VertexBinding vertexBinding1{};
+	vertexBinding1.SetBinding(1);
+	vertexBinding1.SetStride(12);
+	vertexBinding1.AppendAttribute(vertexAttribute1);
+
+	vkr::VertexBinding vertexBinding2{};
+	vertexBinding2.SetBinding(2);
+	vertexBinding2.SetStride(12);
+	vertexBinding2.AppendAttribute(vertexAttribute2);
+
+	vkr::VertexBinding vertexBinding3{};
+	vertexBinding3.SetBinding(3);
+	vertexBinding3.SetStride(12);
+	vertexBinding3.AppendAttribute(vertexAttribute3);
+
+	vkr::GraphicsPipelineCreateInfo2 gpCreateInfo   = {};
+	gpCreateInfo.VS                                 = { VS.Get(), "vsmain" };
+	gpCreateInfo.PS                                 = { PS.Get(), "psmain" };
+	gpCreateInfo.vertexInputState.bindingCount      = 4;
+	gpCreateInfo.vertexInputState.bindings[0]       = vertexBinding0;
+	gpCreateInfo.vertexInputState.bindings[1]       = vertexBinding1;
+	gpCreateInfo.vertexInputState.bindings[2]       = vertexBinding2;
+	gpCreateInfo.vertexInputState.bindings[3]       = vertexBinding3;
+	gpCreateInfo.topology                           = vkr::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	gpCreateInfo.polygonMode                        = vkr::POLYGON_MODE_FILL;
+	gpCreateInfo.cullMode                           = vkr::CULL_MODE_BACK;
+	gpCreateInfo.frontFace                          = vkr::FRONT_FACE_CCW;
+	gpCreateInfo.depthReadEnable                    = true;
+	gpCreateInfo.depthWriteEnable                   = true;
+	gpCreateInfo.blendModes[0]                      = vkr::BLEND_MODE_NONE;
+	gpCreateInfo.outputState.renderTargetCount      = 1;
+	gpCreateInfo.outputState.renderTargetFormats[0] = swapChain.GetColorFormat();
+	gpCreateInfo.outputState.depthStencilFormat     = swapChain.GetDepthFormat();
+	gpCreateInfo.pipelineInterface                  = m_pipelineInterface;
+
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreateGraphicsPipeline(gpCreateInfo, &m_pipeline));
+	device.DestroyShaderModule(VS);
+	device.DestroyShaderModule(PS);
+
+	return true;
+}
+
+bool MapRenderer::setupTextureArray(vkr::RenderDevice& device, const MapGeometry& geometry)
+{
+	const auto& layerTextures = geometry.GetLayerTextures();
+
+	// all layer files are read in one batch, each is decoded as soon as it arrives while the rest are still loading
+	std::vector<Bitmap> layers(std::max<size_t>(layerTextures.size(), 1));
+	std::vector<FileReadRequest> requests(layerTextures.size());
+	bool loaded = true;
+	for (size_t i = 0; i < layerTextures.size(); i++)
+	{
+		requests[i].path = layerTextures[i];
+		requests[i].onComplete = [&layers, &loaded, i](FileReadResult& file)
+			{
+				if (Failed(file.result) || Failed(Bitmap::LoadFromMemory(file.data.size(), file.data.data(), &layers[i])))
+				{
+					Error("Failed to load map texture: " + file.path.string());
+					loaded = false;
+				}
+			};
+	}
+	AsyncFileReader reader;
+	reader.Setup();
+	reader.Submit(requests);
+	reader.Wait();
+	if (!loaded) return false;
+
+	// every layer of an array has the same size, smaller textures are scaled up to the largest one
+	uint32_t width = 1, height = 1;
+	for (size_t i = 0; i < layerTextures.size(); i++)
+	{
+		width = std::max(width, layers[i].GetWidth());
+		height = std::max(height, layers[i].GetHeight());
+	}
+
+	for (size_t i = 0; i < layers.size(); i++)
+	{
+		if (layers[i].IsOk() && layers[i].GetWidth() == width && layers[i].GetHeight() == height)
+			continue;
+
+		Bitmap scaled = Bitmap::Create(width, height, Bitmap::FORMAT_RGBA_UINT8);
+		if (layers[i].IsOk())
+		{
+			CHECKED_CALL_AND_RETURN_FALSE(layers[i].ScaleTo(&scaled));
+		}
+		else
+		{
+			scaled.Fill<uint8_t>(255, 255, 255, 255); // map without textures
+		}
+		layers[i] = scaled;
+	}
+
+	vkr::vkrUtil::ImageOptions options = vkr::vkrUtil::ImageOptions().MipLevelCount(RemainingMipLevels);
+	CHECKED_CALL_AND_RETURN_FALSE(vkr::vkrUtil::CreateImageArrayFromBitmaps(device.GetGraphicsQueue(), static_cast<uint32_t>(layers.size()), layers.data(), &m_textureArray, options));
+
+	// a single layer image would be guessed as a plain 2D view
+	vkr::SampledImageViewCreateInfo viewCreateInfo = vkr::SampledImageViewCreateInfo::GuessFromImage(m_textureArray);
+	viewCreateInfo.imageViewType = vkr::ImageViewType::ImageView2DArray;
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreateSampledImageView(viewCreateInfo, &m_textureArrayView));
+
+	vkr::SamplerCreateInfo samplerCreateInfo = {};
+	samplerCreateInfo.magFilter = vkr::Filter::Nearest;
+	samplerCreateInfo.minFilter = vkr::Filter::Nearest;
+	samplerCreateInfo.mipmapMode = vkr::SamplerMipmapMode::Nearest;
+	samplerCreateInfo.minLod = 0;
+	samplerCreateInfo.maxLod = FLT_MAX;
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreateSampler(samplerCreateInfo, &m_sampler));
+
+	return true;
+}
+
+bool MapRenderer::setupDescriptors(vkr::RenderDevice& device)
+{
+	auto& gameGraphics = m_game->GetGameGraphics();
+	vkr::DescriptorPoolPtr descriptorPool = gameGraphics.GetDescriptorPool();
+	ShadowPass& shadowPass = gameGraphics.GetShadowPass();
+
+	// Draw uniform buffer
+	vkr::BufferCreateInfo bufferCreateInfo = {};
+	bufferCreateInfo.size = RoundUp(512, vkr::CONSTANT_BUFFER_ALIGNMENT);
+	bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
+	bufferCreateInfo.memoryUsage = vkr::MemoryUsage::CPUToGPU;
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreateBuffer(bufferCreateInfo, &m_drawUniformBuffer));
+
+	// Shadow uniform buffer
+	bufferCreateInfo = {};
+	bufferCreateInfo.size = vkr::MINIMUM_UNIFORM_BUFFER_SIZE;
+	bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
+	bufferCreateInfo.memoryUsage = vkr::MemoryUsage::CPUToGPU;
+	CHECKED_CALL_AND_RETURN_FALSE(device.CreateBuffer(bufferCreateInfo, &m_shadowUniformBuffer));
+
+	CHECKED_CALL_AND_RETURN_FALSE(device.AllocateDescriptorSet(descriptorPool, m_drawSetLayout, &m_drawDescriptorSet));
+	CHECKED_CALL_AND_RETURN_FALSE(device.AllocateDescriptorSet(descriptorPool, shadowPass.GetDescriptorSetLayout(), &m_shadowDescriptorSet));
+
+	vkr::WriteDescriptor write = {};
+	write.binding = 0;
+	write.type = vkr::DescriptorType::UniformBuffer;
+	write.bufferOffset = 0;
+	write.bufferRange = WHOLE_SIZE;
+	write.buffer = m_shadowUniformBuffer;
+	CHECKED_CALL_AND_RETURN_FALSE(m_shadowDescriptorSet->UpdateDescriptors(1, &write));
+
+	vkr::WriteDescriptor writes[5] = {};
+	writes[0].binding = 0;
+	writes[0].type = vkr::DescriptorType::UniformBuffer;
+	writes[0].bufferOffset = 0;
+	writes[0].bufferRange = WHOLE_SIZE;
+	writes[0].buffer = m_drawUniformBuffer;
+	writes[1].binding = 1; // Shadow texture
+	writes[1].type = vkr::DescriptorType::SampledImage;
+	writes[1].imageView = shadowPass.GetSampledImageView();
+	writes[2].binding = 2; // Shadow sampler
+	writes[2].type = vkr::DescriptorType::Sampler;
+	writes[2].sampler = shadowPass.GetSampler();
+	writes[3].binding = 3; // Map texture array
+	writes[3].type = vkr::DescriptorType::SampledImage;
+	writes[3].imageView = m_textureArrayView;
+	writes[4].binding = 4; // Map sampler
+	writes[4].type = vkr::DescriptorType::Sampler;
+	writes[4].sampler = m_sampler;
+	CHECKED_CALL_AND_RETURN_FALSE(m_drawDescriptorSet->UpdateDescriptors(5, writes));
+
+	return true;
+}
+
+bool MapRenderer::setupChunks(vkr::RenderDevice& device, const MapGeometry& geometry)
+{
+	m_chunks.reserve(geometry.GetChunks().size());
+	for (const MapChunk& mapChunk : geometry.GetChunks())
+	{
+		ChunkMesh& chunk = m_chunks.emplace_back();
+		chunk.bounds = mapChunk.bounds;
+
+		vkr::Geometry geo;
+		CHECKED_CALL_AND_RETURN_FALSE(CreateChunkGeometry(mapChunk.mesh, &geo));
+		CHECKED_CALL_AND_RETURN_FALSE(vkr::vkrUtil::CreateMeshFromGeometry(device.GetGraphicsQueue(), &geo, &chunk.mesh));
+
+		// every chunk is a separate static collider
+		std::vector<glm::vec3> vertices(mapChunk.mesh.GetCountPositions());
+		for (uint32_t i = 0; i < mapChunk.mesh.GetCountPositions(); i++)
+			vertices[i] = *mapChunk.mesh.GetDataPositions(i);
+		std::vector<uint32_t> indices(mapChunk.mesh.GetCountIndices());
+		for (uint32_t i = 0; i < mapChunk.mesh.GetCountIndices(); i++)
+			indices[i] = *mapChunk.mesh.GetDataIndicesU32(i);
+
+		ph::StaticActorCreateInfo sbci{};
+		chunk.phBody = m_game->GetPhysicsScene().CreateStaticBody(sbci);
+
+		ph::MeshColliderCreateInfo mcci{};
+		mcci.vertices = vertices;
+		mcci.indices = indices;
+		chunk.phBody->AttachCollider(mcci);
+	}
+
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "MapGeometry.h"
+
+class GameApplication;
+class DirectionalLight;
+
+// Draws the static map: one pipeline, one descriptor set with all map textures in a texture array and one draw per chunk.
+class MapRenderer final
+{
+public:
+	bool Setup(GameApplication* game, const MapGeometry& geometry);
+	void Shutdown();
+
+	void UpdateUniformBuffer(const float4x4& viewProj, const DirectionalLight& mainLight, bool usePCF);
+	void Draw(vkr::CommandBufferPtr cmd, const Frustum& frustum);
+	void DrawShadow(vkr::CommandBufferPtr cmd, const vkr::PipelineInterface* pPipelineInterface) const;
+
+	size_t GetChunkCount() const { return m_chunks.size(); }
+	size_t GetVisibleChunkCount() const { return m_visibleChunkCount; }
+
+private:
+	struct ChunkMesh final
+	{
+		AABB               bounds;
+		vkr::MeshPtr       mesh;
+		ph::StaticActorPtr phBody;
+	};
+
+	bool setupPipeline(vkr::RenderDevice& device);
+	bool setupTextureArray(vkr::RenderDevice& device, const MapGeometry& geometry);
+	bool setupDescriptors(vkr::RenderDevice& device);
+	bool setupChunks(vkr::RenderDevice& device, const MapGeometry& geometry);
+
+	GameApplication*            m_game = nullptr;
+
+	vkr::DescriptorSetLayoutPtr m_drawSetLayout;
+	vkr::PipelineInterfacePtr   m_pipelineInterface;
+	vkr::GraphicsPipelinePtr    m_pipeline;
+
+	vkr::ImagePtr               m_textureArray;
+	vkr::SampledImageViewPtr    m_textureArrayView;
+	vkr::SamplerPtr             m_sampler;
+
+	vkr::BufferPtr              m_drawUniformBuffer;
+	vkr::DescriptorSetPtr       m_drawDescriptorSet;
+	vkr::BufferPtr              m_shadowUniformBuffer;
+	vkr::DescriptorSetPtr       m_shadowDescriptorSet;
+
+	std::vector<ChunkMesh>      m_chunks;
+	size_t                      m_visibleChunkCount = 0;
+};
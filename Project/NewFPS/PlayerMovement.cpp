@@ -35,7 +35,7 @@ bool PlayerMovement::Setup(GameApplication* game, Transform* playerTransform, co
 	ccci.radius = CAPSULE_RADIUS;
 	ccci.height = CAPSULE_HEIGHT;
 
-	m_controller = std::make_shared<ph::CharacterController>(*game, ccci);
+	m_controller = m_scene->CreateCharacterController(ccci);
 
 	m_position = position;
 	m_predictedPosition = position;
@@ -1,6 +1,7 @@
 ﻿#include "stdafx.h"
 #include "ShadowPass.h"
 #include "Entity.h"
+#include "MapRenderer.h"
 
 #define kShadowMapSize 1024
 
@@ -90,7 +91,7 @@ void ShadowPass::Shutdown()
 {
 }
 
-void ShadowPass::Draw(vkr::CommandBufferPtr cmd, const std::vector<GameEntity>& entities)
+void ShadowPass::Draw(vkr::CommandBufferPtr cmd, const std::vector<GameEntity>& entities, const MapRenderer& map)
 {
 	//  Render shadow pass
 	{
@@ -100,8 +101,12 @@ void ShadowPass::Draw(vkr::CommandBufferPtr cmd, const std::vector<GameEntity>&
 			cmd->SetScissors(mShadowRenderPass->GetScissor());
 			cmd->SetViewports(mShadowRenderPass->GetViewport());
 
-			// Draw entities
 			cmd->BindGraphicsPipeline(mShadowPipeline);
+
+			// Draw map
+			map.DrawShadow(cmd, mShadowPipelineInterface);
+
+			// Draw entities
 			for (size_t i = 0; i < entities.size(); ++i)
 			{
 				auto entity = entities[i];
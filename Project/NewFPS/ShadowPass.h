@@ -1,6 +1,7 @@
 #pragma once
 
 struct GameEntity;
+class MapRenderer;
 
 class ShadowPass final
 {
@@ -8,7 +9,7 @@ public:
 	bool Setup(vkr::RenderDevice& device);
 	void Shutdown();
 
-	void Draw(vkr::CommandBufferPtr cmd, const std::vector<GameEntity>& entities);
+	void Draw(vkr::CommandBufferPtr cmd, const std::vector<GameEntity>& entities, const MapRenderer& map);
 
 	vkr::DescriptorSetLayoutPtr GetDescriptorSetLayout() { return m_shadowSetLayout; }
 	vkr::SampledImageViewPtr GetSampledImageView() { return mShadowImageView; }
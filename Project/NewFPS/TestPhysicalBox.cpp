@@ -4,11 +4,14 @@
 
 bool TestPhysicalBox::Setup(GameApplication* game)
 {
-	auto& device = game->GetRenderDevice();
 	auto& phsystem = game->GetPhysicsSystem();
 	auto phscene = game->GetPhysicsScene();
 
+	// debug drawing, there is no device in a headless run
+	if (!game->IsHeadless())
 	{
+		auto& device = game->GetRenderDevice();
+
 		// Descriptor set layt
 		vkr::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
 		layoutCreateInfo.bindings.push_back(vkr::DescriptorBinding{ 0, vkr::DescriptorType::UniformBuffer, 1, vkr::SHADER_STAGE_ALL_GRAPHICS });
@@ -82,7 +85,7 @@ bool TestPhysicalBox::Setup(GameApplication* game)
 	// plane
 	{
 		ph::StaticActorCreateInfo sbci{};
-		plane = std::make_shared<ph::StaticBody>(*game, sbci);
+		plane = game->GetPhysicsScene().CreateStaticBody(sbci);
 
 		ph::BoxColliderCreateInfo bcci{};
 		bcci.extent = { 1000,1,1000 };
@@ -92,7 +95,7 @@ bool TestPhysicalBox::Setup(GameApplication* game)
 	// box
 	{
 		ph::RigidBodyCreateInfo rbci{};
-		rb = std::make_shared<ph::RigidBody>(*game, rbci);
+		rb = game->GetPhysicsScene().CreateRigidBody(rbci);
 
 		ph::BoxColliderCreateInfo bcci{};
 		bcci.extent = { 1,1,1 };
@@ -6,22 +6,25 @@ bool World::Setup(GameApplication* game, const WorldCreateInfo& createInfo)
 {
 	m_game = game;
 	if (!m_player.Setup(m_game, createInfo.player)) return false;
-	if (!m_mainLight.Setup(m_game)) return false;
+	if (!m_game->IsHeadless() && !m_mainLight.Setup(m_game)) return false;
 	if (!m_phBox.Setup(m_game)) return false;
 
-	if (!setupPipelineEntities()) return false;
+	if (!m_game->IsHeadless() && !setupPipelineEntities()) return false;
 
-	if (!loadMap(createInfo.startMapName)) return false;
+	if (!loadMap(createInfo.startMapName, createInfo.mapGeometry)) return false;
 
 	return true;
 }
 
 void World::Shutdown()
 {
+	m_mapRenderer.Shutdown();
+	m_mapGeometry.Clear();
 	m_mapData.Shutdown();
 	m_phBox.Shutdown();
 	m_mainLight.Shutdown();
 	m_player.Shutdown();
+	m_game->GetPhysicsScene().ReleaseAll();
 }
 
 void World::Update(float deltaTime)
@@ -48,11 +51,20 @@ void World::FixedUpdate(float fixedDeltaTime)
 
 void World::Draw(vkr::CommandBufferPtr cmd)
 {
+	const Frustum frustum(GetViewProjectionMatrix());
+
+	// Draw map
+	m_mapRenderer.Draw(cmd, frustum);
+
 	// Draw entities
+	m_visibleEntityCount = 0;
 	cmd->BindGraphicsPipeline(m_drawObjectPipeline);
 	for (size_t i = 0; i < m_entities.size(); ++i)
 	{
 		GameEntity& entity = m_entities[i];
+		if (!frustum.Intersects(entity.bounds)) continue;
+
+		m_visibleEntityCount++;
 		cmd->BindGraphicsDescriptorSets(m_drawObjectPipelineInterface, 1, &entity.drawDescriptorSet);
 		cmd->BindIndexBuffer(entity.mesh);
 		cmd->BindVertexBuffers(entity.mesh);
@@ -66,6 +78,8 @@ void World::Draw(vkr::CommandBufferPtr cmd)
 
 void World::UpdateUniformBuffer()
 {
+	m_mapRenderer.UpdateUniformBuffer(GetViewProjectionMatrix(), m_mainLight, m_game->GetGameGraphics().GetShadowPass().UsePCF());
+
 	for (size_t i = 0; i < m_entities.size(); ++i)
 	{
 		GameEntity& entity = m_entities[i];
@@ -251,73 +265,16 @@ bool World::addTestEntities()
 	return true;
 }
 
-bool World::loadMap(std::string_view mapFileName)
+bool World::loadMap(std::string_view mapFileName, const MapGeometryCreateInfo& createInfo)
 {
 	if (!m_mapData.Setup(mapFileName)) return false;
 	if (!addTestEntities()) return false;
 
-	auto& device = m_game->GetRenderDevice();
-	auto& gameGraphics = m_game->GetGameGraphics();
-	vkr::DescriptorPoolPtr descriptorPool = gameGraphics.GetDescriptorPool();
-	ShadowPass& shadowPassData = gameGraphics.GetShadowPass();
+	if (!m_mapGeometry.Build(m_mapData, createInfo)) return false;
+	m_mapGeometry.PrintStats();
 
-	vkr::TriMeshOptions options = vkr::TriMeshOptions()
-		.Indices()
-		.VertexColors()
-		.Normals()
-		.TexCoords();
-
-	const auto& tileGrid = m_mapData.GetTileGrid();
-	const auto& tileModelFileName = m_mapData.GetModelPaths();
-	const auto& tileTextureFileName = m_mapData.GetTexturePaths();
-			
-	for (size_t x = 0; x < tileGrid.GetWidth(); x++)
-	{
-		for (size_t y = 0; y < tileGrid.GetLength(); y++)
-		{
-			for (size_t z = 0; z < tileGrid.GetHeight(); z++)
-			{
-				auto tile = tileGrid.GetTile(x, z, y);
-				if (!tile) continue;
-
-				auto mesh = vkr::TriMesh::CreateFromOBJ(
-					tileModelFileName[tile.shape],
-					vkr::TriMeshOptions(options)
-					.ObjectColor(float3(1.0f, 1.0f, 1.0f))
-					.Translate(float3{ x, z, y } * tileGrid.GetSpacing())
-					.RotateX(glm::radians(float(-tile.pitch)))
-					.RotateY(glm::radians(float(-tile.angle)))
-				);
-
-				std::string textureName = tileTextureFileName[tile.texture].string();
-				bool isFind = false;
-				for (size_t i = 0; i < m_mapMeshes.size(); i++)
-				{
-					if (textureName == m_mapMeshes[i].diffuseTextureFileName)
-					{
-						isFind = true;
-						m_mapMeshes[i].mesh += mesh;
-						break;
-					}
-				}
-
-				if (!isFind)
-				{
-					MeshBild mb{};
-					mb.diffuseTextureFileName = textureName;
-					mb.mesh = mesh;
-					m_mapMeshes.emplace_back(mb);
-				}
-			}
-		}
-	}
-
-	for (size_t i = 0; i < m_mapMeshes.size(); i++)
-	{
-		GameEntity entity;
-		entity.Setup(m_game, device, m_mapMeshes[i].mesh, m_mapMeshes[i].diffuseTextureFileName, descriptorPool, m_drawObjectSetLayout, shadowPassData);
-		m_entities.emplace_back(entity);
-	}
+	// the whole map is drawn with one texture array, one draw per chunk. A headless run stops at the CPU side geometry
+	if (!m_game->IsHeadless() && !m_mapRenderer.Setup(m_game, m_mapGeometry)) return false;
 
 	return true;
 }
\ No newline at end of file
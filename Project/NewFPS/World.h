@@ -3,12 +3,15 @@
 #include "Player.h"
 #include "Light.h"
 #include "LoaderMapData.h"
+#include "MapGeometry.h"
+#include "MapRenderer.h"
 #include "TestPhysicalBox.h"
 
 struct WorldCreateInfo final
 {
 	PlayerCreateInfo player;
 	std::string_view startMapName = "test.te3";
+	MapGeometryCreateInfo mapGeometry;
 };
 
 class World final
@@ -28,11 +31,14 @@ public:
 	Player& GetPlayer() { return m_player; }
 	DirectionalLight& GetMainLight() { return m_mainLight; }
 	std::vector<GameEntity>& GetEntities() { return m_entities; }
+	const MapGeometry& GetMapGeometry() const { return m_mapGeometry; }
+	const MapRenderer& GetMapRenderer() const { return m_mapRenderer; }
+	size_t GetVisibleEntityCount() const { return m_visibleEntityCount; }
 
 private:
 	bool setupPipelineEntities();
 	bool addTestEntities();
-	bool loadMap(std::string_view mapFileName);
+	bool loadMap(std::string_view mapFileName, const MapGeometryCreateInfo& createInfo);
 
 	GameApplication* m_game;
 	Player m_player;
@@ -49,16 +55,12 @@ private:
 	vkr::PipelineInterfacePtr m_drawObjectPipelineInterface;
 	vkr::GraphicsPipelinePtr m_drawObjectPipeline;
 	std::vector<GameEntity> m_entities;
+	size_t m_visibleEntityCount = 0;
 
 	// Map
 	LoaderMapData m_mapData;
-
-	struct MeshBild final
-	{
-		vkr::TriMesh mesh;
-		std::string diffuseTextureFileName;
-	};
-	std::vector<MeshBild> m_mapMeshes;
+	MapGeometry m_mapGeometry;
+	MapRenderer m_mapRenderer;
 
 	TestPhysicalBox m_phBox;
 };
\ No newline at end of file
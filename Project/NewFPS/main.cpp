@@ -1,5 +1,6 @@
 ﻿#include "stdafx.h"
 #include "GameApp.h"
+#include "Benchmarks.h"
 
 отсюда всякое для шутера
 https://github.com/blurrypiano/littleVulkanEngine
@@ -11,11 +12,25 @@ magma-engine
 #	pragma comment( lib, "NanoEngine3rdparty.lib" )
 #endif
 //-----------------------------------------------------------------------------
-int main(
-	[[maybe_unused]] int   argc,
-	[[maybe_unused]] char* argv[])
+int main(int argc, char* argv[])
 {
+	// NewFPS --bench <name> [args...]: runs an engine check or benchmark without window and GPU and exits
+	if (argc >= 2 && std::string_view(argv[1]) == "--bench")
+	{
+		BenchmarkApplication bench(argc >= 3 ? argv[2] : "", std::vector<std::string>(argv + std::min(argc, 3), argv + argc));
+		bench.Run();
+		return bench.Succeeded() ? 0 : 1;
+	}
+
 	GameApplication app;
+
+	// NewFPS --pack <directory> <pack>: builds an asset pack (see EngineApplicationCreateInfo::assetPacks) and exits
+	if (argc == 4 && std::string_view(argv[1]) == "--pack")
+		return Failed(BuildAssetPack(argv[2], argv[3])) ? 1 : 0;
+	// NewFPS --headless [frames]: simulates without window and GPU and logs frame timings
+	if (argc >= 2 && std::string_view(argv[1]) == "--headless")
+		app.SetHeadless(argc >= 3 ? static_cast<uint32_t>(std::max(std::atoi(argv[2]), 1)) : 600);
+
 	app.Run();
 }
 //-----------------------------------------------------------------------------
\ No newline at end of file
@@ -44,15 +44,16 @@ void main() {
 
     vec3 Lo = vec3(0.0);
 
-    for (int i = 0; i < uNumPointLights; i++) {
-        const vec3 lightDelta = uPointLights[i].Position - worldPosition.xyz;
+    const uvec2 lightCluster = GetLightCluster(viewSpacePosition.xyz);
+    for (uint i = 0; i < lightCluster.y; i++) {
+        const PointLightData light = uPointLights[uLightIndices[lightCluster.x + i]];
+        const vec3 lightDelta = light.Position - worldPosition.xyz;
         const float lightDistance = length(lightDelta);
-        const float lightRadius = uPointLights[i].Radius;
-        if (lightDistance > lightRadius) {
+        if (lightDistance > light.Radius) {
             continue;
         }
-        const float falloff = PointLightFalloff(lightDistance, lightRadius);
-        Lo += PBR(lightDelta, uPointLights[i].Color, V, N, roughness, metallic, albedo, F0) * falloff;
+        const float falloff = PointLightFalloff(lightDistance, light.Radius);
+        Lo += PBR(lightDelta, light.Color, V, N, roughness, metallic, albedo, F0) * falloff;
     }
 
     const float shadow = ReadShadowMap(viewSpacePosition, worldPosition);
@@ -10,6 +10,7 @@ layout (location = 0) out vec4 vNormal;
 
 layout (push_constant) uniform PushConstantData {
     mat4 uModel;
+    uint uCascadeMask;
 };
 
 void main() {
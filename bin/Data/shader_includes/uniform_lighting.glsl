@@ -1,6 +1,11 @@
 #ifndef UNIFORM_LIGHTING_GLSL
 #define UNIFORM_LIGHTING_GLSL
 
+// must match LightClusterBuilder::GRID_SIZE_*
+#define LIGHT_CLUSTER_GRID_X 16
+#define LIGHT_CLUSTER_GRID_Y 9
+#define LIGHT_CLUSTER_GRID_Z 24
+
 struct PointLightData {
     vec3 Position;
     float Radius;
@@ -16,7 +21,30 @@ layout (set = 0, binding = 1) uniform LightingUniformData {
     vec3 uCascadeShadowMapSplits;
     float LightingUniformDataPadding1;
     mat4 uShadowMatrices[4];
-    PointLightData uPointLights[128];
+    vec4 uLightClusterParams; // xy: view xy / z to NDC scale, zw: depth slice = log(view z) * z + w
+};
+
+layout (std430, set = 0, binding = 2) readonly buffer PointLightBuffer {
+    PointLightData uPointLights[];
+};
+
+// (offset, count) in uLightIndices, one per cluster
+layout (std430, set = 0, binding = 3) readonly buffer LightClusterBuffer {
+    uvec2 uLightClusters[];
+};
+
+layout (std430, set = 0, binding = 4) readonly buffer LightIndexBuffer {
+    uint uLightIndices[];
 };
 
+// Same mapping as LightClusterBuilder::GetClusterIndex.
+uvec2 GetLightCluster(vec3 viewPosition) {
+    const vec2 gridSize = vec2(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y);
+    const vec2 ndc = viewPosition.xy / max(viewPosition.z, 1e-4) * uLightClusterParams.xy;
+    const uvec2 tile = uvec2(clamp(floor((ndc * 0.5 + 0.5) * gridSize), vec2(0.0), gridSize - 1.0));
+    const float slice = log(max(viewPosition.z, 1e-4)) * uLightClusterParams.z + uLightClusterParams.w;
+    const uint z = uint(clamp(slice, 0.0, float(LIGHT_CLUSTER_GRID_Z - 1)));
+    return uLightClusters[tile.x + tile.y * LIGHT_CLUSTER_GRID_X + z * LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y];
+}
+
 #endif
@@ -25,4 +25,15 @@ float4 psmain(VSOutput input) : SV_TARGET
     float4 value  = Tex0.Sample(Sampler0, input.TexCoord).xxxx;    
     float4 output = value * input.Color4;
     return output;
-}
\ No newline at end of file
+}
+
+// For TextureFont with signedDistanceField. The atlas stores 128 on the glyph outline, fwidth keeps the
+// antialiased edge about one pixel wide whatever size the glyph is drawn at.
+float4 psmain_sdf(VSOutput input) : SV_TARGET
+{
+    float distance = Tex0.Sample(Sampler0, input.TexCoord).x;
+    float width    = max(0.5 * fwidth(distance), 0.0001);
+    float coverage = smoothstep(128.0 / 255.0 - width, 128.0 / 255.0 + width, distance);
+    float4 output  = coverage * input.Color4;
+    return output;
+}